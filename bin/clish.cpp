@@ -5,6 +5,8 @@
 //-------------------------------------
 #include "clish/private.h"
 
+#include <string.h>
+
 static 
 clish_shell_hooks_t my_hooks = 
 {
@@ -15,6 +17,20 @@ clish_shell_hooks_t my_hooks =
     NULL, /* don't worry about fini callback */
     NULL  /* don't register any builtin functions */
 };
+/*
+ * When asked, save starting a new shell for every ACTION script
+ * run from a file. The scripts then share their environment.
+ */
+static 
+clish_shell_hooks_t my_coprocess_hooks = 
+{
+    NULL, /* don't worry about init callback */
+    clish_access_callback,
+    NULL, /* don't worry about cmd_line callback */
+    clish_script_coprocess_callback,
+    NULL, /* don't worry about fini callback */
+    NULL  /* don't register any builtin functions */
+};
 //---------------------------------------------------------
 int 
 main(int argc, const char **argv)
@@ -23,13 +39,26 @@ main(int argc, const char **argv)
 	
     clish_startup(argc,argv);
     
-    if(argc > 1)
+    if((argc > 2) && (0 == strcmp(argv[1],"-compile")))
+    {
+        /* save the XML definitions as an image for later sessions */
+        result = clish_shell_compile(argv[2]);
+    }
+    else if(argc > 1)
     {
-        int i = 1;
+        clish_shell_hooks_t *hooks = &my_hooks;
+        int                  i     = 1;
+
+        if(0 == strcmp(argv[1],"-coprocess"))
+        {
+            hooks = &my_coprocess_hooks;
+            i++;
+            argc--;
+        }
         while(argc--)
         {
             /* run the commands in the file */
-            result = clish_shell_spawn_from_file(&my_hooks,NULL,argv[i++]);
+            result = clish_shell_spawn_from_file(hooks,NULL,argv[i++]);
         }
     }
     else
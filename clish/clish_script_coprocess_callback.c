@@ -0,0 +1,22 @@
+/*
+ * clish_script_coprocess_callback.c
+ *
+ *
+ * Callback hook to action a shell script using the shell's coprocess
+ * rather than starting a new shell for every command.
+ */
+#include <stdio.h>
+ 
+#include "private.h" 
+/*--------------------------------------------------------- */
+bool_t
+clish_script_coprocess_callback(const clish_shell_t *shell,
+                                const char          *script)
+{
+#ifdef DEBUG
+    printf("COPROCESS: %s\n",script);   
+#endif /* DEBUG */
+
+    return clish_shell_coprocess_execute(shell,script);
+}
+/*--------------------------------------------------------- */
@@ -19,8 +19,12 @@
 static void
 usage(const char *filename)
 {
-    printf("%s [-help] [scriptname]\n",filename);
+    printf("%s [-help] [-compile imagename] [-coprocess] [scriptname]\n",filename);
     printf("  -help      : display this usage\n");
+    printf("  -compile   : save the XML definitions as the specified image\n");
+    printf("  -coprocess : evaluate the ACTION scripts of a scriptname in a\n");
+    printf("               single shell, which they share, rather than\n");
+    printf("               starting a new shell for each one\n");
     printf("  scriptname : run the commands in the specified file\n");
     printf("\n");
     printf("VERSION %s\n\n",PACKAGE_VERSION);
@@ -29,6 +33,13 @@ usage(const char *filename)
     printf("               which should be searched for XML definition files.\n");
     printf("               Current Value: '%s'\n",getenv("CLISH_PATH"));
     printf("               If undefined then '/etc/clish;~/.clish' will be used.\n");
+    printf("  CLISH_IMAGE: Set to the name of an image made with -compile. This\n");
+    printf("               is used in place of the XML definition files unless\n");
+    printf("               they have changed since it was made.\n");
+    printf("               Current Value: '%s'\n",getenv("CLISH_IMAGE"));
+    printf("  CLISH_HISTORY: Set to the name of a file in which the command\n");
+    printf("               history is kept and shared between sessions.\n");
+    printf("               Current Value: '%s'\n",getenv("CLISH_HISTORY"));
 }
 /*--------------------------------------------------------- */
 void 
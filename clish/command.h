@@ -10,6 +10,7 @@ typedef struct clish_command_s clish_command_t;
 #include "clish/pargv.h"
 #include "clish/view.h"
 #include "clish/param.h"
+#include "clish/variable.h"
 
 /*=====================================
  * COMMAND INTERFACE
@@ -28,6 +29,8 @@ void
                             lub_bintree_key_t *key);
 size_t
     clish_command_bt_offset(void);
+const char *
+    clish_command_hash_getkey(const void *clientnode);
 clish_command_t *
     clish_command_choose_longest(clish_command_t *cmd1,
                                  clish_command_t *cmd2);
@@ -65,20 +68,28 @@ const char *
     clish_command__get_detail(const clish_command_t *instance);
 const char *
     clish_command__get_builtin(const clish_command_t *instance);
+bool_t
+    clish_command__get_executable(const clish_command_t *instance);
 const char *
     clish_command__get_escape_chars(const clish_command_t *instance);
 const clish_param_t *
     clish_command__get_args(const clish_command_t *instance);
+const char *
+    clish_command__get_access(const clish_command_t *instance);
 char *
-    clish_command__get_action(const clish_command_t *instance,
-                              const char            *viewid,
-                              clish_pargv_t         *pargv);
+    clish_command__get_action(const clish_command_t       *instance,
+                              const clish_variable_viewid_t *viewid,
+                              clish_pargv_t                 *pargv);
+const char *
+    clish_command__get_unexpanded_action(const clish_command_t *instance);
 clish_view_t *
     clish_command__get_view(const clish_command_t *instance);
 char *
-    clish_command__get_viewid(const clish_command_t *instance,
-                              const char            *viewid,
-                              clish_pargv_t         *pargv);
+    clish_command__get_viewid(const clish_command_t       *instance,
+                              const clish_variable_viewid_t *viewid,
+                              clish_pargv_t                 *pargv);
+const char *
+    clish_command__get_unexpanded_viewid(const clish_command_t *instance);
 const unsigned
 clish_command__get_param_count(const clish_command_t *instance);
 const clish_param_t *
@@ -96,6 +107,9 @@ void
 void
     clish_command__set_args(clish_command_t *instance,
                             clish_param_t   *args);
+void
+    clish_command__set_access(clish_command_t *instance,
+                              const char      *access);
 void
     clish_command__set_detail(clish_command_t *instance,
                               const char      *detail);
@@ -35,10 +35,14 @@ clish_command_init(clish_command_t *this,
     this->viewid       = NULL;
     this->view         = NULL;
     this->action       = NULL;
+    this->action_template = NULL;
+    this->viewid_template = NULL;
     this->detail       = NULL;
     this->builtin      = NULL;
     this->escape_chars = NULL;
     this->args         = NULL;
+    this->access       = NULL;
+    this->executable   = BOOL_FALSE;
 }
 /*--------------------------------------------------------- */
 static void
@@ -57,8 +61,12 @@ clish_command_fini(clish_command_t *this)
     free(this->paramv);
     lub_string_free(this->viewid);
     this->viewid = NULL;
+    clish_variable_template_delete(this->viewid_template);
+    this->viewid_template = NULL;
     lub_string_free(this->action);
     this->action = NULL;
+    clish_variable_template_delete(this->action_template);
+    this->action_template = NULL;
     lub_string_free(this->name);
     this->name = NULL;
     lub_string_free(this->text);
@@ -69,6 +77,8 @@ clish_command_fini(clish_command_t *this)
     this->builtin = NULL;
     lub_string_free(this->escape_chars);
     this->escape_chars = NULL;
+    lub_string_free(this->access);
+    this->access = NULL;
 
     if(NULL != this->args)
     {
@@ -77,6 +87,24 @@ clish_command_fini(clish_command_t *this)
     }
 }
 
+/*--------------------------------------------------------- */
+/*
+ * A command is executable if it does something i.e. it has an
+ * action which expands to something, a builtin or a view to move to.
+ * This is worked out as the command is defined rather than each time
+ * a command line is resolved.
+ */
+static void
+clish_command_update_executable(clish_command_t *this)
+{
+    this->executable = BOOL_FALSE;
+    if((NULL != this->builtin) ||
+       (NULL != this->view)    ||
+       (0 != clish_variable_template__get_segment_count(this->action_template)))
+    {
+        this->executable = BOOL_TRUE;
+    }
+}
 /*---------------------------------------------------------
  * PUBLIC META FUNCTIONS
  *--------------------------------------------------------- */
@@ -106,6 +134,14 @@ clish_command_bt_getkey(const void         *clientnode,
     strcpy((char *)key,this->name);
 }
 /*--------------------------------------------------------- */
+const char *
+clish_command_hash_getkey(const void *clientnode)
+{
+    const clish_command_t *this = clientnode;
+
+    return this->name;
+}
+/*--------------------------------------------------------- */
 clish_command_t *
 clish_command_new(const char *name,
                   const char *text)
@@ -395,6 +431,10 @@ clish_command__set_action(clish_command_t *this,
 {
     assert(NULL == this->action);
     this->action = lub_string_dup(action);
+
+    /* parse any variables once rather than at each execution */
+    this->action_template = clish_variable_template_new(action);
+    clish_command_update_executable(this);
 }
 /*--------------------------------------------------------- */
 const char *
@@ -412,11 +452,20 @@ clish_command__set_detail(clish_command_t *this,
 }
 /*--------------------------------------------------------- */
 char *
-clish_command__get_action(const clish_command_t *this,
-                          const char            *viewid,
-                          clish_pargv_t         *pargv)
+clish_command__get_action(const clish_command_t       *this,
+                          const clish_variable_viewid_t *viewid,
+                          clish_pargv_t                 *pargv)
+{
+    return clish_variable_template_expand(this->action_template,
+                                          viewid,
+                                          this,
+                                          pargv);
+}
+/*--------------------------------------------------------- */
+const char *
+clish_command__get_unexpanded_action(const clish_command_t *this)
 {
-    return clish_variable_expand(this->action,viewid,this,pargv);
+    return this->action;
 }
 /*--------------------------------------------------------- */
 void
@@ -425,6 +474,7 @@ clish_command__set_view(clish_command_t *this,
 {
     assert(NULL == this->view);
     this->view = view;
+    clish_command_update_executable(this);
 }
 /*--------------------------------------------------------- */
 clish_view_t *
@@ -439,14 +489,26 @@ clish_command__set_viewid(clish_command_t *this,
 {
     assert(NULL == this->viewid);
     this->viewid = lub_string_dup(viewid);
+
+    /* parse any variables once rather than at each execution */
+    this->viewid_template = clish_variable_template_new(viewid);
 }
 /*--------------------------------------------------------- */
 char *
-clish_command__get_viewid(const clish_command_t *this,
-                          const char            *viewid,
-                          clish_pargv_t         *pargv)
+clish_command__get_viewid(const clish_command_t       *this,
+                          const clish_variable_viewid_t *viewid,
+                          clish_pargv_t                 *pargv)
 {
-    return clish_variable_expand(this->viewid,viewid,this,pargv);
+    return clish_variable_template_expand(this->viewid_template,
+                                          viewid,
+                                          this,
+                                          pargv);
+}
+/*--------------------------------------------------------- */
+const char *
+clish_command__get_unexpanded_viewid(const clish_command_t *this)
+{
+    return this->viewid;
 }
 /*--------------------------------------------------------- */
 const clish_param_t *
@@ -500,6 +562,7 @@ clish_command__set_builtin(clish_command_t *this,
 {
     assert(NULL == this->builtin);
     this->builtin = lub_string_dup(builtin);
+    clish_command_update_executable(this);
 }
 /*--------------------------------------------------------- */
 const char *
@@ -508,6 +571,12 @@ clish_command__get_builtin(const clish_command_t *this)
     return this->builtin;
 }
 /*--------------------------------------------------------- */
+bool_t
+clish_command__get_executable(const clish_command_t *this)
+{
+    return this->executable;
+}
+/*--------------------------------------------------------- */
 void
 clish_command__set_escape_chars(clish_command_t *this,
                                 const char      *escape_chars)
@@ -536,6 +605,20 @@ clish_command__get_args(const clish_command_t *this)
     return this->args;
 }
 /*--------------------------------------------------------- */
+void
+clish_command__set_access(clish_command_t *this,
+                          const char      *access)
+{
+    assert(NULL == this->access);
+    this->access = lub_string_dup(access);
+}
+/*--------------------------------------------------------- */
+const char *
+clish_command__get_access(const clish_command_t *this)
+{
+    return this->access;
+}
+/*--------------------------------------------------------- */
 const unsigned
 clish_command__get_param_count(const clish_command_t *this)
 {
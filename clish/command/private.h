@@ -14,10 +14,14 @@ struct clish_command_s
     unsigned        paramc;
     clish_param_t **paramv;
     char           *action;
+    clish_variable_template_t *action_template;
     clish_view_t   *view;
     char           *viewid;
+    clish_variable_template_t *viewid_template;
     char           *detail;
     char           *builtin;
     char           *escape_chars;
     clish_param_t  *args;
+    char           *access;
+    bool_t          executable;
 };
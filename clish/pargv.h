@@ -26,6 +26,7 @@ typedef struct clish_parg_s  clish_parg_t;
 
 #include "clish/ptype.h"
 #include "clish/command.h"
+#include "lub/argv.h"
 
 /*=====================================
  * PARGV INTERFACE
@@ -38,6 +39,14 @@ clish_pargv_t *
 		                const char            *line,
 		                size_t                 offset,
 		                clish_pargv_status_t  *status);
+/*
+ * As above but for a line which has already been split into words.
+ */
+clish_pargv_t *
+		clish_pargv_new_argv(const clish_command_t *cmd,
+		                     const lub_argv_t      *argv,
+		                     size_t                 offset,
+		                     clish_pargv_status_t  *status);
 /*-----------------
  * methods
  *----------------- */
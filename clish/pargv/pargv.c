@@ -93,7 +93,8 @@ set_defaults(clish_pargv_t         *this,
 static clish_pargv_status_t
 clish_pargv_init(clish_pargv_t         *this,
                  const clish_command_t *cmd,
-                 const lub_argv_t      *argv)
+                 const lub_argv_t      *argv,
+                 size_t                 offset)
 {
     const clish_param_t *param;
     unsigned             start = lub_argv_wordcount(clish_command__get_name(cmd));
@@ -134,10 +135,10 @@ clish_pargv_init(clish_pargv_t         *this,
                 if(NULL == arg)
                 {
                     const char *prefix = clish_param__get_prefix(param);
-                    size_t      offset = lub_argv__get_offset(argv,i-1);
+                    size_t      pos    = offset + lub_argv__get_offset(argv,i-1);
 
-                    offset += strlen(prefix) + 1;
-                    clish_param_help(param,offset);
+                    pos += strlen(prefix) + 1;
+                    clish_param_help(param,pos);
                     return clish_BAD_PARAM;
                 }
             }
@@ -165,7 +166,7 @@ clish_pargv_init(clish_pargv_t         *this,
             }
             else
             {
-                clish_param_help(param,lub_argv__get_offset(argv,i));
+                clish_param_help(param,offset + lub_argv__get_offset(argv,i));
                 return clish_BAD_PARAM;
             }
         }
@@ -180,35 +181,38 @@ clish_pargv_init(clish_pargv_t         *this,
                 /* 
                  * put all the argument into a single string 
                  */
-                char *args = NULL;
+                char         storage[256];
+                lub_strbuf_t args;
+
+                lub_strbuf_init(&args,storage,sizeof(storage));
                 while(NULL != arg)
                 {
                     bool_t quoted = lub_argv__get_quoted(argv,i);
                     if(BOOL_TRUE == quoted) 
                     {
-                        lub_string_cat(&args,"\"");
+                        lub_strbuf_cat(&args,"\"");
                     }
                     /* place the current argument in the string */
-                    lub_string_cat(&args,arg);
+                    lub_strbuf_cat(&args,arg);
                     if(BOOL_TRUE == quoted) 
                     {
-                        lub_string_cat(&args,"\"");
+                        lub_strbuf_cat(&args,"\"");
                     }
                     i++;
                     arg = lub_argv__get_arg(argv,i);
                     if(NULL != arg)
                     {
                         /* add a space if there are more arguments */
-                        lub_string_cat(&args," ");
+                        lub_strbuf_cat(&args," ");
                     }
                 }
                 /* add (or update) this parameter */
-                insert_parg(this,param,args);
-                lub_string_free(args);
+                insert_parg(this,param,lub_strbuf__get_string(&args));
+                lub_strbuf_fini(&args);
             }
             else
             {
-                printf("%*c\n",lub_argv__get_offset(argv,i),'^');
+                printf("%*c\n",(int)(offset + lub_argv__get_offset(argv,i)),'^');
                 return clish_BAD_PARAM;
             }
         }
@@ -219,9 +223,9 @@ clish_pargv_init(clish_pargv_t         *this,
         if(NULL == find_parg(this,clish_param__get_name(param)))
         {
             /* failed to construct a valid command line */
-            size_t offset = lub_argv__get_offset(argv,i-1);
-            offset += strlen(lub_argv__get_arg(argv,i-1)) + 1;
-            clish_param_help(param,offset);
+            size_t pos = offset + lub_argv__get_offset(argv,i-1);
+            pos += strlen(lub_argv__get_arg(argv,i-1)) + 1;
+            clish_param_help(param,pos);
             return clish_BAD_PARAM;
         }
     }
@@ -229,13 +233,12 @@ clish_pargv_init(clish_pargv_t         *this,
 }
 /*--------------------------------------------------------- */
 clish_pargv_t *
-clish_pargv_new(const clish_command_t *cmd,
-                const char            *line,
-                size_t                 offset,
-                clish_pargv_status_t  *status)
+clish_pargv_new_argv(const clish_command_t *cmd,
+                     const lub_argv_t      *argv,
+                     size_t                 offset,
+                     clish_pargv_status_t  *status)
 {
     clish_pargv_t *this;
-    lub_argv_t   *argv       = lub_argv_new(line,offset);
     unsigned      max_params = lub_argv__get_count(argv);
     unsigned      cmd_params = clish_command__get_param_count(cmd);
     size_t        size;
@@ -252,7 +255,7 @@ clish_pargv_new(const clish_command_t *cmd,
 
     if(NULL != this)
     {
-        *status = clish_pargv_init(this,cmd,argv);
+        *status = clish_pargv_init(this,cmd,argv,offset);
         switch(*status)
         {
             case clish_LINE_OK:
@@ -267,6 +270,20 @@ clish_pargv_new(const clish_command_t *cmd,
         }
     }
 
+    return this;
+}
+/*--------------------------------------------------------- */
+clish_pargv_t *
+clish_pargv_new(const clish_command_t *cmd,
+                const char            *line,
+                size_t                 offset,
+                clish_pargv_status_t  *status)
+{
+    clish_pargv_t *this;
+    lub_argv_t    *argv = lub_argv_new(line,0);
+
+    this = clish_pargv_new_argv(cmd,argv,offset,status);
+
     /* cleanup */
     lub_argv_delete(argv);
 
@@ -28,6 +28,7 @@ extern struct termios clish_default_tty_termios;
 /* clish callback functions */
 extern clish_shell_access_fn_t   clish_access_callback;
 extern clish_shell_script_fn_t   clish_script_callback;
+extern clish_shell_script_fn_t   clish_script_coprocess_callback;
 
 /* tclish callback functions */
 extern clish_shell_init_fn_t   tclish_init_callback;
@@ -85,6 +85,8 @@ void
                           lub_bintree_key_t *key);
 size_t
     clish_ptype_bt_offset(void);
+const char *
+    clish_ptype_hash_getkey(const void *clientnode);
 const char *
     clish_ptype_method__get_name(clish_ptype_method_e method);
 clish_ptype_method_e
@@ -132,9 +134,9 @@ char *
  * This is used to perform parameter auto-completion
  */
 char *
-    clish_ptype_word_generator(clish_ptype_t *instance,
-                               const char    *text,
-                               unsigned       state);
+    clish_ptype_word_generator(const clish_ptype_t *instance,
+                               const char          *text,
+                               unsigned             state);
 void
     clish_ptype_dump(clish_ptype_t *instance);
 /*-----------------
@@ -146,6 +148,12 @@ const char *
     clish_ptype__get_text(const clish_ptype_t *instance);
 const char *
     clish_ptype__get_range(const clish_ptype_t *instance);
+const char *
+    clish_ptype__get_pattern(const clish_ptype_t *instance);
+clish_ptype_method_e
+    clish_ptype__get_method(const clish_ptype_t *instance);
+clish_ptype_preprocess_e
+    clish_ptype__get_preprocess(const clish_ptype_t *instance);
 void
     clish_ptype__set_preprocess(clish_ptype_t            *instance,
                                 clish_ptype_preprocess_e  preprocess);
@@ -30,7 +30,6 @@ struct clish_ptype_s
     char                    *range;
     clish_ptype_method_e     method;
     clish_ptype_preprocess_e preprocess;
-    unsigned                 last_name; /* index used for auto-completion */
     union
     {
         regex_t               regexp;
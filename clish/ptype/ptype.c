@@ -108,23 +108,28 @@ clish_ptype__set_range(clish_ptype_t *this)
             /*
              * Setup the selection values to the help text
              */
-            unsigned    i;
+            unsigned     i;
+            lub_strbuf_t range;
             
+            lub_strbuf_init(&range,tmp,sizeof(tmp));
             for(i=0;
                 i < lub_argv__get_count(this->u.select.items);
                 i++)
             {
-                char *p    = tmp;
                 char *name = clish_ptype_select__get_name(this,i);
                 
                 if(i > 0)
                 {
-                    p += sprintf(p,"/");
+                    lub_strbuf_cat(&range,"/");
                 }
-                p += sprintf(p,"%s",name);
-                lub_string_cat(&this->range,tmp);
+                lub_strbuf_cat(&range,name);
                 lub_string_free(name);
             }
+            if(i > 0)
+            {
+                this->range = lub_strbuf_detach(&range);
+            }
+            lub_strbuf_fini(&range);
             break;
         }
         /*------------------------------------------------- */
@@ -159,6 +164,14 @@ clish_ptype_bt_offset(void)
       return offsetof(clish_ptype_t,bt_node);
 }
 /*--------------------------------------------------------- */
+const char *
+clish_ptype_hash_getkey(const void *clientnode)
+{
+        const clish_ptype_t *this = clientnode;
+
+        return this->name;
+}
+/*--------------------------------------------------------- */
 static const char *method_names[] = 
 {
     "regexp",
@@ -237,31 +250,43 @@ clish_ptype_preprocess_resolve(const char *name)
 
 /*--------------------------------------------------------- */
 char *
-clish_ptype_word_generator(clish_ptype_t *this,
-                           const char    *text,
-                           unsigned       state)
+clish_ptype_word_generator(const clish_ptype_t *this,
+                           const char          *text,
+                           unsigned             state)
 {
-    char                  *result = NULL;
-    if (0 == state)
+    /* first of all simply try to validate the result */
+    char *result = clish_ptype_validate(this,text);
+
+    if(NULL != result)
     {
-        /* first of all simply try to validate the result */
-        result = clish_ptype_validate(this,text);
+        if(0 != state)
+        {
+            /* valid text is its own and only completion */
+            lub_string_free(result);
+            result = NULL;
+        }
     }
-    if(NULL == result)
+    else
     {
         switch(this->method)
         {
             /*--------------------------------------------- */
             case CLISH_PTYPE_SELECT:
             {
-                if(0 == state)
-                {
-                    this->last_name = 0;
-                }
-                while((result = clish_ptype_select__get_name(this,this->last_name++)))
+                unsigned i;
+                
+                /* 
+                 * A ptype may be shared between shells, so rather than
+                 * remember where the last call got to, count past the
+                 * completions which have already been returned.
+                 */
+                for(i = 0;
+                    (result = clish_ptype_select__get_name(this,i));
+                    i++)
                 {
                     /* get the next item and check if it is a completion */
-                    if(result == lub_string_nocasestr(result,text))
+                    if((result == lub_string_nocasestr(result,text)) &&
+                       (0 == state--))
                     {
                         /* found the next completion */
                         break; 
@@ -586,16 +611,20 @@ clish_ptype__set_pattern(clish_ptype_t       *this,
         /*------------------------------------------------- */
         case CLISH_PTYPE_REGEXP:
         {
-            int result;
+            int   result;
+            char *anchored = NULL;
     
+            this->pattern = lub_string_dup(pattern);
+
             /* only the expression is allowed */
-            lub_string_cat(&this->pattern,"^");
-            lub_string_cat(&this->pattern,pattern);
-            lub_string_cat(&this->pattern,"$");
+            lub_string_cat(&anchored,"^");
+            lub_string_cat(&anchored,pattern);
+            lub_string_cat(&anchored,"$");
 
             /* compile the regular expression for later use */
-            result = regcomp(&this->u.regexp,this->pattern,REG_NOSUB | REG_EXTENDED);
+            result = regcomp(&this->u.regexp,anchored,REG_NOSUB | REG_EXTENDED);
             assert(0 == result);
+            lub_string_free(anchored);
             break;
         }
         /*------------------------------------------------- */
@@ -662,3 +691,21 @@ clish_ptype__get_range(const clish_ptype_t *this)
     return (const char*)this->range;
 }
 /*--------------------------------------------------------- */
+const char *
+clish_ptype__get_pattern(const clish_ptype_t *this)
+{
+    return (const char*)this->pattern;
+}
+/*--------------------------------------------------------- */
+clish_ptype_method_e
+clish_ptype__get_method(const clish_ptype_t *this)
+{
+    return this->method;
+}
+/*--------------------------------------------------------- */
+clish_ptype_preprocess_e
+clish_ptype__get_preprocess(const clish_ptype_t *this)
+{
+    return this->preprocess;
+}
+/*--------------------------------------------------------- */
@@ -142,10 +142,11 @@ typedef bool_t
   * A hook function used to control access for the current user.
   * 
   * This will be invoked from the context of the spawned shell's thread
-  * and will be called during the parsing of the XML files.
+  * the first time that shell looks up a command with a given access
+  * string. The answer is remembered for the rest of the session.
   * 
-  * The clish component will only insert a command into a view if the access 
-  * call is sucessfull.
+  * The clish component will only let the shell use the command if the
+  * access call is sucessfull.
   *
   * The client may choose to implement invocation of the script in a number of
   * ways, which may include forking a sub-process or thread. It is important 
@@ -156,8 +157,8 @@ typedef bool_t
   * - BOOL_FALSE - if the user of the current CLISH session is not permitted access
   *
   * \post
-  * - If access is granted then the associated command will be inserted into the
-  *   appropriate view.
+  * - If access is granted then the associated commands will be available to
+  *   this shell.
   */
 typedef bool_t 
     clish_shell_access_fn_t(
@@ -181,6 +182,10 @@ typedef bool_t
   * A client may register any number of these callbacks in its 
   * clish_shell_builtin_cmds_t structure.
   *
+  * Shells which are running at the same time share a single read-only
+  * copy of the definitions held in the XML files; these are only read
+  * when a shell is spawned whilst no other shell is running.
+  *
   * \return
   * - BOOL_TRUE  - if the command completes correctly
   * - BOOL_FALSE - if the command fails.
@@ -275,6 +280,27 @@ bool_t
                                 void                      *cookie,
                                 const                char *filename);
         
+/**
+ * This operation reads the XML definition files found in the CLISH_PATH
+ * and saves the definitions they hold as an image. A shell which is
+ * spawned whilst the CLISH_IMAGE environment variable names this image
+ * will load it in place of the XML files, unless any of them have been
+ * added, removed or changed since it was made.
+ *
+ * Commands are saved with any access restriction, which each shell
+ * checks as it looks the commands up.
+ *
+ * \return
+ * - BOOL_TRUE  - if the image was saved
+ * - BOOL_FALSE - if the image could not be saved
+ */
+bool_t
+    clish_shell_compile(
+        /**
+         * The name of the image file to create (or replace)
+         */
+        const char *filename
+    );
 clish_shell_t *
     clish_shell_new(const clish_shell_hooks_t *hooks,
                     void                      *cookie,
@@ -322,6 +348,35 @@ void
     clish_shell_dump(clish_shell_t *instance);
 void
     clish_shell_close(clish_shell_t *instance);
+/**
+ * This operation evaluates a script using a "/bin/sh" coprocess which
+ * is started the first time it is called and lives as long as the shell
+ * instance. This avoids the cost of starting a new shell for every
+ * script, which is what system() does.
+ *
+ * The scripts share the environment of the coprocess, so (unlike with
+ * system()) a change of directory or variable made by one script is seen
+ * by the next. A script which calls "exit" causes a new coprocess to be
+ * started for the next script. If the coprocess cannot be started, or is
+ * killed, then system() is used instead.
+ *
+ * A client may use this to implement its clish_shell_script_fn_t hook.
+ *
+ * \return
+ * - BOOL_TRUE  - if the script is executed without issue
+ * - BOOL_FALSE - if the script had an issue with execution.
+ */
+bool_t
+    clish_shell_coprocess_execute(
+        /** 
+         * The shell instance on which to operate
+         */
+        const clish_shell_t *instance,
+        /** 
+         * The script to be evaluated
+         */
+        const char          *script
+    );
 /*-----------------
  * attributes 
  *----------------- */
@@ -3,9 +3,14 @@
  */
 #include "clish/shell.h"
 #include "clish/pargv.h"
+#include "clish/variable.h"
 #include "lub/bintree.h"
+#include "lub/hash.h"
+#include "lub/argv.h"
 #include "tinyrl/tinyrl.h"
 
+#include <sys/types.h>
+
 /*-------------------------------------
  * PRIVATE TYPES 
  *------------------------------------- */
@@ -36,21 +41,80 @@ struct clish_shell_file_s
     bool_t              stop_on_error;      /* stop on error for file input  */
 };
 
-struct clish_shell_s
+/* this is used to evaluate scripts without starting a new shell each time */
+typedef struct clish_shell_coprocess_s clish_shell_coprocess_t;
+struct clish_shell_coprocess_s
+{
+    pid_t               pid;
+    int                 fd;                 /* commands to and status from it */
+    bool_t              failed;             /* fall back to system()         */
+};
+
+/* this is used to remember the client's access decisions */
+typedef struct clish_shell_access_s clish_shell_access_t;
+struct clish_shell_access_s
+{
+    clish_shell_access_t *next;
+    const char          *access;            /* the restriction (model owned) */
+    bool_t               allowed;           /* whether the user may pass it  */
+};
+
+/* 
+ * this is used to remember what has been learnt about a line of text
+ * so that it need not be worked out again until the line changes
+ */
+typedef struct
+{
+    clish_view_t        *view;              /* the view resolved against     */
+    bool_t               valid;             /* the prefix is known           */
+    clish_command_t     *prefix;            /* the longest matching command  */
+    size_t               extent;            /* text the prefix depends upon  */
+} clish_line_ctx_resolution_t;
+
+typedef struct clish_line_ctx_s clish_line_ctx_t;
+struct clish_line_ctx_s
+{
+    clish_shell_t       *shell;             /* whose access rights apply     */
+    char                *line;              /* the line being analysed       */
+    lub_argv_t          *argv;              /* the words of the line         */
+    clish_line_ctx_resolution_t local;      /* resolved in the current view  */
+    clish_line_ctx_resolution_t global;     /* resolved in the global view   */
+    bool_t               extension_valid;   /* the extension is known        */
+    const clish_command_t *extension;       /* the first completion          */
+};
+
+/*
+ * The definitions read from the XML files. Once a model has been
+ * frozen it is never modified, so it may be shared by many shells.
+ */
+typedef struct clish_shell_model_s clish_shell_model_t;
+struct clish_shell_model_s
 {
     lub_bintree_t        view_tree;         /* Maintain a tree of views      */
     lub_bintree_t        ptype_tree;        /* Maintain a tree of ptypes     */
+    lub_hash_t           view_hash;         /* Find views by name            */
+    lub_hash_t           ptype_hash;        /* Find ptypes by name           */
+    clish_view_t        *global;            /* Reference to the global view. */
+    clish_command_t     *startup;           /* This is the startup command   */
+    char                *overview;          /* Overview text for this shell.  */
+    unsigned             refcount;          /* Number of shells using it     */
+    bool_t               frozen;            /* No more definitions allowed   */
+};
+
+struct clish_shell_s
+{
+    clish_shell_model_t *model;             /* The (shared) definitions      */
     const clish_shell_hooks_t *client_hooks;/* Client callback hooks         */
     void                *client_cookie;     /* Client callback cookie        */
-    clish_view_t        *global;            /* Reference to the global view. */
     clish_view_t        *view;              /* Reference to the current view.*/
-    clish_command_t     *startup;           /* This is the startup command   */
     clish_shell_iterator_t iter;            /* used for iterating commands */
     shell_state_t        state;             /* The current state               */
-    char                *overview;          /* Overview text for this shell.  */
-    char                *viewid;            /* The current view ID string     */
+    clish_variable_viewid_t *viewid;        /* The current view ID            */
     tinyrl_t            *tinyrl;            /* Tiny readline instance          */
     clish_shell_file_t  *current_file;      /* file currently in use for input */
+    clish_shell_coprocess_t *coprocess;     /* script evaluation coprocess     */
+    clish_line_ctx_t    *line_ctx;          /* analysis of the current line    */
+    clish_shell_access_t *access;           /* access decisions made so far    */
 };
 
 /**
@@ -94,7 +158,11 @@ bool_t
 clish_view_t *
     clish_shell_find_view(clish_shell_t *instance,
                               const char    *name);
-void
+/*
+ * Add a view to the model; if it cannot be added it is deleted and
+ * BOOL_FALSE is returned.
+ */
+bool_t
     clish_shell_insert_view(clish_shell_t *instance,
                             clish_view_t    *view);
 clish_pargv_status_t
@@ -119,7 +187,11 @@ const clish_command_t *
 const clish_command_t *
      clish_shell_getnext_command(clish_shell_t *instance,
                                  const char    *line);
-void
+/*
+ * Add a ptype to the model; if it cannot be added it is deleted and
+ * BOOL_FALSE is returned.
+ */
+bool_t
      clish_shell_insert_ptype(clish_shell_t *instance,
                               clish_ptype_t *ptype);
 void
@@ -131,4 +203,82 @@ tinyrl_t *
                            unsigned stifle);
 void
     clish_shell_tinyrl_delete(tinyrl_t *instance);
-
+void
+    clish_shell_coprocess_init(clish_shell_coprocess_t *instance);
+void
+    clish_shell_coprocess_fini(clish_shell_coprocess_t *instance);
+clish_shell_model_t *
+    clish_shell_model_new(void);
+void
+    clish_shell_model_release(clish_shell_model_t *instance);
+/**
+ * Attach the shell to the model shared by all spawned shells, loading
+ * the XML files found in the CLISH path if there is no such model.
+ */
+void
+    clish_shell_attach_model(clish_shell_t *instance);
+void
+    clish_shell_load_files(clish_shell_t *instance);
+/**
+ * Find the XML files in the directories of the CLISH path.
+ *
+ * \return
+ * A NULL terminated list of filenames, in the order they are to be read.
+ */
+char **
+    clish_shell_find_files(clish_shell_t *instance);
+void
+    clish_shell_free_files(char **files);
+/**
+ * Load the definitions held in a compiled image, provided that it
+ * was compiled from exactly the specified files, none of which have
+ * changed since.
+ *
+ * \return
+ * BOOL_TRUE  - the definitions have been loaded.
+ * BOOL_FALSE - the image is missing, invalid or out of date, and
+ *              nothing has been loaded.
+ */
+bool_t
+    clish_shell_image_read(clish_shell_t *instance,
+                           const char    *filename,
+                           char         **files);
+/**
+ * Save the definitions held by this shell as a compiled image, along
+ * with the size and modification time of the files they were read from.
+ */
+bool_t
+    clish_shell_image_write(clish_shell_t *instance,
+                            const char    *filename,
+                            char         **files);
+/**
+ * Decide whether the user of the shell (passed as 'arg') may use the
+ * specified command, asking the client about any restriction which has
+ * not been seen before.
+ */
+clish_view_access_fn_t clish_shell_command_allowed;
+void
+    clish_shell_access_fini(clish_shell_t *instance);
+void
+    clish_line_ctx_init(clish_line_ctx_t *instance,
+                        clish_shell_t    *shell);
+void
+    clish_line_ctx_fini(clish_line_ctx_t *instance);
+/**
+ * Get the shell's line context up to date with the specified line,
+ * discarding only that analysis which the changes to the line affect.
+ */
+clish_line_ctx_t *
+    clish_shell_line_ctx(const clish_shell_t *instance,
+                         const char          *line);
+const lub_argv_t *
+    clish_line_ctx__get_argv(const clish_line_ctx_t *instance);
+const clish_command_t *
+    clish_line_ctx_resolve_prefix(clish_line_ctx_t *instance);
+const clish_command_t *
+    clish_line_ctx_resolve_command(clish_line_ctx_t *instance);
+const clish_command_t *
+    clish_line_ctx_find_next_completion(clish_line_ctx_t       *instance,
+                                        clish_shell_iterator_t *iter);
+const clish_command_t *
+    clish_line_ctx__get_extension(clish_line_ctx_t *instance);
@@ -7,6 +7,6 @@
 const char *
 clish_shell__get_viewid(const clish_shell_t *this)
 {
-	return this->viewid;
+	return clish_variable_viewid__get_text(this->viewid);
 }
 /*--------------------------------------------------------- */
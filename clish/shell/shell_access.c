@@ -0,0 +1,66 @@
+/*
+ * shell_access.c
+ *
+ * The model may be shared by the shells of several users, so the access
+ * restriction on a command is checked as each shell looks it up rather
+ * than when the definitions are read. The client's answer for each
+ * restriction is remembered for the rest of the session.
+ */
+#include "private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------- */
+bool_t
+clish_shell_command_allowed(const clish_command_t *cmd,
+                            void                  *arg)
+{
+    clish_shell_t        *this    = arg;
+    const char           *access  = clish_command__get_access(cmd);
+    clish_shell_access_t *entry;
+    bool_t                allowed = BOOL_FALSE; /* err on the side of caution */
+
+    if(NULL == access)
+    {
+        /* there is no restriction */
+        return BOOL_TRUE;
+    }
+    for(entry = this->access;
+        entry;
+        entry = entry->next)
+    {
+        if(0 == strcmp(entry->access,access))
+        {
+            return entry->allowed;
+        }
+    }
+    if(this->client_hooks->access_fn)
+    {
+        /* get the client to authenticate */
+        allowed = this->client_hooks->access_fn(this,access);
+    }
+    entry = malloc(sizeof(clish_shell_access_t));
+    if(NULL != entry)
+    {
+        /* the model holds the string for as long as this shell uses it */
+        entry->access  = access;
+        entry->allowed = allowed;
+        entry->next    = this->access;
+        this->access   = entry;
+    }
+    return allowed;
+}
+/*--------------------------------------------------------- */
+void
+clish_shell_access_fini(clish_shell_t *this)
+{
+    while(NULL != this->access)
+    {
+        clish_shell_access_t *entry = this->access;
+
+        this->access = entry->next;
+        free(entry);
+    }
+}
+/*--------------------------------------------------------- */
@@ -19,41 +19,18 @@ clish_shell_find_next_completion(const clish_shell_t    *this,
                                  const char             *line,
                                  clish_shell_iterator_t *iter)
 {
-    const clish_command_t *result=NULL,*cmd1,*cmd2;
-    int                    diff;
+    clish_line_ctx_t *ctx = clish_shell_line_ctx(this,line);
 
-    /* ask the local view for it's next command */
-    cmd1 = clish_view_find_next_completion(this->view,
-                                           iter->last_cmd_local,
-                                           line);
-    /* ask the global view for it's next command */
-    cmd2 = clish_view_find_next_completion(this->global,
-                                           iter->last_cmd_global,
-                                           line);
-    /* compare the two results */
-    diff = clish_command_diff(cmd1,cmd2);
-    if(diff > 0)
-    {
-        result = iter->last_cmd_global = cmd2;
-    }
-    else
-    {
-        if(0 == diff)
-        {
-            /* local view may override global command */
-            iter->last_cmd_global = cmd2;
-        }
-        result = iter->last_cmd_local = cmd1;
-    }
-    return result;
+    return clish_line_ctx_find_next_completion(ctx,iter);
 }
 /*--------------------------------------------------------- */
 static char *
-clish_shell_param_generator(const clish_shell_t   *this,
-                            const clish_command_t *cmd,
-                            const char            *line,
-                            unsigned               offset,
-                            unsigned               state)
+clish_shell_param_generator(const clish_shell_t    *this,
+                            const clish_line_ctx_t *ctx,
+                            const clish_command_t  *cmd,
+                            const char             *line,
+                            unsigned                offset,
+                            unsigned                state)
 {
     char                *result      = NULL;
     const char          *name        = clish_command__get_name(cmd);
@@ -63,7 +40,8 @@ clish_shell_param_generator(const clish_shell_t   *this,
     clish_ptype_t       *ptype;
     
     /* get the index of the current parameter */
-    index = lub_argv_wordcount(line) - lub_argv_wordcount(name);
+    index = lub_argv__get_count(clish_line_ctx__get_argv(ctx)) 
+          - lub_argv_wordcount(name);
 
     if((0 != index) || (line[offset-1] == ' '))
     {
@@ -148,23 +126,20 @@ clish_shell_word_generator(clish_shell_t *this,
                            unsigned       state)
 {
     char                  *result     = NULL;
+    clish_line_ctx_t      *ctx        = clish_shell_line_ctx(this,line);
     const clish_command_t *cmd, *next = NULL;
 
     /* try and resolve a command which is a prefix of the line */
-    cmd  = clish_shell_resolve_command(this,line);
+    cmd  = clish_line_ctx_resolve_command(ctx);
     if(NULL != cmd)
     {
-        clish_shell_iterator_t iter;
         /* see whether there is an extended extension */
-        clish_shell_iterator_init(&iter);
-        next  = clish_shell_find_next_completion(this,
-                                                line,
-                                                &iter);
+        next = clish_line_ctx__get_extension(ctx);
     }
     if((NULL != cmd) && (NULL == next))
     {
         /* this needs to be completed as a parameter */
-        result = clish_shell_param_generator(this,cmd,line,offset,state);
+        result = clish_shell_param_generator(this,ctx,cmd,line,offset,state);
     }
     else
     {
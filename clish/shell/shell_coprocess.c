@@ -0,0 +1,323 @@
+/*
+ * shell_coprocess.c
+ *
+ * Evaluate ACTION scripts using a long-lived "/bin/sh" coprocess rather
+ * than starting a new shell for every command.
+ *
+ * Each script is handed to the coprocess quoted as the argument of an
+ * "eval", so that a script with a syntax error cannot leave the coprocess
+ * waiting for more input. The exit status of the script is then written
+ * back to us as a line of text.
+ *
+ * The scripts are evaluated by the coprocess itself rather than in a
+ * subshell (which would cost a fork per script) so, much like the Tcl
+ * interpreter used by tclish, they share a single environment. A script
+ * which calls "exit" takes the coprocess with it; its exit status is
+ * collected and a new coprocess is started for the next script.
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* the descriptors used within the coprocess */
+#define COPROCESS_STATUS_FD 8 /* exit status of each script */
+#define COPROCESS_STDIN_FD  9 /* standard input for each script */
+
+/* how long to wait for a coprocess to exit before killing it */
+#define COPROCESS_STOP_POLL_NS 1000000 /* 1ms */
+#define COPROCESS_STOP_POLLS   1000
+
+/*--------------------------------------------------------- */
+static void
+clish_shell_coprocess_child(int fd)
+{
+    /* keep the command stream clear of the descriptors we are about to use */
+    int cmd = fcntl(fd,F_DUPFD,COPROCESS_STDIN_FD+1);
+
+    if(-1 == cmd)
+    {
+        _exit(127);
+    }
+    /* scripts get our standard input just as they would from system() */
+    if(-1 == dup2(STDIN_FILENO,COPROCESS_STDIN_FD))
+    {
+        int null = open("/dev/null",O_RDONLY);
+        if(-1 != null)
+        {
+            dup2(null,COPROCESS_STDIN_FD);
+            close(null);
+        }
+    }
+    dup2(cmd,STDIN_FILENO);
+    dup2(cmd,COPROCESS_STATUS_FD);
+    close(cmd);
+    if((STDIN_FILENO        != fd) &&
+       (COPROCESS_STATUS_FD != fd) &&
+       (COPROCESS_STDIN_FD  != fd))
+    {
+        close(fd);
+    }
+    execl("/bin/sh","sh",(char *)NULL);
+    _exit(127);
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_shell_coprocess_start(clish_shell_coprocess_t *this)
+{
+    int sv[2];
+
+    if(-1 == socketpair(AF_UNIX,SOCK_STREAM,0,sv))
+    {
+        return BOOL_FALSE;
+    }
+    /* 
+     * Nothing else we start (another shell's coprocess, system() etc.)
+     * may hold on to either end, otherwise the coprocess would never
+     * see the end of its input. The child's copies are made with F_DUPFD
+     * and dup2() so aren't affected.
+     */
+    (void)fcntl(sv[0],F_SETFD,FD_CLOEXEC);
+    (void)fcntl(sv[1],F_SETFD,FD_CLOEXEC);
+    this->pid = fork();
+    if(0 == this->pid)
+    {
+        close(sv[0]);
+        clish_shell_coprocess_child(sv[1]);
+    }
+    close(sv[1]);
+    if(-1 == this->pid)
+    {
+        close(sv[0]);
+        return BOOL_FALSE;
+    }
+    this->fd = sv[0];
+
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+static int
+clish_shell_coprocess_stop(clish_shell_coprocess_t *this)
+{
+    int status = -1;
+
+    if(-1 != this->fd)
+    {
+        /* end of input causes the coprocess to exit */
+        close(this->fd);
+        this->fd = -1;
+    }
+    if(-1 != this->pid)
+    {
+        struct timespec delay;
+        unsigned        polls = 0;
+
+        delay.tv_sec  = 0;
+        delay.tv_nsec = COPROCESS_STOP_POLL_NS;
+        for(;;)
+        {
+            pid_t pid = waitpid(this->pid,&status,
+                                (polls < COPROCESS_STOP_POLLS) ? WNOHANG : 0);
+            if(this->pid == pid)
+            {
+                break;
+            }
+            if(-1 == pid)
+            {
+                if(EINTR == errno)
+                {
+                    /* try again */
+                    continue;
+                }
+                status = -1;
+                break;
+            }
+            /* it is still running */
+            if(++polls < COPROCESS_STOP_POLLS)
+            {
+                nanosleep(&delay,NULL);
+            }
+            else
+            {
+                /* something is keeping it alive so don't wait any longer */
+                (void)kill(this->pid,SIGKILL);
+            }
+        }
+        this->pid = -1;
+    }
+    return status;
+}
+/*--------------------------------------------------------- */
+/*
+ * Build the text which is handed to the coprocess for a given script
+ * i.e. the script single quoted as an argument to "eval". This is
+ * run through "command" so that a syntax error fails the script rather 
+ * than ending the coprocess.
+ */
+static char *
+clish_shell_coprocess_wrap(const char *script)
+{
+    lub_strbuf_t  buffer;
+    char         *result;
+    const char   *p;
+
+    lub_strbuf_init(&buffer,NULL,0);
+    lub_strbuf_cat(&buffer,"{ command eval '");
+    for(p = strchr(script,'\'');
+        p;
+        p = strchr(script,'\''))
+    {
+        lub_strbuf_catn(&buffer,script,p - script);
+        lub_strbuf_cat(&buffer,"'\\''");
+        script = p + 1;
+    }
+    lub_strbuf_cat(&buffer,script);
+    lub_strbuf_cat(&buffer,"\n' ; } <&9 9<&- 8>&- ; echo $? >&8\n");
+    result = lub_strbuf_detach(&buffer);
+    lub_strbuf_fini(&buffer);
+
+    return result;
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_shell_coprocess_send(clish_shell_coprocess_t *this,
+                           const char              *text)
+{
+    size_t len = strlen(text);
+
+    while(len)
+    {
+        ssize_t n = send(this->fd,text,len,MSG_NOSIGNAL);
+        if(n < 0)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+            return BOOL_FALSE;
+        }
+        text += n;
+        len  -= n;
+    }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_shell_coprocess_receive(clish_shell_coprocess_t *this,
+                              int                     *status)
+{
+    char     buffer[16];
+    unsigned len = 0;
+
+    while(len < sizeof(buffer) - 1)
+    {
+        ssize_t n = read(this->fd,&buffer[len],1);
+        if(n < 0)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+            return BOOL_FALSE;
+        }
+        if((0 == n) || ('\n' == buffer[len]))
+        {
+            break;
+        }
+        len++;
+    }
+    buffer[len] = '\0';
+    if(0 == len)
+    {
+        /* the coprocess has gone away */
+        return BOOL_FALSE;
+    }
+    *status = atoi(buffer);
+
+    return BOOL_TRUE;
+}
+/*---------------------------------------------------------
+ * PRIVATE METHODS
+ *--------------------------------------------------------- */
+void
+clish_shell_coprocess_init(clish_shell_coprocess_t *this)
+{
+    this->pid    = -1;
+    this->fd     = -1;
+    this->failed = BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+void
+clish_shell_coprocess_fini(clish_shell_coprocess_t *this)
+{
+    clish_shell_coprocess_stop(this);
+}
+/*---------------------------------------------------------
+ * PUBLIC METHODS
+ *--------------------------------------------------------- */
+bool_t
+clish_shell_coprocess_execute(const clish_shell_t *this,
+                              const char          *script)
+{
+    clish_shell_coprocess_t *coprocess = this->coprocess;
+    char                    *text;
+    int                      status;
+    bool_t                   sent;
+
+    if((BOOL_FALSE == coprocess->failed) && (-1 == coprocess->pid))
+    {
+        /* start the coprocess on first use */
+        if(BOOL_FALSE == clish_shell_coprocess_start(coprocess))
+        {
+            coprocess->failed = BOOL_TRUE;
+        }
+    }
+    if(BOOL_TRUE == coprocess->failed)
+    {
+        /* fall back to the traditional approach */
+        return (0 == system(script)) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    text = clish_shell_coprocess_wrap(script);
+    sent = text ? clish_shell_coprocess_send(coprocess,text) : BOOL_FALSE;
+    lub_string_free(text);
+
+    if(BOOL_FALSE == sent)
+    {
+        /* the coprocess has died so don't try to use it again */
+        clish_shell_coprocess_stop(coprocess);
+        coprocess->failed = BOOL_TRUE;
+
+        /* the script never reached the coprocess */
+        return (0 == system(script)) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    if(BOOL_FALSE == clish_shell_coprocess_receive(coprocess,&status))
+    {
+        status = clish_shell_coprocess_stop(coprocess);
+        if((-1 != status) && WIFEXITED(status))
+        {
+            /* the script called "exit" so start afresh next time */
+            status = WEXITSTATUS(status);
+        }
+        else
+        {
+            /* 
+             * the coprocess has died so don't try to use it again,
+             * nor evaluate this script again as it may already 
+             * have been (partly) evaluated.
+             */
+            coprocess->failed = BOOL_TRUE;
+            status            = -1;
+        }
+    }
+    return (0 == status) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
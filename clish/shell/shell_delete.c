@@ -2,45 +2,19 @@
  * shell_delete.c
  */
 #include "private.h"
-#include "lub/string.h"
 
 #include <stdlib.h>
 /*--------------------------------------------------------- */
 static void
 clish_shell_fini(clish_shell_t *this)
 {
-	clish_view_t  *view;
-	clish_ptype_t *ptype;
-	
+    /* let go of the definitions */
+    clish_shell_model_release(this->model);
+    this->model = NULL;
 
-	/* delete each view held  */
-	while((view = lub_bintree_findfirst(&this->view_tree)))
-	{
-		/* remove the command from the tree */
-		lub_bintree_remove(&this->view_tree,view);
-
-		/* release the instance */
-		clish_view_delete(view);
-	}
-
-	/* delete each ptype held  */
-	while((ptype = lub_bintree_findfirst(&this->ptype_tree)))
-	{
-		/* remove the command from the tree */
-		lub_bintree_remove(&this->ptype_tree,ptype);
-
-		/* release the instance */
-		clish_ptype_delete(ptype);
-	}
     /* free the textual details */
-    lub_string_free(this->overview);
-    lub_string_free(this->viewid);
-    
-	if(NULL != this->startup)
-    {
-        /* remove the startup command */
-        clish_command_delete(this->startup);
-    }
+    clish_variable_viewid_delete(this->viewid);
+
     /* clean up the file stack */
     while(BOOL_TRUE == clish_shell_pop_file(this))
     {
@@ -49,6 +23,16 @@ clish_shell_fini(clish_shell_t *this)
     /* delete the tinyrl object */
     clish_shell_tinyrl_delete(this->tinyrl);
     
+    /* shut down any script coprocess */
+    clish_shell_coprocess_fini(this->coprocess);
+    free(this->coprocess);
+
+    /* forget the current line */
+    clish_line_ctx_fini(this->line_ctx);
+    free(this->line_ctx);
+
+    /* forget the access decisions */
+    clish_shell_access_fini(this);
 
 }
 /*--------------------------------------------------------- */
@@ -10,27 +10,23 @@ clish_shell_dump(clish_shell_t *this)
 {
     clish_view_t             *v;
     clish_ptype_t            *t;	
-    lub_bintree_iterator_t   iter;
 
     lub_dump_printf("shell(%p)\n",this);
-    lub_dump_printf("OVERVIEW:\n%s",this->overview);
+    lub_dump_printf("OVERVIEW:\n%s",this->model->overview);
     lub_dump_indent();
     
-    v = lub_bintree_findfirst(&this->view_tree);
-    
-    /* iterate the tree of views */
-    for(lub_bintree_iterator_init(&iter,&this->view_tree,v);
+    /* iterate the tree of views, which other shells may be using */
+    for(v = lub_bintree_peekfirst(&this->model->view_tree);
         v;
-        v=lub_bintree_iterator_next(&iter))
+        v = lub_bintree_peeknext(&this->model->view_tree,clish_view__get_name(v)))
     {
         clish_view_dump(v);
     }
 
     /* iterate the tree of types */
-    t = lub_bintree_findfirst(&this->ptype_tree);
-    for(lub_bintree_iterator_init(&iter,&this->ptype_tree,t);
+    for(t = lub_bintree_peekfirst(&this->model->ptype_tree);
         t;
-        t=lub_bintree_iterator_next(&iter))
+        t = lub_bintree_peeknext(&this->model->ptype_tree,clish_ptype__get_name(t)))
     {
         clish_ptype_dump(t);
     }
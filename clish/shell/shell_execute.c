@@ -4,6 +4,8 @@
 #include "private.h"
 #include "lub/string.h"
 #include "lub/argv.h"
+#include "lub/heap.h"
+#include "lub/size_fmt.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -19,7 +21,8 @@ static clish_shell_builtin_fn_t
     clish_overview,
     clish_source,
     clish_source_nostop,
-    clish_history;
+    clish_history,
+    clish_heap_sites;
 
 static clish_shell_builtin_t clish_cmd_list[] =
 {
@@ -28,6 +31,7 @@ static clish_shell_builtin_t clish_cmd_list[] =
     {"clish_source",        clish_source},
     {"clish_source_nostop", clish_source_nostop},
     {"clish_history",       clish_history},
+    {"clish_heap_sites",    clish_heap_sites},
     {NULL,NULL}
 };
 /*----------------------------------------------------------- */
@@ -126,7 +130,7 @@ clish_overview(const clish_shell_t *this,
 {
     argv = argv; /* not used */
     
-    tinyrl_printf(this->tinyrl,"%s\n",this->overview);
+    tinyrl_printf(this->tinyrl,"%s\n",this->model->overview);
 
     return BOOL_TRUE;
 }
@@ -169,6 +173,100 @@ clish_history(const clish_shell_t *this,
     return BOOL_TRUE;
 }
 /*----------------------------------------------------------- */
+#ifdef LUBHEAP
+/* the most allocation sites which clish_heap_sites will show */
+#define CLISH_HEAP_SITES_MAX 50
+
+typedef struct
+{
+    lub_heap_site_stats_t site[CLISH_HEAP_SITES_MAX];
+    unsigned              count;
+    unsigned              limit;
+} clish_heap_sites_t;
+/*----------------------------------------------------------- */
+/* keep the sites holding the most bytes, largest first */
+static void
+clish_heap_sites_fn(const lub_heap_site_stats_t *stats,
+                    void                        *arg)
+{
+    clish_heap_sites_t *this = arg;
+    unsigned            i;
+
+    if(this->count < this->limit)
+    {
+        ++this->count;
+    }
+    else if(stats->bytes <= this->site[this->count-1].bytes)
+    {
+        return;
+    }
+    for(i = this->count-1;
+        (i > 0) && (stats->bytes > this->site[i-1].bytes);
+        --i)
+    {
+        this->site[i] = this->site[i-1];
+    }
+    this->site[i] = *stats;
+}
+#endif /* LUBHEAP */
+/*----------------------------------------------------------- */
+/*
+ Show the allocation sites which currently hold the most memory
+*/
+static bool_t
+clish_heap_sites(const clish_shell_t *this,
+                 const lub_argv_t    *argv)
+{
+#ifdef LUBHEAP
+    clish_heap_sites_t sites;
+    const char        *arg = lub_argv__get_arg(argv,0);
+    unsigned           i;
+
+    sites.count = 0;
+    sites.limit = 20;
+    if((NULL != arg) && ('\0' != *arg))
+    {
+        sites.limit = (unsigned)atoi(arg);
+    }
+    if((0 == sites.limit) || (sites.limit > CLISH_HEAP_SITES_MAX))
+    {
+        sites.limit = CLISH_HEAP_SITES_MAX;
+    }
+    lub_heap_foreach_site(clish_heap_sites_fn,&sites);
+    if(0 == sites.count)
+    {
+        tinyrl_printf(this->tinyrl,"No allocations have been counted by site\n");
+        return BOOL_TRUE;
+    }
+    tinyrl_printf(this->tinyrl,
+                  "%18s %10s %10s %10s %10s\n",
+                  "site","allocs","blocks","bytes","peak bytes");
+    for(i = 0; i < sites.count; ++i)
+    {
+        const lub_heap_site_stats_t *site = &sites.site[i];
+
+        if(site->address)
+        {
+            tinyrl_printf(this->tinyrl,"%18p",site->address);
+        }
+        else
+        {
+            tinyrl_printf(this->tinyrl,"%18s","(other)");
+        }
+        tinyrl_printf(this->tinyrl,
+                      " %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT"\n",
+                      site->allocs,
+                      site->blocks,
+                      site->bytes,
+                      site->peak_bytes);
+    }
+#else /* not LUBHEAP */
+    argv = argv; /* not used */
+    tinyrl_printf(this->tinyrl,"Allocation sites are only counted by lubheap builds\n");
+#endif /* not LUBHEAP */
+    return BOOL_TRUE;
+}
+/*----------------------------------------------------------- */
 /*
  * Searches for a builtin command to execute
  */
@@ -258,8 +356,9 @@ clish_shell_execute(clish_shell_t         *this,
         if(viewid)
         {
             /* cleanup */
-            lub_string_free(this->viewid);
-            this->viewid = viewid;
+            clish_variable_viewid_delete(this->viewid);
+            this->viewid = clish_variable_viewid_new(viewid);
+            lub_string_free(viewid);
         }
     }
     if(NULL != *pargv)
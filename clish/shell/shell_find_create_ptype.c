@@ -13,14 +13,18 @@ clish_shell_find_create_ptype(clish_shell_t           *this,
                               clish_ptype_method_e     method,
                               clish_ptype_preprocess_e preprocess)
 {
-    clish_ptype_t *ptype = lub_bintree_find(&this->ptype_tree,name);
+    clish_ptype_t *ptype = lub_hash_find(&this->model->ptype_hash,name);
 
     if(NULL == ptype) 
     {
         /* create a ptype */
         ptype = clish_ptype_new(name,text,pattern,method,preprocess);
         assert(ptype);
-        clish_shell_insert_ptype(this,ptype);
+        if(BOOL_FALSE == clish_shell_insert_ptype(this,ptype))
+        {
+            /* the ptype has been deleted */
+            ptype = NULL;
+        }
     }
     else
     {
@@ -10,14 +10,18 @@ clish_shell_find_create_view(clish_shell_t *this,
                              const char    *name,
                              const char    *prompt)
 {
-	clish_view_t *view = lub_bintree_find(&this->view_tree,name);
+	clish_view_t *view = lub_hash_find(&this->model->view_hash,name);
 
 	if(NULL == view) 
 	{
 		/* create a view */
 		view = clish_view_new(name,prompt);
 		assert(view);
-		clish_shell_insert_view(this,view);
+		if(BOOL_FALSE == clish_shell_insert_view(this,view))
+		{
+			/* the view has been deleted */
+			view = NULL;
+		}
 	}
 	else
 	{
@@ -8,6 +8,6 @@ clish_view_t *
 clish_shell_find_view(clish_shell_t *this,
                       const char    *name)
 {
-	return lub_bintree_find(&this->view_tree,name);
+	return lub_hash_find(&this->model->view_hash,name);
 }  
 /*--------------------------------------------------------- */
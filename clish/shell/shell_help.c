@@ -5,6 +5,7 @@
 #include "lub/string.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /*--------------------------------------------------------- */
@@ -19,6 +20,10 @@ available_commands(clish_shell_t         *this,
     char                  *buf = NULL;
     size_t                 max_width = 0;
     const clish_command_t *cmd;
+    const clish_command_t **cmdv = NULL;
+    unsigned               cmdc = 0,cmdmax = 0,i;
+    clish_line_ctx_t      *ctx;
+    clish_shell_iterator_t iter;
     if(NULL == clish_shell_getfirst_command(this,line))
     {
         /*
@@ -52,34 +57,51 @@ available_commands(clish_shell_t         *this,
         /* take a copy */
         buf = lub_string_dup(line); 
     }
-    /* iterate round to determine max_width */
-    for(cmd = clish_shell_getfirst_command(this,buf);
+    /* gather the commands in a single pass, determining max_width */
+    ctx = clish_shell_line_ctx(this,buf);
+    clish_shell_iterator_init(&iter);
+    for(cmd = clish_line_ctx_find_next_completion(ctx,&iter);
         cmd;
-        cmd = clish_shell_getnext_command(this,buf))
+        cmd = clish_line_ctx_find_next_completion(ctx,&iter))
     {
-            size_t      width;
-            const char *name;
-            if(full)
-            {
-                name = clish_command__get_name(cmd);
-            }
-            else
-            {
-               name = clish_command__get_suffix(cmd);
-            }
+        size_t      width;
+        const char *name;
+        if(full)
+        {
+            name = clish_command__get_name(cmd);
+        }
+        else
+        {
+            name = clish_command__get_suffix(cmd);
+        }
         width = strlen(name);
         if(width > max_width)
         {
             max_width = width;
         }
+        if(cmdc == cmdmax)
+        {
+            /* make room for some more commands */
+            const clish_command_t **tmp;
+            
+            cmdmax = cmdmax ? 2 * cmdmax : 16;
+            tmp    = realloc(cmdv,cmdmax * sizeof(clish_command_t*));
+            if(NULL == tmp)
+            {
+                break;
+            }
+            cmdv = tmp;
+        }
+        cmdv[cmdc++] = cmd;
     }
 
-    /* now iterate round to print the help */
-    for(cmd = clish_shell_getfirst_command(this,buf);
-        cmd;
-        cmd = clish_shell_getnext_command(this,buf))
+    /* now print the help */
+    for(i = 0;
+        i < cmdc;
+        i++)
     {
         const char *name;
+        cmd = cmdv[i];
         if(full)
         {
             name = clish_command__get_name(cmd);
@@ -94,6 +116,7 @@ available_commands(clish_shell_t         *this,
               clish_command__get_text(cmd));
     }
     /* cleanup */
+    free(cmdv);
     lub_string_free(buf);
 }
 /*--------------------------------------------------------- */
@@ -102,9 +125,10 @@ clish_shell_help(clish_shell_t *this,
                  const char    *line)
 {
     const clish_command_t *cmd,*next_cmd, *first_cmd;
+    clish_line_ctx_t      *ctx = clish_shell_line_ctx(this,line);
     
     /* if there are further commands then we need to show them too */
-    cmd = clish_shell_resolve_prefix(this,line);
+    cmd = clish_line_ctx_resolve_prefix(ctx);
     if(NULL != cmd)
     {
         clish_shell_iterator_t iter;
@@ -112,12 +136,8 @@ clish_shell_help(clish_shell_t *this,
         /* skip the command already known about */
         clish_shell_iterator_init(&iter);
 
-        first_cmd = clish_shell_find_next_completion(this,
-                                                     line,
-                                                    &iter);
-        next_cmd = clish_shell_find_next_completion(this,
-                                                    line,
-                                                    &iter);
+        first_cmd = clish_line_ctx_find_next_completion(ctx,&iter);
+        next_cmd  = clish_line_ctx_find_next_completion(ctx,&iter);
     }
     else
     {
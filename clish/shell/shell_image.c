@@ -0,0 +1,949 @@
+/*
+ * shell_image.c
+ *
+ * A compiled image holds the definitions read from the XML files in the
+ * CLISH path, so that a shell can start without parsing them again.
+ *
+ * The image is a header followed by tables of fixed size records (the
+ * files it was compiled from, the ptypes, the views, their commands and
+ * the parameters of those commands) and then a table of strings. Every
+ * reference within the image is an index into one of these tables, so
+ * the image can be mapped at any address. The model is then rebuilt from
+ * the mapped image; this saves reading and parsing the XML files, though
+ * each ptype, view and command is still created (and each regular
+ * expression compiled) just as if they had been. The image is specific
+ * to the host which compiled it.
+ *
+ * The image is only used whilst the set of XML files, and the size and
+ * modification time of each, are just as they were when it was compiled.
+ * Command access restrictions are recorded in the image, and each session
+ * checks them as it looks the commands up.
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLISH_IMAGE_MAGIC   0x48534c43U /* "CLSH" */
+#define CLISH_IMAGE_VERSION 2
+#define CLISH_IMAGE_NONE    (~0U)       /* a NULL reference */
+
+/*---------------------------------------------------------
+ * IMAGE RECORDS
+ *--------------------------------------------------------- */
+typedef struct
+{
+    unsigned magic;
+    unsigned version;
+    unsigned length;        /* of the whole image in bytes       */
+    unsigned file_count;
+    unsigned ptype_count;
+    unsigned view_count;
+    unsigned command_count;
+    unsigned param_count;
+    unsigned string_size;   /* in bytes                          */
+    unsigned global;        /* string: name of the global view   */
+    unsigned startup;       /* index of the startup command      */
+    unsigned overview;      /* string                            */
+} clish_image_header_t;
+
+typedef struct
+{
+    unsigned name;          /* string                            */
+    off_t    size;
+    time_t   mtime;
+} clish_image_file_t;
+
+typedef struct
+{
+    unsigned name;          /* string                            */
+    unsigned text;          /* string                            */
+    unsigned pattern;       /* string                            */
+    unsigned method;
+    unsigned preprocess;
+} clish_image_ptype_t;
+
+typedef struct
+{
+    unsigned name;          /* string                            */
+    unsigned prompt;        /* string                            */
+    unsigned commands;      /* index of the first command        */
+    unsigned command_count;
+} clish_image_view_t;
+
+typedef struct
+{
+    unsigned name;          /* string                            */
+    unsigned text;          /* string                            */
+    unsigned access;        /* string                            */
+    unsigned action;        /* string                            */
+    unsigned builtin;       /* string                            */
+    unsigned detail;        /* string                            */
+    unsigned escape_chars;  /* string                            */
+    unsigned viewid;        /* string                            */
+    unsigned view;          /* string: name of the view to enter */
+    unsigned args;          /* index of the "rest of line" param */
+    unsigned params;        /* index of the first param          */
+    unsigned param_count;
+} clish_image_command_t;
+
+typedef struct
+{
+    unsigned name;          /* string                            */
+    unsigned text;          /* string                            */
+    unsigned ptype;         /* string: name of the ptype         */
+    unsigned prefix;        /* string                            */
+    unsigned defval;        /* string                            */
+} clish_image_param_t;
+
+/* a mapped image */
+typedef struct
+{
+    const clish_image_header_t  *header;
+    const clish_image_file_t    *files;
+    const clish_image_ptype_t   *ptypes;
+    const clish_image_view_t    *views;
+    const clish_image_command_t *commands;
+    const clish_image_param_t   *params;
+    const char                  *strings;
+} clish_image_t;
+
+/* a table of records being built for writing */
+typedef struct
+{
+    char    *data;
+    unsigned count;
+    unsigned capacity;
+    size_t   size;          /* of each record                    */
+    bool_t   failed;        /* to find the memory for a record   */
+} clish_image_table_t;
+
+/* an image being built for writing */
+typedef struct
+{
+    clish_image_header_t header;
+    clish_image_table_t  files;
+    clish_image_table_t  ptypes;
+    clish_image_table_t  views;
+    clish_image_table_t  commands;
+    clish_image_table_t  params;
+    clish_image_table_t  strings;
+} clish_image_writer_t;
+
+/*---------------------------------------------------------
+ * WRITING AN IMAGE
+ *--------------------------------------------------------- */
+static void
+clish_image_table_init(clish_image_table_t *this,
+                       size_t               size)
+{
+    this->data     = NULL;
+    this->count    = 0;
+    this->capacity = 0;
+    this->size     = size;
+    this->failed   = BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_table_fini(clish_image_table_t *this)
+{
+    free(this->data);
+    this->data = NULL;
+}
+/*--------------------------------------------------------- */
+/*
+ * Add the specified number of (zeroed) records to the table, returning
+ * the index of the first of them, or CLISH_IMAGE_NONE if there is not
+ * the memory for them.
+ */
+static unsigned
+clish_image_table_append(clish_image_table_t *this,
+                         unsigned             count)
+{
+    unsigned result = this->count;
+
+    if(this->count + count > this->capacity)
+    {
+        unsigned capacity = this->capacity ? this->capacity : 64;
+        char    *tmp;
+
+        while(this->count + count > capacity)
+        {
+            capacity *= 2;
+        }
+        tmp = realloc(this->data,capacity * this->size);
+        if(NULL == tmp)
+        {
+            /* the image will not be written */
+            this->failed = BOOL_TRUE;
+            return CLISH_IMAGE_NONE;
+        }
+        this->data     = tmp;
+        this->capacity = capacity;
+    }
+    memset(this->data + result * this->size,0,count * this->size);
+    this->count += count;
+
+    return result;
+}
+/*--------------------------------------------------------- */
+#define clish_image_table_record(table,type,index) \
+    (&((type *)(table)->data)[index])
+/*--------------------------------------------------------- */
+static unsigned
+clish_image_put_string(clish_image_writer_t *this,
+                       const char           *string)
+{
+    unsigned result = CLISH_IMAGE_NONE;
+
+    if(NULL != string)
+    {
+        size_t length = strlen(string) + 1;
+
+        result = clish_image_table_append(&this->strings,length);
+        if(CLISH_IMAGE_NONE != result)
+        {
+            memcpy(this->strings.data + result,string,length);
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_put_param(clish_image_writer_t *this,
+                      unsigned              index,
+                      const clish_param_t  *param)
+{
+    const clish_ptype_t *ptype = clish_param__get_ptype(param);
+    clish_image_param_t  record;
+
+    record.name   = clish_image_put_string(this,clish_param__get_name(param));
+    record.text   = clish_image_put_string(this,clish_param__get_text(param));
+    record.ptype  = clish_image_put_string(this,
+                                           ptype ? clish_ptype__get_name(ptype)
+                                                 : NULL);
+    record.prefix = clish_image_put_string(this,clish_param__get_prefix(param));
+    record.defval = clish_image_put_string(this,clish_param__get_default(param));
+    *clish_image_table_record(&this->params,clish_image_param_t,index) = record;
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_put_command(clish_image_writer_t  *this,
+                        const clish_command_t *cmd)
+{
+    unsigned               index = clish_image_table_append(&this->commands,1);
+    const clish_param_t   *args  = clish_command__get_args(cmd);
+    const clish_view_t    *view  = clish_command__get_view(cmd);
+    clish_image_command_t  record;
+    unsigned               i;
+
+    if(CLISH_IMAGE_NONE == index)
+    {
+        return;
+    }
+    record.name         = clish_image_put_string(this,
+                                clish_command__get_name(cmd));
+    record.text         = clish_image_put_string(this,
+                                clish_command__get_text(cmd));
+    record.access       = clish_image_put_string(this,
+                                clish_command__get_access(cmd));
+    record.action       = clish_image_put_string(this,
+                                clish_command__get_unexpanded_action(cmd));
+    record.builtin      = clish_image_put_string(this,
+                                clish_command__get_builtin(cmd));
+    record.detail       = clish_image_put_string(this,
+                                clish_command__get_detail(cmd));
+    record.escape_chars = clish_image_put_string(this,
+                                clish_command__get_escape_chars(cmd));
+    record.viewid       = clish_image_put_string(this,
+                                clish_command__get_unexpanded_viewid(cmd));
+    record.view         = clish_image_put_string(this,
+                                view ? clish_view__get_name(view) : NULL);
+    record.args         = CLISH_IMAGE_NONE;
+    if(NULL != args)
+    {
+        record.args = clish_image_table_append(&this->params,1);
+        if(CLISH_IMAGE_NONE != record.args)
+        {
+            clish_image_put_param(this,record.args,args);
+        }
+    }
+    /* the parameters of a command are held together */
+    record.param_count  = clish_command__get_param_count(cmd);
+    record.params       = clish_image_table_append(&this->params,
+                                                   record.param_count);
+    for(i = 0;
+        (CLISH_IMAGE_NONE != record.params) && (i < record.param_count);
+        i++)
+    {
+        clish_image_put_param(this,
+                              record.params + i,
+                              clish_command__get_param(cmd,i));
+    }
+    *clish_image_table_record(&this->commands,clish_image_command_t,index) = record;
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_image_put_files(clish_image_writer_t *this,
+                      char                **files)
+{
+    char **file;
+
+    for(file = files;
+        *file;
+        file++)
+    {
+        unsigned           index = clish_image_table_append(&this->files,1);
+        clish_image_file_t record;
+        struct stat        info;
+
+        if((CLISH_IMAGE_NONE == index) || (-1 == stat(*file,&info)))
+        {
+            return BOOL_FALSE;
+        }
+        record.name  = clish_image_put_string(this,*file);
+        record.size  = info.st_size;
+        record.mtime = info.st_mtime;
+        *clish_image_table_record(&this->files,clish_image_file_t,index) = record;
+    }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_put_model(clish_image_writer_t      *this,
+                      const clish_shell_model_t *model)
+{
+    clish_ptype_t         *ptype;
+    clish_view_t          *view;
+
+    for(ptype = lub_bintree_peekfirst(&model->ptype_tree);
+        ptype;
+        ptype = lub_bintree_peeknext(&model->ptype_tree,clish_ptype__get_name(ptype)))
+    {
+        unsigned            index = clish_image_table_append(&this->ptypes,1);
+        clish_image_ptype_t record;
+
+        if(CLISH_IMAGE_NONE == index)
+        {
+            return;
+        }
+        record.name       = clish_image_put_string(this,
+                                clish_ptype__get_name(ptype));
+        record.text       = clish_image_put_string(this,
+                                clish_ptype__get_text(ptype));
+        record.pattern    = clish_image_put_string(this,
+                                clish_ptype__get_pattern(ptype));
+        record.method     = (NULL != clish_ptype__get_pattern(ptype))
+                          ? clish_ptype__get_method(ptype)
+                          : CLISH_PTYPE_REGEXP;
+        record.preprocess = clish_ptype__get_preprocess(ptype);
+        *clish_image_table_record(&this->ptypes,clish_image_ptype_t,index) = record;
+    }
+    for(view = lub_bintree_peekfirst(&model->view_tree);
+        view;
+        view = lub_bintree_peeknext(&model->view_tree,clish_view__get_name(view)))
+    {
+        unsigned            index = clish_image_table_append(&this->views,1);
+        clish_image_view_t  record;
+        clish_command_t    *cmd;
+
+        if(CLISH_IMAGE_NONE == index)
+        {
+            return;
+        }
+        record.name     = clish_image_put_string(this,
+                                clish_view__get_name(view));
+        record.prompt   = clish_image_put_string(this,
+                                clish_view__get_unexpanded_prompt(view));
+        record.commands = this->commands.count;
+        for(cmd = clish_view_getfirst_command(view);
+            cmd;
+            cmd = clish_view_getnext_command(view,cmd))
+        {
+            clish_image_put_command(this,cmd);
+        }
+        record.command_count = this->commands.count - record.commands;
+        *clish_image_table_record(&this->views,clish_image_view_t,index) = record;
+    }
+    this->header.startup = CLISH_IMAGE_NONE;
+    if(NULL != model->startup)
+    {
+        this->header.startup = this->commands.count;
+        clish_image_put_command(this,model->startup);
+    }
+    this->header.global   = clish_image_put_string(this,
+                                model->global ? clish_view__get_name(model->global)
+                                              : NULL);
+    this->header.overview = clish_image_put_string(this,model->overview);
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_image_write_table(FILE                      *file,
+                        const clish_image_table_t *table)
+{
+    size_t count = table->count;
+
+    return (count == fwrite(table->data,table->size,count,file))
+           ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_image_writer_failed(const clish_image_writer_t *this)
+{
+    return (this->files.failed
+         || this->ptypes.failed
+         || this->views.failed
+         || this->commands.failed
+         || this->params.failed
+         || this->strings.failed) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+bool_t
+clish_shell_image_write(clish_shell_t *this,
+                        const char    *filename,
+                        char         **files)
+{
+    clish_image_writer_t writer;
+    clish_image_header_t *header = &writer.header;
+    bool_t               result  = BOOL_FALSE;
+    char                *tmpname = NULL;
+    FILE                *file;
+
+    clish_image_table_init(&writer.files,sizeof(clish_image_file_t));
+    clish_image_table_init(&writer.ptypes,sizeof(clish_image_ptype_t));
+    clish_image_table_init(&writer.views,sizeof(clish_image_view_t));
+    clish_image_table_init(&writer.commands,sizeof(clish_image_command_t));
+    clish_image_table_init(&writer.params,sizeof(clish_image_param_t));
+    clish_image_table_init(&writer.strings,1);
+
+    if(BOOL_TRUE == clish_image_put_files(&writer,files))
+    {
+        clish_image_put_model(&writer,this->model);
+        result = BOOL_TRUE;
+    }
+    if(BOOL_TRUE == clish_image_writer_failed(&writer))
+    {
+        result = BOOL_FALSE;
+    }
+    if(BOOL_TRUE == result)
+    {
+        header->magic         = CLISH_IMAGE_MAGIC;
+        header->version       = CLISH_IMAGE_VERSION;
+        header->file_count    = writer.files.count;
+        header->ptype_count   = writer.ptypes.count;
+        header->view_count    = writer.views.count;
+        header->command_count = writer.commands.count;
+        header->param_count   = writer.params.count;
+        header->string_size   = writer.strings.count;
+        header->length        = sizeof(clish_image_header_t)
+            + writer.files.count    * sizeof(clish_image_file_t)
+            + writer.ptypes.count   * sizeof(clish_image_ptype_t)
+            + writer.views.count    * sizeof(clish_image_view_t)
+            + writer.commands.count * sizeof(clish_image_command_t)
+            + writer.params.count   * sizeof(clish_image_param_t)
+            + writer.strings.count;
+
+        /*
+         * write a new file then rename it, so that any shell which has
+         * the old image mapped is unaffected
+         */
+        lub_string_cat(&tmpname,filename);
+        lub_string_cat(&tmpname,".tmp");
+        file = fopen(tmpname,"wb");
+        if(NULL != file)
+        {
+            result = (1 == fwrite(header,sizeof(*header),1,file))
+                   ? BOOL_TRUE : BOOL_FALSE;
+            if(BOOL_TRUE == result)
+            {
+                result = clish_image_write_table(file,&writer.files)
+                      && clish_image_write_table(file,&writer.ptypes)
+                      && clish_image_write_table(file,&writer.views)
+                      && clish_image_write_table(file,&writer.commands)
+                      && clish_image_write_table(file,&writer.params)
+                      && clish_image_write_table(file,&writer.strings)
+                       ? BOOL_TRUE : BOOL_FALSE;
+            }
+            if(0 != fclose(file))
+            {
+                result = BOOL_FALSE;
+            }
+            if((BOOL_FALSE == result) || (0 != rename(tmpname,filename)))
+            {
+                (void)unlink(tmpname);
+                result = BOOL_FALSE;
+            }
+        }
+        else
+        {
+            result = BOOL_FALSE;
+        }
+        lub_string_free(tmpname);
+    }
+    clish_image_table_fini(&writer.files);
+    clish_image_table_fini(&writer.ptypes);
+    clish_image_table_fini(&writer.views);
+    clish_image_table_fini(&writer.commands);
+    clish_image_table_fini(&writer.params);
+    clish_image_table_fini(&writer.strings);
+
+    return result;
+}
+/*---------------------------------------------------------
+ * READING AN IMAGE
+ *--------------------------------------------------------- */
+static const char *
+clish_image_string(const clish_image_t *this,
+                   unsigned             ref)
+{
+    return (CLISH_IMAGE_NONE == ref) ? NULL : &this->strings[ref];
+}
+/*--------------------------------------------------------- */
+/*
+ * Check that each of the specified string references lies within the
+ * string table (which is known to end with a terminator)
+ */
+static bool_t
+clish_image_check_strings(const clish_image_t *this,
+                          const unsigned      *refs,
+                          size_t               count)
+{
+    size_t i;
+
+    for(i = 0;
+        i < count;
+        i++)
+    {
+        if((CLISH_IMAGE_NONE != refs[i]) &&
+           (refs[i] >= this->header->string_size))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+/* Check that a range of records lies within a table */
+static bool_t
+clish_image_check_range(unsigned first,
+                        unsigned count,
+                        unsigned limit)
+{
+    return ((first <= limit) && (count <= limit - first))
+           ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+/*
+ * Locate the tables within an image and check that every reference
+ * they hold is sound, so that loading it cannot go astray.
+ */
+static bool_t
+clish_image_check(clish_image_t *this,
+                  size_t         length)
+{
+    const clish_image_header_t *header = this->header;
+    const char                 *p      = (const char *)header;
+    size_t                      offset = sizeof(clish_image_header_t);
+    unsigned                    i;
+
+    if((length < sizeof(clish_image_header_t)) ||
+       (CLISH_IMAGE_MAGIC   != header->magic)   ||
+       (CLISH_IMAGE_VERSION != header->version) ||
+       (length              != header->length))
+    {
+        return BOOL_FALSE;
+    }
+#define CLISH_IMAGE_TABLE(field,type,count)                   \
+    if((length - offset) / sizeof(type) < (count))            \
+    {                                                         \
+        return BOOL_FALSE;                                    \
+    }                                                         \
+    this->field = (const type *)(p + offset);                 \
+    offset     += (count) * sizeof(type)
+
+    CLISH_IMAGE_TABLE(files,clish_image_file_t,header->file_count);
+    CLISH_IMAGE_TABLE(ptypes,clish_image_ptype_t,header->ptype_count);
+    CLISH_IMAGE_TABLE(views,clish_image_view_t,header->view_count);
+    CLISH_IMAGE_TABLE(commands,clish_image_command_t,header->command_count);
+    CLISH_IMAGE_TABLE(params,clish_image_param_t,header->param_count);
+#undef CLISH_IMAGE_TABLE
+
+    this->strings = p + offset;
+    if((length - offset != header->string_size) ||
+       ((0 != header->string_size) &&
+        ('\0' != this->strings[header->string_size - 1])))
+    {
+        return BOOL_FALSE;
+    }
+    /*
+     * now check every string reference; these lead each record, so
+     * each run of them can be checked as an array
+     */
+#define CLISH_IMAGE_STRINGS(first,count)                              \
+    if(BOOL_FALSE == clish_image_check_strings(this,(first),(count)))  \
+    {                                                                 \
+        return BOOL_FALSE;                                            \
+    }
+    for(i = 0; i < header->file_count; i++)
+    {
+        CLISH_IMAGE_STRINGS(&this->files[i].name,1);
+        if(NULL == clish_image_string(this,this->files[i].name))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    for(i = 0; i < header->ptype_count; i++)
+    {
+        const clish_image_ptype_t *ptype = &this->ptypes[i];
+
+        CLISH_IMAGE_STRINGS(&ptype->name,3);
+        if((NULL == clish_image_string(this,ptype->name))  ||
+           (ptype->method     > CLISH_PTYPE_SELECT)        ||
+           (ptype->preprocess > CLISH_PTYPE_TOLOWER))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    for(i = 0; i < header->view_count; i++)
+    {
+        const clish_image_view_t *view = &this->views[i];
+
+        CLISH_IMAGE_STRINGS(&view->name,2);
+        if((NULL == clish_image_string(this,view->name)) ||
+           (BOOL_FALSE == clish_image_check_range(view->commands,
+                                                  view->command_count,
+                                                  header->command_count)))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    for(i = 0; i < header->command_count; i++)
+    {
+        const clish_image_command_t *cmd = &this->commands[i];
+
+        CLISH_IMAGE_STRINGS(&cmd->name,9);
+        if((NULL == clish_image_string(this,cmd->name)) ||
+           ((CLISH_IMAGE_NONE != cmd->args) &&
+            (cmd->args >= header->param_count))  ||
+           (BOOL_FALSE == clish_image_check_range(cmd->params,
+                                                  cmd->param_count,
+                                                  header->param_count)))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    for(i = 0; i < header->param_count; i++)
+    {
+        const clish_image_param_t *param = &this->params[i];
+
+        CLISH_IMAGE_STRINGS(&param->name,5);
+        if((NULL == clish_image_string(this,param->name)) ||
+           (NULL == clish_image_string(this,param->text)))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    CLISH_IMAGE_STRINGS(&header->global,1);
+    CLISH_IMAGE_STRINGS(&header->overview,1);
+#undef CLISH_IMAGE_STRINGS
+
+    if((CLISH_IMAGE_NONE != header->startup) &&
+       (header->startup >= header->command_count))
+    {
+        return BOOL_FALSE;
+    }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+/*
+ * Check that the image was compiled from exactly these files, and
+ * that none of them have changed since.
+ */
+static bool_t
+clish_image_check_files(const clish_image_t *this,
+                        char               **files)
+{
+    unsigned i;
+
+    for(i = 0;
+        files[i];
+        i++)
+    {
+        const clish_image_file_t *record = &this->files[i];
+        struct stat               info;
+
+        if((i >= this->header->file_count)                             ||
+           (0 != strcmp(files[i],clish_image_string(this,record->name)))||
+           (-1 == stat(files[i],&info))                                ||
+           (info.st_size  != record->size)                             ||
+           (info.st_mtime != record->mtime))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return (i == this->header->file_count) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+static clish_param_t *
+clish_image_get_param(clish_shell_t       *shell,
+                      const clish_image_t *this,
+                      unsigned             index)
+{
+    const clish_image_param_t *record = &this->params[index];
+    const char                *ptype  = clish_image_string(this,record->ptype);
+    const char                *prefix = clish_image_string(this,record->prefix);
+    const char                *defval = clish_image_string(this,record->defval);
+    clish_ptype_t             *tmp    = NULL;
+    clish_param_t             *param;
+
+    if(NULL != ptype)
+    {
+        tmp = clish_shell_find_create_ptype(shell,ptype,
+                                            NULL,NULL,
+                                            CLISH_PTYPE_REGEXP,
+                                            CLISH_PTYPE_NONE);
+    }
+    param = clish_param_new(clish_image_string(this,record->name),
+                            clish_image_string(this,record->text),
+                            tmp);
+    if(NULL != prefix)
+    {
+        clish_param__set_prefix(param,prefix);
+    }
+    if(NULL != defval)
+    {
+        clish_param__set_default(param,defval);
+    }
+    return param;
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_get_command(clish_shell_t               *shell,
+                        const clish_image_t         *this,
+                        const clish_image_command_t *record,
+                        clish_command_t             *cmd)
+{
+    const char *access       = clish_image_string(this,record->access);
+    const char *action       = clish_image_string(this,record->action);
+    const char *builtin      = clish_image_string(this,record->builtin);
+    const char *detail       = clish_image_string(this,record->detail);
+    const char *escape_chars = clish_image_string(this,record->escape_chars);
+    const char *viewid       = clish_image_string(this,record->viewid);
+    const char *view         = clish_image_string(this,record->view);
+    unsigned    i;
+
+    if(NULL != access)
+    {
+        clish_command__set_access(cmd,access);
+    }
+    if(NULL != escape_chars)
+    {
+        clish_command__set_escape_chars(cmd,escape_chars);
+    }
+    if(CLISH_IMAGE_NONE != record->args)
+    {
+        const clish_image_param_t *args = &this->params[record->args];
+
+        clish_command__set_args(cmd,
+                                clish_param_new(clish_image_string(this,args->name),
+                                                clish_image_string(this,args->text),
+                                                NULL));
+    }
+    if(NULL != view)
+    {
+        clish_command__set_view(cmd,clish_shell_find_create_view(shell,view,NULL));
+    }
+    if(NULL != viewid)
+    {
+        clish_command__set_viewid(cmd,viewid);
+    }
+    for(i = 0;
+        i < record->param_count;
+        i++)
+    {
+        clish_command_insert_param(cmd,
+                                   clish_image_get_param(shell,
+                                                         this,
+                                                         record->params + i));
+    }
+    if(NULL != action)
+    {
+        clish_command__set_action(cmd,action);
+    }
+    if(NULL != builtin)
+    {
+        clish_command__set_builtin(cmd,builtin);
+    }
+    if(NULL != detail)
+    {
+        clish_command__set_detail(cmd,detail);
+    }
+}
+/*--------------------------------------------------------- */
+static void
+clish_image_get_model(clish_shell_t       *shell,
+                      const clish_image_t *this)
+{
+    const clish_image_header_t *header = this->header;
+    clish_shell_model_t        *model  = shell->model;
+    unsigned                    i,j;
+
+    for(i = 0;
+        i < header->ptype_count;
+        i++)
+    {
+        const clish_image_ptype_t *record = &this->ptypes[i];
+
+        (void)clish_shell_find_create_ptype(shell,
+                        clish_image_string(this,record->name),
+                        clish_image_string(this,record->text),
+                        clish_image_string(this,record->pattern),
+                        (clish_ptype_method_e)record->method,
+                        (clish_ptype_preprocess_e)record->preprocess);
+    }
+    /* create every view before any command can refer to one */
+    for(i = 0;
+        i < header->view_count;
+        i++)
+    {
+        const clish_image_view_t *record = &this->views[i];
+
+        (void)clish_shell_find_create_view(shell,
+                        clish_image_string(this,record->name),
+                        clish_image_string(this,record->prompt));
+    }
+    if(CLISH_IMAGE_NONE != header->global)
+    {
+        model->global = clish_shell_find_view(shell,
+                            clish_image_string(this,header->global));
+    }
+    for(i = 0;
+        i < header->view_count;
+        i++)
+    {
+        const clish_image_view_t *record = &this->views[i];
+        clish_view_t             *view;
+
+        view = clish_shell_find_view(shell,clish_image_string(this,record->name));
+        for(j = record->commands;
+            j < record->commands + record->command_count;
+            j++)
+        {
+            const clish_image_command_t *cmd = &this->commands[j];
+            clish_command_t             *tmp;
+
+            tmp = clish_view_new_command(view,
+                                         clish_image_string(this,cmd->name),
+                                         clish_image_string(this,cmd->text));
+            if(NULL != tmp)
+            {
+                clish_image_get_command(shell,this,cmd,tmp);
+            }
+        }
+    }
+    if(CLISH_IMAGE_NONE != header->startup)
+    {
+        const clish_image_command_t *cmd = &this->commands[header->startup];
+
+        model->startup = clish_command_new(clish_image_string(this,cmd->name),
+                                           clish_image_string(this,cmd->text));
+        clish_image_get_command(shell,this,cmd,model->startup);
+    }
+    model->overview = lub_string_dup(clish_image_string(this,header->overview));
+}
+/*--------------------------------------------------------- */
+bool_t
+clish_shell_image_read(clish_shell_t *this,
+                       const char    *filename,
+                       char         **files)
+{
+    clish_image_t image;
+    bool_t        result = BOOL_FALSE;
+    struct stat   info;
+    void         *map;
+    int           fd;
+
+    fd = open(filename,O_RDONLY);
+    if(-1 == fd)
+    {
+        return BOOL_FALSE;
+    }
+    if((-1 == fstat(fd,&info)) || (0 == info.st_size))
+    {
+        close(fd);
+        return BOOL_FALSE;
+    }
+    map = mmap(NULL,info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(MAP_FAILED == map)
+    {
+        return BOOL_FALSE;
+    }
+    image.header = map;
+    if((BOOL_TRUE == clish_image_check(&image,info.st_size)) &&
+       (BOOL_TRUE == clish_image_check_files(&image,files)))
+    {
+        clish_image_get_model(this,&image);
+        result = BOOL_TRUE;
+    }
+    munmap(map,info.st_size);
+
+    return result;
+}
+/*--------------------------------------------------------- */
+static bool_t
+clish_shell_compile_script(const clish_shell_t *shell,
+                           const char          *script)
+{
+    /* nothing is executed */
+    shell  = shell;
+    script = script;
+    return BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+static clish_shell_hooks_t clish_shell_compile_hooks =
+{
+    NULL, /* no init callback */
+    NULL, /* access is not checked until a command is looked up */
+    NULL, /* no cmd_line callback */
+    clish_shell_compile_script,
+    NULL, /* no fini callback */
+    NULL  /* no builtin functions */
+};
+/*---------------------------------------------------------
+ * PUBLIC META FUNCTIONS
+ *--------------------------------------------------------- */
+bool_t
+clish_shell_compile(const char *filename)
+{
+    bool_t         result = BOOL_FALSE;
+    clish_shell_t *shell  = clish_shell_new(&clish_shell_compile_hooks,
+                                            NULL,
+                                            stdin);
+
+    if(NULL != shell)
+    {
+        char **files = clish_shell_find_files(shell);
+        char **file;
+
+        for(file = files;
+            *file;
+            file++)
+        {
+            (void)clish_shell_xml_read(shell,*file);
+        }
+        result = clish_shell_image_write(shell,filename,files);
+
+        clish_shell_free_files(files);
+        clish_shell_delete(shell);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
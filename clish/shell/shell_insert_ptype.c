@@ -1,13 +1,30 @@
 /*
- * shell_insert_view.c
+ * shell_insert_ptype.c
  */
 #include "private.h"
 
+#include <assert.h>
+
 /*--------------------------------------------------------- */
-void
+bool_t
 clish_shell_insert_ptype(clish_shell_t *this,
                          clish_ptype_t *ptype)
 {
-    (void)lub_bintree_insert(&this->ptype_tree,ptype);
+    assert(BOOL_FALSE == this->model->frozen);
+
+    if(-1 == lub_bintree_insert(&this->model->ptype_tree,ptype))
+    {
+        /* inserting a duplicate ptype is bad */
+        clish_ptype_delete(ptype);
+        return BOOL_FALSE;
+    }
+    if(-1 == lub_hash_insert(&this->model->ptype_hash,ptype))
+    {
+        /* it cannot be found without the index */
+        lub_bintree_remove(&this->model->ptype_tree,ptype);
+        clish_ptype_delete(ptype);
+        return BOOL_FALSE;
+    }
+    return BOOL_TRUE;
 }  
 /*--------------------------------------------------------- */
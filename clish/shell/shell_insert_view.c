@@ -3,11 +3,28 @@
  */
 #include "private.h"
 
+#include <assert.h>
+
 /*--------------------------------------------------------- */
-void
+bool_t
 clish_shell_insert_view(clish_shell_t *this,
                         clish_view_t  *view)
 {
-    (void)lub_bintree_insert(&this->view_tree,view);
+    assert(BOOL_FALSE == this->model->frozen);
+
+    if(-1 == lub_bintree_insert(&this->model->view_tree,view))
+    {
+        /* inserting a duplicate view is bad */
+        clish_view_delete(view);
+        return BOOL_FALSE;
+    }
+    if(-1 == lub_hash_insert(&this->model->view_hash,view))
+    {
+        /* it cannot be found without the index */
+        lub_bintree_remove(&this->model->view_tree,view);
+        clish_view_delete(view);
+        return BOOL_FALSE;
+    }
+    return BOOL_TRUE;
 }  
 /*--------------------------------------------------------- */
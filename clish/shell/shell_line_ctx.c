@@ -0,0 +1,281 @@
+/*
+ * shell_line_ctx.c
+ *
+ * Handling a single keystroke can involve resolving, completing and
+ * parsing the same line of text several times over. The line context
+ * remembers the words of the line and the commands it resolves to, so
+ * that this work is only done again once the line has changed.
+ *
+ * Rather than being told about each edit, the context compares the line
+ * it is given with the one it last analysed. A resolved command depends
+ * only upon the words which were examined to find it, so an edit beyond
+ * those words leaves it intact.
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------- */
+static void
+clish_line_ctx_resolution_init(clish_line_ctx_resolution_t *this)
+{
+    this->view   = NULL;
+    this->valid  = BOOL_FALSE;
+    this->prefix = NULL;
+    this->extent = 0;
+}
+/*--------------------------------------------------------- */
+/*
+ * Return the offset just beyond the specified word (and any quotes
+ * which surround it) in the line.
+ */
+static size_t
+clish_line_ctx_word_end(const clish_line_ctx_t *this,
+                        unsigned                index)
+{
+    size_t offset = lub_argv__get_offset(this->argv,index);
+    size_t end    = offset + lub_argv__get_length(this->argv,index);
+
+    if('"' == this->line[offset])
+    {
+        /* account for the opening quotation mark */
+        end++;
+    }
+    if(BOOL_TRUE == lub_argv__get_quoted(this->argv,index))
+    {
+        /* account for the closing quotation mark */
+        end++;
+    }
+    return end;
+}
+/*--------------------------------------------------------- */
+static clish_command_t *
+clish_line_ctx_resolve(clish_line_ctx_t            *this,
+                       clish_line_ctx_resolution_t *resolution)
+{
+    if((BOOL_FALSE == resolution->valid) && (NULL != resolution->view))
+    {
+        unsigned examined;
+
+        resolution->prefix = clish_view_resolve_prefix_argv(resolution->view,
+                                                            this->argv,
+                                                            &examined,
+                                                            clish_shell_command_allowed,
+                                                            this->shell);
+        if(examined < lub_argv__get_count(this->argv))
+        {
+            /* the result depends on no more than the words examined */
+            resolution->extent = clish_line_ctx_word_end(this,examined-1);
+        }
+        else
+        {
+            /* any further words may extend the match */
+            resolution->extent = strlen(this->line);
+        }
+        resolution->valid = BOOL_TRUE;
+    }
+    return resolution->prefix;
+}
+/*--------------------------------------------------------- */
+static void
+clish_line_ctx_set_view(clish_line_ctx_t            *this,
+                        clish_line_ctx_resolution_t *resolution,
+                        clish_view_t                *view)
+{
+    if(view != resolution->view)
+    {
+        resolution->view   = view;
+        resolution->valid  = BOOL_FALSE;
+        resolution->prefix = NULL;
+
+        /* completions draw from both views */
+        this->extension_valid = BOOL_FALSE;
+    }
+}
+/*--------------------------------------------------------- */
+static void
+clish_line_ctx_set_line(clish_line_ctx_t *this,
+                        const char       *line)
+{
+    size_t diff = 0;
+
+    if(NULL != this->line)
+    {
+        /* find where the new line departs from the old one */
+        while(line[diff] && (line[diff] == this->line[diff]))
+        {
+            diff++;
+        }
+        if(('\0' == line[diff]) && ('\0' == this->line[diff]))
+        {
+            /* nothing has changed */
+            return;
+        }
+    }
+    /* discard any resolutions which depend upon the changed text */
+    if(diff <= this->local.extent)
+    {
+        this->local.valid = BOOL_FALSE;
+    }
+    if(diff <= this->global.extent)
+    {
+        this->global.valid = BOOL_FALSE;
+    }
+    this->extension_valid = BOOL_FALSE;
+
+    /* remember the words of the new line */
+    lub_string_free(this->line);
+    this->line = lub_string_dup(line);
+    if(NULL != this->argv)
+    {
+        lub_argv_delete(this->argv);
+    }
+    this->argv = lub_argv_new(this->line,0);
+}
+/*---------------------------------------------------------
+ * PRIVATE METHODS
+ *--------------------------------------------------------- */
+void
+clish_line_ctx_init(clish_line_ctx_t *this,
+                    clish_shell_t    *shell)
+{
+    this->shell           = shell;
+    this->line            = NULL;
+    this->argv            = NULL;
+    clish_line_ctx_resolution_init(&this->local);
+    clish_line_ctx_resolution_init(&this->global);
+    this->extension_valid = BOOL_FALSE;
+    this->extension       = NULL;
+}
+/*--------------------------------------------------------- */
+void
+clish_line_ctx_fini(clish_line_ctx_t *this)
+{
+    if(NULL != this->argv)
+    {
+        lub_argv_delete(this->argv);
+        this->argv = NULL;
+    }
+    lub_string_free(this->line);
+    this->line = NULL;
+}
+/*--------------------------------------------------------- */
+clish_line_ctx_t *
+clish_shell_line_ctx(const clish_shell_t *shell,
+                     const char          *line)
+{
+    clish_line_ctx_t *this = shell->line_ctx;
+
+    clish_line_ctx_set_line(this,line);
+    clish_line_ctx_set_view(this,&this->local,shell->view);
+    clish_line_ctx_set_view(this,&this->global,shell->model->global);
+
+    return this;
+}
+/*--------------------------------------------------------- */
+const lub_argv_t *
+clish_line_ctx__get_argv(const clish_line_ctx_t *this)
+{
+    return this->argv;
+}
+/*--------------------------------------------------------- */
+const clish_command_t *
+clish_line_ctx_resolve_prefix(clish_line_ctx_t *this)
+{
+    clish_command_t *cmd1,*cmd2;
+
+    /* search the current view and global view */
+    cmd1 = clish_line_ctx_resolve(this,&this->local);
+    cmd2 = clish_line_ctx_resolve(this,&this->global);
+
+    /* choose the longest match */
+    return clish_command_choose_longest(cmd1,cmd2);
+}
+/*--------------------------------------------------------- */
+const clish_command_t *
+clish_line_ctx_resolve_command(clish_line_ctx_t *this)
+{
+    clish_command_t *cmd1,*cmd2;
+
+    /* search the current view and global view */
+    cmd1 = clish_line_ctx_resolve(this,&this->local);
+    cmd2 = clish_line_ctx_resolve(this,&this->global);
+
+    /* if these don't do anything we've not resolved a command */
+    if((NULL != cmd1) && (BOOL_FALSE == clish_command__get_executable(cmd1)))
+    {
+        cmd1 = NULL;
+    }
+    if((NULL != cmd2) && (BOOL_FALSE == clish_command__get_executable(cmd2)))
+    {
+        cmd2 = NULL;
+    }
+    /* choose the longest match */
+    return clish_command_choose_longest(cmd1,cmd2);
+}
+/*--------------------------------------------------------- */
+const clish_command_t *
+clish_line_ctx_find_next_completion(clish_line_ctx_t       *this,
+                                    clish_shell_iterator_t *iter)
+{
+    const clish_command_t *result=NULL,*cmd1 = NULL,*cmd2 = NULL;
+    int                    diff;
+
+    /* ask the local view for it's next command */
+    if(NULL != this->local.view)
+    {
+        cmd1 = clish_view_find_next_completion_argv(this->local.view,
+                                                    iter->last_cmd_local,
+                                                    this->line,
+                                                    this->argv,
+                                                    clish_shell_command_allowed,
+                                                    this->shell);
+    }
+    /* ask the global view for it's next command */
+    if(NULL != this->global.view)
+    {
+        cmd2 = clish_view_find_next_completion_argv(this->global.view,
+                                                    iter->last_cmd_global,
+                                                    this->line,
+                                                    this->argv,
+                                                    clish_shell_command_allowed,
+                                                    this->shell);
+    }
+    /* compare the two results */
+    diff = clish_command_diff(cmd1,cmd2);
+    if(diff > 0)
+    {
+        result = iter->last_cmd_global = cmd2;
+    }
+    else
+    {
+        if(0 == diff)
+        {
+            /* local view may override global command */
+            iter->last_cmd_global = cmd2;
+        }
+        result = iter->last_cmd_local = cmd1;
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+/*
+ * Return the first command of which the line is a prefix
+ */
+const clish_command_t *
+clish_line_ctx__get_extension(clish_line_ctx_t *this)
+{
+    if(BOOL_FALSE == this->extension_valid)
+    {
+        clish_shell_iterator_t iter;
+
+        clish_shell_iterator_init(&iter);
+        this->extension       = clish_line_ctx_find_next_completion(this,
+                                                                    &iter);
+        this->extension_valid = BOOL_TRUE;
+    }
+    return this->extension;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,154 @@
+/*
+ * shell_model.c
+ *
+ * Every spawned shell would otherwise read the XML files for itself and
+ * hold a private copy of the views, commands and ptypes they define.
+ * Instead the first shell to start reads the files and the resulting
+ * model is frozen; any shells which start while it remains in use are
+ * simply given a reference to it. The model is deleted when the last
+ * shell using it goes away.
+ *
+ * Since shells may run for different users, the access restrictions on
+ * commands are left for each shell to check as it looks them up. The
+ * trees in a shared model are only walked in ways which leave them as
+ * they are.
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+/* protects the shared model and the reference counts of all models */
+static pthread_mutex_t      clish_shell_model_lock   = PTHREAD_MUTEX_INITIALIZER;
+static clish_shell_model_t *clish_shell_model_shared = NULL;
+
+/*--------------------------------------------------------- */
+static void
+clish_shell_model_init(clish_shell_model_t *this)
+{
+    /* initialise the tree of views */
+    lub_bintree_init(&this->view_tree,
+                    clish_view_bt_offset(),
+                    clish_view_bt_compare,
+                    clish_view_bt_getkey);
+
+    /* initialise the tree of views */
+    lub_bintree_init(&this->ptype_tree,
+                    clish_ptype_bt_offset(),
+                    clish_ptype_bt_compare,
+                    clish_ptype_bt_getkey);
+
+    /* ...and the indexes used to find them by name */
+    lub_hash_init(&this->view_hash,clish_view_hash_getkey,BOOL_FALSE);
+    lub_hash_init(&this->ptype_hash,clish_ptype_hash_getkey,BOOL_FALSE);
+
+    this->global   = NULL;
+    this->startup  = NULL;
+    this->overview = NULL;
+    this->refcount = 1;
+    this->frozen   = BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+static void
+clish_shell_model_fini(clish_shell_model_t *this)
+{
+	clish_view_t  *view;
+	clish_ptype_t *ptype;
+
+	/* the indexes only reference the views and ptypes */
+	lub_hash_fini(&this->view_hash);
+	lub_hash_fini(&this->ptype_hash);
+
+	/* delete each view held  */
+	while((view = lub_bintree_findfirst(&this->view_tree)))
+	{
+		/* remove the command from the tree */
+		lub_bintree_remove(&this->view_tree,view);
+
+		/* release the instance */
+		clish_view_delete(view);
+	}
+
+	/* delete each ptype held  */
+	while((ptype = lub_bintree_findfirst(&this->ptype_tree)))
+	{
+		/* remove the command from the tree */
+		lub_bintree_remove(&this->ptype_tree,ptype);
+
+		/* release the instance */
+		clish_ptype_delete(ptype);
+	}
+    /* free the textual details */
+    lub_string_free(this->overview);
+
+	if(NULL != this->startup)
+    {
+        /* remove the startup command */
+        clish_command_delete(this->startup);
+    }
+}
+/*---------------------------------------------------------
+ * PRIVATE METHODS
+ *--------------------------------------------------------- */
+clish_shell_model_t *
+clish_shell_model_new(void)
+{
+    clish_shell_model_t *this = malloc(sizeof(clish_shell_model_t));
+
+    if(this)
+    {
+        clish_shell_model_init(this);
+    }
+    return this;
+}
+/*--------------------------------------------------------- */
+void
+clish_shell_model_release(clish_shell_model_t *this)
+{
+    unsigned refcount;
+
+    pthread_mutex_lock(&clish_shell_model_lock);
+    refcount = --this->refcount;
+    if((0 == refcount) && (this == clish_shell_model_shared))
+    {
+        /* the next shell to start will have to load the files again */
+        clish_shell_model_shared = NULL;
+    }
+    pthread_mutex_unlock(&clish_shell_model_lock);
+
+    if(0 == refcount)
+    {
+        clish_shell_model_fini(this);
+        free(this);
+    }
+}
+/*--------------------------------------------------------- */
+void
+clish_shell_attach_model(clish_shell_t *this)
+{
+    /*
+     * Holding the lock whilst the files are loaded means that shells
+     * which start meanwhile wait to share the result.
+     */
+    pthread_mutex_lock(&clish_shell_model_lock);
+    if(NULL != clish_shell_model_shared)
+    {
+        /* no-one else has seen this shell's own (empty) model */
+        clish_shell_model_fini(this->model);
+        free(this->model);
+
+        this->model = clish_shell_model_shared;
+        this->model->refcount++;
+    }
+    else
+    {
+        clish_shell_load_files(this);
+
+        /* from now on the model is read-only */
+        this->model->frozen      = BOOL_TRUE;
+        clish_shell_model_shared = this->model;
+    }
+    pthread_mutex_unlock(&clish_shell_model_lock);
+}
+/*--------------------------------------------------------- */
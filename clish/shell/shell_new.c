@@ -12,18 +12,6 @@ clish_shell_init(clish_shell_t             *this,
                  void                      *cookie,
                  FILE                      *istream)
 {
-    /* initialise the tree of views */
-    lub_bintree_init(&this->view_tree,
-                    clish_view_bt_offset(),
-                    clish_view_bt_compare,
-                    clish_view_bt_getkey);
-
-    /* initialise the tree of views */
-    lub_bintree_init(&this->ptype_tree,
-                    clish_ptype_bt_offset(),
-                    clish_ptype_bt_compare,
-                    clish_ptype_bt_getkey);
-
     assert((NULL != hooks) && (NULL != hooks->script_fn));
     
     /* set up defaults */
@@ -31,15 +19,21 @@ clish_shell_init(clish_shell_t             *this,
     this->client_cookie   = cookie;
     this->view            = NULL;
     this->viewid          = NULL;
-    this->global          = NULL;
-    this->startup         = NULL;
     this->state           = SHELL_STATE_INITIALISING;
-    this->overview        = NULL;
+    this->model           = clish_shell_model_new();
+    assert(this->model);
     clish_shell_iterator_init(&this->iter);
     this->tinyrl          = clish_shell_tinyrl_new(istream,
                                                    stdout,
                                                    0);
     this->current_file    = NULL;
+    this->coprocess       = malloc(sizeof(clish_shell_coprocess_t));
+    assert(this->coprocess);
+    clish_shell_coprocess_init(this->coprocess);
+    this->line_ctx        = malloc(sizeof(clish_line_ctx_t));
+    assert(this->line_ctx);
+    clish_line_ctx_init(this->line_ctx,this);
+    this->access          = NULL;
 }
 /*-------------------------------------------------------- */
 clish_shell_t *
@@ -13,6 +13,7 @@ clish_shell_parse(const clish_shell_t    *this,
                   clish_pargv_t         **pargv)
 {
     clish_pargv_status_t result = clish_BAD_CMD;
+    clish_line_ctx_t    *ctx;
     size_t             offset;
     char              *prompt = clish_view__get_prompt(this->view,this->viewid);
     
@@ -22,13 +23,17 @@ clish_shell_parse(const clish_shell_t    *this,
     /* cleanup */
     lub_string_free(prompt);
 
-    *cmd = clish_shell_resolve_command(this,line);
+    ctx  = clish_shell_line_ctx(this,line);
+    *cmd = clish_line_ctx_resolve_command(ctx);
     if(NULL != *cmd)
     {
         /*
          * Now construct the parameters for the command
          */
-        *pargv = clish_pargv_new(*cmd,line,offset,&result);
+        *pargv = clish_pargv_new_argv(*cmd,
+                                      clish_line_ctx__get_argv(ctx),
+                                      offset,
+                                      &result);
     }
     return result;
 }
@@ -15,8 +15,9 @@ clish_shell_pop_file(clish_shell_t *this)
         /* remove the current file from the stack... */
         this->current_file = node->next;
     
-        /* and close the current file...
+        /* and close the current file, dropping anything read ahead...
          */
+        tinyrl_forget_istream(this->tinyrl,node->file);
         fclose(node->file);
 
         if(node->next)
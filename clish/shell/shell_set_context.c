@@ -11,6 +11,6 @@ clish_shell_set_context(clish_shell_t *this,
 {
  	this->view   = clish_shell_find_view(this,viewname);
  	assert(this->view);
- 	assert(this->global);
+ 	assert(this->model->global);
 }
 /*--------------------------------------------------------- */
@@ -68,10 +68,12 @@ clish_shell_tilde_expand(const char *path)
     return result;
 }
 /*-------------------------------------------------------- */
-void 
-clish_shell_load_files(clish_shell_t *this)
+char **
+clish_shell_find_files(clish_shell_t *this)
 {
-    const char *path = getenv("CLISH_PATH");
+    const char *path   = getenv("CLISH_PATH");
+    char      **result = NULL;
+    unsigned    count  = 0;
     char       *buffer;
     char       *dirname;
     
@@ -110,18 +112,20 @@ clish_shell_load_files(clish_shell_t *this)
             {
                 if(0 == strcmp(".xml",extension))
                 {
-                    char *filename = NULL;
+                    char  *filename = NULL;
+                    char **tmp;
                     
                     /* build the filename */
                     lub_string_cat(&filename,dirname);
                     lub_string_cat(&filename,"/");
                     lub_string_cat(&filename,entry->d_name);
                     
-                    /* load this file */
-                    (void)clish_shell_xml_read(this,filename);
-                    
-                    /* release the resource */
-                    lub_string_free(filename);
+                    /* add it to the (NULL terminated) list */
+                    tmp = realloc(result,(count + 2) * sizeof(char *));
+                    assert(tmp);
+                    result          = tmp;
+                    result[count++] = filename;
+                    result[count]   = NULL;
                 }
             }
         }
@@ -130,6 +134,53 @@ clish_shell_load_files(clish_shell_t *this)
     }
     /* tidy up */
     lub_string_free(buffer);
+
+    if(NULL == result)
+    {
+        /* an empty list */
+        result = malloc(sizeof(char *));
+        assert(result);
+        result[0] = NULL;
+    }
+    return result;
+}
+/*-------------------------------------------------------- */
+void
+clish_shell_free_files(char **files)
+{
+    char **file;
+
+    for(file = files;
+        *file;
+        file++)
+    {
+        lub_string_free(*file);
+    }
+    free(files);
+}
+/*-------------------------------------------------------- */
+void 
+clish_shell_load_files(clish_shell_t *this)
+{
+    const char *image = getenv("CLISH_IMAGE");
+    char      **files = clish_shell_find_files(this);
+    
+    /* a compiled image saves reading the files, if it is up to date */
+    if((NULL == image) || 
+       (BOOL_FALSE == clish_shell_image_read(this,image,files)))
+    {
+        char **file;
+
+        for(file = files;
+            *file;
+            file++)
+        {
+            /* load this file */
+            (void)clish_shell_xml_read(this,*file);
+        }
+    }
+    /* tidy up */
+    clish_shell_free_files(files);
 #ifdef DEBUG
         clish_shell_dump(this);
 #endif
@@ -201,9 +252,10 @@ clish_shell_thread(void *arg)
     if(this && (SHELL_STATE_CLOSING != this->state))
     {
         /*
-         * load the XML files found in the current CLISH path 
+         * use the definitions from the XML files found in the 
+         * current CLISH path 
          */
-        clish_shell_load_files(this);
+        clish_shell_attach_model(this);
 
         /* start off with the default inputs stream */
         (void)clish_shell_push_file(this,
@@ -236,7 +288,7 @@ clish_shell_thread(void *arg)
                 view = clish_shell__get_view(this);
                 assert(view);
                 
-                context->prompt = clish_view__get_prompt(view,clish_shell__get_viewid(this));
+                context->prompt = clish_view__get_prompt(view,this->viewid);
                 assert(context->prompt);
 
                 /* get input from the user */
@@ -11,14 +11,14 @@ clish_shell_startup(clish_shell_t *this)
     const char    *banner;
     clish_pargv_t *dummy = NULL;
     
-    assert(this->startup);
+    assert(this->model->startup);
     
-    banner = clish_command__get_detail(this->startup);
+    banner = clish_command__get_detail(this->model->startup);
     
     if(NULL != banner)
     {
         tinyrl_printf(this->tinyrl,"%s\n",banner);
     }
-    return clish_shell_execute(this,this->startup,&dummy);
+    return clish_shell_execute(this,this->model->startup,&dummy);
 }
 /*----------------------------------------------------------- */
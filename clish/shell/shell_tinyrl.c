@@ -361,8 +361,17 @@ clish_shell_tinyrl_new(FILE    *istream,
                                 clish_shell_tinyrl_completion);
     if(NULL != this)
     {
+        const char *filename = getenv("CLISH_HISTORY");
+
         /* now call our own constructor */
         clish_shell_tinyrl_init(this);
+        if(NULL != filename)
+        {
+            /* share the history with any other sessions */
+            (void)tinyrl_history_attach(tinyrl__get_history(this),
+                                        filename,
+                                        TINYRL_HISTORY_FILE_LIMIT);
+        }
     }
     return this;
 }
@@ -114,11 +114,11 @@ process_clish_module(clish_shell_t *shell,
                      void          *)
 {
     // create the global view
-    if(NULL == shell->global)
+    if(NULL == shell->model->global)
     {
-        shell->global = clish_shell_find_create_view(shell,"global","");
+        shell->model->global = clish_shell_find_create_view(shell,"global","");
     }
-    process_children(shell,element,shell->global);
+    process_children(shell,element,shell->model->global);
 }
 ///////////////////////////////////////
 static void
@@ -175,9 +175,9 @@ process_overview(clish_shell_t *shell,
     {
         assert(TiXmlNode::TEXT == text->Type());
         // set the overview text for this view
-        assert(NULL == shell->overview);
+        assert(NULL == shell->model->overview);
         // store the overview
-        shell->overview = lub_string_dup(text->Value());
+        shell->model->overview = lub_string_dup(text->Value());
     }
 }
 ////////////////////////////////////////
@@ -188,74 +188,65 @@ process_command(clish_shell_t *shell,
 {
     clish_view_t    *v       = (clish_view_t*)parent;
     clish_command_t *cmd     = NULL;
-    const char      *access  = element->Attribute("access");
-    bool             allowed = true;
+    // the model may be shared, so access is checked as each shell looks up the command
+    const char *access       = element->Attribute("access");
+    const char *name         = element->Attribute("name");
+    const char *help         = element->Attribute("help");
+    const char *view         = element->Attribute("view");
+    const char *viewid       = element->Attribute("viewid");
+    const char *escape_chars = element->Attribute("escape_chars");
+    const char *args_name    = element->Attribute("args");
+    const char *args_help    = element->Attribute("args_help");
     
-    if(NULL != access)
+    clish_command_t *old = clish_view_find_command(v,name);
+
+    // check this command doesn't already exist
+    if(NULL != old)
     {
-        allowed = false; // err on the side of caution
-        if(shell->client_hooks->access_fn)
-        {
-            // get the client to authenticate
-            allowed = shell->client_hooks->access_fn(shell,access) ? true : false;
-        }
+        // flag the duplication then ignore further definition
+        printf("DUPLICATE COMMAND: %s\n",clish_command__get_name(old));
     }
-    
-    if(allowed)
+    else
     {
-        const char *name         = element->Attribute("name");
-        const char *help         = element->Attribute("help");
-        const char *view         = element->Attribute("view");
-        const char *viewid       = element->Attribute("viewid");
-        const char *escape_chars = element->Attribute("escape_chars");
-        const char *args_name    = element->Attribute("args");
-        const char *args_help    = element->Attribute("args_help");
-        
-        clish_command_t *old = clish_view_find_command(v,name);
-
-        // check this command doesn't already exist
-        if(NULL != old)
+        assert(name);
+        assert(help);
+        /* create a command */
+        cmd = clish_view_new_command(v,name,help);
+        assert(cmd);
+        if(NULL != access)
         {
-            // flag the duplication then ignore further definition
-            printf("DUPLICATE COMMAND: %s\n",clish_command__get_name(old));
+            /* remember the restriction */
+            clish_command__set_access(cmd,access);
         }
-        else
+        if(NULL != escape_chars)
         {
-            assert(name);
-            assert(help);
-            /* create a command */
-            cmd = clish_view_new_command(v,name,help);
-            assert(cmd);
-            if(NULL != escape_chars)
-            {
-                /* define some specialist escape characters */
-                clish_command__set_escape_chars(cmd,escape_chars);
-            }
-            if(NULL != args_name)
-            {
-                /* define a "rest of line" argument */
-                clish_param_t *param;
-                
-                assert(NULL != args_help);
-                param = clish_param_new(args_name,args_help,NULL);
-                
-                clish_command__set_args(cmd,param);
-            }
-            // define the view which this command changes to
-            if(NULL != view)
-            {
-                clish_view_t *next = clish_shell_find_create_view(shell,view,NULL);
+            /* define some specialist escape characters */
+            clish_command__set_escape_chars(cmd,escape_chars);
+        }
+        if(NULL != args_name)
+        {
+            /* define a "rest of line" argument */
+            clish_param_t *param;
+            
+            assert(NULL != args_help);
+            param = clish_param_new(args_name,args_help,NULL);
+            
+            clish_command__set_args(cmd,param);
+        }
+        // define the view which this command changes to
+        if(NULL != view)
+        {
+            clish_view_t *next = clish_shell_find_create_view(shell,view,NULL);
 
-                // reference the next view
-                clish_command__set_view(cmd,next);
-            }
-            // define the view id which this command changes to
-            if(NULL != viewid)
-            {
-                clish_command__set_viewid(cmd,viewid);
-            }
-            process_children(shell,element,cmd);
+            // reference the next view
+            clish_command__set_view(cmd,next);
+        }
+        // define the view id which this command changes to
+        if(NULL != viewid)
+        {
+            clish_command__set_viewid(cmd,viewid);
         }
+        process_children(shell,element,cmd);
     }
 }
 ///////////////////////////////////////
@@ -269,7 +260,7 @@ process_startup(clish_shell_t *shell,
     const char      *view   = element->Attribute("view");
     const char      *viewid = element->Attribute("viewid");
 
-    assert(NULL == shell->startup);
+    assert(NULL == shell->model->startup);
     assert(view);
         
     /* create a command with NULL help */
@@ -287,7 +278,7 @@ process_startup(clish_shell_t *shell,
     }
     
     // remember this command 
-    shell->startup = cmd;
+    shell->model->startup = cmd;
     
     process_children(shell,element,cmd);
 }
@@ -301,7 +292,7 @@ process_param(clish_shell_t *shell,
 
     if(NULL != cmd)
     {
-        assert(cmd != shell->startup);
+        assert(cmd != shell->model->startup);
         const char          *name   = element->Attribute("name");
         const char          *help   = element->Attribute("help");
         const char          *ptype  = element->Attribute("ptype");
@@ -388,6 +379,9 @@ clish_shell_xml_read(clish_shell_t *shell,
     int           ret = -1;
     TiXmlDocument doc;
     
+    // a shared model must never change
+    assert(BOOL_FALSE == shell->model->frozen);
+
     // keep the white space 
     TiXmlBase::SetCondenseWhiteSpace(false);
     
@@ -12,6 +12,9 @@
 #ifndef _clish_variable_h
 #define _clish_variable_h
 
+typedef struct clish_variable_template_s clish_variable_template_t;
+typedef struct clish_variable_viewid_s   clish_variable_viewid_t;
+
 #include "clish/shell.h"
 #include "clish/command.h"
 #include "clish/pargv.h"
@@ -27,13 +30,57 @@ char *
                	              const char            *viewid,
                	              const clish_command_t *cmd,
                    		      clish_pargv_t         *pargv);
+/**
+ * This operation parses a string containing "${FRED}" type variable
+ * references into a template, so that it can be expanded repeatedly
+ * without being rescanned.
+ *
+ * \return
+ * - A template instance, or NULL if 'string' is NULL.
+ */
+clish_variable_template_t *
+        clish_variable_template_new(const char *string);
+/**
+ * This operation parses a viewid string of the form "name=value;name=value"
+ * into a set of name/value pairs.
+ *
+ * \return
+ * - A viewid instance, or NULL if 'viewid' is NULL.
+ */
+clish_variable_viewid_t *
+        clish_variable_viewid_new(const char *viewid);
 /*-----------------
  * methods
  *----------------- */
-
+/**
+ * This operation builds a dynamic string from a template, substituting
+ * each variable reference with the appropriate value from the command
+ * line arguments, the viewid or the environment.
+ *
+ * \return
+ * - A dynamically allocated string, or NULL if the template is NULL or
+ *   empty. The client is responsible for releasing it with 
+ *   lub_string_free()
+ */
+char *
+        clish_variable_template_expand(const clish_variable_template_t *instance,
+                                       const clish_variable_viewid_t   *viewid,
+                                       const clish_command_t           *cmd,
+                                       clish_pargv_t                   *pargv);
+void
+        clish_variable_template_delete(clish_variable_template_t *instance);
+const char *
+        clish_variable_viewid_find(const clish_variable_viewid_t *instance,
+                                   const char                    *name);
+void
+        clish_variable_viewid_delete(clish_variable_viewid_t *instance);
 /*-----------------
  * attributes
  *----------------- */
+unsigned
+        clish_variable_template__get_segment_count(const clish_variable_template_t *instance);
+const char *
+        clish_variable_viewid__get_text(const clish_variable_viewid_t *instance);
 
 #endif /* _clish_variable_h */
 /** @} clish_variable */
@@ -7,8 +7,46 @@
 typedef struct context_s context_t;
 struct context_s
 {
-    const char            *viewid;
-    const clish_command_t *cmd;
-    clish_pargv_t         *pargv;
+    const clish_variable_viewid_t *viewid;
+    const clish_command_t         *cmd;
+    clish_pargv_t                 *pargv;
+};
+/*--------------------------------------------------------- */
+/*
+ * A template is held as a sequence of segments, each of which is
+ * either a run of literal text or a "${...}" variable reference. The
+ * text of a variable reference is held as its ':' separated words.
+ */
+typedef struct clish_variable_segment_s clish_variable_segment_t;
+struct clish_variable_segment_s
+{
+    bool_t    variable;
+    char     *text;
+    unsigned  wordc;
+    char    **wordv;
+};
+struct clish_variable_template_s
+{
+    unsigned                  segc;
+    clish_variable_segment_t *segv;
+};
+/*--------------------------------------------------------- */
+/*
+ * A viewid string of the form "name=value;name=value" is held as
+ * a vector of name/value pairs which point into a private copy of
+ * the string.
+ */
+typedef struct clish_variable_entry_s clish_variable_entry_t;
+struct clish_variable_entry_s
+{
+    const char *name;
+    const char *value;
+};
+struct clish_variable_viewid_s
+{
+    char                   *text;
+    char                   *buffer;
+    unsigned                entryc;
+    clish_variable_entry_t *entryv;
 };
 /*--------------------------------------------------------- */
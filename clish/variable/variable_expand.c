@@ -7,9 +7,6 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
-
-#include <sys/types.h>
-#include <regex.h>
 /*
  * These are the escape characters which are used by default when 
  * expanding variables. These characters will be backslash escaped
@@ -20,48 +17,6 @@
  */
 static const char *default_escape_chars = "`|$<>&()#";
 
-/*----------------------------------------------------------- */
-/*
- * search the current viewid string for a variable
- */
-static char *
-find_viewid_var(const char *viewid,
-                const char *name)
-{
-    char      *result=NULL;
-    regex_t    regex;
-    int        status;
-    char      *pattern = NULL;
-    regmatch_t pmatches[2];
-    
-    /* build up the pattern to match */
-    lub_string_cat(&pattern,name);
-    lub_string_cat(&pattern,"[ ]*=([^;]*)");
-    
-    /* compile the regular expression to find this variable */
-    status = regcomp(&regex,pattern,REG_EXTENDED);
-    assert(0 == status);
-    lub_string_free(pattern);
-    
-    /* now perform the matching */
-    /*lint -e64 Type mismatch (arg. no. 4) */
-    /* 
-     * lint seems to equate regmatch_t[] as being of type regmatch_t !!!
-     */
-    status = regexec(&regex,viewid,2,pmatches,0);
-    /*lint +e64 */
-    if(0 == status)
-    {
-        regoff_t     len   = pmatches[1].rm_eo - pmatches[1].rm_so;
-        const char  *value = &viewid[pmatches[1].rm_so]; 
-        /* found a match */
-        result = lub_string_dupn(value,(unsigned)len);
-    }
-    /* release the regular expression */
-    regfree(&regex);
-    
-    return result;
-}
 /*----------------------------------------------------------- */
 /*
  * This needs to escape any dangerous characters within the command line
@@ -71,32 +26,43 @@ static char *
 escape_special_chars(const char *string,
                      const char *escape_chars)
 {
-        char       *result = NULL;
-        const char *p;
+        char         storage[128];
+        lub_strbuf_t buffer;
+        char        *result = NULL;
+        const char  *p;
 
+        if((NULL == string) || ('\0' == *string))
+        {
+                /* nothing to escape */
+                return NULL;
+        }
         if(NULL == escape_chars)
         {
             escape_chars = default_escape_chars;
         }
+        lub_strbuf_init(&buffer,storage,sizeof(storage));
         for(p = string;
-            p && *p;
+            *p;
             p++)
 
         {
                 /* find any special characters and prefix them with '\' */
                 size_t len = strcspn(p,escape_chars);
-                lub_string_catn(&result,p,len);
+                lub_strbuf_catn(&buffer,p,len);
                 p += len;
                 if(*p)
                 {
-                        lub_string_catn(&result,"\\",1);
-                        lub_string_catn(&result,p,1);
+                        lub_strbuf_catn(&buffer,"\\",1);
+                        lub_strbuf_catn(&buffer,p,1);
                 }
                 else
                 {
                         break;
                 }
         }
+        result = lub_strbuf_detach(&buffer);
+        lub_strbuf_fini(&buffer);
+
         return result;
 }
 /*--------------------------------------------------------- */
@@ -107,7 +73,6 @@ context_retrieve(const context_t *this,
     char       *result       = NULL;
     const char *tmp          = NULL;
     const char *escape_chars = NULL;
-    char       *string       = NULL;
     assert(name);
 
     /* try and substitute a parameter value */
@@ -126,7 +91,7 @@ context_retrieve(const context_t *this,
         /* try and substitute a viewId variable */
         if(this && this->viewid)
         {
-            tmp = string = find_viewid_var(this->viewid,name);
+            tmp = clish_variable_viewid_find(this->viewid,name);
         }
     }
 
@@ -141,105 +106,102 @@ context_retrieve(const context_t *this,
         escape_chars = clish_command__get_escape_chars(this->cmd);
     }
     result = escape_special_chars(tmp,escape_chars);
-    if(NULL != string)
-    {
-        /* free the dynamic memory */
-        lub_string_free(string);
-    }
+
     return result;
 }
 /*--------------------------------------------------------- */
 /* 
- * return the next segment of text from the provided string
- * segments are delimited by variables within the string.
+ * return the expansion of a variable segment.
+ * Each of the ':' separated words is either expanded or duplicated into
+ * the result string. Only return a non-empty result if at least one
+ * of the words is an expandable variable.
  */
 static char *
-context_nextsegment(const context_t  *this,
-                    const char      **string)
+context_expand(const context_t                *this,
+               const clish_variable_segment_t *seg)
 {
-    const char *p      = *string;
-    char       *result = NULL;
-    size_t      len    = 0;
+    char         storage[128];
+    lub_strbuf_t buffer;
+    char        *result = NULL;
+    bool_t       valid  = BOOL_FALSE;
+    unsigned     i;
+
+    lub_strbuf_init(&buffer,storage,sizeof(storage));
 
-    if(p)
+    for(i = 0;
+        i < seg->wordc;
+        i++)
     {
-        if(*p && (p[0] == '$') && (p[1] == '{'))
-        {
-            /* start of a variable */
-            const char *tmp;
-            p += 2;
-            tmp = p;
+        char *var = context_retrieve(this,seg->wordv[i]);
 
-            /* 
-             * find the end of the variable 
-             */
-            while(*p && p++[0] != '}')
-            {
-                len++;
-            }
-            
-            /* ignore non-terminated variables */
-            if(p[-1] == '}')
-            {
-                bool_t valid = BOOL_FALSE;
-                char  *text,*q;
+        /* copy the expansion or the raw word */
+        lub_strbuf_cat(&buffer,var ? var : seg->wordv[i]);
 
-                /* get the variable text */
-                text = lub_string_dupn(tmp,len);	
-                /*
-                 * tokenise this INTO ':' separated words
-                 * and either expand or duplicate into the result string.
-                 * Only return a result if at least 
-                 * of the words is an expandable variable
-                 */
-                for(q = strtok(text,":");
-                    q;
-                    q = strtok(NULL,":") )
-                {
-                    char *var = context_retrieve(this,q);
+        /* record any expansions */
+        if(NULL != var)
+        {
+            valid = BOOL_TRUE;
+        }
+        lub_string_free(var);
+    }
+    if(BOOL_TRUE == valid)
+    {
+        result = lub_strbuf_detach(&buffer);
+    }
+    /* otherwise this is not a valid variable expansion */
+    lub_strbuf_fini(&buffer);
+
+    return result;
+}
+/*--------------------------------------------------------- */
+/*
+ * This function builds a dynamic string based on the provided template
+ * subtituting each "${FRED}" type variable reference with the 
+ * appropriate value.
+ */
+char *
+clish_variable_template_expand(const clish_variable_template_t *this,
+                               const clish_variable_viewid_t   *viewid,
+                               const clish_command_t           *cmd,
+                               clish_pargv_t                   *pargv)
+{
+    char         *result = NULL;
+    lub_strbuf_t  buffer;
+    context_t     context;
+    unsigned      i;
 
-                    /* copy the expansion or the raw word */
-                    lub_string_cat(&result,var ? var : q);
+    if((NULL == this) || (0 == this->segc))
+    {
+        return NULL;
+    }
+    /* setup the context */
+    context.viewid = viewid;
+    context.cmd    = cmd;
+    context.pargv  = pargv;
 
-                    /* record any expansions */
-                    if(NULL != var)
-                    {
-                        valid = BOOL_TRUE;
-                    }
-                    lub_string_free(var);
-                }
+    /* extend the result with each segment in turn */
+    lub_strbuf_init(&buffer,NULL,0);
+    for(i = 0;
+        i < this->segc;
+        i++)
+    {
+        const clish_variable_segment_t *seg = &this->segv[i];
 
-                if(BOOL_FALSE == valid)
-                {
-                    /* not a valid variable expansion */
-                    lub_string_free(result);
-                    result = lub_string_dup("");
-                }
+        if(BOOL_TRUE == seg->variable)
+        {
+            char *var = context_expand(&context,seg);
 
-                /* finished with the variable text */
-                lub_string_free(text);
-            }
+            lub_strbuf_cat(&buffer,var);
+            lub_string_free(var);
         }
         else
         {
-            /* find the start of a variable */
-            while(*p)
-            {
-                if((p[0] == '$') && (p[1] == '{'))
-                {
-                    break;
-                }
-                len++;
-                p++;
-            }
-            if(len > 0)
-            {
-                result = lub_string_dupn(*string,len);
-            }
+            lub_strbuf_cat(&buffer,seg->text);
         }
-        /* move the string pointer on for next time... */
-        *string = p;
     }
+    result = lub_strbuf_detach(&buffer);
+    lub_strbuf_fini(&buffer);
+
     return result;
 }
 /*--------------------------------------------------------- */
@@ -254,20 +216,14 @@ clish_variable_expand(const char            *string,
                       const clish_command_t *cmd,
                       clish_pargv_t         *pargv)
 {
-    char       *seg,*result = NULL;
-    context_t   context;
+    clish_variable_template_t *parsed   = clish_variable_template_new(string);
+    clish_variable_viewid_t   *map      = clish_variable_viewid_new(viewid);
+    char                      *result;
 
-    /* setup the context */
-    context.viewid = viewid;
-    context.cmd    = cmd;
-    context.pargv  = pargv;
+    result = clish_variable_template_expand(parsed,map,cmd,pargv);
 
-    /* read each segment and extend the result */
-    while(NULL != (seg = context_nextsegment(&context,&string)))
-    {
-        lub_string_cat(&result,seg);
-        lub_string_free(seg);
-    }
+    clish_variable_viewid_delete(map);
+    clish_variable_template_delete(parsed);
 
     return result;
 }
@@ -0,0 +1,167 @@
+/*
+ * variable_template.c
+ *
+ * Parse a string containing "${FRED}" type variable references once,
+ * so that it can be expanded many times without being rescanned.
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------- */
+static clish_variable_segment_t *
+clish_variable_template_add(clish_variable_template_t *this,
+                            const char                *text,
+                            size_t                     len)
+{
+    clish_variable_segment_t *seg;
+
+    /* resize the segment vector */
+    seg = realloc(this->segv,(this->segc+1) * sizeof(clish_variable_segment_t));
+    if(NULL == seg)
+    {
+        return NULL;
+    }
+    this->segv = seg;
+    seg        = &this->segv[this->segc++];
+
+    seg->variable = BOOL_FALSE;
+    seg->text     = lub_string_dupn(text,len);
+    seg->wordc    = 0;
+    seg->wordv    = NULL;
+
+    return seg;
+}
+/*--------------------------------------------------------- */
+/*
+ * tokenise the text of a variable reference into ':' separated words
+ */
+static void
+clish_variable_segment_split(clish_variable_segment_t *this)
+{
+    char *p = this->text;
+
+    this->variable = BOOL_TRUE;
+    while(p && *p)
+    {
+        char **tmp;
+
+        /* skip any leading separators */
+        p += strspn(p,":");
+        if('\0' == *p)
+        {
+            break;
+        }
+        tmp = realloc(this->wordv,(this->wordc+1) * sizeof(char *));
+        if(NULL == tmp)
+        {
+            break;
+        }
+        this->wordv                = tmp;
+        this->wordv[this->wordc++] = p;
+
+        /* terminate the word */
+        p += strcspn(p,":");
+        if(*p)
+        {
+            *p++ = '\0';
+        }
+    }
+}
+/*--------------------------------------------------------- */
+static void
+clish_variable_template_init(clish_variable_template_t *this,
+                             const char                *p)
+{
+    this->segc = 0;
+    this->segv = NULL;
+
+    while(*p)
+    {
+        const char *tmp = p;
+
+        if((p[0] == '$') && (p[1] == '{'))
+        {
+            clish_variable_segment_t *seg;
+
+            /* start of a variable, so find the end of it */
+            tmp = strchr(p += 2,'}');
+            if(NULL == tmp)
+            {
+                /* ignore non-terminated variables */
+                break;
+            }
+            seg = clish_variable_template_add(this,p,tmp - p);
+            if(NULL != seg)
+            {
+                clish_variable_segment_split(seg);
+            }
+            p = tmp + 1;
+        }
+        else
+        {
+            /* find the start of a variable */
+            while(*p)
+            {
+                if((p[0] == '$') && (p[1] == '{'))
+                {
+                    break;
+                }
+                p++;
+            }
+            clish_variable_template_add(this,tmp,p - tmp);
+        }
+    }
+}
+/*--------------------------------------------------------- */
+static void
+clish_variable_template_fini(clish_variable_template_t *this)
+{
+    unsigned i;
+
+    for(i = 0;
+        i < this->segc;
+        i++)
+    {
+        lub_string_free(this->segv[i].text);
+        free(this->segv[i].wordv);
+    }
+    free(this->segv);
+    this->segv = NULL;
+    this->segc = 0;
+}
+/*--------------------------------------------------------- */
+clish_variable_template_t *
+clish_variable_template_new(const char *string)
+{
+    clish_variable_template_t *this = NULL;
+
+    if(NULL != string)
+    {
+        this = malloc(sizeof(clish_variable_template_t));
+        if(this)
+        {
+            clish_variable_template_init(this,string);
+        }
+    }
+    return this;
+}
+/*--------------------------------------------------------- */
+void
+clish_variable_template_delete(clish_variable_template_t *this)
+{
+    if(NULL != this)
+    {
+        clish_variable_template_fini(this);
+        free(this);
+    }
+}
+/*--------------------------------------------------------- */
+unsigned
+clish_variable_template__get_segment_count(const clish_variable_template_t *this)
+{
+    return this ? this->segc : 0;
+}
+/*--------------------------------------------------------- */
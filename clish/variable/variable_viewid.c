@@ -0,0 +1,137 @@
+/*
+ * variable_viewid.c
+ *
+ * Parse a viewid string of the form "name=value;name=value" once,
+ * so that its variables can be looked up without rescanning it.
+ */
+#include "private.h"
+#include "lub/string.h"
+#include "lub/ctype.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------- */
+static void
+clish_variable_viewid_init(clish_variable_viewid_t *this,
+                           const char              *viewid)
+{
+    char *p;
+
+    this->text   = lub_string_dup(viewid);
+    this->buffer = lub_string_dup(viewid);
+    this->entryc = 0;
+    this->entryv = NULL;
+
+    /* split into ';' separated "name=value" pairs */
+    for(p = this->buffer;
+        p && *p;
+        )
+    {
+        char *name  = p;
+        char *value = p + strcspn(p,";=");
+        char *end;
+
+        if('=' != *value)
+        {
+            /* not an assignment so skip it */
+            p = *value ? value + 1 : value;
+            continue;
+        }
+        /* terminate the name, ignoring any surrounding space */
+        end = value;
+        while((end > name) && (' ' == end[-1]))
+        {
+            end--;
+        }
+        *end = '\0';
+        while(lub_ctype_isspace(*name))
+        {
+            name++;
+        }
+        /* terminate the value */
+        value++;
+        p = value + strcspn(value,";");
+        if(*p)
+        {
+            *p++ = '\0';
+        }
+        if(*name)
+        {
+            clish_variable_entry_t *tmp;
+
+            tmp = realloc(this->entryv,
+                          (this->entryc+1) * sizeof(clish_variable_entry_t));
+            if(NULL != tmp)
+            {
+                this->entryv = tmp;
+                this->entryv[this->entryc].name  = name;
+                this->entryv[this->entryc].value = value;
+                this->entryc++;
+            }
+        }
+    }
+}
+/*--------------------------------------------------------- */
+static void
+clish_variable_viewid_fini(clish_variable_viewid_t *this)
+{
+    free(this->entryv);
+    this->entryv = NULL;
+    this->entryc = 0;
+    lub_string_free(this->buffer);
+    this->buffer = NULL;
+    lub_string_free(this->text);
+    this->text = NULL;
+}
+/*--------------------------------------------------------- */
+clish_variable_viewid_t *
+clish_variable_viewid_new(const char *viewid)
+{
+    clish_variable_viewid_t *this = NULL;
+
+    if(NULL != viewid)
+    {
+        this = malloc(sizeof(clish_variable_viewid_t));
+        if(this)
+        {
+            clish_variable_viewid_init(this,viewid);
+        }
+    }
+    return this;
+}
+/*--------------------------------------------------------- */
+void
+clish_variable_viewid_delete(clish_variable_viewid_t *this)
+{
+    if(NULL != this)
+    {
+        clish_variable_viewid_fini(this);
+        free(this);
+    }
+}
+/*--------------------------------------------------------- */
+const char *
+clish_variable_viewid_find(const clish_variable_viewid_t *this,
+                           const char                    *name)
+{
+    unsigned i;
+
+    for(i = 0;
+        i < this->entryc;
+        i++)
+    {
+        if(0 == strcmp(this->entryv[i].name,name))
+        {
+            return this->entryv[i].value;
+        }
+    }
+    return NULL;
+}
+/*--------------------------------------------------------- */
+const char *
+clish_variable_viewid__get_text(const clish_variable_viewid_t *this)
+{
+    return this ? this->text : NULL;
+}
+/*--------------------------------------------------------- */
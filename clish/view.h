@@ -19,6 +19,16 @@ a global scope.
 typedef struct clish_view_s clish_view_t;
 
 #include "clish/command.h"
+#include "clish/variable.h"
+#include "lub/argv.h"
+
+/*
+ * Decides whether a command may be used. A command for which this
+ * returns BOOL_FALSE is passed over as though it were not in the view.
+ */
+typedef bool_t
+		clish_view_access_fn_t(const clish_command_t *cmd,
+		                       void                  *arg);
 
 /*=====================================
  * VIEW INTERFACE
@@ -37,6 +47,8 @@ void
                 	             lub_bintree_key_t *key);
 size_t
 		clish_view_bt_offset(void);
+const char *
+		clish_view_hash_getkey(const void *clientnode);
 /*-----------------
  * methods
  *----------------- */
@@ -59,6 +71,30 @@ clish_command_t *
 clish_command_t *
 		clish_view_resolve_prefix(clish_view_t *instance,
 				          const char   *line);
+/*
+ * These variants operate on a line which has already been split
+ * into words, the argument vector being that of the whole line.
+ * Only those commands which 'access_fn' (if not NULL) allows are
+ * considered.
+ */
+const clish_command_t *
+		clish_view_find_next_completion_argv(clish_view_t           *instance,
+                		                     const clish_command_t  *cmd,
+                		                     const char             *line,
+                		                     const lub_argv_t       *argv,
+                		                     clish_view_access_fn_t *access_fn,
+                		                     void                   *arg);
+clish_command_t *
+		clish_view_resolve_prefix_argv(clish_view_t           *instance,
+				               const lub_argv_t       *argv,
+				               unsigned               *examined,
+				               clish_view_access_fn_t *access_fn,
+				               void                   *arg);
+clish_command_t *
+		clish_view_getfirst_command(clish_view_t *instance);
+clish_command_t *
+		clish_view_getnext_command(clish_view_t          *instance,
+		                           const clish_command_t *cmd);
 void
 		clish_view_dump(clish_view_t *instance);
 /*-----------------
@@ -70,8 +106,10 @@ void
 		clish_view__set_prompt(clish_view_t *instance,
                 		       const char   *prompt);
 char *
-		clish_view__get_prompt(const clish_view_t  *instance,
-                               const char          *viewid);
+		clish_view__get_prompt(const clish_view_t            *instance,
+                               const clish_variable_viewid_t *viewid);
+const char *
+		clish_view__get_unexpanded_prompt(const clish_view_t *instance);
 
 #endif /* _clish_view_h */
 /** @} clish_view */
@@ -3,14 +3,53 @@
  */
 #include "clish/view.h"
 #include "lub/bintree.h"
+#include "lub/hash.h"
 
 /*---------------------------------------------------------
  * PRIVATE TYPES
  *--------------------------------------------------------- */
+/*
+ * A node in the word level trie of command names held by each view.
+ * The root node has no word, every other node represents a single word
+ * of one or more command names. The children of a node are held in
+ * case insensitive order so that they can be binary searched and
+ * iterated in the same order as the binary tree of commands.
+ */
+typedef struct clish_view_trie_s clish_view_trie_t;
+struct clish_view_trie_s
+{
+    char               *word;
+    clish_command_t    *cmd;
+    unsigned            childc;
+    clish_view_trie_t **childv;
+};
+
 struct clish_view_s
 {
     lub_bintree_t      tree;
+    lub_hash_t         hash;
     lub_bintree_node_t bt_node;
     char              *name;
     char              *prompt;
+    clish_variable_template_t *prompt_template;
+    clish_view_trie_t  trie;
 };
+/*---------------------------------------------------------
+ * PRIVATE METHODS
+ *--------------------------------------------------------- */
+void
+    clish_view_trie_init(clish_view_trie_t *instance,
+                         const char        *word);
+void
+    clish_view_trie_fini(clish_view_trie_t *instance);
+void
+    clish_view_trie_insert(clish_view_trie_t *instance,
+                           clish_command_t   *cmd);
+clish_view_trie_t *
+    clish_view_trie_find(const clish_view_trie_t *instance,
+                         const char              *word,
+                         size_t                   length);
+unsigned
+    clish_view_trie_bound(const clish_view_trie_t *instance,
+                          const char              *word,
+                          bool_t                   upper);
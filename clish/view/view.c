@@ -36,6 +36,37 @@ clish_view_bt_getkey(const void        *clientnode,
     /* fill out the opaque key */
     strcpy((char *)key,this->name);
 }
+/*-------------------------------------------------------- */
+const char *
+clish_view_hash_getkey(const void *clientnode)
+{
+    const clish_view_t *this = clientnode;
+
+    return this->name;
+}
+/*--------------------------------------------------------- */
+/*
+ * Case insensitive comparison of the first 'length' characters
+ * of two strings.
+ */
+static int
+clish_view_nocasencmp(const char *cs,
+                      const char *ct,
+                      size_t      length)
+{
+    int result = 0;
+
+    while((0 == result) && length--)
+    {
+        result = lub_ctype_tolower(*cs) - lub_ctype_tolower(*ct);
+        if(('\0' == *cs) || ('\0' == *ct))
+        {
+            break;
+        }
+        cs++,ct++;
+    }
+    return result;
+}
 /*---------------------------------------------------------
  * PRIVATE METHODS
  *--------------------------------------------------------- */
@@ -47,6 +78,7 @@ clish_view_init(clish_view_t *this,
     /* set up defaults */
     this->name   = lub_string_dup(name);
     this->prompt = NULL;
+    this->prompt_template = NULL;
 
     /* Be a good binary tree citizen */
     lub_bintree_node_init(&this->bt_node);
@@ -57,6 +89,12 @@ clish_view_init(clish_view_t *this,
                      clish_command_bt_compare,
                      clish_command_bt_getkey);
 
+    /* ...the index used to find them by name */
+    lub_hash_init(&this->hash,clish_command_hash_getkey,BOOL_TRUE);
+
+    /* ...and the trie of the words which make up their names */
+    clish_view_trie_init(&this->trie,NULL);
+
     /* set up the defaults */
     clish_view__set_prompt(this,prompt);
 }
@@ -66,6 +104,10 @@ clish_view_fini(clish_view_t *this)
 {
     clish_command_t *cmd;
     
+    /* the trie only references the commands */
+    clish_view_trie_fini(&this->trie);
+    lub_hash_fini(&this->hash);
+
     /* delete each command held by this view */
     while((cmd = lub_bintree_findfirst(&this->tree)))
     {
@@ -81,6 +123,8 @@ clish_view_fini(clish_view_t *this)
     this->name = NULL;
     lub_string_free(this->prompt);
     this->prompt = NULL;
+    clish_variable_template_delete(this->prompt_template);
+    this->prompt_template = NULL;
 }
 /*---------------------------------------------------------
  * PUBLIC META FUNCTIONS
@@ -132,53 +176,91 @@ clish_view_new_command(clish_view_t *this,
             clish_command_delete(cmd);
             cmd = NULL;
         }
+        else if(-1 == lub_hash_insert(&this->hash,cmd))
+        {
+            /* it cannot be found without the index */
+            lub_bintree_remove(&this->tree,cmd);
+            clish_command_delete(cmd);
+            cmd = NULL;
+        }
+        else
+        {
+            /* ...and index it by the words in its name */
+            clish_view_trie_insert(&this->trie,cmd);
+        }
     }
     return cmd;
 }
 /*--------------------------------------------------------- */
 /* This method identifies the command (if any) which provides
- * the longest match with the specified line of text.
+ * the longest match with the specified words.
  *
  * NB this comparison is case insensitive.
  *
- * this - the view instance upon which to operate
- * line - the command line to analyse 
+ * this      - the view instance upon which to operate
+ * argv      - the words of the command line to analyse
+ * examined  - if not NULL, is set to the number of words which were
+ *             looked at in order to reach the result
+ * access_fn - if not NULL, decides which commands may be matched
+ * arg       - passed to access_fn
  */
 clish_command_t *
-clish_view_resolve_prefix(clish_view_t *this,
-                          const char   *line)
+clish_view_resolve_prefix_argv(clish_view_t           *this,
+                               const lub_argv_t       *argv,
+                               unsigned               *examined,
+                               clish_view_access_fn_t *access_fn,
+                               void                   *arg)
 {
-    clish_command_t *result = NULL,*cmd;
-    char            *buffer = NULL;
-    lub_argv_t      *argv;
-    unsigned         i;
+    clish_command_t         *result = NULL;
+    const clish_view_trie_t *node   = &this->trie;
+    unsigned                 i;
 
-    /* create a vector of arguments */
-    argv = lub_argv_new(line,0);
-    
     for(i = 0;
         i < lub_argv__get_count(argv);
         i++)
     {
-        /* set our buffer to be that of the first "i" arguments  */
-        lub_string_cat(&buffer,lub_argv__get_arg(argv,i));
+        /* descend a word at a time */
+        node = clish_view_trie_find(node,
+                                    lub_argv__get_arg(argv,i),
+                                    lub_argv__get_length(argv,i));
 
-        /* set the result to the longest match */
-        cmd = clish_view_find_command(this,buffer);
-        
-        if(NULL == cmd)
+        if((NULL == node) || (NULL == node->cmd) ||
+           (access_fn && (BOOL_FALSE == access_fn(node->cmd,arg))))
         {
             /* job done */
+            i++;
             break;
         }
-        result = cmd;
-
-        /* ready for the next word */
-        lub_string_cat(&buffer," ");
+        /* set the result to the longest match */
+        result = node->cmd;
+    }
+    if(NULL != examined)
+    {
+        *examined = i;
     }
+    return result;                        
+}
+/*--------------------------------------------------------- */
+/* This method identifies the command (if any) which provides
+ * the longest match with the specified line of text.
+ *
+ * NB this comparison is case insensitive.
+ *
+ * this - the view instance upon which to operate
+ * line - the command line to analyse 
+ */
+clish_command_t *
+clish_view_resolve_prefix(clish_view_t *this,
+                          const char   *line)
+{
+    clish_command_t *result;
+    lub_argv_t      *argv;
+
+    /* create a vector of arguments */
+    argv   = lub_argv_new(line,0);
+    result = clish_view_resolve_prefix_argv(this,argv,NULL,NULL,NULL);
     
     /* free up our dynamic storage */
-    lub_string_free(buffer);
     lub_argv_delete(argv);
     
     return result;                        
@@ -190,20 +272,13 @@ clish_view_resolve_command(clish_view_t *this,
 {
     clish_command_t *result = clish_view_resolve_prefix(this,line);
 
-    if (NULL != result)
+    if((NULL != result) &&
+       (BOOL_FALSE == clish_command__get_executable(result)))
     {
-        char *action = clish_command__get_action(result,NULL,NULL);
-        if((NULL == action) &&
-           (NULL == clish_command__get_builtin(result)) &&
-           (NULL == clish_command__get_view(result)) )
-        {
-            /* if this doesn't do anything we've
-             * not resolved a command 
-             */
-            result = NULL;
-        }
-        /* cleanup */
-        lub_string_free(action);
+        /* if this doesn't do anything we've
+         * not resolved a command 
+         */
+        result = NULL;
     }
     return result;
 }  
@@ -212,45 +287,125 @@ clish_command_t *
 clish_view_find_command(clish_view_t *this,
                         const char   *name)
 {
-    return lub_bintree_find(&this->tree,name);
+    return lub_hash_find(&this->hash,name);
 }  
 /*--------------------------------------------------------- */
+/*
+ * The view may be shared between shells so the tree of commands
+ * is walked without being rearranged.
+ */
+clish_command_t *
+clish_view_getfirst_command(clish_view_t *this)
+{
+    return lub_bintree_peekfirst(&this->tree);
+}
+/*--------------------------------------------------------- */
+clish_command_t *
+clish_view_getnext_command(clish_view_t          *this,
+                           const clish_command_t *cmd)
+{
+    return lub_bintree_peeknext(&this->tree,clish_command__get_name(cmd));
+}
+/*--------------------------------------------------------- */
 const clish_command_t *
-clish_view_find_next_completion(clish_view_t          *this,
-                                const clish_command_t *cmd,
-                                const char            *line)
+clish_view_find_next_completion_argv(clish_view_t           *this,
+                                     const clish_command_t  *cmd,
+                                     const char             *line,
+                                     const lub_argv_t       *largv,
+                                     clish_view_access_fn_t *access_fn,
+                                     void                   *arg)
 {
-    const char *name = "";
-    lub_argv_t *largv;
-    unsigned    words;
+    const clish_view_trie_t *node    = &this->trie;
+    const char              *partial = "";
+    const char              *name;
+    size_t                   offset  = strlen(line);
+    unsigned                 words,i,start;
     
-    /* build an argument vector for the line */
-    largv = lub_argv_new(line,0);
     words = lub_argv__get_count(largv);
     
-    if(!*line || lub_ctype_isspace(line[strlen(line)-1]))
+    if(words && !lub_ctype_isspace(line[offset-1]))
     {
-        /* account for trailing space */
-        words++;
+        /* the last word is still being typed */
+        words--;
+        partial = lub_argv__get_arg(largv,words);
+        offset  = lub_argv__get_offset(largv,words);
     }
-    
-    if(NULL != cmd)
+    /* walk down the trie for each of the complete words */
+    for(i = 0;
+        node && (i < words);
+        i++)
     {
-        name = clish_command__get_name(cmd);
+        node = clish_view_trie_find(node,
+                                    lub_argv__get_arg(largv,i),
+                                    lub_argv__get_length(largv,i));
     }
-    while( (cmd = lub_bintree_findnext(&this->tree,name)) )
+    /* the completions are those children which start with the partial word */
+    start = node ? clish_view_trie_bound(node,partial,BOOL_FALSE) : 0;
+
+    if(node && (NULL != cmd))
     {
+        int diff;
+
         name = clish_command__get_name(cmd);
-        if(words == lub_argv_wordcount(name))
+        diff = clish_view_nocasencmp(name,line,offset);
+
+        if(diff > 0)
+        {
+            /* the last completion lies beyond this part of the trie */
+            node = NULL;
+        }
+        else if(0 == diff)
         {
-            /* only bother with commands of which this line is a prefix */
-            if(lub_string_nocasestr(name,line) == name)
-            {
-                /* this is a completion */
-                break;
-            }
+            /* skip past the last completion */
+            i = clish_view_trie_bound(node,&name[offset],BOOL_TRUE);
+            start = (i > start) ? i : start;
         }
     }
+    cmd = NULL;
+    for(i = start;
+        node && (i < node->childc);
+        i++)
+    {
+        const clish_view_trie_t *child = node->childv[i];
+
+        if(0 != clish_view_nocasencmp(child->word,partial,strlen(partial)))
+        {
+            /* we've moved beyond the possible completions */
+            break;
+        }
+        if(NULL == child->cmd)
+        {
+            /* just an intermediate word */
+            continue;
+        }
+        if(access_fn && (BOOL_FALSE == access_fn(child->cmd,arg)))
+        {
+            /* not available here */
+            continue;
+        }
+        name = clish_command__get_name(child->cmd);
+
+        /* only bother with commands of which this line is a prefix */
+        if(lub_string_nocasestr(name,line) == name)
+        {
+            /* this is a completion */
+            cmd = child->cmd;
+            break;
+        }
+    }
+    return cmd;
+}
+/*--------------------------------------------------------- */
+const clish_command_t *
+clish_view_find_next_completion(clish_view_t          *this,
+                                const clish_command_t *cmd,
+                                const char            *line)
+{
+    /* build an argument vector for the line */
+    lub_argv_t *largv = lub_argv_new(line,0);
+
+    cmd = clish_view_find_next_completion_argv(this,cmd,line,largv,NULL,NULL);
+
     /* clean up the dynamic memory */
     lub_argv_delete(largv);
     return cmd;
@@ -270,12 +425,24 @@ clish_view__set_prompt(clish_view_t *this,
 {
     assert(NULL == this->prompt);
     this->prompt = lub_string_dup(prompt);
+
+    /* parse any variables once rather than at each prompt */
+    this->prompt_template = clish_variable_template_new(prompt);
+}
+/*--------------------------------------------------------- */
+const char *
+clish_view__get_unexpanded_prompt(const clish_view_t *this)
+{
+    return this->prompt;
 }
 /*--------------------------------------------------------- */
 char *
-clish_view__get_prompt(const clish_view_t *this,
-                       const char         *viewid)
+clish_view__get_prompt(const clish_view_t            *this,
+                       const clish_variable_viewid_t *viewid)
 {
-    return clish_variable_expand(this->prompt,viewid,NULL,NULL);
+    return clish_variable_template_expand(this->prompt_template,
+                                          viewid,
+                                          NULL,
+                                          NULL);
 }
 /*--------------------------------------------------------- */
@@ -0,0 +1,213 @@
+/*
+ * view_trie.c
+ *
+ * This file provides the word level trie of command names which a view
+ * uses to resolve and complete command lines. Each level of the trie
+ * holds its children in case insensitive order, which is the same order
+ * in which the binary tree of commands holds full command names.
+ */
+#include "private.h"
+#include "clish/command.h"
+#include "lub/argv.h"
+#include "lub/string.h"
+#include "lub/ctype.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------------------------------------
+ * PRIVATE META FUNCTIONS
+ *--------------------------------------------------------- */
+/*
+ * Case insensitive comparison of a NUL terminated word with
+ * a length delimited key.
+ */
+static int
+clish_view_trie_compare(const char *word,
+                        const char *key,
+                        size_t      length)
+{
+    int result = 0;
+
+    while((0 == result) && *word && length)
+    {
+        result = lub_ctype_tolower(*word++) - lub_ctype_tolower(*key++);
+        length--;
+    }
+    if(0 == result)
+    {
+        /* account for different string lengths */
+        result = *word - (length ? *key : '\0');
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+static clish_view_trie_t *
+clish_view_trie_new(const char *word)
+{
+    clish_view_trie_t *this = malloc(sizeof(clish_view_trie_t));
+
+    if(this)
+    {
+        clish_view_trie_init(this,word);
+    }
+    return this;
+}
+/*--------------------------------------------------------- */
+static void
+clish_view_trie_delete(clish_view_trie_t *this)
+{
+    clish_view_trie_fini(this);
+    free(this);
+}
+/*--------------------------------------------------------- */
+/*
+ * Find the child for the specified word, creating it if necessary
+ */
+static clish_view_trie_t *
+clish_view_trie_child(clish_view_trie_t *this,
+                      const char        *word)
+{
+    unsigned            i = clish_view_trie_bound(this,word,BOOL_FALSE);
+    clish_view_trie_t  *child;
+    clish_view_trie_t **tmp;
+
+    if((i < this->childc) &&
+       (0 == lub_string_nocasecmp(this->childv[i]->word,word)))
+    {
+        /* already present */
+        return this->childv[i];
+    }
+    child = clish_view_trie_new(word);
+    if(NULL == child)
+    {
+        return NULL;
+    }
+    /* resize the child vector */
+    tmp = realloc(this->childv,(this->childc+1) * sizeof(clish_view_trie_t*));
+    if(NULL == tmp)
+    {
+        clish_view_trie_delete(child);
+        return NULL;
+    }
+    this->childv = tmp;
+
+    /* keep the children in order */
+    memmove(&this->childv[i+1],
+            &this->childv[i],
+            (this->childc - i) * sizeof(clish_view_trie_t*));
+    this->childv[i] = child;
+    this->childc++;
+
+    return child;
+}
+/*---------------------------------------------------------
+ * PRIVATE METHODS
+ *--------------------------------------------------------- */
+void
+clish_view_trie_init(clish_view_trie_t *this,
+                     const char        *word)
+{
+    this->word   = lub_string_dup(word);
+    this->cmd    = NULL;
+    this->childc = 0;
+    this->childv = NULL;
+}
+/*--------------------------------------------------------- */
+void
+clish_view_trie_fini(clish_view_trie_t *this)
+{
+    unsigned i;
+
+    /* the commands themselves are owned by the binary tree */
+    for(i = 0;
+        i < this->childc;
+        i++)
+    {
+        clish_view_trie_delete(this->childv[i]);
+    }
+    free(this->childv);
+    this->childv = NULL;
+    this->childc = 0;
+    this->cmd    = NULL;
+    lub_string_free(this->word);
+    this->word = NULL;
+}
+/*--------------------------------------------------------- */
+void
+clish_view_trie_insert(clish_view_trie_t *this,
+                       clish_command_t   *cmd)
+{
+    lub_argv_t *argv = lub_argv_new(clish_command__get_name(cmd),0);
+    unsigned    i;
+
+    for(i = 0;
+        this && (i < lub_argv__get_count(argv));
+        i++)
+    {
+        this = clish_view_trie_child(this,lub_argv__get_arg(argv,i));
+    }
+    if(this && i)
+    {
+        this->cmd = cmd;
+    }
+    lub_argv_delete(argv);
+}
+/*--------------------------------------------------------- */
+clish_view_trie_t *
+clish_view_trie_find(const clish_view_trie_t *this,
+                     const char              *word,
+                     size_t                   length)
+{
+    unsigned lo = 0,hi = this->childc;
+
+    while(lo < hi)
+    {
+        unsigned mid    = (lo + hi) / 2;
+        int      result = clish_view_trie_compare(this->childv[mid]->word,
+                                                  word,
+                                                  length);
+        if(0 == result)
+        {
+            return this->childv[mid];
+        }
+        if(result < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+/*--------------------------------------------------------- */
+/*
+ * Returns the index of the first child which is not less than
+ * (or when 'upper' is set, greater than) the specified word.
+ */
+unsigned
+clish_view_trie_bound(const clish_view_trie_t *this,
+                      const char              *word,
+                      bool_t                   upper)
+{
+    unsigned lo = 0,hi = this->childc;
+
+    while(lo < hi)
+    {
+        unsigned mid    = (lo + hi) / 2;
+        int      result = lub_string_nocasecmp(this->childv[mid]->word,word);
+
+        if((result < 0) || (upper && (0 == result)))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+/*--------------------------------------------------------- */
@@ -70,6 +70,9 @@ unsigned
  * \post
  * - The client becomes resposible for releasing the instance when they are
  *   finished with it, by calling lub_argv_delete()
+ * - The line is scanned only once and the words are held in a single 
+ *   allocation along with the vector itself, so an instance may cheaply
+ *   be shared by all the clients interested in a given line.
  */
 lub_argv_t *
     lub_argv_new(
@@ -93,6 +96,9 @@ const char *
 size_t
     lub_argv__get_offset(const lub_argv_t *instance,
                          unsigned          index);
+size_t
+    lub_argv__get_length(const lub_argv_t *instance,
+                         unsigned          index);
 bool_t
     lub_argv__get_quoted(const lub_argv_t *instance,
                          unsigned          index);
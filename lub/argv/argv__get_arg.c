@@ -12,7 +12,7 @@ lub_argv__get_arg(const lub_argv_t *this,
 
     if(this->argc > index)
     {
-        result = this->argv[index].arg;
+        result = &this->text[this->argv[index].start];
     }
     return result;
 }
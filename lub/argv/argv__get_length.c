@@ -0,0 +1,19 @@
+/*
+ * argv__get_length.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+size_t
+lub_argv__get_length(const lub_argv_t *this,
+                     unsigned          index)
+{
+    size_t result = 0;
+
+    if(this->argc > index)
+    {
+        result = this->argv[index].len;
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
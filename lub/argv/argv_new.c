@@ -2,64 +2,116 @@
  * argv_new.c
  */
 #include "private.h"
-#include "lub/string.h"
 
 #include <stdlib.h>
-/*--------------------------------------------------------- */
-static void
-lub_argv_init(lub_argv_t *this,
-              const char *line,
-              size_t      offset)
-{
-    size_t      len;
-    const char *word;
-    lub_arg_t  *arg;
-    bool_t      quoted;
+#include <string.h>
 
-    /* first of all count the words in the line */
-    this->argc = lub_argv_wordcount(line);
+/* the number of words which can be collected without a dynamic vector */
+#define LUB_ARGV_STATIC_WORDS 16
 
-    /* allocate space to hold the vector */
-    arg = this->argv = malloc(sizeof(lub_arg_t) * this->argc);
+/*
+ * A word found by the tokenizer, before it is copied into the vector
+ */
+typedef struct
+{
+    const char *word;
+    lub_arg_t   arg;
+} lub_argv_word_t;
+/*--------------------------------------------------------- */
+/*
+ * Split the line into words in a single pass, returning the number of
+ * words found. The words are collected in the specified vector until
+ * it is full, after which a dynamic vector is used.
+ */
+static unsigned
+lub_argv_split(const char       *line,
+               size_t            offset,
+               lub_argv_word_t **words,
+               size_t           *textlen)
+{
+    lub_argv_word_t *vector = *words;
+    unsigned         size   = LUB_ARGV_STATIC_WORDS;
+    unsigned         count  = 0;
+    size_t           len;
+    const char      *word;
+    bool_t           quoted;
 
-    if(arg)
+    *textlen = 0;
+    for(word = lub_argv_nextword(line,&len,&offset,&quoted);
+        *word;
+        word = lub_argv_nextword(word+len,&len,&offset,&quoted))
     {
-        /* then fill out the array with the words */
-        for(word = lub_argv_nextword(line,&len,&offset,&quoted);
-            *word;
-            word = lub_argv_nextword(word+len,&len,&offset,&quoted))
+        if(count == size)
         {
-            (*arg).arg    = lub_string_dupn(word,len);
-            (*arg).offset = offset;
-            (*arg).quoted = quoted;
-
-            offset += len;
-
-            if(BOOL_TRUE == quoted)
+            /* double the size of the vector */
+            lub_argv_word_t *tmp = malloc(2 * size * sizeof(lub_argv_word_t));
+            if(NULL == tmp)
+            {
+                break;
+            }
+            memcpy(tmp,vector,count * sizeof(lub_argv_word_t));
+            if(vector != *words)
             {
-                len    += 1; /* account for terminating quotation mark */
-                offset += 2; /* account for quotation marks */
+                free(vector);
             }
-            arg++;
+            vector = tmp;
+            size  *= 2;
+        }
+        vector[count].word       = word;
+        vector[count].arg.start  = *textlen;
+        vector[count].arg.len    = len;
+        vector[count].arg.offset = offset;
+        vector[count].arg.quoted = quoted;
+        count++;
+
+        /* account for the '\0' */
+        *textlen += len + 1;
+        offset   += len;
+
+        if(BOOL_TRUE == quoted)
+        {
+            len    += 1; /* account for terminating quotation mark */
+            offset += 2; /* account for quotation marks */
         }
     }
-    else
-    {
-        /* failed to get memory so don't pretend otherwise */
-        this->argc = 0;
-    }
+    *words = vector;
+
+    return count;
 }
 /*--------------------------------------------------------- */
 lub_argv_t *
 lub_argv_new(const char *line,
              size_t      offset)
 {
-    lub_argv_t *this;
-    
-    this = malloc(sizeof(lub_argv_t));
+    lub_argv_t      *this;
+    lub_argv_word_t  buffer[LUB_ARGV_STATIC_WORDS];
+    lub_argv_word_t *words = buffer;
+    size_t           textlen;
+    unsigned         argc,i;
+
+    argc = lub_argv_split(line,offset,&words,&textlen);
+
+    /* the instance, the spans and the text share a single allocation */
+    this = malloc(sizeof(lub_argv_t) + argc * sizeof(lub_arg_t) + textlen);
     if(NULL != this)
     {
-        lub_argv_init(this,line,offset);
+        this->argc = argc;
+        this->argv = (lub_arg_t*)&this[1];
+        this->text = (char*)&this->argv[argc];
+        for(i = 0;
+            i < argc;
+            i++)
+        {
+            lub_arg_t *arg = &this->argv[i];
+
+            *arg = words[i].arg;
+            memcpy(&this->text[arg->start],words[i].word,arg->len);
+            this->text[arg->start + arg->len] = '\0';
+        }
+    }
+    if(words != buffer)
+    {
+        free(words);
     }
     return this;
 }
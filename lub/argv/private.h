@@ -6,11 +6,17 @@
  */
 #include "lub/argv.h"
 
+/*
+ * Each argument is a span of the text held by the vector; the words
+ * are stored one after another (each '\0' terminated) in a single
+ * buffer which immediately follows the spans.
+ */
 typedef struct lub_arg_s lub_arg_t;
 struct lub_arg_s
 {
-    char   *arg;
-    size_t  offset;
+    size_t  start;  /* start of the word in the text */
+    size_t  len;    /* length of the word */
+    size_t  offset; /* offset of the word in the original line */
     bool_t  quoted;
 };
 
@@ -18,6 +24,7 @@ struct lub_argv_s
 {
     unsigned   argc;
     lub_arg_t *argv;
+    char      *text;
 };
 /*-------------------------------------
  * PRIVATE META FUNCTIONS
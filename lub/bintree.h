@@ -145,7 +145,7 @@ typedef int
  * If any client requires a greater storage size then this will need to
  * be increased.
  */
-#define lub_bintree_MAX_KEY_STORAGE (200)
+#define lub_bintree_MAX_KEY_STORAGE (256)
 /**
  * This is used to declare an opaque key structure
  * Typically a client would declare their own non-opaque structure
@@ -408,6 +408,49 @@ extern void *
                 const void    *key
 	);
 
+/**
+ * This operation returns the first "clientnode" present in the specified
+ * "tree". Unlike lub_bintree_findfirst() the tree is not rearranged, so
+ * any number of threads may do this at once to a tree which none of them
+ * modifies.
+ *
+ * \pre The tree must be initialised
+ *
+ * \return
+ * "clientnode" instance or NULL if no nodes are present in this tree.
+ */
+extern void *
+	lub_bintree_peekfirst(
+		/** 
+		 * the "tree" instance to invoke this operation upon
+		 */
+		const lub_bintree_t *tree
+	);
+
+/**
+ * This operation searches the specified "tree" for a "clientnode" which is
+ * the one which logically follows the specified "key". Unlike 
+ * lub_bintree_findnext() the tree is not rearranged.
+ *
+ * A "clientnode" with the specified "key" doesn't need to be in the tree.
+ *
+ * \pre The tree must be initialised
+ *
+ * \return
+ * "clientnode" instance or NULL if no node is found.
+ */
+extern void *
+	lub_bintree_peeknext(
+		/** 
+		 * the "tree" instance to invoke this operation upon
+		 */
+		const lub_bintree_t *tree,
+		/** 
+		  * the "key" to search with
+		  */
+        	const void          *key
+	);
+
 /*****************************************
  * ITERATION OPERATIONS
  ***************************************** */
@@ -0,0 +1,23 @@
+/*
+ * bintree_peekfirst.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void *
+lub_bintree_peekfirst(const lub_bintree_t *this)
+{
+    lub_bintree_node_t *t = this->root;
+
+    if(NULL == t)
+    {
+        return NULL;
+    }
+    /* the left most node, leaving the tree as it is */
+    while(NULL != t->left)
+    {
+        t = t->left;
+    }
+    return lub_bintree_getclientnode(this,t);
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,30 @@
+/*
+ * bintree_peeknext.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void *
+lub_bintree_peeknext(const lub_bintree_t *this,
+                     const void          *clientkey)
+{
+    lub_bintree_node_t *t      = this->root;
+    lub_bintree_node_t *result = NULL;
+
+    /* descend the tree, leaving it as it is */
+    while(NULL != t)
+    {
+        if(lub_bintree_compare(this,t,clientkey) > 0)
+        {
+            /* this follows the key but there may be a closer node */
+            result = t;
+            t      = t->left;
+        }
+        else
+        {
+            t      = t->right;
+        }
+    }
+    return result ? lub_bintree_getclientnode(this,result) : NULL;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,192 @@
+/**
+\ingroup lub
+\defgroup lub_hash hash
+ @{
+
+\brief This interface provides a facility which enables a client to 
+ find a set of arbitary data by name.
+ 
+ Each "clientnode" is known by a string "key" which the client holds
+ within the "clientnode" itself. The key is not copied; the index simply
+ refers to the client's own string, so it must remain unchanged for as
+ long as the "clientnode" is held by the index.
+
+ Unlike the lub_bintree the index holds no order between the
+ "clientnodes" but looking one up never modifies the index, so a
+ populated index may be searched by any number of threads at once.
+
+\par Implementation
+The implementation of this interface uses open addressing with linear
+probing. The hash value of each key is held alongside each entry so
+that the keys themselves are only compared when the hash values match.
+The table is kept no more than half full, doubling in size as needed,
+and removals shift later entries back rather than leaving markers.
+ */
+#ifndef _lub_hash_h
+#define _lub_hash_h
+#include <stddef.h>
+
+#include "lub/c_decl.h"
+#include "lub/types.h"
+
+_BEGIN_C_DECL
+
+/****************************************************************
+ * TYPE DEFINITIONS
+ **************************************************************** */
+/**
+ * This type defines a callback function which will return the key
+ * of a client's "node".
+ * 
+ * \param clientnode 	the node from which to derive a key
+ * 
+ * \return
+ * The string by which the "clientnode" is known
+ */
+typedef const char *
+		lub_hash_getkey_fn(const void *clientnode);
+/**
+ * This type represents an entry within the index
+ */
+typedef struct lub_hash_entry_s lub_hash_entry_t;
+/** 
+ * CLIENTS MUSTN'T TOUCH THE CONTENTS OF THIS STRUCTURE
+ */
+struct lub_hash_entry_s
+{
+	/** internal */unsigned long hash;
+	/** internal */void         *clientnode;
+};
+/**
+ * This type represents a hash index instance
+ */
+typedef struct lub_hash_s lub_hash_t;
+/** 
+ * CLIENTS MUSTN'T TOUCH THE CONTENTS OF THIS STRUCTURE
+ */
+struct lub_hash_s
+{
+	/** internal */lub_hash_entry_t   *table;
+	/** internal */size_t              size;
+	/** internal */size_t              count;
+	/** internal */lub_hash_getkey_fn *getkeyFn;
+	/** internal */bool_t              nocase;
+};
+/****************************************************************
+ * HASH OPERATIONS
+ **************************************************************** */
+/**
+ * This operation initialises an instance of a hash index.
+ *
+ * \pre none
+ *
+ * \post The index is ready to have client nodes inserted.
+ */
+extern void
+	lub_hash_init(
+		/** 
+		* the "hash" instance to initialise 
+		*/
+		lub_hash_t         *hash,
+		/**
+		* a function which will return the key of a clientnode
+		*/
+		lub_hash_getkey_fn  getkeyFn,
+		/**
+		* BOOL_TRUE if keys are to be compared without regard to case
+		*/
+		bool_t              nocase
+	);
+/**
+ * This operation releases the resources held by an index.
+ *
+ * \pre The index must be initialised
+ *
+ * \post The index no longer refers to any "clientnode", the client
+ * remains responsible for the "clientnodes" themselves.
+ */
+extern void
+	lub_hash_fini(
+		/** 
+		* the "hash" instance to finalise
+		*/
+		lub_hash_t *hash
+	);
+/**
+ * This operation adds a client node to the specified index.
+ *
+ * \pre The index must be initialised
+ * 
+ * \return
+ * 0 if the "clientnode" is added correctly to the index.
+ * If another "clientnode" already exists in the index with the same key, or
+ * there is insufficient resource to add it, then -1 is returned, and the
+ * index remains unchanged.
+ */
+extern int
+	lub_hash_insert(
+		/**
+		 * the "hash" instance to invoke this operation upon
+		 */ 
+		lub_hash_t *hash,
+		/** 
+		 * a pointer to a client node
+		 */
+		void       *clientnode
+	);
+/**
+ * This operation removes a "clientnode" from the specified index
+ *
+ * \pre The index must be initialised
+ *
+ * \post The "clientnode" will no longer be part of the specified index.
+ */
+extern void
+	lub_hash_remove(
+		/**
+		 * the "hash" instance to invoke this operation upon
+		 */ 
+		lub_hash_t *hash,
+		/** 
+		 * a pointer to a client node
+		 */
+		void       *clientnode
+	);
+/**
+ * This operation searches the specified index for a "clientnode" with
+ * the specified key.
+ *
+ * \pre The index must be initialised
+ *
+ * \return
+ * A pointer to the "clientnode" which matches the key, or NULL if there is
+ * no such "clientnode".
+ *
+ * \post The index is not modified.
+ */
+extern void *
+	lub_hash_find(
+		/**
+		 * the "hash" instance to invoke this operation upon
+		 */ 
+		const lub_hash_t *hash,
+		/** 
+		 * the key to search for
+		 */
+		const char       *key
+	);
+/**
+ * This operation returns the number of "clientnodes" in the index.
+ */
+extern size_t
+	lub_hash__get_count(
+		/**
+		 * the "hash" instance to invoke this operation upon
+		 */ 
+		const lub_hash_t *hash
+	);
+
+_END_C_DECL
+
+#endif /* _lub_hash_h */
+/** @} */
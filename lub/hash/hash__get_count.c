@@ -0,0 +1,12 @@
+/*
+ * hash__get_count.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+size_t
+lub_hash__get_count(const lub_hash_t *this)
+{
+    return this->count;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,19 @@
+/*
+ * hash_find.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void *
+lub_hash_find(const lub_hash_t *this,
+              const char       *key)
+{
+    if(0 == this->count)
+    {
+        return NULL;
+    }
+    return this->table[lub_hash_probe(this,
+                                      lub_hash_string(this,key),
+                                      key)].clientnode;
+}
+/*--------------------------------------------------------- */
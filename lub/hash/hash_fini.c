@@ -0,0 +1,17 @@
+/*
+ * hash_fini.c
+ */
+#include "private.h"
+
+#include <stdlib.h>
+
+/*--------------------------------------------------------- */
+void
+lub_hash_fini(lub_hash_t *this)
+{
+    free(this->table);
+    this->table = NULL;
+    this->size  = 0;
+    this->count = 0;
+}
+/*--------------------------------------------------------- */
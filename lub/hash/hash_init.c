@@ -0,0 +1,18 @@
+/*
+ * hash_init.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void
+lub_hash_init(lub_hash_t         *this,
+              lub_hash_getkey_fn  getkeyFn,
+              bool_t              nocase)
+{
+    this->table    = NULL;
+    this->size     = 0;
+    this->count    = 0;
+    this->getkeyFn = getkeyFn;
+    this->nocase   = nocase;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,77 @@
+/*
+ * hash_insert.c
+ */
+#include "private.h"
+
+#include <stdlib.h>
+
+/* the size of the table when the first node is inserted */
+#define LUB_HASH_MIN_SIZE 16
+
+/*--------------------------------------------------------- */
+/*
+ * Double the size of the table, placing each entry afresh
+ */
+static int
+lub_hash_grow(lub_hash_t *this)
+{
+    lub_hash_entry_t *old  = this->table;
+    size_t            size = this->size;
+    size_t            i;
+
+    this->size  = size ? (size * 2) : LUB_HASH_MIN_SIZE;
+    this->table = calloc(this->size,sizeof(lub_hash_entry_t));
+    if(NULL == this->table)
+    {
+        /* leave things as they were */
+        this->table = old;
+        this->size  = size;
+        return -1;
+    }
+    for(i = 0;
+        i < size;
+        i++)
+    {
+        if(NULL != old[i].clientnode)
+        {
+            size_t j = old[i].hash & (this->size - 1);
+
+            while(NULL != this->table[j].clientnode)
+            {
+                j = (j + 1) & (this->size - 1);
+            }
+            this->table[j] = old[i];
+        }
+    }
+    free(old);
+
+    return 0;
+}
+/*--------------------------------------------------------- */
+int
+lub_hash_insert(lub_hash_t *this,
+                void       *clientnode)
+{
+    const char    *key = this->getkeyFn(clientnode);
+    unsigned long  value;
+    size_t         i;
+
+    /* keep the table no more than half full */
+    if((2 * (this->count + 1) > this->size) && (-1 == lub_hash_grow(this)))
+    {
+        return -1;
+    }
+    value = lub_hash_string(this,key);
+    i     = lub_hash_probe(this,value,key);
+    if(NULL != this->table[i].clientnode)
+    {
+        /* this key is already present */
+        return -1;
+    }
+    this->table[i].hash       = value;
+    this->table[i].clientnode = clientnode;
+    this->count++;
+
+    return 0;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,38 @@
+/*
+ * hash_probe.c
+ */
+#include "private.h"
+#include "lub/string.h"
+
+#include <string.h>
+
+/*--------------------------------------------------------- */
+size_t
+lub_hash_probe(const lub_hash_t *this,
+               unsigned long     value,
+               const char       *key)
+{
+    size_t mask = this->size - 1;
+    size_t i    = value & mask;
+
+    /* the table is never full so this will find an empty entry */
+    while(NULL != this->table[i].clientnode)
+    {
+        const lub_hash_entry_t *entry = &this->table[i];
+
+        if(entry->hash == value)
+        {
+            const char *name = this->getkeyFn(entry->clientnode);
+            int         diff = this->nocase 
+                             ? lub_string_nocasecmp(name,key)
+                             : strcmp(name,key);
+            if(0 == diff)
+            {
+                break;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+/*--------------------------------------------------------- */
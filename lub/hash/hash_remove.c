@@ -0,0 +1,49 @@
+/*
+ * hash_remove.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void
+lub_hash_remove(lub_hash_t *this,
+                void       *clientnode)
+{
+    const char *key;
+    size_t      mask,i,j;
+
+    if(0 == this->count)
+    {
+        return;
+    }
+    key  = this->getkeyFn(clientnode);
+    mask = this->size - 1;
+    i    = lub_hash_probe(this,lub_hash_string(this,key),key);
+    if(clientnode != this->table[i].clientnode)
+    {
+        /* not held by this index */
+        return;
+    }
+    this->table[i].clientnode = NULL;
+    this->count--;
+
+    /* 
+     * shift back any following entries which would no longer be 
+     * reachable across the gap
+     */
+    for(j = (i + 1) & mask;
+        NULL != this->table[j].clientnode;
+        j = (j + 1) & mask)
+    {
+        size_t home = this->table[j].hash & mask;
+
+        /* is the home of this entry cyclically outside (i,j]? */
+        if((i <= j) ? ((home <= i) || (home > j)) 
+                    : ((home <= i) && (home > j)))
+        {
+            this->table[i]            = this->table[j];
+            this->table[j].clientnode = NULL;
+            i = j;
+        }
+    }
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,38 @@
+/*
+ * hash_string.c
+ *
+ * This uses the FNV-1a hash function, which is simple and spreads
+ * short similar strings (such as command names) well.
+ */
+#include "private.h"
+#include "lub/ctype.h"
+
+#define LUB_HASH_FNV_OFFSET 2166136261UL
+#define LUB_HASH_FNV_PRIME  16777619UL
+
+/*--------------------------------------------------------- */
+unsigned long
+lub_hash_string(const lub_hash_t *this,
+                const char       *key)
+{
+    unsigned long result = LUB_HASH_FNV_OFFSET;
+
+    if(BOOL_TRUE == this->nocase)
+    {
+        while(*key)
+        {
+            result ^= (unsigned char)lub_ctype_tolower(*key++);
+            result  = (result * LUB_HASH_FNV_PRIME) & 0xffffffffUL;
+        }
+    }
+    else
+    {
+        while(*key)
+        {
+            result ^= (unsigned char)*key++;
+            result  = (result * LUB_HASH_FNV_PRIME) & 0xffffffffUL;
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,31 @@
+/*
+ * private.h
+ */
+#include "lub/hash.h"
+
+/*************************************************************
+ * PRIVATE OPERATIONS
+ ************************************************************* */
+/*------------------------------------------------------------ */
+/* This operation returns the hash value of a key
+ *
+ * hash - the index to invoke this operation upon
+ * key  - the key to hash
+ */
+extern unsigned long
+		lub_hash_string(const lub_hash_t *hash,
+		                const char       *key);
+/*------------------------------------------------------------ */
+/* This operation returns the position within the table at which
+ * an entry with the specified key is held, or the empty position 
+ * at which it would be held.
+ *
+ * hash  - the index to invoke this operation upon
+ * value - the hash value of the key
+ * key   - the key to look for
+ */
+extern size_t
+		lub_hash_probe(const lub_hash_t *hash,
+		               unsigned long     value,
+		               const char       *key);
+/*------------------------------------------------------------ */
@@ -85,6 +85,19 @@ Currently the following utility functions are available:
                           With no specified framecount the maximum will be assumed.
 
 - leakDisable             - Disabled the leak detection.
+
+- leakSample [bytes]      - only monitors a sample of the allocations; on 
+                          average one allocation is recorded for each 
+                          'bytes' allocated, the threshold being drawn at 
+                          random so that any allocation may be chosen. 
+                          Larger blocks are more likely to be sampled.
+                          The leak reports are then scaled up to give 
+                          estimated totals. This makes the cost of leak 
+                          detection low enough to leave it switched on.
+                          A block which is resized keeps the decision 
+                          made when it was first allocated.
+                          A value of zero monitors every allocation, 
+                          which is the default.
     
 \section implementation Implementation
 Static and dynamic blocks are allocated from opposite ends of a memory
@@ -101,6 +114,12 @@ This minimises fragmentation of the dynamically allocated memory.
 The free blocks are held in a binary tree (using \ref lub_bintree) which provide
 fast searching for the appropriate block.
 
+Alternatively a heap can be created with its free blocks held in
+two level segregated lists; one list per size range, with a bitmap of
+the non-empty lists. This finds a "good fit" in constant time, without
+the tree having to be rebalanced for every allocation and release, at
+the cost of some extra memory for the lists. 
+
 \author  Graeme McKerrell
 \date    Created On      : Wed Dec 14 10:20:00 2005
 \version UNTESTED
@@ -123,6 +142,31 @@ typedef struct lub_heap_s lub_heap_t;
  */
 typedef struct lub_heap_free_block_s lub_heap_free_block_t;
 
+/**
+ * This type defines the statistics available for each size class of 
+ * a heap's cache.
+ */
+typedef struct lub_heap_cache_class_stats_s lub_heap_cache_class_stats_t;
+struct lub_heap_cache_class_stats_s
+{
+    /**
+     * Number of bytes available to the client in each block of this class
+     */
+    size_t block_size;
+    /**
+     * Number of blocks currently held by this class
+     */
+    size_t num_blocks;
+    /**
+     * Number of allocations satisfied by this class
+     */
+    size_t hits;
+    /**
+     * Number of allocations which this class was unable to satisfy
+     */
+    size_t misses;
+};
+
 /**
  * This type defines the statistics available for each heap.
  */
@@ -230,6 +274,17 @@ struct lub_heap_stats_s
      */
     size_t static_overhead;
     /*----------------------------------------------------- */
+    /**
+     * Number of size classes in the cache, zero if there is no cache.
+     */
+    size_t cache_classes;
+    /**
+     * Number of allocations too large for any size class in the cache.
+     * The details for each size class are given by 
+     * lub_heap_foreach_cache_class().
+     */
+    size_t cache_misses;
+    /*----------------------------------------------------- */
 };
 /**
  * This type is used to indicate the result of a dynamic
@@ -401,6 +456,22 @@ typedef enum
     LUB_HEAP_SHOW_ALL
 } lub_heap_show_e;
 
+/**
+ * This type defines how the free blocks of a heap are indexed
+ */
+typedef enum
+{
+    /**
+     * A binary tree, ordered by size, giving a best fit.
+     */
+    LUB_HEAP_INDEX_TREE,
+    /**
+     * Two level segregated lists, giving a good fit in constant time.
+     * The lists are taken from the end of the first memory segment.
+     */
+    LUB_HEAP_INDEX_TLSF
+} lub_heap_index_e;
+
 /**
  * This type defines a function prototype to be used to 
  * iterate around each of a number of things in the system.
@@ -515,6 +586,38 @@ lub_heap_t *
          */
         size_t size
     );
+/**
+  * This operation creates a dynamic heap from the provided
+  * memory segment, using the specified index for its free blocks.
+  * lub_heap_create() is equivalent to using LUB_HEAP_INDEX_TREE.
+  *
+  * \pre
+  * - none
+  *
+  * \return
+  * - a reference to a heap object which can be used to allocate
+  *   memory from the segments associated with this heap.
+  * - NULL if the segment is too small.
+  *
+  * \post
+  * - memory allocations can be invoked on the returned intance.
+  */
+lub_heap_t *
+    lub_heap_create_indexed(
+        /**
+         * The begining of the first memory segment to associate with 
+         * this heap
+         */
+        void *start,
+        /**
+         * The number of bytes available for use in the first segment.
+         */
+        size_t size,
+        /**
+         * The type of index to use for the free blocks
+         */
+        lub_heap_index_e index
+    );
 /**
   * This operation creates a dynamic heap from the provided
   * memory segment.
@@ -571,7 +674,34 @@ void
         size_t size
     );
 /**
- * This operation allocates some "static" memory from a heap. This is 
+ * This operation takes back a segment, previously given by
+ * lub_heap_add_segment(), which no longer holds any allocated memory.
+ * The initial memory segment is never taken back.
+ *
+ * \pre
+ * - The heap needs to have been create with an initial memory segment.
+ *
+ * \return
+ * - the beginning of the segment which has been removed, or
+ * - NULL if no segment is entirely free, or a leak scan is under way.
+ *
+ * \post
+ * - The heap no longer uses the memory of the returned segment, which
+ *   may be handed back to the system.
+ */
+void *
+    lub_heap_remove_free_segment(
+        /**
+         * The heap instance on which to operate
+         */
+        lub_heap_t *instance,
+        /**
+         * This is filled out with the number of bytes in the segment
+         */
+        size_t *size
+    );
+/**
+ * This operation allocates some "static" memory from a heap. This is
  * memory which will remain allocted for the lifetime of the heap instance.
  * "static" memory allocation has zero overhead and causes zero fragmentation.
  *
@@ -644,6 +774,37 @@ lub_heap_status_t
          */
         lub_heap_align_t alignment
     );
+/**
+ * This operation is lub_heap_realloc() for allocators built on top of
+ * a heap, which know the site of the allocation they are making; see
+ * lub_heap_site_caller().
+ */
+lub_heap_status_t
+    lub_heap_realloc_by_site(
+        /**
+         * The heap instance on which to operate
+         */
+        lub_heap_t *instance,
+        /**
+         * Reference to a pointer containing previously allocated memory 
+         * or NULL.
+         */
+        char **ptr,
+        /**
+         * The number of bytes required for the object 
+         */
+        size_t size,
+        /**
+         * The alignement required for a new allocations.
+         */
+        lub_heap_align_t alignment,
+        /**
+         * The site to count any new allocation against, or NULL if
+         * the allocator will count it for itself with
+         * lub_heap_site_charge().
+         */
+        const void *caller
+    );
 /**
  * This operation controls the tainted memory facility.
  * This means that during certain heap operations memory can
@@ -801,6 +962,37 @@ void
         lub_heap_stats_t *stats
     );
 
+/**
+ * This type defines a function to be called with the details of each
+ * size class in a heap's cache.
+ */
+typedef void
+    lub_heap_foreach_cache_class_fn(const lub_heap_cache_class_stats_t *stats,
+                                    void                               *arg);
+/**
+ * This operation calls the specified function with the details of each
+ * size class in the cache of the specified heap, from the smallest to
+ * the largest. Nothing is allocated from any heap whilst doing so.
+ *
+ * \post
+ * - the function will not have been called if the heap has no cache.
+ */
+void
+    lub_heap_foreach_cache_class(
+        /**
+         * The instance on which to operate
+         */
+        lub_heap_t *instance,
+        /**
+         * The client provided function to call for each size class
+         */
+        lub_heap_foreach_cache_class_fn *fn,
+        /**
+         * Some client specific data to pass through to the callback
+         * function.
+         */
+        void *arg
+    );
 /**
  * This operation dumps the salient details of the specified heap to stdout
  */
@@ -815,6 +1007,27 @@ void
          */
         bool_t verbose
     );
+/**
+ * This operation writes the statistics of the specified heap to a file
+ * descriptor as a single line of JSON, including the details for each
+ * size class in the cache. Nothing is allocated from any heap whilst
+ * doing so.
+ *
+ * \return
+ * - BOOL_TRUE if the details were written.
+ * - BOOL_FALSE if the file descriptor could not be written to.
+ */
+bool_t
+    lub_heap_export(
+        /**
+         * The instance on which to operate
+         */
+        lub_heap_t *instance,
+        /**
+         * The file descriptor to write to
+         */
+        int fd
+    );
 /**
  * This method provides the size, in bytes, of the largest allocation
  * which can be performed.
@@ -851,6 +1064,37 @@ extern size_t
  */
 extern void
     lub_heap_leak_scan(void);
+/**
+ * This function starts a leak scan which is then carried out a piece
+ * at a time by lub_heap_leak_scan_step(). In between the steps other
+ * tasks are free to allocate and release memory; anything allocated
+ * once the scan has started is taken to be referenced.
+ *
+ * The stacks, BSS and DATA are looked at again at the end of the scan,
+ * along with any segments added while it was under way. 
+ *
+ * NB. a reference which is moved from a block yet to be scanned into
+ * a block which has already been scanned, while the scan is under way,
+ * can still make a block appear leaked. A further scan will clear this.
+ */
+extern void
+    lub_heap_leak_scan_start(void);
+/**
+ * This function carries out the next piece of a leak scan started
+ * with lub_heap_leak_scan_start(). 
+ *
+ * \return 
+ * - BOOL_TRUE if the scan has finished and the results can be shown
+ *   with lub_heap_leak_report()
+ * - BOOL_FALSE if there is more scanning to do.
+ */
+extern bool_t
+    lub_heap_leak_scan_step(
+        /**
+         * The (approximate) number of bytes to scan before returning
+         */
+        size_t budget
+    );
 /**
  * This function dumps all the context details for the heap
  * to stdout.
@@ -877,6 +1121,41 @@ extern bool_t
          */
         const char *substring
     );
+/**
+ * This function writes the same details as lub_heap_leak_report() to a
+ * file descriptor as JSON, one object per line, so that reports can be
+ * compared over time or passed on to other tools. Nothing is allocated
+ * from any heap whilst doing so.
+ *
+ * Each context selected by 'how' gives a line of the form
+ *
+ *   {"type":"context","context":"0x...","heap":"0x...",
+ *    "stack":["0x...",...],"allocs":N,"alloc_bytes":N,...}
+ *
+ * where the stack holds the raw return addresses, innermost first, and
+ * the counts include any leaks and partials. A final "summary" line
+ * holds the totals for every context along with the number of frames
+ * held and the sample interval.
+ *
+ * Unlike lub_heap_leak_report() there is no filter by function name, as
+ * looking up the symbols would allocate; the stacks are left for the
+ * reader to resolve and filter.
+ *
+ * \return 
+ * - BOOL_FALSE if leak detection is disabled, 'how' is invalid or the
+ *   file descriptor could not be written to.
+ */
+extern bool_t
+    lub_heap_leak_export(
+        /**
+         * The file descriptor to write to
+         */
+        int fd,
+        /**
+         * which contexts to write out
+         */
+        lub_heap_show_e how
+    );
 
 void
     lub_heap__set_framecount(
@@ -888,6 +1167,192 @@ void
 
 unsigned
     lub_heap__get_framecount(void);
+
+/**
+ * This function sets the rate at which allocations are sampled for leak
+ * detection. Changing it clears out the current statistics.
+ */
+void
+    lub_heap__set_sample_interval(
+        /**
+         * The mean number of bytes allocated between each monitored
+         * allocation; zero monitors every allocation.
+         */
+        size_t bytes
+    );
+
+size_t
+    lub_heap__get_sample_interval(void);
+
+/**
+ * This function sets the number of threads used to scan the heap 
+ * segments for references during a leak scan. Each step of 
+ * lub_heap_leak_scan_step() shares its budget out between the threads
+ * in pieces. 
+ *
+ * Platforms which cannot run the scan in parallel carry on using a
+ * single thread.
+ */
+void
+    lub_heap__set_scan_threads(
+        /**
+         * The number of threads; zero or one scans the segments a 
+         * piece at a time from the calling thread, which is the default.
+         */
+        unsigned threads
+    );
+
+unsigned
+    lub_heap__get_scan_threads(void);
+
+/**
+ * This function switches on, or off, the counting of allocations by
+ * call site for heaps created from then on. A heap keeps the setting it
+ * was created with for its lifetime.
+ *
+ * Each allocation from such a heap carries a small trailer naming the
+ * site which made it, and the site's counters are updated atomically;
+ * no stack is captured and no lock is taken. A site is the return
+ * address of the call to lub_heap_realloc(), or the site passed to
+ * lub_heap_realloc_by_site(); see lub_heap__set_site_skip() for callers 
+ * who wrap them.
+ */
+void
+    lub_heap__set_site_stats(
+        /**
+         * BOOL_TRUE to count allocations by site
+         */
+        bool_t enabled
+    );
+
+bool_t
+    lub_heap__get_site_stats(void);
+
+/**
+ * This function sets the number of callers of lub_heap_realloc(), or
+ * of an allocator using lub_heap_site_caller(), which are skipped to
+ * find an allocation's site, so that the site of an allocation made
+ * through a wrapper such as malloc() is the caller of the wrapper. By 
+ * default no callers are skipped, which is the cheapest.
+ */
+void
+    lub_heap__set_site_skip(
+        /**
+         * The number of wrapping functions to skip
+         */
+        unsigned frames
+    );
+
+unsigned
+    lub_heap__get_site_skip(void);
+
+/**
+ * The details held for each allocation site
+ */
+typedef struct lub_heap_site_stats_s lub_heap_site_stats_t;
+struct lub_heap_site_stats_s
+{
+    /**
+     * The return address of the allocating call, or NULL for the
+     * allocations from sites which could not be given an entry of
+     * their own.
+     */
+    const void *address;
+    /**
+     * Number of allocations made from this site
+     */
+    size_t allocs;
+    /**
+     * Number of blocks from this site currently held
+     */
+    size_t blocks;
+    /**
+     * Number of bytes from this site currently held
+     */
+    size_t bytes;
+    /**
+     * The most bytes from this site held at any one time
+     */
+    size_t peak_bytes;
+};
+
+typedef void
+    lub_heap_foreach_site_fn(const lub_heap_site_stats_t *stats,
+                             void                        *arg);
+/**
+ * This function finds the site of an allocation made through the
+ * allocator which calls it, skipping any wrappers as set by 
+ * lub_heap__set_site_skip().
+ *
+ * \return
+ * - the site to pass to lub_heap_realloc_by_site() and 
+ *   lub_heap_site_charge()
+ */
+const void *
+    lub_heap_site_caller(
+        /**
+         * The return address of the allocator
+         */
+        const void *address
+    );
+
+/**
+ * An allocator which hands the blocks of a heap out again, once they
+ * have been released to it rather than to the heap, uses this function
+ * to count each reuse against its site.
+ */
+void
+    lub_heap_site_charge(
+        /**
+         * The heap the block was allocated from
+         */
+        lub_heap_t *instance,
+        /**
+         * The block, as allocated from the heap
+         */
+        char *ptr,
+        /**
+         * The number of bytes being used
+         */
+        size_t size,
+        /**
+         * The site using them
+         */
+        const void *caller
+    );
+
+/**
+ * This function takes a block which has been released to an allocator
+ * built on top of a heap off its site.
+ */
+void
+    lub_heap_site_discharge(
+        /**
+         * The heap the block was allocated from
+         */
+        lub_heap_t *instance,
+        /**
+         * The block, as allocated from the heap
+         */
+        char *ptr
+    );
+
+/**
+ * This function calls the specified function with the details of each
+ * allocation site seen so far. The counts cover every heap counting 
+ * by site and may change while the iteration is under way.
+ */
+void
+    lub_heap_foreach_site(
+        /**
+         * The function to call for each site
+         */
+        lub_heap_foreach_site_fn *fn,
+        /**
+         * Client data for the function
+         */
+        void *arg
+    );
     
 extern bool_t 
     lub_heap_validate_pointer(lub_heap_t *instance,
@@ -941,6 +1406,13 @@ extern void
   * This operation adds a cache to the current heap, which speeds up
   * the allocation and releasing of smaller block sizes.
   *
+  * The cache has a size class for each 16 bytes up to 256 bytes, and
+  * for each power of two above that up to "max_block_size". Each class
+  * starts with a chunk of blocks taken from the heap's static memory
+  * and, when that is used up, takes further chunks from the heap's
+  * dynamic memory. A further chunk is handed back once it is no longer
+  * in use.
+  *
   * \pre
   * - The heap must have been initialised
   * - This call must not have been made on this heap before
@@ -964,7 +1436,8 @@ lub_heap_status_t
          */
         lub_heap_align_t max_block_size,
         /**
-         * The number of maximum sized blocks to make available.
+         * The number of maximum sized blocks to make available in
+         * each chunk.
          */
         size_t num_max_blocks
     );
@@ -1044,6 +1517,27 @@ size_t
          */
         size_t num_max_blocks
     );
+/**
+  * This operation returns the extra overhead, in bytes, which is taken
+  * from the first memory segment of a heap to hold the specified type
+  * of free block index. 
+  *
+  * \pre
+  * - none
+  *
+  * \return
+  * - size in bytes of the index
+  *
+  * \post
+  * - none
+  */
+size_t
+    lub_heap_index_overhead_size(
+        /**
+         * The type of index
+         */
+        lub_heap_index_e index
+    );
 
 
 _END_C_DECL
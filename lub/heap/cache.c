@@ -15,7 +15,7 @@ lub_heap_cache__get_max_free(lub_heap_cache_t *this)
         ++ptr)
     {
         lub_blockpool_stats_t stats;
-        lub_blockpool__get_stats(&(*ptr)->m_blockpool,&stats);
+        lub_heap_cache_bucket__get_stats(*ptr,&stats);
         if(stats.free_blocks && ((stats.block_size - sizeof(lub_heap_cache_bucket_t*)) > size))
         {
             size = stats.block_size - sizeof(lub_heap_cache_bucket_t*);
@@ -28,33 +28,66 @@ static lub_heap_cache_bucket_t *
 _lub_heap_cache_find_bucket_from_size(lub_heap_cache_t *this,
                                       size_t            size)
 {
-    lub_heap_cache_bucket_t **ptr = this->m_bucket_start;
+    lub_heap_cache_bucket_t **ptr;
+
     /* leave space to put the bucket reference into place */
     size += sizeof(lub_heap_cache_bucket_t*);
-    /* place powers of two into the correct bucket */
-    --size; 
-    /* ignore sizes of 1,2 and 4 bytes */
-    size >>= 3; 
-    for(;
-        (ptr < this->m_bucket_end) && size;
+
+    /* the buckets are in size order so take the first which fits */
+    for(ptr = this->m_bucket_start;
+        ptr < this->m_bucket_end;
         ++ptr)
     {
-        size >>= 1;
+        if((*ptr)->m_block_size >= size)
+        {
+            return *ptr;
+        }
     }
-    return (ptr == this->m_bucket_end) ? 0 : *ptr;
+    return 0;
+}
+/*--------------------------------------------------------- */
+/*
+ * The block size of the bucket which follows one of the specified size
+ */
+static size_t
+lub_heap_cache_next_block_size(size_t block_size)
+{
+    if(block_size < LUB_HEAP_CACHE_MAX_STEP_SIZE)
+    {
+        return block_size + LUB_HEAP_CACHE_STEP_SIZE;
+    }
+    return block_size << 1;
+}
+/*--------------------------------------------------------- */
+/*
+ * The number of bytes of blocks in each chunk of a bucket
+ */
+static size_t
+lub_heap_cache_chunk_size(size_t block_size,
+                          size_t num_max_blocks)
+{
+    size_t chunk_size = block_size * num_max_blocks;
+
+    if(chunk_size < LUB_HEAP_CACHE_MIN_CHUNK_SIZE)
+    {
+        /* don't bother with tiny chunks of small blocks */
+        chunk_size = (LUB_HEAP_CACHE_MIN_CHUNK_SIZE / block_size) * block_size;
+    }
+    return chunk_size;
 }
 /*--------------------------------------------------------- */
 static size_t
 lub_heap_cache_num_buckets(lub_heap_align_t max_block_size)
 {
     unsigned num_buckets = 0;
+    size_t   block_size;
 
     /* count the number of buckets to be created */
-    max_block_size >>= 3; /* ignore buckets of size 1,2 and 4 bytes */
-    while(max_block_size)
+    for(block_size = LUB_HEAP_CACHE_STEP_SIZE;
+        block_size <= (size_t)max_block_size;
+        block_size = lub_heap_cache_next_block_size(block_size))
     {
         ++num_buckets;
-        max_block_size >>= 1;
     }
     return num_buckets;
 }
@@ -81,7 +114,7 @@ lub_heap_cache_overhead_size(lub_heap_align_t max_block_size,
         overhead += sizeof(lub_heap_cache_bucket_t*) * max_block_size;
         
         /* buckets themselves */
-        overhead += num_buckets * offsetof(lub_heap_cache_bucket_t,m_memory_start);
+        overhead += num_buckets * offsetof(lub_heap_cache_bucket_t,m_chunk.m_memory_start);
     }
     return overhead;
 }
@@ -98,14 +131,25 @@ lub_heap_overhead_size(lub_heap_align_t max_block_size,
 
     if(max_block_size && num_max_blocks)
     {
-        size_t num_buckets = lub_heap_cache_num_buckets(max_block_size);
-        size_t bucket_size = max_block_size * num_max_blocks;
+        size_t block_size;
 
         /* now add any cache overhead contribution */
         overhead += lub_heap_cache_overhead_size(max_block_size,num_max_blocks);
 
-        /* add the bucket contents */
-        overhead += (num_buckets * bucket_size);
+        /* 
+         * add the contents of the initial chunks, and the same again 
+         * for the buckets to grow into
+         */
+        for(block_size = LUB_HEAP_CACHE_STEP_SIZE;
+            block_size <= (size_t)max_block_size;
+            block_size = lub_heap_cache_next_block_size(block_size))
+        {
+            size_t chunk_size = lub_heap_cache_chunk_size(block_size,num_max_blocks);
+
+            overhead += chunk_size;
+            overhead += chunk_size + offsetof(lub_heap_cache_chunk_t,m_memory_start);
+            overhead += sizeof(lub_heap_alloc_block_t);
+        }
     }
     return overhead;
 }
@@ -118,42 +162,45 @@ lub_heap_cache_init(lub_heap_t      *this,
     lub_heap_status_t status      = LUB_HEAP_FAILED;
     do
     {
-        size_t                    bucket_size = (max_block_size * num_max_blocks);
         unsigned                  num_buckets = lub_heap_cache_num_buckets(max_block_size);
-        size_t                    block_size  = 8;
+        size_t                    block_size  = LUB_HEAP_CACHE_STEP_SIZE;
         lub_heap_cache_t         *cache;
         lub_heap_cache_bucket_t **ptr;
         int                       i;
         /* cannot call this multiple times */
         if(this->cache) break;
 
+        /* there must be at least one bucket */
+        if(!num_buckets || !num_max_blocks) break;
         
         /* allocate a cache control block */
         cache = this->cache = lub_heap_static_alloc(this,
                                                     sizeof(lub_heap_cache_t) + sizeof(lub_heap_cache_bucket_t*)*(num_buckets-1));
         if(!cache) break;
         
+        cache->m_heap           = this;
         cache->m_max_block_size = max_block_size;
         cache->m_num_max_blocks = num_max_blocks;
         cache->m_num_buckets    = num_buckets;
-        cache->m_bucket_size    = bucket_size;
         cache->m_misses         = 0;
         cache->m_bucket_end     = &cache->m_bucket_start[num_buckets];
     
-        /* allocate each bucket for the cache */
+        /* allocate each bucket, with its initial chunk, for the cache */
         for(ptr = cache->m_bucket_start;
             ptr < cache->m_bucket_end;
             ++ptr)
         {
+            size_t chunk_size = lub_heap_cache_chunk_size(block_size,num_max_blocks);
+
             *ptr = lub_heap_static_alloc(this,
-                                         bucket_size + offsetof(lub_heap_cache_bucket_t,m_memory_start));
+                                         chunk_size + offsetof(lub_heap_cache_bucket_t,m_chunk.m_memory_start));
             if(!*ptr) break;
             /* set up each bucket */
             lub_heap_cache_bucket_init(*ptr,
                                        cache,
                                        block_size,
-                                       bucket_size);
-            block_size <<= 1;
+                                       chunk_size);
+            block_size = lub_heap_cache_next_block_size(block_size);
         }
         if(ptr != cache->m_bucket_end) break;
 
@@ -182,8 +229,10 @@ lub_heap_cache_find_bucket_from_address(lub_heap_cache_t *this,
     /* get the bucket reference */
     --bucket;
     
+    /* the buckets are statically allocated downwards in memory */
     if(    (*bucket > this->m_bucket_start[0]) 
-        || (*bucket < this->m_bucket_end[-1]) )
+        || (*bucket < this->m_bucket_end[-1])
+        || ((*bucket)->m_cache != this) )
     {
         bucket = 0;
     }
@@ -254,8 +303,10 @@ lub_heap_cache_realloc(lub_heap_t *this,
                 {
                     if(old_ptr)
                     {
+                        size_t old_size = lub_heap_cache_bucket__get_block_size(old_bucket,old_ptr);
+
                         /* copy the old details across */
-                        memcpy(new_ptr,old_ptr,size);
+                        memcpy(new_ptr,old_ptr,(size < old_size) ? size : old_size);
 
                         /* release the old cache block */
                         status = lub_heap_cache_bucket_free(old_bucket,old_ptr);
@@ -280,8 +331,8 @@ lub_heap_cache_realloc(lub_heap_t *this,
                 {
                     break;
                 }
-                /* copy the old details across */
-                memcpy(new_ptr,old_ptr,size);
+                /* copy the old details across (the old block is the smaller) */
+                memcpy(new_ptr,old_ptr,lub_heap_cache_bucket__get_block_size(old_bucket,old_ptr));
             }
             /* release the old cache block */
             status = lub_heap_cache_bucket_free(old_bucket,old_ptr);
@@ -355,10 +406,9 @@ lub_heap_cache_show(lub_heap_cache_t *this)
         ptr < this->m_bucket_end;
         ++ptr)
     {
-        lub_blockpool_t      *blockpool = &(*ptr)->m_blockpool;
         lub_blockpool_stats_t stats;
         
-        lub_blockpool__get_stats(blockpool,&stats);
+        lub_heap_cache_bucket__get_stats(*ptr,&stats);
 
         printf(" %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT" %10"SIZE_FMT"\n",
                stats.block_size,
@@ -391,12 +441,11 @@ lub_heap_cache__get_stats(lub_heap_cache_t *this,
         ptr < this->m_bucket_end;
         ++ptr)
     {
-        lub_blockpool_t      *blockpool = &(*ptr)->m_blockpool;
         lub_blockpool_stats_t bucket_stats;
         size_t                block_size;
         size_t                block_overhead = sizeof(lub_heap_cache_bucket_t*); /* used for fast lookup from address */
         
-        lub_blockpool__get_stats(blockpool,&bucket_stats);
+        lub_heap_cache_bucket__get_stats(*ptr,&bucket_stats);
         block_size = (bucket_stats.block_size - block_overhead);
 
         stats->free_blocks   += bucket_stats.free_blocks;
@@ -410,6 +459,38 @@ lub_heap_cache__get_stats(lub_heap_cache_t *this,
         stats->alloc_total_blocks += bucket_stats.alloc_total_blocks;
         stats->alloc_total_bytes  += block_size * bucket_stats.alloc_total_blocks;
     }
-    
+    lub_heap_cache__get_class_stats(this,stats);
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_cache__get_class_stats(lub_heap_cache_t *this,
+                                lub_heap_stats_t *stats)
+{
+    stats->cache_classes = this->m_num_buckets;
+    stats->cache_misses  = this->m_misses;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_cache_foreach_class(lub_heap_cache_t                *this,
+                             lub_heap_foreach_cache_class_fn *fn,
+                             void                            *arg)
+{
+    lub_heap_cache_bucket_t **ptr;
+
+    for(ptr = this->m_bucket_start;
+        ptr < this->m_bucket_end;
+        ++ptr)
+    {
+        lub_heap_cache_class_stats_t class_stats;
+        lub_blockpool_stats_t        bucket_stats;
+
+        lub_heap_cache_bucket__get_stats(*ptr,&bucket_stats);
+        class_stats.block_size = bucket_stats.block_size - sizeof(lub_heap_cache_bucket_t*);
+        class_stats.num_blocks = bucket_stats.num_blocks;
+        class_stats.hits       = (*ptr)->m_hits;
+        class_stats.misses     = (*ptr)->m_misses;
+
+        fn(&class_stats,arg);
+    }
 }
 /*--------------------------------------------------------- */
@@ -2,15 +2,24 @@
 #include "private.h"
 
 typedef struct _lub_heap_cache_bucket lub_heap_cache_bucket_t;
+typedef struct _lub_heap_cache_chunk  lub_heap_cache_chunk_t;
+
+/* the size classes go up in these steps... */
+#define LUB_HEAP_CACHE_STEP_SIZE     16
+/* ...up to this size, and then in powers of two */
+#define LUB_HEAP_CACHE_MAX_STEP_SIZE 256
+/* the smallest number of bytes of blocks in a chunk */
+#define LUB_HEAP_CACHE_MIN_CHUNK_SIZE 1024
+
 /*-------------------------------------
  * lub_heap_cache_t class
  *------------------------------------- */
 struct _lub_heap_cache
 {
+    lub_heap_t               *m_heap;
     lub_heap_align_t          m_max_block_size;
     unsigned                  m_num_max_blocks;
     unsigned                  m_num_buckets;
-    size_t                    m_bucket_size;
     size_t                    m_misses;
     lub_heap_cache_bucket_t **m_bucket_lookup;
     lub_heap_cache_bucket_t **m_bucket_end;
@@ -26,28 +35,54 @@ lub_heap_cache_bucket_t *
 void
     lub_heap_cache__get_stats(lub_heap_cache_t *this,
                               lub_heap_stats_t *stats);
+void
+    lub_heap_cache__get_class_stats(lub_heap_cache_t *this,
+                                    lub_heap_stats_t *stats);
+void
+    lub_heap_cache_foreach_class(lub_heap_cache_t                *this,
+                                 lub_heap_foreach_cache_class_fn *fn,
+                                 void                            *arg);
+
+/*-------------------------------------
+ * lub_heap_cache_chunk_t class
+ *
+ * A piece of memory from which a bucket hands out blocks
+ *------------------------------------- */
+struct _lub_heap_cache_chunk
+{
+    lub_heap_cache_chunk_t *m_next;
+    lub_blockpool_t         m_blockpool;
+    char                   *m_memory_end;
+    char                    m_memory_start[1]; /* must be last */
+};
 
 /*-------------------------------------
  * lub_heap_cache_bucket_t class
  *------------------------------------- */
 struct _lub_heap_cache_bucket
 {
-    lub_blockpool_t   m_blockpool;
-    lub_heap_cache_t *m_cache;
-    char             *m_memory_end;
-    char              m_memory_start[1]; /* must be last */
+    lub_heap_cache_t       *m_cache;
+    size_t                  m_block_size;
+    size_t                  m_chunk_size;
+    size_t                  m_hits;
+    size_t                  m_misses;
+    lub_heap_cache_chunk_t *m_first_chunk;
+    lub_heap_cache_chunk_t  m_chunk; /* the initial chunk; must be last */
 };
 
 void
     lub_heap_cache_bucket_init(lub_heap_cache_bucket_t *instance,
                                lub_heap_cache_t        *cache,
                                size_t                   block_size,
-                               size_t                   bucket_size);
+                               size_t                   chunk_size);
 void *
     lub_heap_cache_bucket_alloc(lub_heap_cache_bucket_t *instance);
 lub_heap_status_t
     lub_heap_cache_bucket_free(lub_heap_cache_bucket_t *instance,
                                 void                    *ptr);
+void
+    lub_heap_cache_bucket__get_stats(lub_heap_cache_bucket_t *instance,
+                                     lub_blockpool_stats_t   *stats);
 size_t
     lub_heap_cache__get_max_free(lub_heap_cache_t *this);
 
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "cache.h"
 
 /*--------------------------------------------------------- */
@@ -12,46 +14,103 @@ size_t
 lub_heap_cache_bucket__get_block_size(lub_heap_cache_bucket_t *this,
                                       const char              *ptr)
 {
-    size_t size = 0;
-
-    /* get the size from the cache */
-    lub_blockpool_stats_t stats;
-    lub_blockpool__get_stats(&this->m_blockpool,&stats);
-    size = stats.block_size - sizeof(lub_heap_cache_bucket_t*);
-
-    return size;
+    return this->m_block_size - sizeof(lub_heap_cache_bucket_t*);
 }
 /*--------------------------------------------------------- */
-void
-lub_heap_cache_bucket_init(lub_heap_cache_bucket_t *this,
-                           lub_heap_cache_t        *cache,
-                           size_t                   block_size,
-                           size_t                   bucket_size)
+static void
+lub_heap_cache_chunk_init(lub_heap_cache_chunk_t *this,
+                          size_t                  block_size,
+                          size_t                  chunk_size)
 {
     /* initialise the blockpool */
-    size_t num_blocks = bucket_size/block_size;
-    
+    size_t num_blocks = chunk_size/block_size;
+
     lub_blockpool_init(&this->m_blockpool,
                        this->m_memory_start,
                        block_size,
                        num_blocks);
-    this->m_memory_end = this->m_memory_start + bucket_size;
-    this->m_cache      = cache;
+    this->m_memory_end = this->m_memory_start + chunk_size;
+    this->m_next       = 0;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_cache_bucket_init(lub_heap_cache_bucket_t *this,
+                           lub_heap_cache_t        *cache,
+                           size_t                   block_size,
+                           size_t                   chunk_size)
+{
+    lub_heap_cache_chunk_init(&this->m_chunk,block_size,chunk_size);
+
+    this->m_cache       = cache;
+    this->m_block_size  = block_size;
+    this->m_chunk_size  = chunk_size;
+    this->m_hits        = 0;
+    this->m_misses      = 0;
+    this->m_first_chunk = &this->m_chunk;
+}
+/*--------------------------------------------------------- */
+/*
+ * Take a further chunk from the heap's dynamic memory
+ */
+static lub_heap_cache_chunk_t *
+lub_heap_cache_bucket_grow(lub_heap_cache_bucket_t *this)
+{
+    char                   *ptr   = 0;
+    lub_heap_cache_chunk_t *chunk = 0;
+
+    if(LUB_HEAP_OK == lub_heap_raw_realloc(this->m_cache->m_heap,
+                                           &ptr,
+                                           offsetof(lub_heap_cache_chunk_t,m_memory_start) + this->m_chunk_size,
+                                           LUB_HEAP_ALIGN_NATIVE))
+    {
+        chunk = (lub_heap_cache_chunk_t*)ptr;
+        lub_heap_cache_chunk_init(chunk,this->m_block_size,this->m_chunk_size);
+
+        /* put it after the initial chunk */
+        chunk->m_next         = this->m_chunk.m_next;
+        this->m_chunk.m_next  = chunk;
+    }
+    return chunk;
 }
 /*--------------------------------------------------------- */
 void *
 lub_heap_cache_bucket_alloc(lub_heap_cache_bucket_t *this)
 {
     void                     *ptr        = 0;
-    lub_heap_cache_bucket_t **bucket_ptr = lub_blockpool_alloc(&this->m_blockpool);
+    lub_heap_cache_bucket_t **bucket_ptr = 0;
+    lub_heap_cache_chunk_t   *chunk;
+
+    /* find a chunk with a free block */
+    for(chunk = this->m_first_chunk;
+        chunk;
+        chunk = chunk->m_next)
+    {
+        if(chunk->m_blockpool.m_alloc_blocks < chunk->m_blockpool.m_num_blocks)
+        {
+            break;
+        }
+    }
+    if(!chunk)
+    {
+        chunk = lub_heap_cache_bucket_grow(this);
+    }
+    if(chunk)
+    {
+        bucket_ptr = lub_blockpool_alloc(&chunk->m_blockpool);
+    }
     if(bucket_ptr)
     {
+        ++this->m_hits;
         *bucket_ptr = this;
         ptr = ++bucket_ptr;
         /* make sure that released memory is tainted */
         lub_heap_taint_memory(ptr,
                               LUB_HEAP_TAINT_ALLOC,
-                              this->m_blockpool.m_block_size-sizeof(lub_heap_cache_bucket_t*));
+                              this->m_block_size-sizeof(lub_heap_cache_bucket_t*));
+    }
+    else
+    {
+        ++this->m_misses;
     }
     return ptr;
 }
@@ -62,16 +121,75 @@ lub_heap_cache_bucket_free(lub_heap_cache_bucket_t *this,
 {
     lub_heap_status_t         status     = LUB_HEAP_CORRUPTED;
     lub_heap_cache_bucket_t **bucket_ptr = ptr;
+    lub_heap_cache_chunk_t  **chunk_ptr;
     --bucket_ptr;
     if(*bucket_ptr == this)
     {
-        lub_blockpool_free(&this->m_blockpool,bucket_ptr);
-        /* make sure that released memory is tainted */
-        lub_heap_taint_memory((char*)bucket_ptr,
-                              LUB_HEAP_TAINT_FREE,
-                              this->m_blockpool.m_block_size);
-        status = LUB_HEAP_OK;
+        /* find the chunk which holds this block */
+        for(chunk_ptr = &this->m_first_chunk;
+            *chunk_ptr;
+            chunk_ptr = &(*chunk_ptr)->m_next)
+        {
+            lub_heap_cache_chunk_t *chunk = *chunk_ptr;
+
+            if(((char*)bucket_ptr >= chunk->m_memory_start) &&
+               ((char*)bucket_ptr <  chunk->m_memory_end))
+            {
+                lub_blockpool_free(&chunk->m_blockpool,bucket_ptr);
+                /* make sure that released memory is tainted */
+                lub_heap_taint_memory((char*)bucket_ptr,
+                                      LUB_HEAP_TAINT_FREE,
+                                      this->m_block_size);
+                status = LUB_HEAP_OK;
+
+                if((chunk != &this->m_chunk) && (0 == chunk->m_blockpool.m_alloc_blocks))
+                {
+                    char *tmp = (char*)chunk;
+
+                    /* hand an unused further chunk back to the heap */
+                    *chunk_ptr = chunk->m_next;
+                    (void)lub_heap_raw_realloc(this->m_cache->m_heap,
+                                               &tmp,
+                                               0,
+                                               LUB_HEAP_ALIGN_NATIVE);
+                }
+                break;
+            }
+        }
     }
     return status;
 }
 /*--------------------------------------------------------- */
+void
+lub_heap_cache_bucket__get_stats(lub_heap_cache_bucket_t *this,
+                                 lub_blockpool_stats_t   *stats)
+{
+    lub_heap_cache_chunk_t *chunk;
+
+    memset(stats,0,sizeof(*stats));
+    stats->block_size = this->m_block_size;
+
+    /* add up the details of each chunk */
+    for(chunk = this->m_first_chunk;
+        chunk;
+        chunk = chunk->m_next)
+    {
+        lub_blockpool_stats_t chunk_stats;
+
+        lub_blockpool__get_stats(&chunk->m_blockpool,&chunk_stats);
+        stats->num_blocks            += chunk_stats.num_blocks;
+        stats->alloc_blocks          += chunk_stats.alloc_blocks;
+        stats->alloc_bytes           += chunk_stats.alloc_bytes;
+        stats->free_blocks           += chunk_stats.free_blocks;
+        stats->free_bytes            += chunk_stats.free_bytes;
+        stats->alloc_hightide_blocks += chunk_stats.alloc_hightide_blocks;
+        stats->alloc_hightide_bytes  += chunk_stats.alloc_hightide_bytes;
+        stats->free_hightide_blocks  += chunk_stats.free_hightide_blocks;
+        stats->free_hightide_bytes   += chunk_stats.free_hightide_bytes;
+    }
+    /* the chunks come and go so the bucket keeps the running totals */
+    stats->alloc_total_blocks = this->m_hits;
+    stats->alloc_total_bytes  = this->m_hits * this->m_block_size;
+    stats->alloc_failures     = this->m_misses;
+}
+/*--------------------------------------------------------- */
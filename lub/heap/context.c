@@ -9,6 +9,7 @@
 #include "node.h"
 
 unsigned long lub_heap_frame_count;
+size_t        lub_heap_sample_interval;
 
 #define CONTEXT_CHUNK_SIZE 100 /* number of contexts per chunk */
 #define CONTEXT_MAX_CHUNKS 100 /* allow upto 10000 contexts */
@@ -66,6 +67,23 @@ lub_heap_context_getkey(const void        *clientnode,
     memcpy(key,&context->key,sizeof(lub_heap_context_key_t));
 }
 /*--------------------------------------------------------- */
+/* the bucket which holds contexts with this backtrace */
+static lub_heap_context_t **
+lub_heap_context_bucket(lub_heap_leak_t              *leak,
+                        const lub_heap_context_key_t *key)
+{
+    unsigned long hash = 0;
+    unsigned long i;
+
+    for(i = 0; i < lub_heap_frame_count; ++i)
+    {
+        hash = (hash * 31) + ((unsigned long)key->backtrace[i] >> 2);
+    }
+    hash ^= (hash >> 16);
+
+    return &leak->m_context_hash[hash & (LUB_HEAP_CONTEXT_HASH_SIZE - 1)];
+}
+/*--------------------------------------------------------- */
 static bool_t
 lub_heap_foreach_context(bool_t (*fn)(lub_heap_context_t *,void *),
                          void    *arg)
@@ -190,9 +208,15 @@ lub_heap_context_init(lub_heap_context_t * this,
     lub_bintree_node_init(&this->bt_node);
 
     {
-        lub_heap_leak_t *leak = lub_heap_leak_instance();
+        lub_heap_leak_t     *leak   = lub_heap_leak_instance();
+        lub_heap_context_t **bucket = lub_heap_context_bucket(leak,&this->key);
+
         /* add this context to the context_tree */
         lub_bintree_insert(&leak->m_context_tree,this);
+
+        /* and to the hash used to look it up */
+        this->hash_next = *bucket;
+        *bucket         = this;
         lub_heap_leak_release(leak);
     }
 }
@@ -200,9 +224,19 @@ lub_heap_context_init(lub_heap_context_t * this,
 void
 lub_heap_context_fini(lub_heap_context_t * this)
 {
-    lub_heap_leak_t *leak = lub_heap_leak_instance();
+    lub_heap_leak_t     *leak   = lub_heap_leak_instance();
+    lub_heap_context_t **bucket = lub_heap_context_bucket(leak,&this->key);
+
     /* remove this node from the context_tree */
     lub_bintree_remove(&leak->m_context_tree,this);
+
+    /* and from the hash */
+    while(*bucket != this)
+    {
+        bucket = &(*bucket)->hash_next;
+    }
+    *bucket         = this->hash_next;
+    this->hash_next = NULL;
     lub_heap_leak_release(leak);
 
     /* cleanup the context */
@@ -250,13 +284,6 @@ lub_heap_context_remove_node(lub_heap_context_t *this,
     /* clear the pointers */
     lub_heap_node__set_next(node,NULL);
     node->prev = NULL;
-    
-    /* is this the last node in a context? */
-    if(0 == this->allocs)
-    {
-        /* removing the last node deletes the context */
-        lub_heap_context_delete(this);
-    }
 }
 /*--------------------------------------------------------- */
 void
@@ -286,8 +313,7 @@ lub_heap_node_post(lub_heap_node_t *node)
 }
 /*--------------------------------------------------------- */
 void
-lub_heap_node_prep(lub_heap_node_t *node,
-                   void            *arg)
+lub_heap_node_prep(lub_heap_node_t *node)
 {
     /* assume the worst */
     lub_heap_node__set_leaked(node,BOOL_TRUE);
@@ -295,36 +321,28 @@ lub_heap_node_prep(lub_heap_node_t *node,
     lub_heap_node__set_scanned(node,BOOL_FALSE);
 }
 /*--------------------------------------------------------- */
-void
-lub_heap_node_scan(lub_heap_node_t *node,
-                   void            *arg)
-{
-    /* only scan nodes which have references */
-    if(   (BOOL_FALSE == lub_heap_node__get_leaked(node) )
-       && (BOOL_FALSE == lub_heap_node__get_scanned(node)) )
-    {
-        lub_heap_node__set_scanned(node,BOOL_TRUE);
-        lub_heap_scan_memory(lub_heap_node__get_ptr(node),
-                             lub_heap_node__get_size(node));
-    }
-}
-/*--------------------------------------------------------- */
 static bool_t
 lub_heap_context_prep(lub_heap_context_t *this,
                       void               *arg)
 {
+    /* 
+     * the counters and the nodes are changed together so that
+     * allocations and releases on other threads see them agree
+     */
+    lub_heap_leak_t *leak = lub_heap_leak_instance();
+
     /* start off by assuming the worst */
     this->partials         = this->leaks           = this->allocs;
     this->partial_bytes    = this->leaked_bytes    = this->alloc_bytes;
     this->partial_overhead = this->leaked_overhead = this->alloc_overhead;
-    {
-        lub_heap_leak_t *leak = lub_heap_leak_instance();
-        /* initialised the global stats */
-        leak->m_stats.allocs         += this->allocs;
-        leak->m_stats.alloc_bytes    += this->alloc_bytes;
-        leak->m_stats.alloc_overhead += this->alloc_overhead;
-        lub_heap_leak_release(leak);
-    }
+    lub_heap_context_foreach_node(this,lub_heap_node_prep);
+
+    /* initialised the global stats */
+    leak->m_stats.allocs         += this->allocs;
+    leak->m_stats.alloc_bytes    += this->alloc_bytes;
+    leak->m_stats.alloc_overhead += this->alloc_overhead;
+    lub_heap_leak_release(leak);
+
     return BOOL_TRUE;
 }
 /*--------------------------------------------------------- */
@@ -332,6 +350,8 @@ static bool_t
 lub_heap_context_post(lub_heap_context_t *this,
                       void               *arg)
 {
+    lub_heap_leak_t *leak = lub_heap_leak_instance();
+
     /* don't count full leaks as partials */
     this->partials         -= this->leaks;
     this->partial_bytes    -= this->leaked_bytes;
@@ -339,102 +359,359 @@ lub_heap_context_post(lub_heap_context_t *this,
     
     /* post process the contained nodes */
     lub_heap_context_foreach_node(this,lub_heap_node_post);
+    lub_heap_leak_release(leak);
 
     return BOOL_TRUE;
 }
 /*--------------------------------------------------------- */
+/*
+ * Start going through the heap segments from the beginning. The leak 
+ * lock must be held.
+ */
 static void
-scan_segment(void    *ptr,
-             unsigned index,
-             size_t   size,
-             void    *arg)
+lub_heap_scan_rewind(lub_heap_leak_t *leak)
 {
-    lub_heap_segment_t *segment = ptr;
-    const char         *memory  = (const char*)lub_heap_block_getfirst(segment);
-    
-    /* now scan the memory in this segment */
-    printf(".");
-    lub_heap_scan_memory(memory,size);
+    lub_heap_scan_t *scan = &leak->m_scan;
+
+    scan->heap    = leak->m_heap_list;
+    scan->segment = scan->heap ? &scan->heap->first_segment : 0;
+    scan->offset  = 0;
 }
 /*--------------------------------------------------------- */
-/** 
- * This function scans all the nodes currently allocated in the
- * system for references to other allocated nodes.
- * First of all we mark all nodes as leaked, then scan all the nodes
- * for any references to other ones. If found those other ones 
- * are cleared from being leaked.
- * At the end of the process all nodes which are leaked then
- * update their context leak count.
- */
-void
-lub_heap_scan_all(void)
+size_t
+lub_heap_scan_next_piece(lub_heap_leak_t *leak,
+                         size_t           budget,
+                         const char     **memory)
 {
+    lub_heap_scan_t *scan = &leak->m_scan;
     lub_heap_t      *heap;
-    lub_heap_leak_t *leak = lub_heap_leak_instance();
-    
 
-    /* clear the summary stats */
-    memset(&leak->m_stats,0,sizeof(leak->m_stats));
+    if(NULL == scan->heap)
+    {
+        /* every segment has been covered */
+        return 0;
+    }
+    /* make sure the heap hasn't been destroyed since the last piece */
+    for(heap = leak->m_heap_list; 
+        heap && (heap != scan->heap); 
+        heap = heap->next)
+    {
+    }
+    if(NULL == heap)
+    {
+        /* start from the beginning; scanning memory twice does no harm */
+        heap          = leak->m_heap_list;
+        scan->segment = heap ? &heap->first_segment : 0;
+        scan->offset  = 0;
+    }
+    while(heap)
+    {
+        lub_heap_segment_t *segment = scan->segment;
+        size_t              size    = segment->words << 2;
 
+        /* when rescanning only the segments added since the start matter */
+        if(   (scan->offset < size)
+           && (   (LUB_HEAP_SCAN_RESCAN != scan->phase)
+               || (segment->generation == scan->generation)))
+        {
+            size -= scan->offset;
+            if(size > budget)
+            {
+                /* keep to whole pointers so that the next piece lines up */
+                size_t whole = budget - (budget % sizeof(void*));
+
+                if(whole)
+                {
+                    size = whole;
+                }
+                else if(size > sizeof(void*))
+                {
+                    size = sizeof(void*);
+                }
+            }
+            *memory       = (const char*)lub_heap_block_getfirst(segment) + scan->offset;
+            scan->heap    = heap;
+            scan->offset += size;
+
+            return size;
+        }
+        scan->offset = 0;
+        if(segment->next)
+        {
+            scan->segment = segment->next;
+        }
+        else
+        {
+            heap          = heap->next;
+            scan->segment = heap ? &heap->first_segment : 0;
+        }
+    }
+    scan->heap    = 0;
+    scan->segment = 0;
+
+    return 0;
+}
+/*--------------------------------------------------------- */
+/*
+ * Scan the next piece of the heap segments, returning the number of
+ * bytes covered (zero once every segment has been scanned)
+ */
+static size_t
+lub_heap_scan_segments(size_t budget)
+{
+    lub_heap_leak_t    *leak    = lub_heap_leak_instance();
+    const char         *memory  = 0;
+    lub_heap_segment_t *segment = 0;
+    size_t              size    = lub_heap_scan_next_piece(leak,budget,&memory);
+    size_t              offset  = leak->m_scan.offset;
+
+    segment = leak->m_scan.segment;
     lub_heap_leak_release(leak);
-    /* first of all prepare the contexts for scanning */
-    lub_heap_foreach_context(lub_heap_context_prep,0);
 
-    /* then prepare all the nodes (including those who have no context) */
-    lub_heap_foreach_node(lub_heap_node_prep,0);
-    
-    printf("  Scanning memory");
+    if(size)
+    {
+        /* a monitored block may take the scan past the end of this piece */
+        size_t covered = lub_heap_scan_memory(memory,size);
+        if(covered > size)
+        {
+            leak = lub_heap_leak_instance();
+            if(   (segment == leak->m_scan.segment) 
+               && (offset  == leak->m_scan.offset))
+            {
+                leak->m_scan.offset += covered - size;
+            }
+            lub_heap_leak_release(leak);
+            size = covered;
+        }
+    }
+    memory = 0; /* don't leave pointers on the stack */
+
+    return size;
+}
+/*--------------------------------------------------------- */
+/*
+ * Scan the stacks, BSS and DATA for references
+ */
+static void
+lub_heap_scan_roots(void)
+{
     /* clear out the stacks in the system */
     lub_heap_clean_stacks();
     
     /* Scan the current stack */
-    printf(".");
     lub_heap_scan_stack();
     
     /* Scan the BSS segment */
-    printf(".");
     lub_heap_scan_bss();
     
     /* Scan the DATA segment */
-    printf(".");
     lub_heap_scan_data();
-    
-    /* Scan the non-monitored blocks which are allocated in the system */
-    leak = lub_heap_leak_instance();
-    for(heap = leak->m_heap_list;
-        heap;
-        heap = heap->next) 
+}
+/*--------------------------------------------------------- */
+/*
+ * Scan the next referenced node which has not yet been scanned, 
+ * returning the number of bytes covered (zero at the end of a pass)
+ */
+static size_t
+lub_heap_scan_nodes(void)
+{
+    lub_heap_leak_t    *leak   = lub_heap_leak_instance();
+    lub_heap_scan_t    *scan   = &leak->m_scan;
+    lub_heap_node_t    *node;
+    lub_heap_node_key_t key;
+    const char         *memory = 0;
+    size_t              size   = 0;
+
+    /* carry on from the last node; it may have been released since */
+    key.node = scan->last;
+    for(node = scan->last ? lub_bintree_findnext(&leak->m_node_tree,&key)
+                          : lub_bintree_findfirst(&leak->m_node_tree);
+        node;
+        node = lub_bintree_findnext(&leak->m_node_tree,&key))
     {
-        lub_heap_leak_release(leak);
-        lub_heap_foreach_segment(heap,scan_segment,0);
-        leak = lub_heap_leak_instance();
+        key.node   = node;
+        scan->last = node;
+
+        /* only scan nodes which have references */
+        if(   (BOOL_FALSE == lub_heap_node__get_leaked(node) )
+           && (BOOL_FALSE == lub_heap_node__get_scanned(node)) )
+        {
+            lub_heap_node__set_scanned(node,BOOL_TRUE);
+            ++scan->found;
+            memory = lub_heap_node__get_ptr(node);
+            size   = lub_heap_node__get_size(node);
+            break;
+        }
+    }
+    if(!node)
+    {
+        /* start the next pass from the beginning */
+        scan->last = 0;
     }
     lub_heap_leak_release(leak);
-    
+
+    if(memory)
+    {
+        (void)lub_heap_scan_memory(memory,size);
+    }
+    /* an empty node still counts as progress */
+    return node ? (size + sizeof(lub_heap_node_t)) : 0;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_leak_scan_start(void)
+{
+    lub_heap_leak_t *leak = lub_heap_leak_instance();
+    unsigned         generation = leak->m_scan.generation;
+
+    /* clear the summary stats */
+    memset(&leak->m_stats,0,sizeof(leak->m_stats));
+    memset(&leak->m_scan,0,sizeof(leak->m_scan));
+
+    /* the segments added from here on belong to this scan */
+    leak->m_scan.generation = generation + 1;
+
+    lub_heap_leak_release(leak);
     /* 
-     * now scan the nodes NB. only referenced nodes will be scanned 
-     * we loop until we stop scanning new nodes
+     * first of all prepare the contexts and their nodes for scanning;
+     * any allocation made from here on is taken to be referenced
      */
+    lub_heap_foreach_context(lub_heap_context_prep,0);
+
     leak = lub_heap_leak_instance();
-    do
+    leak->m_scan.phase = LUB_HEAP_SCAN_ROOTS;
+    lub_heap_leak_release(leak);
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_leak_scan_step(size_t budget)
+{
+    lub_heap_leak_t      *leak  = lub_heap_leak_instance();
+    lub_heap_scan_phase_e phase = leak->m_scan.phase;
+    size_t                done  = 0;
+
+    lub_heap_leak_release(leak);
+
+    while(done < budget)
     {
-        leak->m_stats.scanned = 0;
-        /* scan each node */
-        lub_heap_leak_release(leak);
-        printf(".");
-        lub_heap_foreach_node(lub_heap_node_scan,NULL);
+        switch(phase)
+        {
+            case LUB_HEAP_SCAN_IDLE:
+            {
+                return BOOL_TRUE;
+            }
+            case LUB_HEAP_SCAN_ROOTS:
+            {
+                lub_heap_scan_roots();
+
+                /* now the (non-monitored) blocks in each heap */
+                leak = lub_heap_leak_instance();
+                lub_heap_scan_rewind(leak);
+                lub_heap_leak_release(leak);
+                phase = LUB_HEAP_SCAN_SEGMENTS;
+                break;
+            }
+            case LUB_HEAP_SCAN_SEGMENTS:
+            case LUB_HEAP_SCAN_RESCAN:
+            {
+                size_t size;
+
+                if(BOOL_FALSE == lub_heap_scan_segments_parallel(budget - done,&size))
+                {
+                    size = lub_heap_scan_segments(budget - done);
+                }
+                if(size)
+                {
+                    done += size;
+                }
+                else
+                {
+                    lub_heap_scan_segments_parallel_end();
+
+                    /* 
+                     * NB. only referenced nodes will be scanned; from here on new
+                     * allocations are taken to have been scanned already
+                     */
+                    phase = LUB_HEAP_SCAN_NODES;
+                }
+                break;
+            }
+            case LUB_HEAP_SCAN_NODES:
+            {
+                size_t size = lub_heap_scan_nodes();
+                if(size)
+                {
+                    done += size;
+                }
+                else
+                {
+                    leak = lub_heap_leak_instance();
+                    if(leak->m_scan.found)
+                    {
+                        /* loop until we stop scanning new nodes */
+                        leak->m_scan.found = 0;
+                        lub_heap_leak_release(leak);
+                    }
+                    else if(BOOL_FALSE == leak->m_scan.rescanned)
+                    {
+                        /*
+                         * references may have moved about while the scan
+                         * was under way so look at the roots again, along
+                         * with any segments added since it started
+                         */
+                        leak->m_scan.rescanned = BOOL_TRUE;
+                        lub_heap_scan_rewind(leak);
+                        lub_heap_leak_release(leak);
+
+                        lub_heap_scan_roots();
+                        phase = LUB_HEAP_SCAN_RESCAN;
+                    }
+                    else
+                    {
+                        lub_heap_leak_release(leak);
+
+                        /* post process each context and contained nodes */
+                        lub_heap_foreach_context(lub_heap_context_post,0);
+                        phase = LUB_HEAP_SCAN_IDLE;
+                    }
+                }
+                break;
+            }
+        }
         leak = lub_heap_leak_instance();
-    } while(leak->m_stats.scanned);
-        
-    printf("done\n\n");
+        leak->m_scan.phase = phase;
+        lub_heap_leak_release(leak);
+    }
+    return (LUB_HEAP_SCAN_IDLE == phase) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+/** 
+ * This function scans all the nodes currently allocated in the
+ * system for references to other allocated nodes.
+ * First of all we mark all nodes as leaked, then scan all the nodes
+ * for any references to other ones. If found those other ones 
+ * are cleared from being leaked.
+ * At the end of the process all nodes which are leaked then
+ * update their context leak count.
+ *
+ * The scan is made a piece at a time so that other threads can
+ * carry on allocating and releasing memory while it runs.
+ */
+void
+lub_heap_scan_all(void)
+{
+    unsigned steps = 0;
 
-    /* post process each context and contained nodes */
-    lub_heap_leak_release(leak);
-    lub_heap_foreach_context(lub_heap_context_post,0);
-    leak = lub_heap_leak_instance();
-    
-    
-    lub_heap_leak_release(leak);
+    printf("  Scanning memory");
+    lub_heap_leak_scan_start();
+    while(BOOL_FALSE == lub_heap_leak_scan_step(LUB_HEAP_SCAN_STEP_SIZE))
+    {
+        if(0 == (steps++ % 16))
+        {
+            printf(".");
+        }
+    }
+    printf("done\n\n");
 }
 /*--------------------------------------------------------- */
 void lub_heap_node_show(lub_heap_node_t *node)
@@ -473,59 +750,75 @@ lub_heap_context_match(lub_heap_context_t *this,
     return result;
 }
 /*--------------------------------------------------------- */
-typedef struct
-{
-    lub_heap_show_e how;
-    const char     *substring;
-} context_show_arg_t;
-/*--------------------------------------------------------- */
-bool_t
-lub_heap_context_show_fn(lub_heap_context_t *this,
-                         void                *arg)
+/*
+ * Obtain the details of a context; when only a sample of the
+ * allocations is monitored these are scaled up to estimated totals.
+ */
+static void
+lub_heap_context__get_stats(lub_heap_context_t    *this,
+                            lub_heap_leak_stats_t *stats)
 {
-    bool_t              result = BOOL_FALSE;
-    context_show_arg_t *show_arg = arg;
-    
-    lub_heap_leak_t *leak = lub_heap_leak_instance();
-    /* add in the context details */
-    ++leak->m_stats.contexts;
-    leak->m_stats.allocs           += this->allocs;
-    leak->m_stats.alloc_bytes      += this->alloc_bytes;
-    leak->m_stats.alloc_overhead   += this->alloc_overhead;
-    leak->m_stats.partials         += this->partials;
-    leak->m_stats.partial_bytes    += this->partial_bytes;
-    leak->m_stats.partial_overhead += this->partial_overhead;
-    leak->m_stats.leaks            += this->leaks;
-    leak->m_stats.leaked_bytes     += this->leaked_bytes;
-    leak->m_stats.leaked_overhead  += this->leaked_overhead;
-    lub_heap_leak_release(leak);
-    
-    
-    if(lub_heap_context_match(this,show_arg->substring))
+    memset(stats,0,sizeof(*stats));
+    if(0 == lub_heap_sample_interval)
     {
-        result = lub_heap_context_show(this,show_arg->how);
+        stats->allocs           = this->allocs;
+        stats->alloc_bytes      = this->alloc_bytes;
+        stats->alloc_overhead   = this->alloc_overhead;
+        stats->leaks            = this->leaks;
+        stats->leaked_bytes     = this->leaked_bytes;
+        stats->leaked_overhead  = this->leaked_overhead;
+        stats->partials         = this->partials;
+        stats->partial_bytes    = this->partial_bytes;
+        stats->partial_overhead = this->partial_overhead;
+    }
+    else
+    {
+        double           allocs   = 0, alloc_bytes   = 0, alloc_overhead   = 0;
+        double           leaks    = 0, leaked_bytes  = 0, leaked_overhead  = 0;
+        double           partials = 0, partial_bytes = 0, partial_overhead = 0;
+        lub_heap_node_t *node;
+
+        for(node = this->first_node;
+            node;
+            node = lub_heap_node__get_next(node))
+        {
+            size_t size     = lub_heap_node__get_size(node);
+            size_t overhead = lub_heap_node__get_overhead(node);
+            double weight   = lub_heap_sample_weight(size);
+
+            allocs         += weight;
+            alloc_bytes    += weight * size;
+            alloc_overhead += weight * overhead;
+            if(lub_heap_node__get_leaked(node))
+            {
+                leaks           += weight;
+                leaked_bytes    += weight * size;
+                leaked_overhead += weight * overhead;
+            }
+            else if(lub_heap_node__get_partial(node))
+            {
+                partials         += weight;
+                partial_bytes    += weight * size;
+                partial_overhead += weight * overhead;
+            }
+        }
+        stats->allocs           = (size_t)(allocs + 0.5);
+        stats->alloc_bytes      = (size_t)(alloc_bytes + 0.5);
+        stats->alloc_overhead   = (size_t)(alloc_overhead + 0.5);
+        stats->leaks            = (size_t)(leaks + 0.5);
+        stats->leaked_bytes     = (size_t)(leaked_bytes + 0.5);
+        stats->leaked_overhead  = (size_t)(leaked_overhead + 0.5);
+        stats->partials         = (size_t)(partials + 0.5);
+        stats->partial_bytes    = (size_t)(partial_bytes + 0.5);
+        stats->partial_overhead = (size_t)(partial_overhead + 0.5);
     }
-    return result;
 }
 /*--------------------------------------------------------- */
-bool_t
-lub_heap_context_show(lub_heap_context_t *this,
-                      lub_heap_show_e     how)
+/* whether a context with these details should be reported */
+static bool_t
+lub_heap_context_wanted(const lub_heap_leak_stats_t *stats,
+                        lub_heap_show_e              how)
 {
-    long   frame       = lub_heap_frame_count-1;
-    size_t ok_allocs   = this->allocs;
-    size_t ok_bytes    = this->alloc_bytes;
-    size_t ok_overhead = this->alloc_overhead;
-    
-    ok_allocs -= this->partials;
-    ok_allocs -= this->leaks;
-
-    ok_bytes  -= this->partial_bytes;
-    ok_bytes  -= this->leaked_bytes;
-
-    ok_overhead  -= this->partial_overhead;
-    ok_overhead  -= this->leaked_overhead;
-
     switch(how)
     {
         case LUB_HEAP_SHOW_ALL:
@@ -535,7 +828,7 @@ lub_heap_context_show(lub_heap_context_t *this,
         }
         case LUB_HEAP_SHOW_PARTIALS:
         {
-            if(0 < this->partials)
+            if(0 < stats->partials)
             {
                 /* there's at least one partial in this context */
                 break;
@@ -544,7 +837,7 @@ lub_heap_context_show(lub_heap_context_t *this,
         }
         case LUB_HEAP_SHOW_LEAKS:
         {
-            if(0 < this->leaks)
+            if(0 < stats->leaks)
             {
                 /* there's at least one leak in this context */
                 break;
@@ -553,10 +846,79 @@ lub_heap_context_show(lub_heap_context_t *this,
         }
         default:
         {
-            /* nothing to be shown */
             return BOOL_FALSE;
         }
     }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+typedef struct
+{
+    lub_heap_show_e how;
+    const char     *substring;
+} context_show_arg_t;
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_context_show_fn(lub_heap_context_t *this,
+                         void                *arg)
+{
+    bool_t                result = BOOL_FALSE;
+    context_show_arg_t   *show_arg = arg;
+    lub_heap_leak_stats_t stats;
+    lub_heap_leak_t      *leak;
+
+    lub_heap_context__get_stats(this,&stats);
+
+    leak = lub_heap_leak_instance();
+    /* add in the context details */
+    ++leak->m_stats.contexts;
+    leak->m_stats.allocs           += stats.allocs;
+    leak->m_stats.alloc_bytes      += stats.alloc_bytes;
+    leak->m_stats.alloc_overhead   += stats.alloc_overhead;
+    leak->m_stats.partials         += stats.partials;
+    leak->m_stats.partial_bytes    += stats.partial_bytes;
+    leak->m_stats.partial_overhead += stats.partial_overhead;
+    leak->m_stats.leaks            += stats.leaks;
+    leak->m_stats.leaked_bytes     += stats.leaked_bytes;
+    leak->m_stats.leaked_overhead  += stats.leaked_overhead;
+    lub_heap_leak_release(leak);
+    
+    
+    if(lub_heap_context_match(this,show_arg->substring))
+    {
+        result = lub_heap_context_show(this,show_arg->how);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_context_show(lub_heap_context_t *this,
+                      lub_heap_show_e     how)
+{
+    long                  frame = lub_heap_frame_count-1;
+    size_t                ok_allocs,ok_bytes,ok_overhead;
+    lub_heap_leak_stats_t stats;
+
+    lub_heap_context__get_stats(this,&stats);
+
+    ok_allocs   = stats.allocs;
+    ok_bytes    = stats.alloc_bytes;
+    ok_overhead = stats.alloc_overhead;
+    
+    ok_allocs -= stats.partials;
+    ok_allocs -= stats.leaks;
+
+    ok_bytes  -= stats.partial_bytes;
+    ok_bytes  -= stats.leaked_bytes;
+
+    ok_overhead  -= stats.partial_overhead;
+    ok_overhead  -= stats.leaked_overhead;
+
+    if(BOOL_FALSE == lub_heap_context_wanted(&stats,how))
+    {
+        /* nothing to be shown */
+        return BOOL_FALSE;
+    }
 
     /* find the top of the stack trace */
     while((frame >= 0) && (0 == this->key.backtrace[frame]))
@@ -577,22 +939,22 @@ lub_heap_context_show(lub_heap_context_t *this,
             ok_overhead);
     lub_heap_context_show_frame(this,frame--);
 
-    if(this->partials)
+    if(stats.partials)
     {
         printf("|partials |%10"SIZE_FMT"|%10"SIZE_FMT"|%10"SIZE_FMT"|%10"SIZE_FMT"|",
-                this->partials,
-                this->partial_bytes,
-                this->partials ? (this->partial_bytes/this->partials) : 0,
-                this->partial_overhead);
+                stats.partials,
+                stats.partial_bytes,
+                stats.partials ? (stats.partial_bytes/stats.partials) : 0,
+                stats.partial_overhead);
         lub_heap_context_show_frame(this,frame--);
     }
-    if(this->leaks)
+    if(stats.leaks)
     {
         printf("|leaks    |%10"SIZE_FMT"|%10"SIZE_FMT"|%10"SIZE_FMT"|%10"SIZE_FMT"|",
-                this->leaks,
-                this->leaked_bytes,
-                this->leaks ? (this->leaked_bytes/this->leaks) : 0,
-                this->leaked_overhead);
+                stats.leaks,
+                stats.leaked_bytes,
+                stats.leaks ? (stats.leaked_bytes/stats.leaks) : 0,
+                stats.leaked_overhead);
         lub_heap_context_show_frame(this,frame--);
     }
 
@@ -722,7 +1084,13 @@ lub_heap_leak_report(lub_heap_show_e how,
             }
             lub_heap_leak_release(leak);
             lub_heap_show_summary();
-            printf("  %lu stack frames held for each allocation.\n\n",lub_heap_frame_count);
+            printf("  %lu stack frames held for each allocation.\n",lub_heap_frame_count);
+            if(lub_heap_sample_interval)
+            {
+                printf("  One allocation sampled per %"SIZE_FMT" bytes; figures are estimated totals.\n",
+                       lub_heap_sample_interval);
+            }
+            printf("\n");
         }
     }
     else
@@ -732,8 +1100,122 @@ lub_heap_leak_report(lub_heap_show_e how,
     return result;
 }
 /*--------------------------------------------------------- */
+typedef struct
+{
+    lub_heap_show_e       how;
+    lub_heap_leak_stats_t totals;
+    lub_heap_writer_t     writer;
+} context_export_arg_t;
+/*--------------------------------------------------------- */
+static void
+lub_heap_leak_stats_export(lub_heap_writer_t           *writer,
+                           const lub_heap_leak_stats_t *stats)
+{
+    lub_heap_writer_field(writer,"allocs",          stats->allocs);
+    lub_heap_writer_field(writer,"alloc_bytes",     stats->alloc_bytes);
+    lub_heap_writer_field(writer,"alloc_overhead",  stats->alloc_overhead);
+    lub_heap_writer_field(writer,"partials",        stats->partials);
+    lub_heap_writer_field(writer,"partial_bytes",   stats->partial_bytes);
+    lub_heap_writer_field(writer,"partial_overhead",stats->partial_overhead);
+    lub_heap_writer_field(writer,"leaks",           stats->leaks);
+    lub_heap_writer_field(writer,"leaked_bytes",    stats->leaked_bytes);
+    lub_heap_writer_field(writer,"leaked_overhead", stats->leaked_overhead);
+}
+/*--------------------------------------------------------- */
+static bool_t
+lub_heap_context_export_fn(lub_heap_context_t *this,
+                           void               *arg)
+{
+    context_export_arg_t *export_arg = arg;
+    lub_heap_writer_t    *writer     = &export_arg->writer;
+    lub_heap_leak_stats_t stats;
+    unsigned long         frame;
 
-/*--------------------------------------------------------- 
+    lub_heap_context__get_stats(this,&stats);
+
+    /* add in the context details */
+    ++export_arg->totals.contexts;
+    export_arg->totals.allocs           += stats.allocs;
+    export_arg->totals.alloc_bytes      += stats.alloc_bytes;
+    export_arg->totals.alloc_overhead   += stats.alloc_overhead;
+    export_arg->totals.partials         += stats.partials;
+    export_arg->totals.partial_bytes    += stats.partial_bytes;
+    export_arg->totals.partial_overhead += stats.partial_overhead;
+    export_arg->totals.leaks            += stats.leaks;
+    export_arg->totals.leaked_bytes     += stats.leaked_bytes;
+    export_arg->totals.leaked_overhead  += stats.leaked_overhead;
+
+    if(BOOL_FALSE == lub_heap_context_wanted(&stats,export_arg->how))
+    {
+        return BOOL_FALSE;
+    }
+    lub_heap_writer_text(writer,"{\"type\":\"context\",\"context\":");
+    lub_heap_writer_address(writer,this);
+    lub_heap_writer_text(writer,",\"heap\":");
+    lub_heap_writer_address(writer,this->heap);
+
+    /* the return addresses, innermost first */
+    lub_heap_writer_text(writer,",\"stack\":[");
+    for(frame = 0;
+        (frame < lub_heap_frame_count) && this->key.backtrace[frame];
+        ++frame)
+    {
+        if(frame)
+        {
+            lub_heap_writer_text(writer,",");
+        }
+        lub_heap_writer_address(writer,(const void*)(unsigned long)this->key.backtrace[frame]);
+    }
+    lub_heap_writer_text(writer,"]");
+    lub_heap_leak_stats_export(writer,&stats);
+    lub_heap_writer_text(writer,"}\n");
+
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_leak_export(int             fd,
+                     lub_heap_show_e how)
+{
+    context_export_arg_t export_arg;
+
+    if(0 == lub_heap_frame_count)
+    {
+        /* leak detection is disabled */
+        return BOOL_FALSE;
+    }
+    switch(how)
+    {
+        case LUB_HEAP_SHOW_LEAKS:
+        case LUB_HEAP_SHOW_PARTIALS:
+        case LUB_HEAP_SHOW_ALL:
+        {
+            break;
+        }
+        default:
+        {
+            return BOOL_FALSE;
+        }
+    }
+    export_arg.how = how;
+    memset(&export_arg.totals,0,sizeof(export_arg.totals));
+    lub_heap_writer_init(&export_arg.writer,fd);
+
+    (void)lub_heap_foreach_context(lub_heap_context_export_fn,&export_arg);
+
+    /* the totals cover every context, whether exported or not */
+    lub_heap_writer_text(&export_arg.writer,"{\"type\":\"summary\"");
+    lub_heap_writer_field(&export_arg.writer,"contexts",export_arg.totals.contexts);
+    lub_heap_leak_stats_export(&export_arg.writer,&export_arg.totals);
+    lub_heap_writer_field(&export_arg.writer,"frames",lub_heap_frame_count);
+    lub_heap_writer_field(&export_arg.writer,"sample_interval",lub_heap_sample_interval);
+    lub_heap_writer_text(&export_arg.writer,"}\n");
+
+    return lub_heap_writer_flush(&export_arg.writer);
+}
+/*--------------------------------------------------------- */
+
+/*---------------------------------------------------------
  * PUBLIC META FUNCTIONS
  *--------------------------------------------------------- */
 void
@@ -799,6 +1281,27 @@ unsigned
     return lub_heap_frame_count;
 }
 /*--------------------------------------------------------- */
+void
+lub_heap__set_sample_interval(size_t bytes)
+{
+    if(bytes == lub_heap_sample_interval)
+        return;
+
+    /* 
+     * the existing nodes were sampled at the old rate so clear them 
+     * out; reports start afresh from this point in time
+     */
+    lub_heap_foreach_node(lub_heap_node_clear,0);
+
+    lub_heap_sample_interval = bytes;
+}
+/*--------------------------------------------------------- */
+size_t
+    lub_heap__get_sample_interval(void)
+{
+    return lub_heap_sample_interval;
+}
+/*--------------------------------------------------------- */
 size_t
     lub_heap_context__get_instanceSize(void)
 {
@@ -808,12 +1311,21 @@ size_t
 lub_heap_context_t *
 lub_heap_context_find(const stackframe_t *stack)
 {
-    lub_heap_context_t    *result;
-    lub_heap_leak_t       *leak = lub_heap_leak_instance();
-    lub_heap_context_key_t key  = *stack;
-
-    result = lub_bintree_find(&leak->m_context_tree,&key);
+    lub_heap_context_t *result;
+    lub_heap_leak_t    *leak = lub_heap_leak_instance();
 
+    /* contexts with the same backtrace are shared */
+    for(result = *lub_heap_context_bucket(leak,stack);
+        result;
+        result = result->hash_next)
+    {
+        if(0 == memcmp(result->key.backtrace,
+                       stack->backtrace,
+                       lub_heap_frame_count * sizeof(function_t*)))
+        {
+            break;
+        }
+    }
     lub_heap_leak_release(leak);
     return result;
 }
@@ -40,6 +40,10 @@ struct _lub_heap_context
      * This is needed to maintain a tree of contexts
      */
     lub_bintree_node_t bt_node;
+    /**
+     * The next context in the same hash bucket
+     */
+    lub_heap_context_t *hash_next;
     /**
      * The first node in this context
      */
@@ -88,16 +92,117 @@ struct _lub_heap_context
 
 extern unsigned long lub_heap_frame_count;
 
-typedef struct _lub_heap_leak lub_heap_leak_t;
+/*
+ * This operation captures the return addresses of up to 'max' callers,
+ * starting with the caller of this function after skipping 'skip' of them.
+ * If 'frame_end' is given it is set to the outermost stack address of
+ * the frames captured.
+ *
+ * \return the number of return addresses captured.
+ */
+extern unsigned
+    lub_heap__get_backtrace(function_t **backtrace,
+                            unsigned     skip,
+                            unsigned     max,
+                            char       **frame_end);
+extern size_t        lub_heap_sample_interval;
+
+/*
+ * Decide whether a new allocation of the specified size should be
+ * monitored; with a sample interval set, on average one allocation is
+ * chosen for each 'lub_heap_sample_interval' bytes allocated.
+ */
+extern bool_t
+    lub_heap_sample(lub_heap_t *instance,
+                    size_t      size);
+/*
+ * The number of allocations of the specified size which a single
+ * monitored allocation stands for.
+ */
+extern double
+    lub_heap_sample_weight(size_t size);
+
+/* the number of buckets used to look up contexts (a power of two) */
+#define LUB_HEAP_CONTEXT_HASH_SIZE (4096)
+
+/* the most threads which lub_heap_scan_segments_parallel() will use */
+#define LUB_HEAP_SCAN_MAX_THREADS (32)
+
+extern unsigned lub_heap_scan_threads;
+
+/*
+ * Scan the next pieces of the heap segments, up to 'budget' bytes, 
+ * using 'lub_heap_scan_threads' threads. This returns BOOL_FALSE if 
+ * the segments are left for a single thread to scan, otherwise '*done'
+ * is set to the number of bytes covered (zero once every segment has
+ * been scanned).
+ */
+extern bool_t
+    lub_heap_scan_segments_parallel(size_t  budget,
+                                    size_t *done);
+/*
+ * Release the copy of the monitored blocks which is held from one
+ * step of the scan to the next.
+ */
+extern void
+    lub_heap_scan_segments_parallel_end(void);
+
+/* the number of bytes scanned by each step of lub_heap_scan_all() */
+#define LUB_HEAP_SCAN_STEP_SIZE (1024 * 1024)
+
+typedef enum
+{
+    LUB_HEAP_SCAN_IDLE,     /* no scan in progress               */
+    LUB_HEAP_SCAN_ROOTS,    /* stacks, BSS and DATA still to do  */
+    LUB_HEAP_SCAN_SEGMENTS, /* working through the heap segments */
+    LUB_HEAP_SCAN_NODES,    /* following the referenced nodes    */
+    LUB_HEAP_SCAN_RESCAN    /* segments added during the scan    */
+} lub_heap_scan_phase_e;
+
+/*
+ * Where an incremental leak scan has got to. 
+ *
+ * No segment is taken away from a heap while a scan is under way and
+ * new ones are only added to the front of the list, so the scan can 
+ * hold its place by pointer. The segments added since the scan started
+ * are marked with its generation so they can be looked at before it 
+ * finishes.
+ */
+typedef struct _lub_heap_scan lub_heap_scan_t;
+struct _lub_heap_scan
+{
+    lub_heap_scan_phase_e  phase;
+    unsigned               generation; /* counts the scans started        */
+    lub_heap_t            *heap;       /* the heap being scanned          */
+    lub_heap_segment_t    *segment;    /* the segment being scanned       */
+    size_t                 offset;     /* how far into the segment        */
+    bool_t                 rescanned;  /* the roots have been seen again  */
+    const lub_heap_node_t *last;       /* the last node looked at this pass */
+    size_t                 found;      /* nodes scanned during this pass  */
+    size_t                 released;   /* monitored blocks released       */
+};
+
+/*
+ * Reserve the next piece of the heap segments to scan, of no more than 
+ * 'budget' bytes, returning its size or zero once every segment has 
+ * been covered. The leak lock must be held.
+ */
+extern size_t
+    lub_heap_scan_next_piece(lub_heap_leak_t *leak,
+                             size_t           budget,
+                             const char     **memory);
+
 struct _lub_heap_leak
 {
     lub_bintree_t         m_context_tree;
+    lub_heap_context_t   *m_context_hash[LUB_HEAP_CONTEXT_HASH_SIZE];
     lub_bintree_t         m_node_tree;
     lub_bintree_t         m_clear_node_tree;
     lub_bintree_t         m_segment_tree;
     lub_heap_leak_stats_t m_stats;
     lub_dblockpool_t      m_context_pool;
     lub_heap_t           *m_heap_list;
+    lub_heap_scan_t       m_scan;
 };
 
 extern lub_heap_leak_t *
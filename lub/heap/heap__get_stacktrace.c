@@ -1,54 +1,218 @@
 /*
  * Generic stacktrace function
+ *
+ * The call chain is followed through the saved frame pointers, which is
+ * quick, when the program keeps them. Otherwise the unwind tables are
+ * used to step from frame to frame.
  */
 #ifdef __GNUC__
 #include <string.h>
+#include <unwind.h>
 
 #include "private.h"
 #include "context.h"
 
+#if defined(__i386__) || defined(__x86_64__) || defined(__aarch64__)
+/* the saved frame pointer is followed by the return address */
+#define LUB_HEAP_FRAME_POINTERS
+#endif /* frame layout */
+
+/* a frame larger than this is taken to be a corrupt frame pointer */
+#define LUB_HEAP_MAX_FRAME_SIZE (100000)
+
+typedef enum
+{
+    LUB_HEAP_WALK_UNKNOWN,
+    LUB_HEAP_WALK_FRAME_POINTERS,
+    LUB_HEAP_WALK_UNWIND
+} lub_heap_walk_e;
+
+static lub_heap_walk_e lub_heap_walk_method = LUB_HEAP_WALK_UNKNOWN;
+
+typedef struct
+{
+    function_t **backtrace;
+    unsigned     skip;
+    unsigned     max;
+    unsigned     count;
+    char        *frame_end;
+} lub_heap_unwind_arg_t;
+
+/*--------------------------------------------------------- */
+static _Unwind_Reason_Code
+lub_heap_unwind_fn(struct _Unwind_Context *context,
+                   void                   *arg)
+{
+    lub_heap_unwind_arg_t *this = arg;
+    _Unwind_Ptr            ip   = _Unwind_GetIP(context);
+
+    if(0 == ip)
+    {
+        return _URC_END_OF_STACK;
+    }
+    if(this->skip)
+    {
+        --this->skip;
+        return _URC_NO_REASON;
+    }
+    if(this->count >= this->max)
+    {
+        return _URC_END_OF_STACK;
+    }
+    this->backtrace[this->count++] = (function_t*)ip;
+    this->frame_end                = (char*)_Unwind_GetCFA(context);
+
+    return _URC_NO_REASON;
+}
+/*--------------------------------------------------------- */
+static unsigned __attribute__((noinline))
+lub_heap_walk_unwind(function_t **backtrace,
+                     unsigned     skip,
+                     unsigned     max,
+                     char       **frame_end)
+{
+    lub_heap_unwind_arg_t arg;
+
+    /*
+     * the first frame reported is this one and the next is its caller;
+     * skip both to start at the caller of lub_heap__get_backtrace()
+     */
+    arg.backtrace = backtrace;
+    arg.skip      = skip + 2;
+    arg.max       = max;
+    arg.count     = 0;
+    arg.frame_end = 0;
+    (void)_Unwind_Backtrace(lub_heap_unwind_fn,&arg);
+
+    *frame_end = arg.frame_end;
+    return arg.count;
+}
+/*--------------------------------------------------------- */
+#ifdef LUB_HEAP_FRAME_POINTERS
+static unsigned __attribute__((noinline))
+lub_heap_walk_frame_pointers(function_t **backtrace,
+                             unsigned     skip,
+                             unsigned     max,
+                             char       **frame_end)
+{
+    void   **fp    = __builtin_frame_address(0);
+    unsigned count = 0;
+
+    while(count < max)
+    {
+        void **next = fp[0];
+        void  *ra;
+
+        /* the caller's frame must be further up the stack and nearby */
+        if(  (next <= fp)
+           || ((char*)next - (char*)fp > LUB_HEAP_MAX_FRAME_SIZE)
+           || ((unsigned long)next & (sizeof(void*) - 1)))
+        {
+            break;
+        }
+        fp = next;
+
+        /* where the function owning this frame returns to */
+        ra = fp[1];
+        if(0 == ra)
+        {
+            break;
+        }
+        if(skip)
+        {
+            --skip;
+        }
+        else
+        {
+            backtrace[count++] = (function_t*)(unsigned long)ra;
+            *frame_end         = (char*)&fp[2];
+        }
+    }
+    return count;
+}
+#endif /* LUB_HEAP_FRAME_POINTERS */
+/*--------------------------------------------------------- */
+#ifdef LUB_HEAP_FRAME_POINTERS
+/*
+ * Frame pointers can only be trusted if the whole program keeps them;
+ * check once that following them gives the same callers as unwinding.
+ */
+static lub_heap_walk_e __attribute__((noinline))
+lub_heap_walk_choose(void)
+{
+    function_t *fp_trace[4],*uw_trace[4];
+    char       *end;
+    unsigned    fp_count,uw_count,i;
+
+    fp_count = lub_heap_walk_frame_pointers(fp_trace,0,4,&end);
+    uw_count = lub_heap_walk_unwind(uw_trace,0,4,&end);
+
+    if(uw_count && (fp_count == uw_count))
+    {
+        for(i = 0; i < fp_count; ++i)
+        {
+            if(fp_trace[i] != uw_trace[i])
+            {
+                break;
+            }
+        }
+        if(i == fp_count)
+        {
+            return LUB_HEAP_WALK_FRAME_POINTERS;
+        }
+    }
+    return LUB_HEAP_WALK_UNWIND;
+}
+#endif /* LUB_HEAP_FRAME_POINTERS */
 /*--------------------------------------------------------- */
-void
+unsigned __attribute__((noinline))
+lub_heap__get_backtrace(function_t **backtrace,
+                        unsigned     skip,
+                        unsigned     max,
+                        char       **frame_end)
+{
+    char    *end = 0;
+    unsigned result;
+
+#ifdef LUB_HEAP_FRAME_POINTERS
+    if(LUB_HEAP_WALK_UNKNOWN == lub_heap_walk_method)
+    {
+        lub_heap_walk_method = lub_heap_walk_choose();
+    }
+    if(LUB_HEAP_WALK_FRAME_POINTERS == lub_heap_walk_method)
+    {
+        result = lub_heap_walk_frame_pointers(backtrace,skip,max,&end);
+    }
+    else
+#endif /* LUB_HEAP_FRAME_POINTERS */
+    {
+        result = lub_heap_walk_unwind(backtrace,skip,max,&end);
+    }
+    if(frame_end)
+    {
+        *frame_end = end;
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+void __attribute__((noinline))
 lub_heap__get_stackframe(stackframe_t *stack,
                          unsigned      max)
 {
-#define GET_RETURN_ADDRESS(n)                                                       \
-    {                                                                               \
-        if(n < max)                                                                 \
-        {                                                                           \
-            unsigned long fn = (unsigned long)__builtin_return_address(n+2);        \
-            if(!fn || (fn > (unsigned long)lub_heap_data_end))                      \
-            {                                                                       \
-                break;                                                              \
-            }                                                                       \
-            stack->backtrace[n] = (function_t*)fn;                                  \
-        }                                                                           \
-        else                                                                        \
-        {                                                                           \
-            break;                                                                  \
-        }                                                                           \
-    }                                                                               \
-
-    memset(stack,0,sizeof(*stack));
-    do
-    {
-        GET_RETURN_ADDRESS(0);
-        GET_RETURN_ADDRESS(1);
-        GET_RETURN_ADDRESS(2);
-        GET_RETURN_ADDRESS(3);
-        GET_RETURN_ADDRESS(4);
-        GET_RETURN_ADDRESS(5);
-        GET_RETURN_ADDRESS(6);
-        GET_RETURN_ADDRESS(7);
-        GET_RETURN_ADDRESS(8);
-        GET_RETURN_ADDRESS(9);
-        GET_RETURN_ADDRESS(10);
-        GET_RETURN_ADDRESS(11);
-        GET_RETURN_ADDRESS(12);
-        GET_RETURN_ADDRESS(13);
-        GET_RETURN_ADDRESS(14);
-        GET_RETURN_ADDRESS(15);
-    } while(0);
+    unsigned count;
+
+    if(max > MAX_BACKTRACE)
+    {
+        max = MAX_BACKTRACE;
+    }
+    /*
+     * skip this function, the leak detector and lub_heap_realloc()
+     * to start at the client of the heap
+     */
+    count = lub_heap__get_backtrace(stack->backtrace,3,max,0);
+
+    /* clear out the unused frames */
+    memset(&stack->backtrace[count],0,(MAX_BACKTRACE - count) * sizeof(function_t*));
 }
 /*--------------------------------------------------------- */
 #else /* not __GNUC__ */
@@ -1,9 +1,14 @@
-#include "private.h"
+#include "cache.h"
 /*--------------------------------------------------------- */
 void 
 lub_heap__get_stats(lub_heap_t       *this,
                     lub_heap_stats_t *stats)
 {
     *stats = this->stats;
+    if(this->cache)
+    {
+        /* add the number of size classes and the misses */
+        lub_heap_cache__get_class_stats(this->cache,stats);
+    }
 }
 /*--------------------------------------------------------- */
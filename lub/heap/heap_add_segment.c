@@ -76,17 +76,28 @@ lub_heap_add_segment(lub_heap_t *this,
                      size_t      size)
 {
     lub_heap_segment_t *segment;
+    lub_heap_leak_t    *leak;
     
+    lub_heap_segment_meta_init();
+
     /* check for simple adjacent segment as produced by sbrk() type behaviour */
     if(this->first_segment.words)
     {
         lub_heap_tag_t *tail;
         char           *ptr = (char*)&this[1];
         ptr += (this->first_segment.words << 2);
-        if(ptr == start)
+
+        leak = lub_heap_leak_instance();
+        /* 
+         * a leak scan may already have gone past the end of the first 
+         * segment, in which case this is added as a segment of its own
+         */
+        if((ptr == start) && (LUB_HEAP_SCAN_IDLE == leak->m_scan.phase))
         {
             /* simply extend the current first segment */
             this->first_segment.words += (size >> 2);
+            lub_heap_leak_release(leak);
+
             tail          = &((lub_heap_tag_t*)start)[-1];
             tail->segment = BOOL_FALSE; /* no longer last block in segment */
             /* convert the new memory into a free block... */
@@ -98,6 +109,7 @@ lub_heap_add_segment(lub_heap_t *this,
 
             return;
         }
+        lub_heap_leak_release(leak);
     }
     /* adjust the size which can be used */
     size -= sizeof(lub_heap_segment_t);
@@ -110,23 +122,23 @@ lub_heap_add_segment(lub_heap_t *this,
     this->stats.segs_bytes    += size;
     this->stats.segs_overhead += sizeof(lub_heap_segment_t);
     
-    if(segment != &this->first_segment)
-    {
-        /* maintain the list of segments */
-        segment->next = this->first_segment.next;
-        this->first_segment.next = segment;
-    }
     segment->words = (size >> 2);
     
     lub_heap_init_free_block(this,&segment[1],size,BOOL_TRUE,BOOL_TRUE);
     
-    /* add this segment to the tree */
-    lub_heap_segment_meta_init();
     lub_bintree_node_init(&segment->bt_node);
+
+    /* a leak scan walks the segments under the lock */
+    leak = lub_heap_leak_instance();
+    segment->generation = leak->m_scan.generation;
+    if(segment != &this->first_segment)
     {
-        lub_heap_leak_t *leak = lub_heap_leak_instance();
-        lub_bintree_insert(&leak->m_segment_tree,segment);
-        lub_heap_leak_release(leak);
+        /* maintain the list of segments */
+        segment->next = this->first_segment.next;
+        this->first_segment.next = segment;
     }
+    /* add this segment to the tree */
+    lub_bintree_insert(&leak->m_segment_tree,segment);
+    lub_heap_leak_release(leak);
 }
 /*--------------------------------------------------------- */
@@ -109,7 +109,7 @@ lub_heap_align_block(lub_heap_t      *this,
          */
         assert(leading_bytes >= (sizeof(lub_heap_free_block_t) + sizeof(lub_heap_node_t)));
 
-        if((0 < lub_heap_frame_count) && (0 == this->suppress))
+        if((0 < lub_heap_frame_count) && (0 == this->suppress) && this->sampled)
         {
             /* 
              * If leak detection is enabled then offset the pointer back by the size of 
@@ -4,12 +4,13 @@
 bool_t
 lub_heap_context_delete(lub_heap_context_t *context)
 {
-    lub_heap_leak_t *leak = lub_heap_leak_instance();
+    lub_heap_leak_t *leak;
     
-    /* finalise the instance */
+    /* finalise the instance (this takes the leak lock itself) */
     lub_heap_context_fini(context);
 
     /* release the memory */
+    leak = lub_heap_leak_instance();
     lub_dblockpool_free(&leak->m_context_pool,context);
     lub_heap_leak_release(leak);
     
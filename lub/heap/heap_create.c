@@ -1,7 +1,7 @@
 /*
  * heap_create.c
  */
-#include "private.h"
+#include "tlsf.h"
 #include "context.h"
 
 /*--------------------------------------------------------- */
@@ -23,23 +23,51 @@ lub_heap_block_compare(const void *clientnode,
 }
 /*--------------------------------------------------------- */
 lub_heap_t *
-lub_heap_create(void  *start,
-                size_t size)
+lub_heap_create_indexed(void            *start,
+                        size_t           size,
+                        lub_heap_index_e index)
 {
-    lub_heap_t *this = NULL;
+    lub_heap_t      *this = NULL;
+    lub_heap_tlsf_t *tlsf = NULL;
+    size_t           overhead = 0;
     
+    if(LUB_HEAP_INDEX_TLSF == index)
+    {
+        if(size <= lub_heap_index_overhead_size(index))
+        {
+            return NULL;
+        }
+        /* take the segregated lists from the end of the segment */
+        tlsf = (lub_heap_tlsf_t*)((((size_t)start + size - sizeof(lub_heap_tlsf_t))) 
+                                  & ~(sizeof(void*) - 1));
+        overhead = ((char*)start + size) - (char*)tlsf;
+        size    -= overhead;
+    }
     /* we must have at least 1024 bytes for a heap */
     if(size > (sizeof(lub_heap_t) + 4))
     {
         this = start;
         /* set up the binary tree for the free blocks */
         lub_bintree_init(&this->free_tree,
-                         offsetof(lub_heap_free_block_t,bt_node),
+                         offsetof(lub_heap_free_block_t,index.bt_node),
                          lub_heap_block_compare,
                          lub_heap_block_getkey);
+        this->tlsf = tlsf;
+        if(tlsf)
+        {
+            lub_heap_tlsf_init(tlsf);
+        }
 
         this->cache    = 0;
         this->suppress = 0;
+
+        /* each heap draws its own sampling thresholds */
+        this->sample_countdown = 0;
+        this->sample_seed      = (unsigned long)this;
+        this->sampled          = BOOL_FALSE;
+
+        /* this heap counts allocations by site for its whole life */
+        this->sites = lub_heap_site_stats;
         
         /* initialise the statistics */
         this->stats.segs                    = 0;
@@ -62,6 +90,8 @@ lub_heap_create(void  *start,
         this->stats.free_hightide_overhead  = 0;
         this->stats.alloc_total_blocks      = 0;
         this->stats.alloc_total_bytes       = 0;
+        this->stats.cache_classes           = 0;
+        this->stats.cache_misses            = 0;
                 
         /* initialise the first segment */
         this->first_segment.next = NULL;
@@ -71,7 +101,7 @@ lub_heap_create(void  *start,
                              &this->first_segment, 
                              size - sizeof(lub_heap_t) + sizeof(lub_heap_segment_t));
         
-        this->stats.segs_overhead += sizeof(lub_heap_t);
+        this->stats.segs_overhead += sizeof(lub_heap_t) + overhead;
                             
         /* add this heap to the linked list of heaps in the system */
         {
@@ -84,3 +114,16 @@ lub_heap_create(void  *start,
     return this;
 }
 /*--------------------------------------------------------- */
+size_t
+lub_heap_index_overhead_size(lub_heap_index_e index)
+{
+    return (LUB_HEAP_INDEX_TLSF == index) ? sizeof(lub_heap_tlsf_t) : 0;
+}
+/*--------------------------------------------------------- */
+lub_heap_t *
+lub_heap_create(void  *start,
+                size_t size)
+{
+    return lub_heap_create_indexed(start,size,LUB_HEAP_INDEX_TREE);
+}
+/*--------------------------------------------------------- */
@@ -30,10 +30,15 @@ _lub_heap_node_remove(lub_heap_node_t *node,
     {
         --leak->m_stats.allocs;
         leak->m_stats.alloc_bytes -= lub_heap_node__get_size(node);
-        /* remove this node from the leak tree */
+        lub_heap_leak_release(leak);
+
+        /* remove this node from the leak tree (this takes the lock itself) */
         lub_heap_node_fini(node);
     }
-    lub_heap_leak_release(leak);
+    else
+    {
+        lub_heap_leak_release(leak);
+    }
 }
 /*--------------------------------------------------------- */
 void
@@ -0,0 +1,76 @@
+/*
+ * heap_export.c
+ */
+#include "private.h"
+
+typedef struct
+{
+    lub_heap_writer_t *writer;
+    bool_t             first;
+} lub_heap_export_arg_t;
+
+/*--------------------------------------------------------- */
+static void
+lub_heap_export_class(const lub_heap_cache_class_stats_t *class_stats,
+                      void                               *arg)
+{
+    lub_heap_export_arg_t *export = arg;
+    lub_heap_writer_t     *writer = export->writer;
+
+    lub_heap_writer_text(writer,export->first ? "{" : ",{");
+    lub_heap_writer_text(writer,"\"block_size\":");
+    lub_heap_writer_number(writer,class_stats->block_size);
+    lub_heap_writer_field(writer,"num_blocks",class_stats->num_blocks);
+    lub_heap_writer_field(writer,"hits",      class_stats->hits);
+    lub_heap_writer_field(writer,"misses",    class_stats->misses);
+    lub_heap_writer_text(writer,"}");
+
+    export->first = BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_export(lub_heap_t *this,
+                int         fd)
+{
+    lub_heap_writer_t     writer;
+    lub_heap_stats_t      stats;
+    lub_heap_export_arg_t export;
+
+    lub_heap__get_stats(this,&stats);
+
+    lub_heap_writer_init(&writer,fd);
+    lub_heap_writer_text(&writer,"{\"type\":\"heap\",\"heap\":");
+    lub_heap_writer_address(&writer,this);
+    lub_heap_writer_field(&writer,"segs",                   stats.segs);
+    lub_heap_writer_field(&writer,"segs_bytes",             stats.segs_bytes);
+    lub_heap_writer_field(&writer,"segs_overhead",          stats.segs_overhead);
+    lub_heap_writer_field(&writer,"free_blocks",            stats.free_blocks);
+    lub_heap_writer_field(&writer,"free_bytes",             stats.free_bytes);
+    lub_heap_writer_field(&writer,"free_overhead",          stats.free_overhead);
+    lub_heap_writer_field(&writer,"max_free",               lub_heap__get_max_free(this));
+    lub_heap_writer_field(&writer,"alloc_blocks",           stats.alloc_blocks);
+    lub_heap_writer_field(&writer,"alloc_bytes",            stats.alloc_bytes);
+    lub_heap_writer_field(&writer,"alloc_overhead",         stats.alloc_overhead);
+    lub_heap_writer_field(&writer,"alloc_total_blocks",     stats.alloc_total_blocks);
+    lub_heap_writer_field(&writer,"alloc_total_bytes",      stats.alloc_total_bytes);
+    lub_heap_writer_field(&writer,"alloc_hightide_blocks",  stats.alloc_hightide_blocks);
+    lub_heap_writer_field(&writer,"alloc_hightide_bytes",   stats.alloc_hightide_bytes);
+    lub_heap_writer_field(&writer,"alloc_hightide_overhead",stats.alloc_hightide_overhead);
+    lub_heap_writer_field(&writer,"free_hightide_blocks",   stats.free_hightide_blocks);
+    lub_heap_writer_field(&writer,"free_hightide_bytes",    stats.free_hightide_bytes);
+    lub_heap_writer_field(&writer,"free_hightide_overhead", stats.free_hightide_overhead);
+    lub_heap_writer_field(&writer,"static_blocks",          stats.static_blocks);
+    lub_heap_writer_field(&writer,"static_bytes",           stats.static_bytes);
+    lub_heap_writer_field(&writer,"static_overhead",        stats.static_overhead);
+    lub_heap_writer_field(&writer,"cache_misses",           stats.cache_misses);
+
+    /* one entry for each size class in the cache */
+    lub_heap_writer_text(&writer,",\"cache\":[");
+    export.writer = &writer;
+    export.first  = BOOL_TRUE;
+    lub_heap_foreach_cache_class(this,lub_heap_export_class,&export);
+    lub_heap_writer_text(&writer,"]}\n");
+
+    return lub_heap_writer_flush(&writer);
+}
+/*--------------------------------------------------------- */
@@ -22,7 +22,7 @@ lub_heap_extend_downwards(lub_heap_t        *this,
             words_t delta = words - block->alloc.tag.words;
     
             /* remove the block from the tree */
-            lub_bintree_remove(&this->free_tree,prev_block);
+            lub_heap_free_index_remove(this,prev_block);
             
             /* remember the segment status */
             segment = prev_block->tag.segment;
@@ -33,7 +33,7 @@ lub_heap_extend_downwards(lub_heap_t        *this,
             if(NULL != prev_block)
             {
                 /* put the modified free block back into the tree */
-                lub_bintree_insert(&this->free_tree,prev_block);
+                lub_heap_free_index_insert(this,prev_block);
                 
                 /* there is still a block below us */
                 segment = 0;
@@ -22,7 +22,7 @@ lub_heap_extend_upwards(lub_heap_t        *this,
             words -= block->alloc.tag.words;
             
             /* remove the block from the tree */
-            lub_bintree_remove(&this->free_tree,next_block);
+            lub_heap_free_index_remove(this,next_block);
             
             /* remember the segment status of the next block */
             segment = tail->segment;
@@ -33,7 +33,7 @@ lub_heap_extend_upwards(lub_heap_t        *this,
             if(NULL != next_block)
             {
                 /* put the modified free block back into the tree */
-                lub_bintree_insert(&this->free_tree,next_block);
+                lub_heap_free_index_insert(this,next_block);
 
                 /* there is still a block above us */
                 segment = 0;
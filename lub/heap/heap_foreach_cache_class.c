@@ -0,0 +1,16 @@
+/*
+ * heap_foreach_cache_class.c
+ */
+#include "cache.h"
+/*--------------------------------------------------------- */
+void
+lub_heap_foreach_cache_class(lub_heap_t                      *this,
+                             lub_heap_foreach_cache_class_fn *fn,
+                             void                            *arg)
+{
+    if(this->cache)
+    {
+        lub_heap_cache_foreach_class(this->cache,fn,arg);
+    }
+}
+/*--------------------------------------------------------- */
@@ -8,18 +8,17 @@ lub_heap_foreach_free_block(lub_heap_t          *this,
                             lub_heap_foreach_fn *fn,
                             void                *arg)
 {
-    lub_heap_block_t      *block = lub_bintree_findfirst(&this->free_tree);
-    lub_bintree_iterator_t iter;
+    lub_heap_free_block_t *block;
     unsigned int           i = 1;
     
-    for(lub_bintree_iterator_init(&iter,&this->free_tree,block);
+    for(block = lub_heap_free_index_first(this,0);
         block;
-        block = lub_bintree_iterator_next(&iter))
+        block = lub_heap_free_index_next(this,block))
     {
         /* call the client function */
-        fn(&block->free,
+        fn(block,
            i++,
-           (block->free.tag.words << 2) - sizeof(lub_heap_alloc_block_t),
+           (block->tag.words << 2) - sizeof(lub_heap_alloc_block_t),
            arg);        
     }
 }
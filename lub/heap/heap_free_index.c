@@ -0,0 +1,110 @@
+/*
+ * heap_free_index.c
+ */
+#include "tlsf.h"
+
+/*--------------------------------------------------------- */
+void
+lub_heap_free_index_insert(lub_heap_t            *this,
+                           lub_heap_free_block_t *block)
+{
+    if(this->tlsf)
+    {
+        lub_heap_tlsf_insert(this->tlsf,block);
+    }
+    else
+    {
+        lub_bintree_insert(&this->free_tree,block);
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_free_index_remove(lub_heap_t            *this,
+                           lub_heap_free_block_t *block)
+{
+    if(this->tlsf)
+    {
+        lub_heap_tlsf_remove(this->tlsf,block);
+    }
+    else
+    {
+        lub_bintree_remove(&this->free_tree,block);
+    }
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_free_index_find(lub_heap_t *this,
+                         words_t     words)
+{
+    lub_heap_free_block_t *result;
+
+    if(this->tlsf)
+    {
+        /* a good fit, found in constant time */
+        result = lub_heap_tlsf_find(this->tlsf,words);
+    }
+    else
+    {
+        /* the smallest free block which can take this request */
+        result = lub_heap_free_index_first(this,words);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_free_index_first(lub_heap_t *this,
+                          words_t     words)
+{
+    lub_heap_free_block_t *result;
+
+    if(this->tlsf)
+    {
+        result = lub_heap_tlsf_first(this->tlsf,words);
+    }
+    else
+    {
+        lub_heap_key_t key;
+
+        key.words = words;
+        key.block = 0;
+        result = lub_bintree_findnext(&this->free_tree,&key);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_free_index_next(lub_heap_t            *this,
+                         lub_heap_free_block_t *block)
+{
+    lub_heap_free_block_t *result;
+
+    if(this->tlsf)
+    {
+        result = lub_heap_tlsf_next(this->tlsf,block);
+    }
+    else
+    {
+        lub_heap_key_t key;
+
+        lub_heap_block_getkey(block,(lub_bintree_key_t*)&key);
+        result = lub_bintree_findnext(&this->free_tree,&key);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_free_index_last(lub_heap_t *this)
+{
+    lub_heap_free_block_t *result;
+
+    if(this->tlsf)
+    {
+        result = lub_heap_tlsf_last(this->tlsf);
+    }
+    else
+    {
+        result = lub_bintree_findlast(&this->free_tree);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
@@ -18,7 +18,7 @@ lub_heap_graft_to_bottom(lub_heap_t       *this,
     assert(1 == free_block->free.tag.free);
 
     /* remove the previous block from the free tree */
-    lub_bintree_remove(&this->free_tree,free_block);
+    lub_heap_free_index_remove(this,&free_block->free);
 
     /* update the size of the next block */
     this->stats.free_bytes += (words << 2);
@@ -48,7 +48,7 @@ lub_heap_graft_to_bottom(lub_heap_t       *this,
     free_block->free.tag.free    = 1;
     free_block->free.tag.words   = new_words;
     free_block->free.tag.segment = seg_start;
-    lub_bintree_node_init(&free_block->free.bt_node);
+    lub_bintree_node_init(&free_block->free.index.bt_node);
 
     /* and update the tail */
     tail->free    = 1;
@@ -56,6 +56,6 @@ lub_heap_graft_to_bottom(lub_heap_t       *this,
     tail->segment = seg_end;
 
     /* insert back into the tree */
-    lub_bintree_insert(&this->free_tree,free_block);
+    lub_heap_free_index_insert(this,&free_block->free);
 }
 /*--------------------------------------------------------- */
@@ -16,7 +16,7 @@ lub_heap_graft_to_top(lub_heap_t       *this,
     assert(1 == free_block->free.tag.free);
 
     /* remove the previous block from the free tree */
-    lub_bintree_remove(&this->free_tree,free_block);
+    lub_heap_free_index_remove(this,&free_block->free);
 
     if(BOOL_FALSE == other_free_block)
     {
@@ -51,6 +51,6 @@ lub_heap_graft_to_top(lub_heap_t       *this,
     tail->words = free_block->free.tag.words;
 
     /* insert back into the tree */
-    lub_bintree_insert(&this->free_tree,free_block);
+    lub_heap_free_index_insert(this,&free_block->free);
 }
 /*--------------------------------------------------------- */
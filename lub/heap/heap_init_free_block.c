@@ -24,7 +24,7 @@ lub_heap_init_free_block(lub_heap_t *this,
     block->tag.words   = words;
     
     /* initialise the tree node */
-    lub_bintree_node_init(&block->bt_node);
+    lub_bintree_node_init(&block->index.bt_node);
     
     /* now fill out the trailing tag */
     tail          = lub_heap_block__get_tail((lub_heap_block_t*)block);
@@ -33,7 +33,7 @@ lub_heap_init_free_block(lub_heap_t *this,
     tail->words   = words;
 
     /* now insert this free block into the tree */
-    lub_bintree_insert(&this->free_tree,block);
+    lub_heap_free_index_insert(this,block);
 
     ++this->stats.free_blocks;
     this->stats.free_bytes    += (words << 2);
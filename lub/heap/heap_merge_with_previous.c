@@ -27,7 +27,7 @@ lub_heap_merge_with_previous(lub_heap_t       *this,
             if(1 == block->free.tag.free)
             {
                 /* remove this free block from the tree */
-                lub_bintree_remove(&this->free_tree,block);
+                lub_heap_free_index_remove(this,&block->free);
                 --this->stats.free_blocks;
                 this->stats.free_bytes    -= (block->free.tag.words << 2);
                 this->stats.free_bytes    += sizeof(lub_heap_alloc_block_t);
@@ -8,14 +8,9 @@ lub_heap_new_alloc_block(lub_heap_t *this,
     void                  *result = NULL;
     lub_heap_free_block_t *free_block;
     lub_heap_block_t      *new_block;
-    lub_heap_key_t         key;
         
-    /* initialise the seach key */
-    key.words = words;
-    key.block = 0;
-
-    /* find the smallest free block which can take this request */
-    free_block = lub_bintree_findnext(&this->free_tree,&key);
+    /* find a free block which can take this request */
+    free_block = lub_heap_free_index_find(this,words);
     if(NULL != free_block)
     {
         lub_heap_tag_t *tail;
@@ -27,7 +22,7 @@ lub_heap_new_alloc_block(lub_heap_t *this,
         seg_end   = tail->segment;
 
         /* remove the block from the free tree */
-        lub_bintree_remove(&this->free_tree,free_block);
+        lub_heap_free_index_remove(this,free_block);
 
         /* now slice the bottom off for the client */
         new_block = lub_heap_slice_from_bottom(this,&free_block,&words,BOOL_FALSE);
@@ -35,7 +30,7 @@ lub_heap_new_alloc_block(lub_heap_t *this,
         if(NULL != free_block)
         {
             /* put the block back into the tree */
-            lub_bintree_insert(&this->free_tree,free_block);
+            lub_heap_free_index_insert(this,free_block);
         }
         if(NULL != new_block)
         {
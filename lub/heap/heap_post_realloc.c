@@ -9,7 +9,7 @@ lub_heap_post_realloc(lub_heap_t        *this,
                       char             **ptr)
 {
     /* only act if we are about to re-enable the monitoring */
-    if((0 < lub_heap_frame_count) && ( 2 > this->suppress))
+    if((0 < lub_heap_frame_count) && ( 2 > this->suppress) && this->sampled)
     {
         if(NULL != *ptr)
         {
@@ -12,6 +12,8 @@ lub_heap_pre_realloc(lub_heap_t *this,
                      char      **ptr,
                      size_t     *size)
 {
+    bool_t monitored = BOOL_FALSE;
+
     if(*ptr)
     {
         /* is this a pointer to a node in the "leak" trees? */
@@ -21,12 +23,25 @@ lub_heap_pre_realloc(lub_heap_t *this,
             lub_heap_node_fini(node);
              /* move the pointer to the start of the block */
             *ptr = (char*)node;
+            monitored = BOOL_TRUE;
         }
     }
+    this->sampled = BOOL_FALSE;
     if((0 < lub_heap_frame_count))
     {
         size_t old_size = *size;
-        if(old_size)
+
+        if(monitored || (0 == lub_heap_sample_interval))
+        {
+            /* a block keeps its node for as long as it lives */
+            this->sampled = BOOL_TRUE;
+        }
+        else if(NULL == *ptr)
+        {
+            /* only some new allocations are monitored */
+            this->sampled = lub_heap_sample(this,old_size);
+        }
+        if(old_size && this->sampled)
         {
             /* allocate enough bytes for a node */
             *size += lub_heap_node__get_instanceSize();
@@ -3,19 +3,32 @@
 
 #include "cache.h"
 
+#ifdef __GNUC__
+/* the return address of the current function */
+#define LUB_HEAP_CALLER() __builtin_return_address(0)
+#else /* not __GNUC__ */
+#define LUB_HEAP_CALLER() 0
+#endif /* not __GNUC__ */
+
 /*--------------------------------------------------------- */
-lub_heap_status_t
-lub_heap_realloc(lub_heap_t      *this,
-                 char           **ptr,
-                 size_t           requested_size,
-                 lub_heap_align_t alignment)
+static lub_heap_status_t
+lub_heap_realloc_site(lub_heap_t      *this,
+                      char           **ptr,
+                      size_t           requested_size,
+                      lub_heap_align_t alignment,
+                      const void      *caller,
+                      bool_t           counted)
 {
-    lub_heap_status_t status   = LUB_HEAP_FAILED;
-    size_t            size     = requested_size;
+    lub_heap_status_t   status   = LUB_HEAP_FAILED;
+    size_t              size     = requested_size;
+    lub_heap_site_tag_t site_tag;
     
     /* opportunity for leak detection to do it's stuff */
     lub_heap_pre_realloc(this,ptr,&size);
 
+    /* and for the allocation site counts */
+    lub_heap_site_pre_realloc(this,*ptr,&size,&site_tag);
+
     if(this->cache && (LUB_HEAP_ALIGN_NATIVE == alignment))
     {
         /* try and get the memory from the cache */
@@ -27,6 +40,8 @@ lub_heap_realloc(lub_heap_t      *this,
         status = lub_heap_raw_realloc(this,ptr,size,alignment);
     }
     
+    lub_heap_site_post_realloc(this,*ptr,requested_size,status,&site_tag,caller,counted);
+
     /* opportunity for leak detection to do it's stuff */
     lub_heap_post_realloc(this,ptr);
     
@@ -57,3 +72,33 @@ lub_heap_realloc(lub_heap_t      *this,
     return status;
 }
 /*--------------------------------------------------------- */
+lub_heap_status_t
+lub_heap_realloc(lub_heap_t      *this,
+                 char           **ptr,
+                 size_t           requested_size,
+                 lub_heap_align_t alignment)
+{
+    const void *caller = 0;
+
+    if(this->sites)
+    {
+        caller = lub_heap_site_caller(LUB_HEAP_CALLER());
+    }
+    return lub_heap_realloc_site(this,ptr,requested_size,alignment,caller,BOOL_TRUE);
+}
+/*--------------------------------------------------------- */
+lub_heap_status_t
+lub_heap_realloc_by_site(lub_heap_t      *this,
+                         char           **ptr,
+                         size_t           requested_size,
+                         lub_heap_align_t alignment,
+                         const void      *caller)
+{
+    return lub_heap_realloc_site(this,
+                                 ptr,
+                                 requested_size,
+                                 alignment,
+                                 caller,
+                                 caller ? BOOL_TRUE : BOOL_FALSE);
+}
+/*--------------------------------------------------------- */
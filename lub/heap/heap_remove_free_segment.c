@@ -0,0 +1,57 @@
+/*
+ * heap_remove_free_segment.c
+ */
+#include "private.h"
+#include "context.h"
+
+/*--------------------------------------------------------- */
+void *
+lub_heap_remove_free_segment(lub_heap_t *this,
+                             size_t     *size)
+{
+    lub_heap_segment_t **ptr;
+    lub_heap_leak_t     *leak = lub_heap_leak_instance();
+
+    if(LUB_HEAP_SCAN_IDLE != leak->m_scan.phase)
+    {
+        /* a leak scan may be reading the segments without the lock */
+        lub_heap_leak_release(leak);
+        return 0;
+    }
+    /* the first segment holds the heap itself so is never removed */
+    for(ptr = &this->first_segment.next;
+        *ptr;
+        ptr = &(*ptr)->next)
+    {
+        lub_heap_segment_t    *segment = *ptr;
+        lub_heap_free_block_t *block   = &lub_heap_block_getfirst(segment)->free;
+
+        if(block->tag.free && (block->tag.words == segment->words))
+        {
+            size_t bytes = (segment->words << 2);
+
+            /* a single free block spans the whole segment */
+            lub_heap_free_index_remove(this,block);
+            --this->stats.free_blocks;
+            this->stats.free_bytes    -= bytes;
+            this->stats.free_bytes    += sizeof(lub_heap_alloc_block_t);
+            this->stats.free_overhead -= sizeof(lub_heap_alloc_block_t);
+
+            /* forget about the segment */
+            *ptr = segment->next;
+            --this->stats.segs;
+            this->stats.segs_bytes    -= bytes;
+            this->stats.segs_overhead -= sizeof(lub_heap_segment_t);
+            lub_bintree_remove(&leak->m_segment_tree,segment);
+            lub_heap_leak_release(leak);
+
+            *size = bytes + sizeof(lub_heap_segment_t);
+
+            return segment;
+        }
+    }
+    lub_heap_leak_release(leak);
+
+    return 0;
+}
+/*--------------------------------------------------------- */
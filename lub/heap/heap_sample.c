@@ -0,0 +1,110 @@
+/*
+ * heap_sample.c
+ */
+#include "private.h"
+#include "context.h"
+
+/*--------------------------------------------------------- */
+/* a 32 bit xorshift generator; never returns zero */
+static unsigned long
+lub_heap_sample_random(lub_heap_t *this)
+{
+    unsigned long x = this->sample_seed & 0xffffffffUL;
+
+    if(0 == x)
+    {
+        x = 2463534242UL;
+    }
+    x ^= (x << 13) & 0xffffffffUL;
+    x ^= (x >> 17);
+    x ^= (x << 5)  & 0xffffffffUL;
+    this->sample_seed = x;
+
+    return x;
+}
+/*--------------------------------------------------------- */
+/*
+ * Draw the number of bytes until the next sample from an exponential
+ * distribution with a mean of the sample interval, i.e. interval * -ln(u)
+ * for a uniform u in (0,1].
+ */
+static size_t
+lub_heap_sample_draw(lub_heap_t *this)
+{
+    unsigned long r   = lub_heap_sample_random(this);
+    unsigned      msb = 0;
+    unsigned long tmp = r;
+    double        frac,log2_r;
+
+    while(tmp >>= 1)
+    {
+        ++msb;
+    }
+    /* log2(1+f) approximated to within 0.01 without needing libm */
+    frac   = ((double)r / (double)(1UL << msb)) - 1.0;
+    log2_r = msb + frac + (0.3466 * frac * (1.0 - frac));
+
+    return 1 + (size_t)((32.0 - log2_r) * 0.6931471805599453 * (double)lub_heap_sample_interval);
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_sample(lub_heap_t *this,
+                size_t      size)
+{
+    bool_t result = BOOL_TRUE;
+
+    if(lub_heap_sample_interval)
+    {
+        if(0 == this->sample_countdown)
+        {
+            this->sample_countdown = lub_heap_sample_draw(this);
+        }
+        if(size < this->sample_countdown)
+        {
+            /* not this time */
+            this->sample_countdown -= size;
+            result = BOOL_FALSE;
+        }
+        else
+        {
+            /* draw a fresh threshold next time */
+            this->sample_countdown = 0;
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+double
+lub_heap_sample_weight(size_t size)
+{
+    double result = 1.0;
+
+    if(lub_heap_sample_interval && size)
+    {
+        /*
+         * An allocation of this size is sampled with a probability
+         * of 1 - exp(-size/interval) so it stands for the inverse of that.
+         */
+        double   x = (double)size / (double)lub_heap_sample_interval;
+        double   e;
+        unsigned halvings = 0;
+
+        if(x < 32.0)
+        {
+            /* exp(-x) = exp(-x/2^n)^(2^n) with a short series for the small part */
+            while(x > 0.0625)
+            {
+                x /= 2.0;
+                ++halvings;
+            }
+            e = 1.0 - x*(1.0 - x/2.0*(1.0 - x/3.0*(1.0 - x/4.0)));
+            while(halvings--)
+            {
+                e *= e;
+            }
+            result = 1.0 / (1.0 - e);
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,398 @@
+/*
+ * heap_scan_parallel.c
+ *
+ * Scan the heap segments for leak references using several threads.
+ *
+ * The node tree is a splay tree, which changes shape on every lookup, so
+ * the threads cannot share it. Instead the monitored blocks are copied
+ * into a sorted table which the threads search without any locking.
+ * Each thread records the blocks it finds referenced in its own table
+ * of marks, and these are applied to the nodes under the leak lock once
+ * all the threads have finished.
+ *
+ * Each step of the scan deals out the next pieces of the segments, up to
+ * its budget, between the threads. The table is kept from one step to 
+ * the next until a monitored block is released, as the threads would 
+ * otherwise skip over memory which may since have been reused.
+ */
+#include <string.h>
+
+#include "private.h"
+#include "context.h"
+#include "node.h"
+
+unsigned lub_heap_scan_threads;
+
+/* the smallest piece of a segment which is handed to a thread */
+#define LUB_HEAP_SCAN_PIECE_SIZE (4 * 1024)
+
+/* the most pieces handed out in a single step */
+#define LUB_HEAP_SCAN_MAX_PIECES (4 * LUB_HEAP_SCAN_MAX_THREADS)
+
+/* how often to release the leak lock when applying the marks */
+#define LUB_HEAP_SCAN_RELEASE_COUNT 2048
+
+#define LUB_HEAP_SCAN_MARK_INSIDE 0x01 /* something points into the block */
+#define LUB_HEAP_SCAN_MARK_START  0x02 /* something points at its start   */
+
+typedef struct
+{
+    const lub_heap_node_t *node;  /* the monitored block          */
+    const char            *start; /* the client's memory          */
+    const char            *end;   /* the end of the client memory */
+} lub_heap_scan_node_t;
+
+typedef struct
+{
+    const char *start;
+    size_t      size;
+} lub_heap_scan_piece_t;
+
+typedef struct
+{
+    char                  *workspace;
+    size_t                 size;
+    unsigned               generation; /* the scan the table was made for */
+    size_t                 released;   /* blocks released when it was made */
+    lub_heap_scan_node_t  *nodes;
+    size_t                 node_count;
+    size_t                *index;  /* the first node in each stretch of memory */
+    const char            *low;    /* the lowest monitored block */
+    size_t                 stretch;
+    lub_heap_scan_piece_t *pieces;
+    size_t                 piece_count;
+    unsigned char         *marks; /* 'node_count' marks for each thread */
+    unsigned               threads;
+} lub_heap_scan_job_t;
+
+/* this belongs to the thread which is stepping through the scan */
+static lub_heap_scan_job_t lub_heap_scan_job;
+/*--------------------------------------------------------- */
+/*
+ * Split the memory spanned by the monitored blocks into equal stretches,
+ * one for each block, and note the first block in each of them.
+ */
+static void
+lub_heap_scan_build_index(lub_heap_scan_job_t *job)
+{
+    size_t i,stretch;
+
+    job->low     = 0;
+    job->stretch = 1;
+    if(job->node_count)
+    {
+        job->low     = (const char*)job->nodes[0].node;
+        job->stretch = 1 + ((size_t)((const char*)job->nodes[job->node_count-1].node - job->low)
+                            / job->node_count);
+    }
+    for(i = 0, stretch = 0; stretch <= job->node_count; ++stretch)
+    {
+        while((i < job->node_count) &&
+              ((size_t)((const char*)job->nodes[i].node - job->low) < (stretch * job->stretch)))
+        {
+            ++i;
+        }
+        job->index[stretch] = i;
+    }
+}
+/*--------------------------------------------------------- */
+/*
+ * Return the number of monitored blocks which start at or below
+ * the specified address.
+ */
+static size_t
+lub_heap_scan_find(const lub_heap_scan_job_t *job,
+                   const char                *ptr)
+{
+    size_t low,high,stretch;
+
+    if(ptr < job->low)
+    {
+        return 0;
+    }
+    /* narrow the search down to one stretch of memory */
+    stretch = (size_t)(ptr - job->low) / job->stretch;
+    if(stretch >= job->node_count)
+    {
+        return job->node_count;
+    }
+    low  = job->index[stretch];
+    high = job->index[stretch+1];
+
+    while(low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if((const char*)job->nodes[mid].node <= ptr)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_scan_piece(const lub_heap_scan_job_t   *job,
+                    const lub_heap_scan_piece_t *piece,
+                    unsigned char               *marks)
+{
+    typedef const void *void_ptr;
+    const char         *end      = piece->start + piece->size;
+    const char         *ptr      = piece->start;
+    void_ptr            last_ptr = 0;
+    size_t              next     = lub_heap_scan_find(job,ptr);
+
+    /* the piece may start part way through a monitored block */
+    if(next && (ptr < job->nodes[next-1].end))
+    {
+        ptr = job->nodes[next-1].end;
+    }
+    /* NB. a monitored block may take us past the end of the piece */
+    while((ptr < end) && ((size_t)(end - ptr) >= sizeof(void_ptr)))
+    {
+        void_ptr value;
+        size_t   i;
+
+        if((next < job->node_count) && (ptr >= (const char*)job->nodes[next].node))
+        {
+            /* don't scan the contents of a monitored block */
+            if(ptr < job->nodes[next].end)
+            {
+                ptr = job->nodes[next].end;
+            }
+            ++next;
+            last_ptr = 0;
+            continue;
+        }
+        value = *(const void_ptr*)ptr;
+        if(value != last_ptr)
+        {
+            /* see whether this is a reference into a monitored block */
+            i = lub_heap_scan_find(job,value);
+            if(i && (value >= (void_ptr)job->nodes[i-1].start)
+                 && (value <  (void_ptr)job->nodes[i-1].end))
+            {
+                marks[i-1] |= LUB_HEAP_SCAN_MARK_INSIDE;
+                if(value == (void_ptr)job->nodes[i-1].start)
+                {
+                    marks[i-1] |= LUB_HEAP_SCAN_MARK_START;
+                }
+            }
+        }
+        last_ptr = value;
+        ptr     += sizeof(void_ptr);
+    }
+    last_ptr = 0; /* don't leave pointers on the stack */
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_scan_worker(void    *arg,
+                     unsigned index)
+{
+    lub_heap_scan_job_t *job   = arg;
+    unsigned char       *marks = &job->marks[index * job->node_count];
+    size_t               i;
+
+    /* take every n'th piece so that each segment is shared out */
+    for(i = index; i < job->piece_count; i += job->threads)
+    {
+        lub_heap_scan_piece(job,&job->pieces[i],marks);
+    }
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_scan_apply_marks(lub_heap_scan_job_t *job)
+{
+    lub_heap_leak_t *leak          = lub_heap_leak_instance();
+    unsigned         release_count = LUB_HEAP_SCAN_RELEASE_COUNT;
+    size_t           i;
+
+    for(i = 0; i < job->node_count; ++i)
+    {
+        unsigned char mark = 0;
+        unsigned      t;
+
+        /* merge the results from each thread */
+        for(t = 0; t < job->threads; ++t)
+        {
+            mark |= job->marks[(t * job->node_count) + i];
+        }
+        if(mark)
+        {
+            lub_heap_node_t    *node;
+            lub_heap_node_key_t key;
+
+            /* the block may have been released during the scan */
+            key.node = job->nodes[i].node;
+            node     = lub_bintree_find(&leak->m_node_tree,&key);
+            if(NULL != node)
+            {
+                lub_heap_node_mark(leak,
+                                   node,
+                                   (mark & LUB_HEAP_SCAN_MARK_START) ? BOOL_TRUE : BOOL_FALSE);
+            }
+        }
+        if(0 == --release_count)
+        {
+            /* make space for other memory tasks to get in... */
+            lub_heap_leak_release(leak);
+            leak          = lub_heap_leak_instance();
+            release_count = LUB_HEAP_SCAN_RELEASE_COUNT;
+        }
+    }
+    leak->m_stats.scanned += job->piece_count;
+    lub_heap_leak_release(leak);
+}
+/*--------------------------------------------------------- */
+/*
+ * Take a copy of the monitored blocks, in address order. The leak lock
+ * must be held.
+ */
+static bool_t
+lub_heap_scan_build_table(lub_heap_scan_job_t *job,
+                          lub_heap_leak_t     *leak)
+{
+    size_t              node_count = 0;
+    lub_heap_node_t    *node;
+    lub_heap_node_key_t key;
+
+    lub_heap_scan_segments_parallel_end();
+
+    /* size up the work */
+    for(node = lub_bintree_findfirst(&leak->m_node_tree);
+        node;
+        node = lub_bintree_findnext(&leak->m_node_tree,&key))
+    {
+        lub_heap_node_getkey(node,(lub_bintree_key_t*)&key);
+        ++node_count;
+    }
+    job->threads = lub_heap_scan_threads;
+
+    /* NB. this memory must not come from a heap or it would be scanned */
+    job->size = ((node_count + 1) * sizeof(size_t))
+              + (node_count * sizeof(lub_heap_scan_node_t))
+              + (LUB_HEAP_SCAN_MAX_PIECES * sizeof(lub_heap_scan_piece_t))
+              + (node_count * job->threads);
+    job->workspace = lub_heap_scan_workspace_alloc(job->size);
+    if(NULL == job->workspace)
+    {
+        return BOOL_FALSE;
+    }
+    job->generation = leak->m_scan.generation;
+    job->released   = leak->m_scan.released;
+    job->index      = (size_t*)job->workspace;
+    job->nodes      = (lub_heap_scan_node_t*)&job->index[node_count + 1];
+    job->pieces     = (lub_heap_scan_piece_t*)&job->nodes[node_count];
+    job->marks      = (unsigned char*)&job->pieces[LUB_HEAP_SCAN_MAX_PIECES];
+
+    job->node_count = 0;
+    for(node = lub_bintree_findfirst(&leak->m_node_tree);
+        node && (job->node_count < node_count);
+        node = lub_bintree_findnext(&leak->m_node_tree,&key))
+    {
+        lub_heap_scan_node_t *entry = &job->nodes[job->node_count++];
+
+        lub_heap_node_getkey(node,(lub_bintree_key_t*)&key);
+        entry->node  = node;
+        entry->start = lub_heap_node__get_ptr(node);
+        entry->end   = entry->start + lub_heap_node__get_size(node);
+    }
+    lub_heap_scan_build_index(job);
+    node = 0; /* don't leave pointers on the stack */
+
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_scan_segments_parallel(size_t  budget,
+                                size_t *done)
+{
+    lub_heap_scan_job_t *job = &lub_heap_scan_job;
+    lub_heap_leak_t     *leak;
+    size_t               piece_size,total = 0;
+
+    if(lub_heap_scan_threads < 2)
+    {
+        return BOOL_FALSE;
+    }
+    leak = lub_heap_leak_instance();
+    if(   (NULL == job->workspace)
+       || (job->threads    != lub_heap_scan_threads)
+       || (job->generation != leak->m_scan.generation)
+       || (job->released   != leak->m_scan.released))
+    {
+        if(BOOL_FALSE == lub_heap_scan_build_table(job,leak))
+        {
+            /* leave it to the single threaded scan */
+            lub_heap_leak_release(leak);
+            return BOOL_FALSE;
+        }
+    }
+    /* share the budget out between the threads */
+    piece_size = budget / job->threads;
+    if(piece_size < LUB_HEAP_SCAN_PIECE_SIZE)
+    {
+        piece_size = LUB_HEAP_SCAN_PIECE_SIZE;
+    }
+    for(job->piece_count = 0;
+        (total < budget) && (job->piece_count < LUB_HEAP_SCAN_MAX_PIECES);
+        ++job->piece_count)
+    {
+        lub_heap_scan_piece_t *piece = &job->pieces[job->piece_count];
+        size_t                 size  = budget - total;
+
+        piece->size = lub_heap_scan_next_piece(leak,
+                                               (size < piece_size) ? size : piece_size,
+                                               &piece->start);
+        if(0 == piece->size)
+        {
+            /* every segment has been covered */
+            break;
+        }
+        total += piece->size;
+    }
+    lub_heap_leak_release(leak);
+
+    if(job->piece_count)
+    {
+        memset(job->marks,0,job->node_count * job->threads);
+
+        /* now scan the pieces without holding the lock */
+        lub_heap_scan_run(lub_heap_scan_worker,job,job->threads);
+
+        lub_heap_scan_apply_marks(job);
+    }
+    *done = total;
+
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_scan_segments_parallel_end(void)
+{
+    lub_heap_scan_job_t *job = &lub_heap_scan_job;
+
+    if(NULL != job->workspace)
+    {
+        lub_heap_scan_workspace_free(job->workspace,job->size);
+        job->workspace = 0;
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap__set_scan_threads(unsigned threads)
+{
+    lub_heap_scan_threads = (threads > LUB_HEAP_SCAN_MAX_THREADS) ?
+                            LUB_HEAP_SCAN_MAX_THREADS : threads;
+}
+/*--------------------------------------------------------- */
+unsigned
+    lub_heap__get_scan_threads(void)
+{
+    return lub_heap_scan_threads ? lub_heap_scan_threads : 1;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,324 @@
+/*
+ * heap_site.c
+ *
+ * Count the allocations made from each call site.
+ *
+ * The sites are held in a fixed table, shared by all the heaps, which
+ * is updated without taking any locks. Each allocation notes which
+ * entry it was counted against in a trailer at the end of its block so
+ * that it can be taken off again when it is released. The trailer is
+ * checked against the address of its block rather than the block being
+ * looked for amongst the heap's segments.
+ *
+ * An allocator which hands out the blocks of a heap again, such as the
+ * partition magazines, takes them off their site as they are given back
+ * to it and counts them against the real caller as they are reused.
+ */
+#include <string.h>
+
+#include "private.h"
+#include "context.h"
+
+/* the number of sites which can be told apart */
+#define LUB_HEAP_SITE_TABLE_SIZE (1024)
+
+/* how far to look for a free entry before counting a site as "other" */
+#define LUB_HEAP_SITE_MAX_PROBES (16)
+
+/* the entry which counts any sites which don't fit in the table */
+#define LUB_HEAP_SITE_OTHER (0)
+
+/* an index which indicates that there is no site to release */
+#define LUB_HEAP_SITE_NONE (LUB_HEAP_SITE_TABLE_SIZE)
+
+/* mixed into the trailer check to make a false match unlikely */
+#define LUB_HEAP_SITE_MAGIC (0x53495445UL)
+
+#ifdef __GNUC__
+#define LUB_HEAP_SITE_ADD(var,value)   __sync_add_and_fetch(&(var),(value))
+#define LUB_HEAP_SITE_SUB(var,value)   __sync_sub_and_fetch(&(var),(value))
+#define LUB_HEAP_SITE_CAS(var,old,new) __sync_bool_compare_and_swap(&(var),(old),(new))
+#else /* not __GNUC__ */
+/* without atomic operations the counts may drift under contention */
+#define LUB_HEAP_SITE_ADD(var,value)   ((var) += (value))
+#define LUB_HEAP_SITE_SUB(var,value)   ((var) -= (value))
+#define LUB_HEAP_SITE_CAS(var,old,new) (((var) == (old)) ? ((var) = (new)),1 : 0)
+#endif /* not __GNUC__ */
+
+bool_t lub_heap_site_stats;
+
+static unsigned              lub_heap_site_skip;
+static lub_heap_site_stats_t lub_heap_site_table[LUB_HEAP_SITE_TABLE_SIZE];
+
+/*--------------------------------------------------------- */
+static unsigned
+lub_heap_site_find(const void *address)
+{
+    unsigned long hash = (unsigned long)address >> 2;
+    unsigned      probe;
+
+    if(NULL == address)
+    {
+        return LUB_HEAP_SITE_OTHER;
+    }
+    hash ^= (hash >> 10);
+    for(probe = 0; probe < LUB_HEAP_SITE_MAX_PROBES; ++probe)
+    {
+        /* the "other" entry is never handed out */
+        unsigned               index = 1 + ((hash + probe) % (LUB_HEAP_SITE_TABLE_SIZE - 1));
+        lub_heap_site_stats_t *site  = &lub_heap_site_table[index];
+
+        if(site->address == address)
+        {
+            return index;
+        }
+        if(NULL == site->address)
+        {
+            /* claim this entry, unless another thread beats us to it */
+            if(LUB_HEAP_SITE_CAS(site->address,(const void*)0,address)
+               || (site->address == address))
+            {
+                return index;
+            }
+        }
+    }
+    return LUB_HEAP_SITE_OTHER;
+}
+/*--------------------------------------------------------- */
+static char *
+lub_heap_site_trailer(lub_heap_t *this,
+                      char       *ptr)
+{
+    return ptr + lub_heap__get_block_size(this,ptr) - sizeof(lub_heap_site_tag_t);
+}
+/*--------------------------------------------------------- */
+static unsigned
+lub_heap_site_check(const char                *ptr,
+                    const lub_heap_site_tag_t *tag)
+{
+    return (unsigned)((size_t)ptr ^ tag->size ^ tag->site ^ LUB_HEAP_SITE_MAGIC);
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_site_read_tag(lub_heap_t          *this,
+                       char                *ptr,
+                       lub_heap_site_tag_t *tag)
+{
+    /* the block may not be word aligned at the end */
+    memcpy(tag,lub_heap_site_trailer(this,ptr),sizeof(*tag));
+    if((tag->site >= LUB_HEAP_SITE_TABLE_SIZE) ||
+       (tag->check != lub_heap_site_check(ptr,tag)))
+    {
+        /* the trailer has been overwritten, or was never written */
+        tag->size = 0;
+        tag->site = LUB_HEAP_SITE_NONE;
+    }
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_site_write_tag(lub_heap_t *this,
+                        char       *ptr,
+                        size_t      size,
+                        unsigned    site)
+{
+    lub_heap_site_tag_t tag;
+
+    tag.size  = size;
+    tag.site  = site;
+    tag.check = lub_heap_site_check(ptr,&tag);
+    memcpy(lub_heap_site_trailer(this,ptr),&tag,sizeof(tag));
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_site_count(unsigned site_index,
+                    size_t   size)
+{
+    lub_heap_site_stats_t *site = &lub_heap_site_table[site_index];
+    size_t                 bytes,peak;
+
+    (void)LUB_HEAP_SITE_ADD(site->allocs,1);
+    (void)LUB_HEAP_SITE_ADD(site->blocks,1);
+    bytes = LUB_HEAP_SITE_ADD(site->bytes,size);
+
+    /* raise the high tide mark */
+    for(peak = site->peak_bytes;
+        (bytes > peak) && !LUB_HEAP_SITE_CAS(site->peak_bytes,peak,bytes);
+        peak = site->peak_bytes)
+    {
+    }
+}
+/*--------------------------------------------------------- */
+static void
+lub_heap_site_uncount(const lub_heap_site_tag_t *tag)
+{
+    if(LUB_HEAP_SITE_NONE != tag->site)
+    {
+        lub_heap_site_stats_t *site = &lub_heap_site_table[tag->site];
+
+        (void)LUB_HEAP_SITE_SUB(site->blocks,1);
+        (void)LUB_HEAP_SITE_SUB(site->bytes,tag->size);
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_site_pre_realloc(lub_heap_t          *this,
+                          char                *ptr,
+                          size_t              *size,
+                          lub_heap_site_tag_t *old_tag)
+{
+    old_tag->size = 0;
+    old_tag->site = LUB_HEAP_SITE_NONE;
+
+    if(BOOL_FALSE == this->sites)
+    {
+        return;
+    }
+    if(ptr && (LUB_HEAP_ZERO_ALLOC != ptr))
+    {
+        /* 
+         * a pointer from elsewhere is turned down by the realloc, 
+         * before the counts are touched 
+         */
+        lub_heap_site_read_tag(this,ptr,old_tag);
+    }
+    if(*size)
+    {
+        size_t old_size = *size;
+
+        /* allocate enough bytes for a trailer */
+        *size += sizeof(lub_heap_site_tag_t);
+        if(*size < old_size)
+        {
+            /* make sure we fail the allocation */
+            *size = (size_t)-1;
+        }
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_site_post_realloc(lub_heap_t                *this,
+                           char                      *ptr,
+                           size_t                     requested_size,
+                           lub_heap_status_t          status,
+                           const lub_heap_site_tag_t *old_tag,
+                           const void                *caller,
+                           bool_t                     counted)
+{
+    if((BOOL_FALSE == this->sites) || (LUB_HEAP_OK != status))
+    {
+        return;
+    }
+    /* take the old allocation off its site */
+    lub_heap_site_uncount(old_tag);
+
+    if((NULL == ptr) || (0 == requested_size))
+    {
+        return;
+    }
+    if(BOOL_FALSE == counted)
+    {
+        /* the caller counts this allocation for itself */
+        lub_heap_site_write_tag(this,ptr,0,LUB_HEAP_SITE_NONE);
+        return;
+    }
+    lub_heap_site_charge(this,ptr,requested_size,caller);
+}
+/*--------------------------------------------------------- */
+const void *
+lub_heap_site_caller(const void *address)
+{
+    if(lub_heap_site_skip)
+    {
+        function_t *frame = 0;
+
+        /* skip this function, the allocator and the wrappers */
+        if(lub_heap__get_backtrace(&frame,2 + lub_heap_site_skip,1,0))
+        {
+            address = (const void*)(unsigned long)frame;
+        }
+    }
+    return address;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_site_charge(lub_heap_t *this,
+                     char       *ptr,
+                     size_t      size,
+                     const void *caller)
+{
+    unsigned site;
+
+    if(BOOL_FALSE == this->sites)
+    {
+        return;
+    }
+    site = lub_heap_site_find(caller);
+    lub_heap_site_write_tag(this,ptr,size,site);
+    lub_heap_site_count(site,size);
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_site_discharge(lub_heap_t *this,
+                        char       *ptr)
+{
+    lub_heap_site_tag_t tag;
+
+    if(BOOL_FALSE == this->sites)
+    {
+        return;
+    }
+    lub_heap_site_read_tag(this,ptr,&tag);
+    lub_heap_site_uncount(&tag);
+
+    /* make sure that it isn't taken off again */
+    lub_heap_site_write_tag(this,ptr,0,LUB_HEAP_SITE_NONE);
+}
+/*--------------------------------------------------------- */
+size_t
+lub_heap_site_overhead(const lub_heap_t *this)
+{
+    return this->sites ? sizeof(lub_heap_site_tag_t) : 0;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_foreach_site(lub_heap_foreach_site_fn *fn,
+                      void                     *arg)
+{
+    unsigned index;
+
+    for(index = 0; index < LUB_HEAP_SITE_TABLE_SIZE; ++index)
+    {
+        /* take a copy as the counts may be changing under us */
+        lub_heap_site_stats_t stats = lub_heap_site_table[index];
+
+        if(stats.address || stats.allocs)
+        {
+            fn(&stats,arg);
+        }
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap__set_site_stats(bool_t enabled)
+{
+    lub_heap_site_stats = enabled;
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap__get_site_stats(void)
+{
+    return lub_heap_site_stats;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap__set_site_skip(unsigned frames)
+{
+    lub_heap_site_skip = frames;
+}
+/*--------------------------------------------------------- */
+unsigned
+lub_heap__get_site_skip(void)
+{
+    return lub_heap_site_skip;
+}
+/*--------------------------------------------------------- */
@@ -43,7 +43,7 @@ lub_heap_slice_from_bottom(lub_heap_t             *this,
             this->stats.free_bytes -= (*words << 2);
 
             /* set up the tree node */
-            lub_bintree_node_init(&new_block->bt_node);
+            lub_bintree_node_init(&new_block->index.bt_node);
         
             result     = block;
             *ptr_block = new_block;
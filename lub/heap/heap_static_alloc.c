@@ -54,35 +54,30 @@ lub_heap_static_alloc(lub_heap_t *this,
     lub_heap_free_block_t *free_block;
     /* round up to native alignment */
     words_t                words;
-    lub_heap_key_t         key;
     size_t                 size = requested_size;
     
     size  = (size + (LUB_HEAP_ALIGN_NATIVE-1))/LUB_HEAP_ALIGN_NATIVE; 
     size *= LUB_HEAP_ALIGN_NATIVE; 
     words = (size >> 2);
     
-    /* initialise the search key */
-    key.words   = words;
-    key.block   = 0;
-    
     /* search for the start of a segment which is large enough for the request */
-    while( (free_block = lub_bintree_findnext(&this->free_tree,&key)) )
+    for(free_block = lub_heap_free_index_first(this,words);
+        free_block;
+        free_block = lub_heap_free_index_next(this,free_block))
     {
         lub_heap_tag_t *tail = lub_heap_block__get_tail((lub_heap_block_t*)free_block);
         
         /* is this free block at the start of a segment? */
-        if(1 == tail->segment)
+        if((free_block->tag.words >= words) && (1 == tail->segment))
         {
             /* yes this is the end of a segment */
             break;
         }
-        /* update the search key */
-        lub_heap_block_getkey(free_block,(lub_bintree_key_t*)&key);
     }
     if(NULL != free_block)
     {
         /* remove this block from the free tree */
-        lub_bintree_remove(&this->free_tree,free_block);
+        lub_heap_free_index_remove(this,free_block);
         
         /* 
          * get some memory from the bottom of this free block 
@@ -95,7 +90,7 @@ lub_heap_static_alloc(lub_heap_t *this,
         if(NULL != free_block)
         {
             /* put the free block back into the tree */
-            lub_bintree_insert(&this->free_tree,free_block);
+            lub_heap_free_index_insert(this,free_block);
         }
         if(NULL != result)
         {
@@ -0,0 +1,127 @@
+/*
+ * heap_writer.c
+ *
+ * A small buffered writer used to export heap reports straight to a
+ * file descriptor. The numbers are formatted by hand so that neither
+ * the writer nor the C library needs to allocate any memory.
+ */
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "private.h"
+
+/*--------------------------------------------------------- */
+static void
+lub_heap_writer_put(lub_heap_writer_t *this,
+                    const char        *data,
+                    size_t             length)
+{
+    while(length)
+    {
+        size_t space = sizeof(this->buffer) - this->length;
+        size_t chunk = (length < space) ? length : space;
+
+        memcpy(&this->buffer[this->length],data,chunk);
+        this->length += chunk;
+        data         += chunk;
+        length       -= chunk;
+        if(this->length == sizeof(this->buffer))
+        {
+            (void)lub_heap_writer_flush(this);
+        }
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_writer_init(lub_heap_writer_t *this,
+                     int                fd)
+{
+    this->fd     = fd;
+    this->length = 0;
+    this->ok     = BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_writer_text(lub_heap_writer_t *this,
+                     const char        *text)
+{
+    lub_heap_writer_put(this,text,strlen(text));
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_writer_number(lub_heap_writer_t *this,
+                       unsigned long      value)
+{
+    char  digits[3 * sizeof(value)];
+    char *p = &digits[sizeof(digits)];
+
+    do
+    {
+        *--p   = (char)('0' + (value % 10));
+        value /= 10;
+    } while(value);
+
+    lub_heap_writer_put(this,p,(size_t)(&digits[sizeof(digits)] - p));
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_writer_address(lub_heap_writer_t *this,
+                        const void        *address)
+{
+    static const char hex[] = "0123456789abcdef";
+    unsigned long     value = (unsigned long)address;
+    char              digits[2 * sizeof(value) + 4];
+    char             *p = &digits[sizeof(digits)];
+
+    *--p = '"';
+    do
+    {
+        *--p    = hex[value & 0xf];
+        value >>= 4;
+    } while(value);
+    *--p = 'x';
+    *--p = '0';
+    *--p = '"';
+
+    lub_heap_writer_put(this,p,(size_t)(&digits[sizeof(digits)] - p));
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_writer_field(lub_heap_writer_t *this,
+                      const char        *name,
+                      unsigned long      value)
+{
+    lub_heap_writer_text(this,",\"");
+    lub_heap_writer_text(this,name);
+    lub_heap_writer_text(this,"\":");
+    lub_heap_writer_number(this,value);
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_heap_writer_flush(lub_heap_writer_t *this)
+{
+    const char *data = this->buffer;
+
+    while(this->ok && (this->length > 0))
+    {
+        ssize_t written = write(this->fd,data,this->length);
+
+        if((written < 0) && (EINTR == errno))
+        {
+            continue;
+        }
+        if(written <= 0)
+        {
+            /* give up on the rest of the report */
+            this->ok = BOOL_FALSE;
+            break;
+        }
+        data         += written;
+        this->length -= (size_t)written;
+    }
+    this->length = 0;
+
+    return this->ok;
+}
+/*--------------------------------------------------------- */
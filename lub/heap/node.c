@@ -73,17 +73,25 @@ lub_heap_node_init(lub_heap_node_t    * this,
         lub_heap_leak_t *leak = lub_heap_leak_instance();
         /* add this to the node tree */
         lub_bintree_insert(context ? &leak->m_node_tree : &leak->m_clear_node_tree,this);
-        lub_heap_leak_release(leak);
-    }
-    if(context)
-    {
-        /* add ourselves to this context */
-        lub_heap_context_insert_node(context,this);
+        if(LUB_HEAP_SCAN_NODES == leak->m_scan.phase)
+        {
+            /* 
+             * the scan has moved on to the nodes so only those already
+             * found get looked at; this one is taken to be referenced
+             */
+            lub_heap_node__set_scanned(this,BOOL_TRUE);
+        }
+        if(context)
+        {
+            /* add ourselves to this context */
+            lub_heap_context_insert_node(context,this);
 
-        /* maintain the leak statistics */
-        ++context->allocs;
-        context->alloc_bytes    += lub_heap_node__get_size(this);
-        context->alloc_overhead += lub_heap_node__get_overhead(this);
+            /* maintain the leak statistics */
+            ++context->allocs;
+            context->alloc_bytes    += lub_heap_node__get_size(this);
+            context->alloc_overhead += lub_heap_node__get_overhead(this);
+        }
+        lub_heap_leak_release(leak);
     }
 }
 /*--------------------------------------------------------- */
@@ -109,8 +117,10 @@ size_t
 size_t
     lub_heap_node__get_size(const lub_heap_node_t *this)
 {
-    size_t size = lub_heap__get_block_size(lub_heap_node__get_context(this)->heap,this);
+    lub_heap_t *heap = lub_heap_node__get_context(this)->heap;
+    size_t      size = lub_heap__get_block_size(heap,this);
     size -= sizeof(lub_heap_node_t);
+    size -= lub_heap_site_overhead(heap);
     return size;
 }
 /*--------------------------------------------------------- */
@@ -123,6 +133,7 @@ size_t
                                             lub_heap_node__get_ptr(this));
     
     overhead += sizeof(lub_heap_node_t);
+    overhead += lub_heap_site_overhead(lub_heap_node__get_context(this)->heap);
     return overhead;
 }
 /*--------------------------------------------------------- */
@@ -377,31 +388,99 @@ lub_heap_node_clear(lub_heap_node_t *this,
     lub_heap_context_t *context = lub_heap_node__get_context(this);
     if(NULL != context)
     {
-        lub_heap_leak_t *leak = lub_heap_leak_instance();
+        lub_heap_leak_t *leak          = lub_heap_leak_instance();
+        size_t           node_size     = lub_heap_node__get_size(this);
+        size_t           node_overhead = lub_heap_node__get_overhead(this);
+        bool_t           empty;
+
         /* remove from the node tree and place into the clear tree */
         lub_bintree_remove(&leak->m_node_tree,this);
         lub_bintree_insert(&leak->m_clear_node_tree,this);
-        lub_heap_leak_release(leak);
+        ++leak->m_scan.released;
 
         /* maintain the leak statistics */
         --context->allocs;
-        context->alloc_bytes    -= lub_heap_node__get_size(this);
-        context->alloc_overhead -= lub_heap_node__get_overhead(this);
+        context->alloc_bytes    -= node_size;
+        context->alloc_overhead -= node_overhead;
 
+        /* a scan may be under way so take back what it assumed */
+        if(BOOL_TRUE == lub_heap_node__get_leaked(this))
+        {
+            --context->leaks;
+            context->leaked_bytes    -= node_size;
+            context->leaked_overhead -= node_overhead;
+        }
+        if(BOOL_TRUE == lub_heap_node__get_partial(this))
+        {
+            --context->partials;
+            context->partial_bytes    -= node_size;
+            context->partial_overhead -= node_overhead;
+        }
         lub_heap_node__set_context(this,NULL);
         lub_heap_node__set_leaked(this,BOOL_FALSE);
         lub_heap_node__set_partial(this,BOOL_FALSE);
 
         lub_heap_context_remove_node(context,this);
+        empty = (0 == context->allocs) ? BOOL_TRUE : BOOL_FALSE;
+        lub_heap_leak_release(leak);
+
+        if(BOOL_TRUE == empty)
+        {
+            /* removing the last node deletes the context */
+            lub_heap_context_delete(context);
+        }
+    }
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_node_mark(lub_heap_leak_t *leak,
+                   lub_heap_node_t *node,
+                   bool_t           start_of_block)
+{
+    lub_heap_context_t *context       = lub_heap_node__get_context(node);
+    size_t              node_size     = lub_heap_node__get_size(node);
+    size_t              node_overhead = lub_heap_node__get_overhead(node);
+
+    if(BOOL_TRUE == start_of_block)
+    {
+        /* reference to start of block */
+        if(BOOL_TRUE == lub_heap_node__get_partial(node))
+        {
+            lub_heap_node__set_partial(node,BOOL_FALSE);
+
+            if(NULL != context)
+            {
+                --context->partials;
+                context->partial_bytes    -= node_size;
+                context->partial_overhead -= node_overhead;
+            }
+        }
+    }
+    /* this is definately not a leak */
+    if(BOOL_TRUE == lub_heap_node__get_leaked(node))
+    {
+        lub_heap_node__set_leaked(node,BOOL_FALSE);
+
+        if(NULL != context)
+        {
+            --context->leaks;
+            context->leaked_bytes    -= node_size;
+            context->leaked_overhead -= node_overhead;
+
+            --leak->m_stats.leaks;
+            leak->m_stats.leaked_bytes    -= node_size;
+            leak->m_stats.leaked_overhead -= node_overhead;
+        }
     }
 }
 /*--------------------------------------------------------- */
 #define RELEASE_COUNT 2048
-void 
+size_t
 lub_heap_scan_memory(const void  *mem,
                      size_t       size)
 {
     size_t              bytes_left = size;
+    size_t              result;
     typedef const void *void_ptr;
     void_ptr           *ptr,last_ptr = 0;
     lub_heap_leak_t    *leak = lub_heap_leak_instance();
@@ -414,7 +493,7 @@ lub_heap_scan_memory(const void  *mem,
     
     /* scan all the words in this allocated block of memory */
     for(ptr = (void_ptr*)mem;
-        bytes_left;
+        bytes_left >= sizeof(void_ptr);
         )
     {
         if(0 == --release_count)
@@ -443,7 +522,13 @@ lub_heap_scan_memory(const void  *mem,
                 size_t node_size = lub_heap_node__get_size(node);
                 
                 /* skip forward past the node contents */
-                ptr         = (void_ptr*)(tmp + node_size);
+                ptr = (void_ptr*)(tmp + node_size);
+                if(bytes_left < (node_size + sizeof(lub_heap_node_t)))
+                {
+                    /* the node runs past the end of this memory */
+                    bytes_left = 0;
+                    break;
+                }
                 bytes_left -= (node_size + sizeof(lub_heap_node_t));
                 tmp = 0; /* don't leave pointers on our stack */
                 last_ptr = 0;
@@ -459,49 +544,18 @@ lub_heap_scan_memory(const void  *mem,
             node = _lub_heap_node_from_ptr(&leak->m_node_tree,*ptr,BOOL_FALSE);
             if( (NULL != node))
             {
-                /* this looks like a valid node */
-                lub_heap_context_t *context       = lub_heap_node__get_context(node);
-                size_t              node_size     = lub_heap_node__get_size(node);
-                size_t              node_overhead = lub_heap_node__get_overhead(node);
-                char               *tmp           = lub_heap_node__get_ptr(node);
-                if(tmp == *ptr)
-                {
-                    /* reference to start of block */
-                    if(BOOL_TRUE == lub_heap_node__get_partial(node))
-                    {
-                        lub_heap_node__set_partial(node,BOOL_FALSE);
-    
-                        if(NULL != context)
-                        {
-                            --context->partials;
-                            context->partial_bytes    -= node_size;
-                            context->partial_overhead -= node_overhead;
-                        }
-                    }
-                }
-                tmp = 0; /* don't leave pointers on our stack */
-                /* this is definately not a leak */
-                if(BOOL_TRUE == lub_heap_node__get_leaked(node))
-                {
-                    lub_heap_node__set_leaked(node,BOOL_FALSE);
-    
-                    if(NULL != context)
-                    {
-                        --context->leaks;
-                        context->leaked_bytes    -= node_size;
-                        context->leaked_overhead -= node_overhead;
-     
-                        --leak->m_stats.leaks;
-                        leak->m_stats.leaked_bytes    -= node_size;
-                        leak->m_stats.leaked_overhead -= node_overhead;
-                    }
-                }
+                lub_heap_node_mark(leak,
+                                   node,
+                                   (lub_heap_node__get_ptr(node) == *ptr) ? BOOL_TRUE : BOOL_FALSE);
             }
         }
         last_ptr = *ptr++;
         bytes_left -= sizeof(void*);
     }
     lub_heap_leak_release(leak);
+    result   = (const char*)ptr - (const char*)mem;
     last_ptr = ptr = 0; /* don't leave pointers on the stack */
+
+    return result;
 }
 /*--------------------------------------------------------- */
@@ -42,7 +42,19 @@ extern void
 extern void
     lub_heap_foreach_node(void (*fn)(lub_heap_node_t *, void*),void *arg);
 
-extern void 
+/*
+ * Record a reference to the specified node; the leak lock must be held.
+ */
+extern void
+    lub_heap_node_mark(lub_heap_leak_t *leak,
+                       lub_heap_node_t *instance,
+                       bool_t           start_of_block);
+/*
+ * Scan the specified memory for references to nodes, returning the
+ * number of bytes covered; this can be more than was asked for if a
+ * node straddles the end of the memory.
+ */
+extern size_t
     lub_heap_scan_memory(const void  *mem,
                          size_t       size);
 /*
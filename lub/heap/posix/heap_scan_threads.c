@@ -0,0 +1,86 @@
+#define _DEFAULT_SOURCE /* needed for MAP_ANONYMOUS */
+#define _BSD_SOURCE
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "../private.h"
+#include "../context.h"
+
+typedef struct
+{
+    void   (*fn)(void *arg,unsigned index);
+    void    *arg;
+    unsigned index;
+} lub_heap_scan_thread_t;
+
+/*--------------------------------------------------------- */
+void *
+lub_heap_scan_workspace_alloc(size_t size)
+{
+    void *result = mmap(0,
+                        size ? size : 1,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    return (MAP_FAILED == result) ? 0 : result;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_scan_workspace_free(void  *ptr,
+                             size_t size)
+{
+    (void)munmap(ptr,size ? size : 1);
+}
+/*--------------------------------------------------------- */
+static void *
+lub_heap_scan_thread(void *arg)
+{
+    lub_heap_scan_thread_t *this = arg;
+
+    this->fn(this->arg,this->index);
+
+    return 0;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_scan_run(void   (*fn)(void *arg,unsigned index),
+                  void    *arg,
+                  unsigned count)
+{
+    lub_heap_scan_thread_t thread[LUB_HEAP_SCAN_MAX_THREADS];
+    pthread_t              id[LUB_HEAP_SCAN_MAX_THREADS];
+    bool_t                 started[LUB_HEAP_SCAN_MAX_THREADS];
+    unsigned               i;
+
+    if(count > LUB_HEAP_SCAN_MAX_THREADS)
+    {
+        count = LUB_HEAP_SCAN_MAX_THREADS;
+    }
+    /* the calling thread takes the first share of the work */
+    for(i = 1; i < count; ++i)
+    {
+        thread[i].fn    = fn;
+        thread[i].arg   = arg;
+        thread[i].index = i;
+        started[i]      = (0 == pthread_create(&id[i],0,lub_heap_scan_thread,&thread[i])) ?
+                          BOOL_TRUE : BOOL_FALSE;
+        if(BOOL_FALSE == started[i])
+        {
+            /* do this share ourselves */
+            fn(arg,i);
+        }
+    }
+    if(count)
+    {
+        fn(arg,0);
+    }
+    for(i = 1; i < count; ++i)
+    {
+        if(BOOL_TRUE == started[i])
+        {
+            (void)pthread_join(id[i],0);
+        }
+    }
+}
+/*--------------------------------------------------------- */
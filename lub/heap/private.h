@@ -12,7 +12,9 @@
  ********************************************************** */
 typedef struct _lub_heap_node    lub_heap_node_t;    
 typedef struct _lub_heap_context lub_heap_context_t;    
+typedef struct _lub_heap_leak    lub_heap_leak_t;    
 typedef struct _lub_heap_cache   lub_heap_cache_t;    
+typedef struct _lub_heap_tlsf    lub_heap_tlsf_t;    
 
 typedef enum {
     LUB_HEAP_TAINT_INITIAL = 0xBB,
@@ -31,6 +33,7 @@ typedef struct lub_heap_tag_s         lub_heap_tag_t;
 typedef struct lub_heap_segment_s     lub_heap_segment_t;
 typedef union  lub_heap_block_u       lub_heap_block_t;
 typedef struct lub_heap_alloc_block_s lub_heap_alloc_block_t;
+typedef struct lub_heap_free_link_s   lub_heap_free_link_t;
 
 /*
  * a special type which hold both a size and block type
@@ -48,16 +51,31 @@ struct lub_heap_key_s
     words_t                      words;
     const lub_heap_free_block_t *block;
 };
+/*
+ * links to hold a free block in a segregated list
+ */
+struct lub_heap_free_link_s
+{
+    lub_heap_free_block_t *next;
+    lub_heap_free_block_t *prev;
+};
 /*
  * A specialisation of a generic block to hold free block information
  */
 struct lub_heap_free_block_s
 {
     lub_heap_tag_t tag;
-    /*
-     * node to hold this block in the size based binary tree 
-     */
-    lub_bintree_node_t bt_node;
+    union
+    {
+        /*
+         * node to hold this block in the size based binary tree 
+         */
+        lub_bintree_node_t   bt_node;
+        /*
+         * or links to hold it in a segregated free list
+         */
+        lub_heap_free_link_t list;
+    } index;
     /* space holder for the trailing tag */
     lub_heap_tag_t _tail;
 };
@@ -87,6 +105,7 @@ struct lub_heap_segment_s
     lub_heap_segment_t *next;
     words_t             words;
     lub_bintree_node_t  bt_node;
+    unsigned            generation; /* the leak scan under way when added */
 };
 
 /*
@@ -102,10 +121,31 @@ struct lub_heap_s
      * A binary tree of free blocks 
      */
     lub_bintree_t free_tree;
+    /*
+     * The segregated free lists, if these are used in place of the tree
+     */
+    lub_heap_tlsf_t *tlsf;
     /*
      * This is used to supress leak tracking
      */
     unsigned long suppress;
+    /*
+     * The number of bytes still to be allocated before the next
+     * allocation is sampled for leak detection (zero if not yet drawn)
+     */
+    size_t sample_countdown;
+    /*
+     * The state of the generator used to draw the sampling thresholds
+     */
+    unsigned long sample_seed;
+    /*
+     * Whether the allocation in progress carries a leak detection node
+     */
+    bool_t sampled;
+    /*
+     * Whether each allocation carries a trailer naming its site
+     */
+    bool_t sites;
     /* 
      * statistics for this heap 
      */
@@ -215,6 +255,68 @@ extern void
  */
 extern void
     lub_heap_clean_stacks(void);
+/*
+ * A platform implementation should provide memory for the parallel
+ * leak scan which is not taken from any heap; it may return NULL in
+ * which case the scan is made by a single thread.
+ */
+extern void *
+    lub_heap_scan_workspace_alloc(size_t size);
+extern void
+    lub_heap_scan_workspace_free(void  *ptr,
+                                 size_t size);
+/*
+ * A platform implementation should call the specified function for
+ * each index from 0 to count-1, concurrently if it is able to, and
+ * return once every call has completed.
+ */
+extern void
+    lub_heap_scan_run(void   (*fn)(void *arg,unsigned index),
+                      void    *arg,
+                      unsigned count);
+
+/*
+ * A report exported to a file descriptor is built up in this buffer,
+ * which the caller keeps on its stack, so that nothing is allocated
+ * from the heaps being reported on.
+ */
+#define LUB_HEAP_WRITER_BUFFER_SIZE (512)
+
+typedef struct _lub_heap_writer lub_heap_writer_t;
+struct _lub_heap_writer
+{
+    int    fd;
+    size_t length;
+    bool_t ok;
+    char   buffer[LUB_HEAP_WRITER_BUFFER_SIZE];
+};
+extern void
+    lub_heap_writer_init(lub_heap_writer_t *instance,
+                         int                fd);
+/* append some literal text */
+extern void
+    lub_heap_writer_text(lub_heap_writer_t *instance,
+                         const char        *text);
+/* append an unsigned decimal number */
+extern void
+    lub_heap_writer_number(lub_heap_writer_t *instance,
+                           unsigned long      value);
+/* append an address as a quoted hexadecimal string */
+extern void
+    lub_heap_writer_address(lub_heap_writer_t *instance,
+                            const void        *address);
+/* append ',"name":value' */
+extern void
+    lub_heap_writer_field(lub_heap_writer_t *instance,
+                          const char        *name,
+                          unsigned long      value);
+/*
+ * write out anything still buffered
+ *
+ * \return BOOL_FALSE if any part of the output could not be written
+ */
+extern bool_t
+    lub_heap_writer_flush(lub_heap_writer_t *instance);
 
 /*---------------------------------------------------------
  * PRIVATE METHODS
@@ -323,6 +425,49 @@ extern void
          */
         char **ptr
     );
+/*
+ * The trailer held at the end of each allocation from a heap which
+ * counts allocations by site.
+ */
+typedef struct _lub_heap_site_tag lub_heap_site_tag_t;
+struct _lub_heap_site_tag
+{
+    size_t   size;  /* the number of bytes requested */
+    unsigned site;  /* the index of the allocating site */
+    unsigned check; /* ties the trailer to its block */
+};
+
+extern bool_t lub_heap_site_stats;
+
+/*
+ * This is called before a realloc is done, once any leak detection node
+ * has been dealt with. It notes the details of the allocation being
+ * released and makes space for a trailer in the new one.
+ */
+extern void
+    lub_heap_site_pre_realloc(lub_heap_t          *instance,
+                              char                *ptr,
+                              size_t              *size,
+                              lub_heap_site_tag_t *old_tag);
+/*
+ * This is called after a realloc is done, before any leak detection
+ * node is set up. If the realloc worked the site counters are updated
+ * and a trailer is written to the new allocation; unless it is not to
+ * be counted, in which case the trailer names no site.
+ */
+extern void
+    lub_heap_site_post_realloc(lub_heap_t                *instance,
+                               char                      *ptr,
+                               size_t                     requested_size,
+                               lub_heap_status_t          status,
+                               const lub_heap_site_tag_t *old_tag,
+                               const void                *caller,
+                               bool_t                     counted);
+/*
+ * The number of bytes at the end of each block used by the trailer.
+ */
+extern size_t
+    lub_heap_site_overhead(const lub_heap_t *instance);
 /*
  * This function clears all the current leak information from the heap
  *
@@ -483,6 +628,39 @@ extern bool_t
 extern void
     lub_heap_block_getkey(const void        *clientnode,
                           lub_bintree_key_t *key);
+/*
+ * These operations maintain the index of free blocks, using either
+ * the binary tree or the segregated lists chosen when the heap was
+ * created.
+ */
+extern void
+    lub_heap_free_index_insert(lub_heap_t            *instance,
+                               lub_heap_free_block_t *block);
+extern void
+    lub_heap_free_index_remove(lub_heap_t            *instance,
+                               lub_heap_free_block_t *block);
+/*
+ * Find a free block which can hold the specified number of words
+ */
+extern lub_heap_free_block_t *
+    lub_heap_free_index_find(lub_heap_t *instance,
+                             words_t     words);
+/*
+ * Iterate the free blocks in (approximately) ascending size order,
+ * starting with those at least "words" in size. The segregated lists
+ * may also return some smaller blocks, which the client must skip.
+ */
+extern lub_heap_free_block_t *
+    lub_heap_free_index_first(lub_heap_t *instance,
+                              words_t     words);
+extern lub_heap_free_block_t *
+    lub_heap_free_index_next(lub_heap_t            *instance,
+                             lub_heap_free_block_t *block);
+/*
+ * Find the largest free block
+ */
+extern lub_heap_free_block_t *
+    lub_heap_free_index_last(lub_heap_t *instance);
 extern void
     lub_heap_scan_all(void);
 
@@ -0,0 +1,247 @@
+/*
+ * tlsf.c
+ */
+#include <string.h>
+
+#include "tlsf.h"
+
+/* the largest number of words which a block tag can hold */
+#define LUB_HEAP_TLSF_MAX_WORDS ((((words_t)1) << 30) - 1)
+
+/*--------------------------------------------------------- */
+/* the index of the most significant set bit (x must be non-zero) */
+static unsigned
+lub_heap_tlsf_fls(unsigned x)
+{
+#ifdef __GNUC__
+    return (unsigned)(31 - __builtin_clz(x));
+#else /* not __GNUC__ */
+    unsigned result = 0;
+    while(x >>= 1)
+    {
+        ++result;
+    }
+    return result;
+#endif /* not __GNUC__ */
+}
+/*--------------------------------------------------------- */
+/* the index of the least significant set bit (x must be non-zero) */
+static unsigned
+lub_heap_tlsf_ffs(unsigned x)
+{
+#ifdef __GNUC__
+    return (unsigned)__builtin_ctz(x);
+#else /* not __GNUC__ */
+    unsigned result = 0;
+    while(0 == (x & 1))
+    {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif /* not __GNUC__ */
+}
+/*--------------------------------------------------------- */
+/* work out which list holds blocks of the specified size */
+static void
+lub_heap_tlsf_mapping(words_t   words,
+                      unsigned *fl,
+                      unsigned *sl)
+{
+    if(words < LUB_HEAP_TLSF_SL_COUNT)
+    {
+        *fl = 0;
+        *sl = (unsigned)words;
+    }
+    else
+    {
+        unsigned msb = lub_heap_tlsf_fls((unsigned)words);
+
+        *fl = msb - LUB_HEAP_TLSF_SL_LOG2 + 1;
+        *sl = (unsigned)(words >> (msb - LUB_HEAP_TLSF_SL_LOG2)) - LUB_HEAP_TLSF_SL_COUNT;
+    }
+}
+/*--------------------------------------------------------- */
+/* find the first non-empty list at or after the specified one */
+static lub_heap_free_block_t *
+lub_heap_tlsf_search(lub_heap_tlsf_t *this,
+                     unsigned         fl,
+                     unsigned         sl)
+{
+    unsigned map = 0;
+
+    if(sl < LUB_HEAP_TLSF_SL_COUNT)
+    {
+        map = this->m_sl_bitmap[fl] & (~0U << sl);
+    }
+    if(!map)
+    {
+        /* move on to a larger range */
+        if(fl + 1 >= LUB_HEAP_TLSF_FL_COUNT)
+        {
+            return 0;
+        }
+        map = this->m_fl_bitmap & (~0U << (fl + 1));
+        if(!map)
+        {
+            return 0;
+        }
+        fl  = lub_heap_tlsf_ffs(map);
+        map = this->m_sl_bitmap[fl];
+    }
+    return this->m_lists[fl][lub_heap_tlsf_ffs(map)];
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_tlsf_init(lub_heap_tlsf_t *this)
+{
+    memset(this,0,sizeof(*this));
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_tlsf_insert(lub_heap_tlsf_t       *this,
+                     lub_heap_free_block_t *block)
+{
+    unsigned fl,sl;
+
+    lub_heap_tlsf_mapping(block->tag.words,&fl,&sl);
+
+    /* push onto the front of the list */
+    block->index.list.prev = 0;
+    block->index.list.next = this->m_lists[fl][sl];
+    if(block->index.list.next)
+    {
+        block->index.list.next->index.list.prev = block;
+    }
+    this->m_lists[fl][sl] = block;
+
+    this->m_fl_bitmap     |= (1U << fl);
+    this->m_sl_bitmap[fl] |= (1U << sl);
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_tlsf_remove(lub_heap_tlsf_t       *this,
+                     lub_heap_free_block_t *block)
+{
+    lub_heap_free_block_t *next = block->index.list.next;
+    lub_heap_free_block_t *prev = block->index.list.prev;
+    unsigned               fl,sl;
+
+    lub_heap_tlsf_mapping(block->tag.words,&fl,&sl);
+
+    if(next)
+    {
+        next->index.list.prev = prev;
+    }
+    if(prev)
+    {
+        prev->index.list.next = next;
+    }
+    else
+    {
+        this->m_lists[fl][sl] = next;
+        if(!next)
+        {
+            /* the list is now empty */
+            this->m_sl_bitmap[fl] &= ~(1U << sl);
+            if(!this->m_sl_bitmap[fl])
+            {
+                this->m_fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+    block->index.list.next = 0;
+    block->index.list.prev = 0;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_tlsf_find(lub_heap_tlsf_t *this,
+                   words_t          words)
+{
+    lub_heap_free_block_t *result = 0;
+    words_t                rounded = words;
+    unsigned               fl,sl;
+
+    if(words > LUB_HEAP_TLSF_MAX_WORDS)
+    {
+        /* no block can be this big */
+        return 0;
+    }
+    if(words >= LUB_HEAP_TLSF_SL_COUNT)
+    {
+        /* round up to the next list so that any block in it will do */
+        rounded += (((words_t)1) << (lub_heap_tlsf_fls((unsigned)words) - LUB_HEAP_TLSF_SL_LOG2)) - 1;
+    }
+    if(rounded <= LUB_HEAP_TLSF_MAX_WORDS)
+    {
+        lub_heap_tlsf_mapping(rounded,&fl,&sl);
+        result = lub_heap_tlsf_search(this,fl,sl);
+    }
+    if(!result)
+    {
+        /* the list which this size maps to may still hold a large enough block */
+        lub_heap_tlsf_mapping(words,&fl,&sl);
+        for(result = this->m_lists[fl][sl];
+            result && (result->tag.words < words);
+            result = result->index.list.next)
+        {
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_tlsf_first(lub_heap_tlsf_t *this,
+                    words_t          words)
+{
+    unsigned fl,sl;
+
+    if(words > LUB_HEAP_TLSF_MAX_WORDS)
+    {
+        return 0;
+    }
+    lub_heap_tlsf_mapping(words,&fl,&sl);
+    return lub_heap_tlsf_search(this,fl,sl);
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_tlsf_next(lub_heap_tlsf_t       *this,
+                   lub_heap_free_block_t *block)
+{
+    lub_heap_free_block_t *result = block->index.list.next;
+
+    if(!result)
+    {
+        unsigned fl,sl;
+
+        /* move on to the next non-empty list */
+        lub_heap_tlsf_mapping(block->tag.words,&fl,&sl);
+        result = lub_heap_tlsf_search(this,fl,sl + 1);
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+lub_heap_free_block_t *
+lub_heap_tlsf_last(lub_heap_tlsf_t *this)
+{
+    lub_heap_free_block_t *result = 0;
+    lub_heap_free_block_t *block;
+    unsigned               fl;
+
+    if(this->m_fl_bitmap)
+    {
+        fl = lub_heap_tlsf_fls(this->m_fl_bitmap);
+        /* the blocks in a list are not sorted so find the largest */
+        for(block = this->m_lists[fl][lub_heap_tlsf_fls(this->m_sl_bitmap[fl])];
+            block;
+            block = block->index.list.next)
+        {
+            if(!result || (block->tag.words > result->tag.words))
+            {
+                result = block;
+            }
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,44 @@
+#include "private.h"
+
+/*
+ * Free blocks below this many words each have a list of their own;
+ * above it each power of two range is split into this many lists.
+ */
+#define LUB_HEAP_TLSF_SL_LOG2  4
+#define LUB_HEAP_TLSF_SL_COUNT (1 << LUB_HEAP_TLSF_SL_LOG2)
+/* enough first level ranges to cover the 30 bit word count of a block */
+#define LUB_HEAP_TLSF_FL_COUNT (30 - LUB_HEAP_TLSF_SL_LOG2 + 1)
+
+/*-------------------------------------
+ * lub_heap_tlsf_t class
+ *
+ * A two level segregated fit index of free blocks. A bitmap records
+ * which lists are non-empty so that a suitable list can be found
+ * without searching.
+ *------------------------------------- */
+struct _lub_heap_tlsf
+{
+    unsigned               m_fl_bitmap;
+    unsigned               m_sl_bitmap[LUB_HEAP_TLSF_FL_COUNT];
+    lub_heap_free_block_t *m_lists[LUB_HEAP_TLSF_FL_COUNT][LUB_HEAP_TLSF_SL_COUNT];
+};
+
+void
+    lub_heap_tlsf_init(lub_heap_tlsf_t *instance);
+void
+    lub_heap_tlsf_insert(lub_heap_tlsf_t       *instance,
+                         lub_heap_free_block_t *block);
+void
+    lub_heap_tlsf_remove(lub_heap_tlsf_t       *instance,
+                         lub_heap_free_block_t *block);
+lub_heap_free_block_t *
+    lub_heap_tlsf_find(lub_heap_tlsf_t *instance,
+                       words_t          words);
+lub_heap_free_block_t *
+    lub_heap_tlsf_first(lub_heap_tlsf_t *instance,
+                        words_t          words);
+lub_heap_free_block_t *
+    lub_heap_tlsf_next(lub_heap_tlsf_t       *instance,
+                       lub_heap_free_block_t *block);
+lub_heap_free_block_t *
+    lub_heap_tlsf_last(lub_heap_tlsf_t *instance);
@@ -0,0 +1,32 @@
+#include "../private.h"
+
+/*--------------------------------------------------------- */
+void *
+lub_heap_scan_workspace_alloc(size_t size)
+{
+    /* 
+     * the system memory partition may itself be a monitored heap so
+     * the leak scan is left to run in a single task
+     */
+    return 0;
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_scan_workspace_free(void  *ptr,
+                             size_t size)
+{
+}
+/*--------------------------------------------------------- */
+void
+lub_heap_scan_run(void   (*fn)(void *arg,unsigned index),
+                  void    *arg,
+                  unsigned count)
+{
+    unsigned i;
+
+    for(i = 0; i < count; ++i)
+    {
+        fn(arg,i);
+    }
+}
+/*--------------------------------------------------------- */
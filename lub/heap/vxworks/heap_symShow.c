@@ -83,6 +83,18 @@ leakDisable(void)
 }
 /*--------------------------------------------------------- */
 int
+leakSample(unsigned bytes)
+{
+    taskLock();
+
+    lub_heap__set_sample_interval(bytes);
+
+    taskUnlock();
+    
+    return 0;
+}
+/*--------------------------------------------------------- */
+int
 leakShow(unsigned    how,
          const char *substring)
 {
@@ -120,6 +132,9 @@ leakHelp(void)
            "                                specified number of stack frames.\n\n");
     printf("  leakDisable                 - Disable leak detection, clearing out \n"
            "                                any currently monitored allocations\n\n");
+    printf("  leakSample [bytes]          - Only monitor one allocation for each \n"
+           "                                'bytes' allocated on average; reports show\n"
+           "                                estimated totals. 0 monitors every allocation.\n\n");
     printf("  leakScan [how] [,substring] - Scan and show memory leak details.\n"
            "                                'how' can be 0 - leaks only [default]\n"
            "                                             1 - leaks and partials\n"
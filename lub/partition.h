@@ -23,8 +23,18 @@ basis. This is referenced using thread specific storage within the
 owning thread and if it is unable to satisfy the request then a
 slower mutex locked global heap is created and used instead.
 
+Each thread also keeps a small magazine of free blocks for each
+power of two size class, which is filled from and emptied to the
+global heap in batches. A block freed by a thread other than the
+one which took it is handed back to its owner without taking the
+lock. A thread's local heap is recycled when the thread exits.
+
 \section auto_extension Automatically extends itself
 - The (slower) global heap will automatically extend itself as needed.
+- If a release function is provided, segments which become entirely free
+  are handed back to the system. Up to a threshold they are first kept in
+  reserve, with their pages returned but their address space retained, so
+  that they can be reused cheaply.
 
 \author  Graeme McKerrell
 \date    Created On      : Wed Jun 27 14:00:00 2007
@@ -51,6 +61,12 @@ typedef struct _lub_partition lub_partition_t;
  * can be used to extend the partition as needed.
  */
 typedef void *lub_partition_sysalloc_fn(size_t required);
+/**
+ * This type defines a function which hands back to the system some memory
+ * previously obtained from the fundamental allocation function.
+ */
+typedef void lub_partition_sysfree_fn(void  *ptr,
+                                      size_t size);
 /**
  * This type is used to specify any local requirements
  */
@@ -91,6 +107,51 @@ struct _lub_partition_spec
      * If NULL then the standard 'malloc' function will be used. 
      */
      lub_partition_sysalloc_fn *sysalloc;
+    /**
+     * If non-NULL then this pointer references the function which should
+     * be used to hand back segments which are no longer in use. 
+     * If NULL then the partition keeps all the memory it obtains.
+     * Segments which were obtained next to each other may be handed back
+     * together, in a single call.
+     */
+     lub_partition_sysfree_fn *sysfree;
+    /**
+     * If non-zero then each new segment is a multiple of this many bytes.
+     * Setting this to the size of a huge page allows the system to back
+     * the segments with huge pages.
+     */
+     size_t segment_granularity;
+    /**
+     * The number of bytes of free segments which are held in reserve, 
+     * with their pages returned to the system, before any more are 
+     * handed back using the "sysfree" function.
+     */
+     size_t idle_threshold;
+};
+
+/**
+ * This type defines the statistics available for each partition.
+ */
+typedef struct _lub_partition_stats lub_partition_stats_t;
+struct _lub_partition_stats
+{
+    /**
+     * Number of bytes obtained from the system which have not been 
+     * handed back.
+     */
+    size_t reserved_bytes;
+    /**
+     * Number of the reserved bytes which currently occupy physical memory.
+     */
+    size_t resident_bytes;
+    /**
+     * Number of free segments held in reserve.
+     */
+    size_t idle_segs;
+    /**
+     * Number of bytes in the free segments held in reserve.
+     */
+    size_t idle_bytes;
 };
 
 /**
@@ -198,6 +259,66 @@ lub_heap_status_t
  */
 extern bool_t 
     lub_partition_check_memory(lub_partition_t *instance);
+/**
+ * This operation fills out a statistics structure with the details for the 
+ * specified partition.
+ *
+ * \pre
+ * - The partition needs to have been created.
+ *
+ * \return
+ * - none
+ *
+ * \post
+ * - the results are filled out in the client provided structure.
+ */
+void
+    lub_partition__get_stats(
+        /**
+         * The instance on which to operate
+         */
+        lub_partition_t *instance,
+        /**
+         * A client provided structure to fill out with the statistics
+         */
+        lub_partition_stats_t *stats
+    );
+/**
+ * This is a fundamental allocation function, for use as the "sysalloc" of
+ * a partition, which maps memory directly from the system.
+ * A request which is a multiple of LUB_PARTITION_HUGE_PAGE_SIZE is aligned
+ * so that it may be backed by huge pages.
+ * (POSIX only)
+ */
+void *
+    lub_partition_mmap_alloc(
+        /**
+         * The number of bytes required
+         */
+        size_t required
+    );
+/**
+ * This is the corresponding release function, for use as the "sysfree"
+ * of a partition.
+ * (POSIX only)
+ */
+void
+    lub_partition_mmap_free(
+        /**
+         * The memory previously obtained from lub_partition_mmap_alloc()
+         */
+        void *ptr,
+        /**
+         * The number of bytes which were requested
+         */
+        size_t size
+    );
+/**
+ * The size of a huge page, which may be used as the "segment_granularity"
+ * of a partition using lub_partition_mmap_alloc()
+ */
+#define LUB_PARTITION_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 /**
  * This operation dumps the salient details of the specified partition to stdout
  */
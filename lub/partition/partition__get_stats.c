@@ -0,0 +1,47 @@
+/*
+ * partition__get_stats.c
+ */
+#include "private.h"
+
+/*-------------------------------------------------------- */
+static void
+lub_partition_count_resident(void    *segment,
+                             unsigned index,
+                             size_t   size,
+                             void    *arg)
+{
+    lub_partition_stats_t *stats = arg;
+
+    stats->resident_bytes += lub_partition_resident(segment,size);
+}
+/*-------------------------------------------------------- */
+void
+lub_partition__get_stats(lub_partition_t       *this,
+                         lub_partition_stats_t *stats)
+{
+    lub_partition_segment_t *segment;
+
+    stats->reserved_bytes = 0;
+    stats->resident_bytes = 0;
+    stats->idle_segs      = 0;
+    stats->idle_bytes     = 0;
+
+    lub_partition_lock(this);
+    stats->reserved_bytes = this->m_reserved_bytes;
+    if(this->m_global_heap)
+    {
+        lub_heap_foreach_segment(this->m_global_heap,
+                                 lub_partition_count_resident,
+                                 stats);
+    }
+    for(segment = this->m_idle_segments;
+        segment;
+        segment = segment->m_next)
+    {
+        ++stats->idle_segs;
+        stats->idle_bytes     += segment->m_size;
+        stats->resident_bytes += lub_partition_resident(segment,segment->m_size);
+    }
+    lub_partition_unlock(this);
+}
+/*-------------------------------------------------------- */
@@ -0,0 +1,28 @@
+/*
+ * partition_add_segment.c
+ */
+#include "private.h"
+
+/*-------------------------------------------------------- */
+void
+lub_partition_add_segment(lub_partition_t *this,
+                          void            *segment,
+                          size_t           size)
+{
+    lub_heap_stats_t stats;
+    size_t           segs;
+
+    lub_heap__get_stats(this->m_global_heap,&stats);
+    segs = stats.segs;
+    lub_heap_add_segment(this->m_global_heap,segment,size);
+    lub_heap__get_stats(this->m_global_heap,&stats);
+    if(segs == stats.segs)
+    {
+        /*
+         * The heap has simply extended the segment which holds it, so
+         * this memory goes back to the system along with the heap.
+         */
+        this->m_heap_segment_size += size;
+    }
+}
+/*-------------------------------------------------------- */
@@ -10,8 +10,16 @@ void
 lub_partition_destroy_local_heap(lub_partition_t *this,
                                  lub_heap_t      *local_heap) 
 {
+    lub_partition_local_t *local = lub_partition_local_from_heap(local_heap);
+
+    /* return any cached blocks */
+    lub_partition_magazine_flush(this,local_heap);
+
     lub_heap_destroy(local_heap);
     /* now release the memory */
-    lub_partition_global_realloc(this,(char**)&local_heap,0,LUB_HEAP_ALIGN_NATIVE);
+    lub_partition_lock(this);
+    --this->m_internal_blocks;
+    (void)lub_partition_global_realloc_locked(this,(char**)&local,0,LUB_HEAP_ALIGN_NATIVE,0);
+    lub_partition_unlock(this);
 }
 /*-------------------------------------------------------- */
@@ -4,6 +4,10 @@
 #include "private.h"
 
 /*-------------------------------------------------------- */
+/*
+ * This is called with the partition locked; the system allocation
+ * function isn't required to be thread safe.
+ */
 bool_t
 lub_partition_extend_memory(lub_partition_t *this,
                              size_t           required)
@@ -12,9 +16,7 @@ lub_partition_extend_memory(lub_partition_t *this,
     void  *segment = lub_partition_segment_alloc(this,&required);
     if(segment)
     {
-        lub_partition_lock(this);
-        lub_heap_add_segment(this->m_global_heap,segment,required);
-        lub_partition_unlock(this);
+        lub_partition_add_segment(this,segment,required);
         result = BOOL_TRUE;
     }
     return result;
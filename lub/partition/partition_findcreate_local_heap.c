@@ -1,8 +1,56 @@
 /*
  * partition_findcreate_local_heap.c
  */
+#include <string.h>
+
 #include "private.h"
 
+/*-------------------------------------------------------- */
+static lub_heap_t *
+lub_partition_create_local_heap(lub_partition_t *this)
+{
+    lub_partition_local_t *local = 0;
+    lub_heap_t            *local_heap = 0;
+    size_t                 required;
+
+    /* work out how big the local heap will be... */
+    required = lub_heap_overhead_size(this->m_spec.max_local_block_size,
+                                      this->m_spec.num_local_max_blocks);
+    /* 
+     * create a local heap for the current thread which 
+     * just contains a cache, with the magazines in front of it.
+     * Other threads update the remote list, so keep it to itself
+     * in a cache line.
+     */
+    (void)lub_partition_global_realloc(this,
+                                       (char**)&local,
+                                       sizeof(lub_partition_local_t) + required,
+                                       LUB_HEAP_ALIGN_2_POWER_6,
+                                       0);
+    if(local)
+    {
+        lub_partition_lock(this);
+        ++this->m_internal_blocks;
+        lub_partition_unlock(this);
+
+        memset(local,0,sizeof(lub_partition_local_t));
+
+        /* a magazine for each size up to the largest local block */
+        while((local->m_num_classes < LUB_PARTITION_NUM_CLASSES) &&
+              ((LUB_PARTITION_MIN_CLASS_SIZE << local->m_num_classes) 
+                <= this->m_spec.max_local_block_size))
+        {
+            ++local->m_num_classes;
+        }
+        /* initialise the heap object */
+        local_heap = lub_partition_heap_from_local(local);
+        lub_heap_create(local_heap,required);
+        lub_heap_cache_init(local_heap,
+                            this->m_spec.max_local_block_size,
+                            this->m_spec.num_local_max_blocks);
+    }
+    return local_heap;
+}
 /*-------------------------------------------------------- */
 lub_heap_t *
 lub_partition_findcreate_local_heap(lub_partition_t *this) 
@@ -14,27 +62,25 @@ lub_partition_findcreate_local_heap(lub_partition_t *this)
         local_heap = lub_partition__get_local_heap(this);
         if(!local_heap)
         {
-            size_t required;
-        
-            /* work out how big the local heap will be... */
-            required = lub_heap_overhead_size(this->m_spec.max_local_block_size,
-                                              this->m_spec.num_local_max_blocks);
-            /* 
-             * create a local heap for the current thread which 
-             * just contains a cache
-             */
-            (void)lub_partition_global_realloc(this,
-                                               (char**)&local_heap,
-                                               required,
-                                               LUB_HEAP_ALIGN_NATIVE);
+            lub_partition_local_t *local;
+
+            /* reuse one left behind by a thread which has exited */
+            lub_partition_lock(this);
+            local = this->m_idle_locals;
+            if(local)
+            {
+                this->m_idle_locals = local->m_next_idle;
+                local->m_next_idle  = 0;
+                local_heap          = lub_partition_heap_from_local(local);
+            }
+            lub_partition_unlock(this);
+
+            if(!local_heap)
+            {
+                local_heap = lub_partition_create_local_heap(this);
+            }
             if(local_heap)
             {
-                /* initialise the heap object */
-                lub_heap_create(local_heap,required);
-                lub_heap_cache_init(local_heap,
-                                    this->m_spec.max_local_block_size,
-                                    this->m_spec.num_local_max_blocks);
-            
                 /* store this in the thread specific storage */
                 lub_partition__set_local_heap(this,local_heap);
             }
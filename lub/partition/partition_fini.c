@@ -15,12 +15,55 @@ lub_partition_fini(lub_partition_t *this)
     {
         lub_partition_destroy_local_heap(this,local_heap);
     }
+    /* and those left behind by threads which have exited */
+    while(this->m_idle_locals)
+    {
+        lub_partition_local_t *local = this->m_idle_locals;
+
+        this->m_idle_locals = local->m_next_idle;
+        lub_partition_destroy_local_heap(this,
+                                         lub_partition_heap_from_local(local));
+    }
     /*
      * we need to have destroyed any client threads 
      * before calling this function
      */
     lub_partition_lock(this);
-    lub_heap_destroy(this->m_global_heap);
+    if(this->m_global_heap)
+    {
+        lub_heap_t *heap = this->m_global_heap;
+
+        if(this->m_spec.sysfree)
+        {
+            void  *segment;
+            size_t size;
+
+            /* nothing remains allocated so every segment is free */
+            while((segment = lub_heap_remove_free_segment(heap,&size)))
+            {
+                lub_partition_sysfree(this,segment,size);
+            }
+        }
+        lub_heap_destroy(heap);
+        if(this->m_spec.sysfree)
+        {
+            /*
+             * the heap itself lives in the first segment, along with
+             * any segments which were merged onto the end of it
+             */
+            lub_partition_sysfree(this,heap,this->m_heap_segment_size);
+        }
+        this->m_global_heap = 0;
+    }
+    /* hand back the free segments held in reserve */
+    while(this->m_idle_segments)
+    {
+        lub_partition_segment_t *segment = this->m_idle_segments;
+
+        this->m_idle_segments = segment->m_next;
+        this->m_idle_bytes   -= segment->m_size;
+        lub_partition_sysfree(this,segment,segment->m_size);
+    }
     lub_partition_unlock(this);
 }
 /*-------------------------------------------------------- */
@@ -26,5 +26,12 @@ lub_partition_init(lub_partition_t            *this,
     this->m_partition_ceiling = spec->memory_limit ? (spec->memory_limit - sizeof(lub_partition_t)) : -1;
     this->m_dying             = BOOL_FALSE;
     this->m_global_heap       = 0; /* do this on demand */
+    this->m_idle_locals       = 0;
+    this->m_idle_segments     = 0;
+    this->m_idle_bytes        = 0;
+    this->m_reserved_bytes    = 0;
+    this->m_release_mark      = spec->min_segment_size;
+    this->m_heap_segment_size = 0;
+    this->m_internal_blocks   = 0;
 }
 /*-------------------------------------------------------- */
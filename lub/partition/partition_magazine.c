@@ -0,0 +1,360 @@
+/*
+ * partition_magazine.c
+ *
+ * Each thread holds a magazine of free blocks for each power of two
+ * size class, in front of its local heap. These are refilled from,
+ * and drained to, the global heap in batches so that the partition
+ * lock is taken once for many allocations.
+ *
+ * A block remembers the thread whose magazine it was taken from. When
+ * another thread frees it, it is pushed onto that thread's remote list
+ * without taking the lock, and the owner gathers it up when next it
+ * runs short.
+ *
+ * The magazines take the blocks from the global heap uncounted, and
+ * count each one against its real site as it is handed out, and off
+ * again as it is given back.
+ */
+#include <string.h>
+
+#include "private.h"
+
+/* mixed into the header check to make a false match unlikely */
+#define LUB_PARTITION_MAGIC 0x4d41475aUL
+
+/*--------------------------------------------------------- */
+static size_t
+lub_partition_class_size(unsigned size_class)
+{
+    return LUB_PARTITION_MIN_CLASS_SIZE << size_class;
+}
+/*--------------------------------------------------------- */
+static size_t
+lub_partition_block_check(const lub_partition_block_t *block,
+                          unsigned                     size_class)
+{
+    return (size_t)block->m_owner ^ (size_t)block ^ (LUB_PARTITION_MAGIC + size_class);
+}
+/*--------------------------------------------------------- */
+/*
+ * Return the header of a block handed out from a magazine, or NULL if
+ * the pointer references some other memory.
+ */
+static lub_partition_block_t *
+lub_partition_block_from_ptr(char     *ptr,
+                             unsigned *size_class)
+{
+    lub_partition_block_t *block = 0;
+
+    if(ptr && (LUB_HEAP_ZERO_ALLOC != ptr))
+    {
+        size_t check;
+
+        block = &((lub_partition_block_t*)ptr)[-1];
+        check = (block->m_check ^ (size_t)block->m_owner ^ (size_t)block)
+              - LUB_PARTITION_MAGIC;
+        if(check < LUB_PARTITION_NUM_CLASSES)
+        {
+            *size_class = (unsigned)check;
+        }
+        else
+        {
+            block = 0;
+        }
+    }
+    return block;
+}
+/*--------------------------------------------------------- */
+static unsigned
+lub_partition_class_from_size(const lub_partition_local_t *local,
+                              size_t                       size)
+{
+    unsigned size_class;
+
+    size += sizeof(lub_partition_block_t);
+    for(size_class = 0;
+        size_class < local->m_num_classes;
+        ++size_class)
+    {
+        if(size <= lub_partition_class_size(size_class))
+        {
+            break;
+        }
+    }
+    return size_class;
+}
+/*--------------------------------------------------------- */
+/*
+ * Release a number of blocks from the bottom of a magazine to the
+ * global heap.
+ */
+static void
+lub_partition_magazine_drain(lub_partition_t          *this,
+                             lub_partition_magazine_t *magazine,
+                             unsigned                  count)
+{
+    unsigned i;
+
+    lub_partition_lock(this);
+    for(i = 0;
+        i < count;
+        ++i)
+    {
+        (void)lub_heap_realloc(this->m_global_heap,
+                               &magazine->m_blocks[i],
+                               0,
+                               LUB_HEAP_ALIGN_NATIVE);
+    }
+    lub_partition_release_segments(this);
+    lub_partition_unlock(this);
+
+    magazine->m_count -= count;
+    memmove(&magazine->m_blocks[0],
+            &magazine->m_blocks[count],
+            magazine->m_count * sizeof(char*));
+}
+/*--------------------------------------------------------- */
+/*
+ * Take half a magazine's worth of blocks from the global heap
+ */
+static void
+lub_partition_magazine_refill(lub_partition_t       *this,
+                              lub_partition_local_t *local,
+                              unsigned               size_class)
+{
+    lub_partition_magazine_t *magazine = &local->m_magazines[size_class];
+    size_t                    size     = lub_partition_class_size(size_class);
+
+    lub_partition_lock(this);
+    while(magazine->m_count < (LUB_PARTITION_MAGAZINE_SIZE >> 1))
+    {
+        char                  *ptr = 0;
+        lub_partition_block_t *block;
+
+        if(LUB_HEAP_OK != lub_partition_global_realloc_locked(this,
+                                                             &ptr,
+                                                             size,
+                                                             LUB_HEAP_ALIGN_NATIVE,
+                                                             0))
+        {
+            break;
+        }
+        block          = (lub_partition_block_t*)ptr;
+        block->m_owner = local;
+        block->m_check = lub_partition_block_check(block,size_class);
+        magazine->m_blocks[magazine->m_count++] = ptr;
+    }
+    lub_partition_unlock(this);
+}
+/*--------------------------------------------------------- */
+static void
+lub_partition_magazine_put(lub_partition_t       *this,
+                           lub_partition_local_t *local,
+                           lub_partition_block_t *block,
+                           unsigned               size_class)
+{
+    lub_partition_magazine_t *magazine = &local->m_magazines[size_class];
+
+    if(LUB_PARTITION_MAGAZINE_SIZE == magazine->m_count)
+    {
+        /* make room by releasing the least recently used half */
+        lub_partition_magazine_drain(this,
+                                     magazine,
+                                     LUB_PARTITION_MAGAZINE_SIZE >> 1);
+    }
+    magazine->m_blocks[magazine->m_count++] = (char*)block;
+}
+/*--------------------------------------------------------- */
+/*
+ * Gather up the blocks which other threads have freed
+ */
+static void
+lub_partition_magazine_collect(lub_partition_t       *this,
+                               lub_partition_local_t *local)
+{
+    lub_partition_link_t *link = lub_partition_remote_take(&local->m_remote);
+
+    while(link)
+    {
+        lub_partition_link_t  *next       = link->m_next;
+        unsigned               size_class = 0;
+        lub_partition_block_t *block      = lub_partition_block_from_ptr((char*)link,
+                                                                         &size_class);
+        lub_partition_magazine_put(this,local,block,size_class);
+        link = next;
+    }
+}
+/*--------------------------------------------------------- */
+static void
+lub_partition_magazine_free(lub_partition_t       *this,
+                            lub_partition_local_t *local,
+                            lub_partition_block_t *block,
+                            unsigned               size_class)
+{
+    if(this->m_dying)
+    {
+        /* give the memory straight back */
+        char *ptr = (char*)block;
+
+        lub_partition_lock(this);
+        (void)lub_heap_realloc(this->m_global_heap,&ptr,0,LUB_HEAP_ALIGN_NATIVE);
+        lub_partition_unlock(this);
+    }
+    else if(block->m_owner == local)
+    {
+        lub_heap_site_discharge(this->m_global_heap,(char*)block);
+        lub_partition_magazine_put(this,local,block,size_class);
+    }
+    else
+    {
+        lub_heap_site_discharge(this->m_global_heap,(char*)block);
+        /* hand it back to the owning thread */
+        lub_partition_remote_push(&block->m_owner->m_remote,
+                                  (lub_partition_link_t*)&block[1]);
+    }
+}
+/*--------------------------------------------------------- */
+static char *
+lub_partition_magazine_alloc(lub_partition_t       *this,
+                             lub_partition_local_t *local,
+                             unsigned               size_class,
+                             size_t                 size,
+                             const void            *caller)
+{
+    lub_partition_magazine_t *magazine = &local->m_magazines[size_class];
+    lub_partition_block_t    *block;
+
+    if(0 == magazine->m_count)
+    {
+        if(local->m_remote)
+        {
+            lub_partition_magazine_collect(this,local);
+        }
+        if(0 == magazine->m_count)
+        {
+            lub_partition_magazine_refill(this,local,size_class);
+            if(0 == magazine->m_count)
+            {
+                return 0;
+            }
+        }
+    }
+    block = (lub_partition_block_t*)magazine->m_blocks[--magazine->m_count];
+    lub_heap_site_charge(this->m_global_heap,(char*)block,size,caller);
+
+    return (char*)&block[1];
+}
+/*--------------------------------------------------------- */
+bool_t
+lub_partition_magazine_realloc(lub_partition_t   *this,
+                               lub_heap_t        *local_heap,
+                               char             **ptr,
+                               size_t             size,
+                               lub_heap_align_t   alignment,
+                               lub_heap_status_t *status,
+                               const void        *caller)
+{
+    lub_partition_local_t *local = 0;
+    lub_partition_block_t *block;
+    unsigned               size_class = 0;
+
+    if(local_heap)
+    {
+        local = lub_partition_local_from_heap(local_heap);
+    }
+    block = lub_partition_block_from_ptr(*ptr,&size_class);
+    if(block)
+    {
+        if(size && (LUB_HEAP_ALIGN_NATIVE == alignment) &&
+           (size <= lub_partition_class_size(size_class) - sizeof(lub_partition_block_t)))
+        {
+            /* the existing block is big enough */
+            lub_heap_site_discharge(this->m_global_heap,(char*)block);
+            lub_heap_site_charge(this->m_global_heap,(char*)block,size,caller);
+            *status = LUB_HEAP_OK;
+            return BOOL_TRUE;
+        }
+        if(size)
+        {
+            /* move the contents to a new block */
+            char  *new_ptr = 0;
+            size_t used    = lub_partition_class_size(size_class) - sizeof(lub_partition_block_t);
+
+            *status = lub_partition_realloc_by_site(this,&new_ptr,size,alignment,caller);
+            if(LUB_HEAP_OK != *status)
+            {
+                /* leave the existing block alone */
+                return BOOL_TRUE;
+            }
+            memcpy(new_ptr,*ptr,(size < used) ? size : used);
+            lub_partition_magazine_free(this,local,block,size_class);
+            *ptr = new_ptr;
+        }
+        else
+        {
+            lub_partition_magazine_free(this,local,block,size_class);
+            *ptr = LUB_HEAP_ZERO_ALLOC;
+        }
+        *status = LUB_HEAP_OK;
+        return BOOL_TRUE;
+    }
+    if(   local
+       && (0 == *ptr)
+       && size
+       && (LUB_HEAP_ALIGN_NATIVE == alignment)
+       && (BOOL_FALSE == this->m_dying)
+       && (0 == lub_heap__get_framecount()))
+    {
+        /*
+         * Leak detection needs to see each allocation, so magazines are
+         * only used without it.
+         */
+        size_class = lub_partition_class_from_size(local,size);
+        if(size_class < local->m_num_classes)
+        {
+            *ptr = lub_partition_magazine_alloc(this,local,size_class,size,caller);
+            if(*ptr)
+            {
+                *status = LUB_HEAP_OK;
+                return BOOL_TRUE;
+            }
+        }
+    }
+    return BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+void
+lub_partition_magazine_flush(lub_partition_t *this,
+                             lub_heap_t      *local_heap)
+{
+    lub_partition_local_t *local = lub_partition_local_from_heap(local_heap);
+    lub_partition_link_t  *link  = lub_partition_remote_take(&local->m_remote);
+    unsigned               size_class;
+
+    lub_partition_lock(this);
+    for(size_class = 0;
+        size_class < local->m_num_classes;
+        ++size_class)
+    {
+        lub_partition_magazine_t *magazine = &local->m_magazines[size_class];
+
+        while(magazine->m_count)
+        {
+            (void)lub_heap_realloc(this->m_global_heap,
+                                   &magazine->m_blocks[--magazine->m_count],
+                                   0,
+                                   LUB_HEAP_ALIGN_NATIVE);
+        }
+    }
+    while(link)
+    {
+        lub_partition_link_t *next = link->m_next;
+        char                 *ptr  = (char*)&((lub_partition_block_t*)link)[-1];
+
+        (void)lub_heap_realloc(this->m_global_heap,&ptr,0,LUB_HEAP_ALIGN_NATIVE);
+        link = next;
+    }
+    lub_partition_release_segments(this);
+    lub_partition_unlock(this);
+}
+/*--------------------------------------------------------- */
@@ -5,6 +5,12 @@
 
 #include "private.h"
 
+#ifdef __GNUC__
+#define LUB_PARTITION_CALLER() __builtin_return_address(0)
+#else /* not __GNUC__ */
+#define LUB_PARTITION_CALLER() 0
+#endif /* not __GNUC__ */
+
 /*--------------------------------------------------------- */
 void
 lub_partition_stop_here(lub_heap_status_t status,
@@ -25,18 +31,22 @@ lub_partition_time_to_die(lub_partition_t *this)
     lub_heap_t      *local_heap = lub_partition__get_local_heap(this);
     if(local_heap)
     {
+        /* cached blocks don't keep the partition alive */
+        lub_partition_magazine_flush(this,local_heap);
+
         lub_heap__get_stats(local_heap,&stats);
         if(stats.alloc_blocks)
         {
             time_to_die = BOOL_FALSE;
         }
     }
-    if(BOOL_FALSE == time_to_die)
+    if((BOOL_TRUE == time_to_die) && this->m_global_heap)
     {
         lub_partition_lock(this);
         lub_heap__get_stats(this->m_global_heap,&stats);
         lub_partition_unlock(this);
-        if(stats.alloc_blocks)
+        /* the local heaps etc. don't keep the partition alive */
+        if(stats.alloc_blocks > this->m_internal_blocks)
         {
             time_to_die = BOOL_FALSE;
         }
@@ -49,13 +59,13 @@ lub_partition_time_to_die(lub_partition_t *this)
 }
 /*--------------------------------------------------------- */
 lub_heap_status_t
-lub_partition_global_realloc(lub_partition_t *this,
-                             char           **ptr,
-                             size_t           size,
-                             lub_heap_align_t alignment)
+lub_partition_global_realloc_locked(lub_partition_t *this,
+                                    char           **ptr,
+                                    size_t           size,
+                                    lub_heap_align_t alignment,
+                                    const void      *caller)
 {
     lub_heap_status_t status = LUB_HEAP_FAILED;
-    lub_partition_lock(this);
     if(!this->m_global_heap)
     {
         /*
@@ -63,30 +73,57 @@ lub_partition_global_realloc(lub_partition_t *this,
          */
         size_t required     = size;
         void  *segment      = lub_partition_segment_alloc(this,&required);
-        this->m_global_heap = lub_heap_create(segment,required);
+        if(segment)
+        {
+            /* the global heap sees most of the traffic so use the faster index */
+            this->m_global_heap       = lub_heap_create_indexed(segment,
+                                                                required,
+                                                                LUB_HEAP_INDEX_TLSF);
+            this->m_heap_segment_size = required;
+        }
     }
     if(this->m_global_heap)
     {
-        status = lub_heap_realloc(this->m_global_heap,ptr,size,alignment);
+        status = lub_heap_realloc_by_site(this->m_global_heap,
+                                          ptr,size,alignment,caller);
         if(LUB_HEAP_FAILED == status)
         {
             /* expand memory and try again */
             if(lub_partition_extend_memory(this,size))
             {
-                status = lub_heap_realloc(this->m_global_heap,
-                                          ptr,size,alignment);
+                status = lub_heap_realloc_by_site(this->m_global_heap,
+                                                  ptr,size,alignment,caller);
             }
         }
+        else if(0 == size)
+        {
+            /* this may have left a segment unused */
+            lub_partition_release_segments(this);
+        }
     }
+    return status;
+}
+/*--------------------------------------------------------- */
+lub_heap_status_t
+lub_partition_global_realloc(lub_partition_t *this,
+                             char           **ptr,
+                             size_t           size,
+                             lub_heap_align_t alignment,
+                             const void      *caller)
+{
+    lub_heap_status_t status;
+    lub_partition_lock(this);
+    status = lub_partition_global_realloc_locked(this,ptr,size,alignment,caller);
     lub_partition_unlock(this);
     return status;
 }
 /*--------------------------------------------------------- */
 lub_heap_status_t
-lub_partition_realloc(lub_partition_t *this,
-                      char           **ptr,
-                      size_t           size,
-                      lub_heap_align_t alignment)
+lub_partition_realloc_by_site(lub_partition_t *this,
+                              char           **ptr,
+                              size_t           size,
+                              lub_heap_align_t alignment,
+                              const void      *caller)
 {
     lub_heap_status_t status         = LUB_HEAP_FAILED;
     size_t            requested_size = size;
@@ -110,10 +147,20 @@ lub_partition_realloc(lub_partition_t *this,
     {
         local_heap = lub_partition_findcreate_local_heap(this);
     }
-    if(local_heap)
+    if(BOOL_TRUE == lub_partition_magazine_realloc(this,
+                                                   local_heap,
+                                                   ptr,
+                                                   size,
+                                                   alignment,
+                                                   &status,
+                                                   caller))
+    {
+        /* satisfied from (or returned to) a magazine */
+    }
+    else if(local_heap)
     {
         /* try the fast local heap first */
-        status = lub_heap_realloc(local_heap,ptr,size,alignment);
+        status = lub_heap_realloc_by_site(local_heap,ptr,size,alignment,caller);
     }
     if((LUB_HEAP_FAILED == status) || (LUB_HEAP_INVALID_POINTER == status))
     {
@@ -126,14 +173,14 @@ lub_partition_realloc(lub_partition_t *this,
             *ptr    = 0;
         }
         /* time to use the slower global heap */
-        status = lub_partition_global_realloc(this,ptr,size,alignment);
+        status = lub_partition_global_realloc(this,ptr,size,alignment,caller);
         if(old_ptr && (LUB_HEAP_OK == status))
         {
             /* copy from the local to the global */
             memcpy(*ptr,old_ptr,size);
 
             /* and release the local block */
-            status = lub_heap_realloc(local_heap,&old_ptr,0,alignment);
+            status = lub_heap_realloc_by_site(local_heap,&old_ptr,0,alignment,0);
         }
     }
     if(LUB_HEAP_OK != status)
@@ -153,3 +200,19 @@ lub_partition_realloc(lub_partition_t *this,
     return status;
 }
 /*-------------------------------------------------------- */
+lub_heap_status_t
+lub_partition_realloc(lub_partition_t *this,
+                      char           **ptr,
+                      size_t           size,
+                      lub_heap_align_t alignment)
+{
+    const void *caller = 0;
+
+    if(BOOL_TRUE == lub_heap__get_site_stats())
+    {
+        /* the magazines hide the real caller from the heaps */
+        caller = lub_heap_site_caller(LUB_PARTITION_CALLER());
+    }
+    return lub_partition_realloc_by_site(this,ptr,size,alignment,caller);
+}
+/*-------------------------------------------------------- */
@@ -0,0 +1,33 @@
+/*
+ * partition_release_local_heap.c
+ */
+#include "private.h"
+
+/*-------------------------------------------------------- */
+void
+lub_partition_release_local_heap(lub_partition_t *this,
+                                 lub_heap_t      *local_heap) 
+{
+    lub_partition_local_t *local = lub_partition_local_from_heap(local_heap);
+
+    if(this->m_dying)
+    {
+        lub_partition_destroy_local_heap(this,local_heap);
+    }
+    else
+    {
+        /* return any cached blocks */
+        lub_partition_magazine_flush(this,local_heap);
+
+        /* 
+         * Blocks from this heap may still be held by other threads,
+         * and they may still hand blocks back to it, so keep it for
+         * the next thread to start.
+         */
+        lub_partition_lock(this);
+        local->m_next_idle  = this->m_idle_locals;
+        this->m_idle_locals = local;
+        lub_partition_unlock(this);
+    }
+}
+/*-------------------------------------------------------- */
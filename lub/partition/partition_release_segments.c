@@ -0,0 +1,63 @@
+/*
+ * partition_release_segments.c
+ */
+#include "private.h"
+
+/*-------------------------------------------------------- */
+void
+lub_partition_release_segments(lub_partition_t *this)
+{
+    lub_heap_stats_t stats;
+    void            *segment;
+    size_t           size;
+    size_t           slack = this->m_spec.min_segment_size;
+
+    if(!this->m_spec.sysfree || !this->m_global_heap)
+    {
+        return;
+    }
+    lub_heap__get_stats(this->m_global_heap,&stats);
+    if(stats.free_bytes < this->m_release_mark)
+    {
+        if(stats.free_bytes + slack < this->m_release_mark)
+        {
+            /* follow the free memory down so a rise is noticed */
+            this->m_release_mark = stats.free_bytes + slack;
+        }
+        return;
+    }
+    /*
+     * Only look at the segments once a further segment's worth of
+     * memory has been freed.
+     */
+    while((segment = lub_heap_remove_free_segment(this->m_global_heap,&size)))
+    {
+        if(stats.free_bytes < size + slack)
+        {
+            /* 
+             * leave some memory free so that a segment isn't handed 
+             * back only to be needed again straight away
+             */
+            lub_partition_add_segment(this,segment,size);
+            break;
+        }
+        if(this->m_idle_bytes + size <= this->m_spec.idle_threshold)
+        {
+            lub_partition_segment_t *idle = segment;
+
+            /* keep the address space but give the pages back */
+            lub_partition_decommit(idle,size);
+            idle->m_size          = size;
+            idle->m_next          = this->m_idle_segments;
+            this->m_idle_segments = idle;
+            this->m_idle_bytes   += size;
+        }
+        else
+        {
+            lub_partition_sysfree(this,segment,size);
+        }
+        lub_heap__get_stats(this->m_global_heap,&stats);
+    }
+    this->m_release_mark = stats.free_bytes + slack;
+}
+/*-------------------------------------------------------- */
@@ -3,17 +3,67 @@
  */
 #include "private.h"
 
+/*-------------------------------------------------------- */
+/*
+ * Take the smallest free segment held in reserve which is big enough
+ */
+static void *
+lub_partition_segment_reuse(lub_partition_t *this,
+                            size_t          *required)
+{
+    lub_partition_segment_t **ptr;
+    lub_partition_segment_t **best = 0;
+    lub_partition_segment_t  *segment;
+
+    for(ptr = &this->m_idle_segments;
+        *ptr;
+        ptr = &(*ptr)->m_next)
+    {
+        if(((*ptr)->m_size >= *required) &&
+           (!best || ((*ptr)->m_size < (*best)->m_size)))
+        {
+            best = ptr;
+        }
+    }
+    if(!best)
+    {
+        return 0;
+    }
+    segment = *best;
+    *best   = segment->m_next;
+
+    this->m_idle_bytes -= segment->m_size;
+    *required           = segment->m_size;
+
+    return segment;
+}
 /*-------------------------------------------------------- */
 void *
 lub_partition_segment_alloc(lub_partition_t *this,
                             size_t          *required)
 {
+    size_t granularity = this->m_spec.segment_granularity;
+    void  *segment;
+
     if(*required < this->m_spec.min_segment_size)
     {
         *required = (this->m_spec.min_segment_size >> 1);
     }
     /* double the required size */
     *required <<= 1;
-    return lub_partition_sysalloc(this,*required);
+
+    /* the heap deals in whole words */
+    if(!granularity)
+    {
+        granularity = sizeof(void*);
+    }
+    *required = ((*required + granularity - 1) / granularity) * granularity;
+
+    segment = lub_partition_segment_reuse(this,required);
+    if(!segment)
+    {
+        segment = lub_partition_sysalloc(this,*required);
+    }
+    return segment;
 }
 /*-------------------------------------------------------- */
@@ -9,7 +9,10 @@ void
 lub_partition_show(lub_partition_t *this,
                    bool_t           verbose)
 {
-    lub_heap_t *local_heap = lub_partition__get_local_heap(this);
+    lub_heap_t           *local_heap = lub_partition__get_local_heap(this);
+    lub_partition_stats_t stats;
+
+    lub_partition__get_stats(this,&stats);
     lub_partition_lock(this);
     if(verbose)
     {
@@ -19,6 +22,11 @@ lub_partition_show(lub_partition_t *this,
                (this->m_spec.memory_limit - this->m_partition_ceiling),
                this->m_spec.memory_limit,
                this->m_spec.min_segment_size);
+        printf(" resident(%"SIZE_FMT"/%"SIZE_FMT" reserved bytes), idle segments(%"SIZE_FMT" of %"SIZE_FMT" bytes)\n",
+               stats.resident_bytes,
+               stats.reserved_bytes,
+               stats.idle_segs,
+               stats.idle_bytes);
     }
     if(local_heap)
     {
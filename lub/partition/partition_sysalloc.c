@@ -17,6 +17,7 @@ lub_partition_sysalloc(lub_partition_t *this,
         if(result)
         {
             this->m_partition_ceiling -= required;
+            this->m_reserved_bytes    += required;
         }
     }
     return result;
@@ -0,0 +1,16 @@
+/*
+ * partition_sysfree.c
+ */
+#include "private.h"
+
+/*-------------------------------------------------------- */
+void
+lub_partition_sysfree(lub_partition_t *this,
+                      void            *ptr,
+                      size_t           size)
+{
+    this->m_spec.sysfree(ptr,size);
+    this->m_partition_ceiling += size;
+    this->m_reserved_bytes    -= size;
+}
+/*-------------------------------------------------------- */
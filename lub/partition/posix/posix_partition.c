@@ -22,9 +22,15 @@ struct _key_data
 static void
 lub_posix_partition_destroy_key(void *arg)
 {
-    key_data_t *key_data = arg;
-    lub_partition_destroy_local_heap(key_data->partition,key_data->local_heap);
-    lub_partition_global_realloc(key_data->partition,(char**)key_data,0,LUB_HEAP_ALIGN_NATIVE);
+    key_data_t      *key_data  = arg;
+    lub_partition_t *partition = key_data->partition;
+
+    lub_partition_release_local_heap(partition,key_data->local_heap);
+
+    lub_partition_lock(partition);
+    --partition->m_internal_blocks;
+    (void)lub_partition_global_realloc_locked(partition,(char**)&key_data,0,LUB_HEAP_ALIGN_NATIVE,0);
+    lub_partition_unlock(partition);
 }
 /*-------------------------------------------------------- */
 lub_partition_t *
@@ -48,7 +54,7 @@ void
 lub_posix_partition_init(lub_posix_partition_t      *this,
                          const lub_partition_spec_t *spec)
 {
-    memset(this,sizeof(*this),0);
+    memset(this,0,sizeof(*this));
     /* initialise the base class */
     lub_partition_init(&this->m_base,spec);
     
@@ -68,7 +74,8 @@ lub_posix_partition_init(lub_posix_partition_t      *this,
 void
 lub_partition_destroy(lub_partition_t *instance)
 {
-    lub_posix_partition_t *this = (void*)instance;
+    lub_posix_partition_t    *this    = (void*)instance;
+    lub_partition_sysfree_fn *free_fn = this->m_base.m_spec.sysfree;
 
     /* finalise the base class */
     lub_partition_fini(&this->m_base);
@@ -84,8 +91,15 @@ lub_partition_destroy(lub_partition_t *instance)
     {
         perror("pthread_key_delete() failed!");
     }
-    
-    free(this);
+    /* hand back the memory in the same manner as it was obtained */
+    if(free_fn)
+    {
+        free_fn(this,sizeof(lub_posix_partition_t));
+    }
+    else
+    {
+        free(this);
+    }
 }
 /*-------------------------------------------------------- */
 lub_heap_t *
@@ -112,12 +126,15 @@ lub_partition__set_local_heap(lub_partition_t *instance,
     /* cygwin seems to leak key_data!!! so we ignore this for the time being... */
     lub_heap_leak_suppress_detection(instance->m_global_heap);
     #endif /* __CYGWIN__*/
-    lub_partition_global_realloc(instance,(char**)&key_data,sizeof(key_data_t),LUB_HEAP_ALIGN_NATIVE);
+    lub_partition_global_realloc(instance,(char**)&key_data,sizeof(key_data_t),LUB_HEAP_ALIGN_NATIVE,0);
     #if defined(__CYGWIN__)
     /* cygwin seems to leak key_data!!! so we ignore this for the time being... */
     lub_heap_leak_restore_detection(instance->m_global_heap);
     #endif /* __CYGWIN__*/
     assert(key_data);
+    lub_partition_lock(instance);
+    ++instance->m_internal_blocks;
+    lub_partition_unlock(instance);
     key_data->partition  = instance;
     key_data->local_heap = heap;
     if(0 != pthread_getspecific(this->m_key))
@@ -131,6 +148,25 @@ lub_partition__set_local_heap(lub_partition_t *instance,
 }
 /*-------------------------------------------------------- */
 void
+lub_partition_remote_push(lub_partition_link_t **list,
+                          lub_partition_link_t  *link)
+{
+    lub_partition_link_t *head;
+    do
+    {
+        head         = *(lub_partition_link_t * volatile *)list;
+        link->m_next = head;
+    } while(!__sync_bool_compare_and_swap(list,head,link));
+}
+/*-------------------------------------------------------- */
+lub_partition_link_t *
+lub_partition_remote_take(lub_partition_link_t **list)
+{
+    /* take the whole list at once, so there is no ABA problem */
+    return __sync_lock_test_and_set(list,(lub_partition_link_t*)0);
+}
+/*-------------------------------------------------------- */
+void
 lub_partition_lock(lub_partition_t *instance) 
 {
     lub_posix_partition_t *this = (void*)instance;
@@ -0,0 +1,136 @@
+/*
+ * posix_partition_mmap.c
+ *
+ * Segments mapped directly from the system, rather than taken from
+ * the end of the data segment, can be handed back in any order and
+ * don't get in the way of other users of mmap().
+ */
+#define _DEFAULT_SOURCE /* needed for MAP_ANONYMOUS, madvise() and mincore() */
+#define _BSD_SOURCE
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "private.h"
+
+/* the number of pages examined at once when counting resident pages */
+#define LUB_PARTITION_RESIDENT_CHUNK 64
+
+/*-------------------------------------------------------- */
+static size_t
+lub_partition_page_size(void)
+{
+    static size_t page_size;
+
+    if(!page_size)
+    {
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+    }
+    return page_size;
+}
+/*-------------------------------------------------------- */
+void *
+lub_partition_mmap_alloc(size_t required)
+{
+    size_t huge  = LUB_PARTITION_HUGE_PAGE_SIZE;
+    size_t extra = (0 == (required % huge)) ? huge : 0;
+    char  *start;
+    char  *result;
+
+    /* map an extra huge page so that the result can be aligned */
+    start = mmap(0,
+                 required + extra,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0);
+    if(MAP_FAILED == start)
+    {
+        return 0;
+    }
+    result = start;
+    if(extra)
+    {
+        result = (char*)((((size_t)start) + huge - 1) & ~(huge - 1));
+
+        /* trim the excess from either end */
+        if(result != start)
+        {
+            munmap(start,result - start);
+        }
+        if(result + required != start + required + extra)
+        {
+            munmap(result + required,(start + extra) - result);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(result,required,MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+    }
+    return result;
+}
+/*-------------------------------------------------------- */
+void
+lub_partition_mmap_free(void  *ptr,
+                        size_t size)
+{
+    munmap(ptr,size);
+}
+/*-------------------------------------------------------- */
+void
+lub_partition_decommit(void  *ptr,
+                       size_t size)
+{
+    size_t page_size = lub_partition_page_size();
+    size_t start     = (size_t)ptr + sizeof(lub_partition_segment_t);
+    size_t end       = (size_t)ptr + size;
+
+    /* only whole pages, which don't hold the segment details, can go */
+    start = (start + page_size - 1) & ~(page_size - 1);
+    end  &= ~(page_size - 1);
+    if(end > start)
+    {
+        madvise((void*)start,end - start,MADV_DONTNEED);
+    }
+}
+/*-------------------------------------------------------- */
+size_t
+lub_partition_resident(const void *ptr,
+                       size_t      size)
+{
+    size_t        page_size = lub_partition_page_size();
+    size_t        start     = (size_t)ptr & ~(page_size - 1);
+    size_t        end       = (size_t)ptr + size;
+    size_t        result    = 0;
+    unsigned char vec[LUB_PARTITION_RESIDENT_CHUNK];
+
+    while(start < end)
+    {
+        size_t   length = end - start;
+        unsigned pages;
+        unsigned i;
+
+        if(length > LUB_PARTITION_RESIDENT_CHUNK * page_size)
+        {
+            length = LUB_PARTITION_RESIDENT_CHUNK * page_size;
+        }
+        pages = (unsigned)((length + page_size - 1) / page_size);
+        if(0 != mincore((void*)start,length,vec))
+        {
+            /* assume that memory we can't account for is present */
+            return size;
+        }
+        for(i = 0;
+            i < pages;
+            ++i)
+        {
+            if(vec[i] & 1)
+            {
+                result += page_size;
+            }
+        }
+        start += length;
+    }
+    return (result < size) ? result : size;
+}
+/*-------------------------------------------------------- */
@@ -3,15 +3,90 @@
 #include "lub/heap.h"
 #include "lub/size_fmt.h"
 
+/* the number of size classes held in magazines */
+#define LUB_PARTITION_NUM_CLASSES   16
+/* the number of blocks which each magazine can hold */
+#define LUB_PARTITION_MAGAZINE_SIZE 32
+/* the smallest block (including its header) held in a magazine */
+#define LUB_PARTITION_MIN_CLASS_SIZE (4 * sizeof(void*))
+
+typedef struct _lub_partition_local lub_partition_local_t;
+
+/*
+ * This is placed at the start of each block which is handed out from a
+ * magazine.
+ */
+typedef struct _lub_partition_block lub_partition_block_t;
+struct _lub_partition_block
+{
+    lub_partition_local_t *m_owner; /* the thread which may reuse it   */
+    size_t                 m_check; /* identifies this as a header     */
+};
+
+/*
+ * A free block is linked into the remote list of its owner by means
+ * of its first client word.
+ */
+typedef struct _lub_partition_link lub_partition_link_t;
+struct _lub_partition_link
+{
+    lub_partition_link_t *m_next;
+};
+
+/*
+ * A stack of free blocks of a single size class
+ */
+typedef struct _lub_partition_magazine lub_partition_magazine_t;
+struct _lub_partition_magazine
+{
+    unsigned m_count;
+    char    *m_blocks[LUB_PARTITION_MAGAZINE_SIZE];
+};
+
+/*
+ * The per thread details, which are placed immediately in front of
+ * the thread's local heap.
+ */
+struct _lub_partition_local
+{
+    lub_partition_local_t   *m_next_idle;
+    lub_partition_link_t    *m_remote; /* blocks freed by other threads */
+    unsigned                 m_num_classes;
+    lub_partition_magazine_t m_magazines[LUB_PARTITION_NUM_CLASSES];
+};
+
+/*
+ * A free segment held in reserve, whose pages have been returned to the
+ * system. The details are kept at the start of the segment itself.
+ */
+typedef struct _lub_partition_segment lub_partition_segment_t;
+struct _lub_partition_segment
+{
+    lub_partition_segment_t *m_next;
+    size_t                   m_size;
+};
 
 struct _lub_partition
 {
-    lub_heap_t          *m_global_heap;
-    lub_partition_spec_t m_spec;
-    bool_t               m_dying;
-    size_t               m_partition_ceiling;
+    lub_heap_t              *m_global_heap;
+    lub_partition_spec_t     m_spec;
+    bool_t                   m_dying;
+    size_t                   m_partition_ceiling;
+    lub_partition_local_t   *m_idle_locals;       /* left by old threads    */
+    lub_partition_segment_t *m_idle_segments;     /* free ones in reserve   */
+    size_t                   m_idle_bytes;
+    size_t                   m_reserved_bytes;    /* held from the system   */
+    size_t                   m_release_mark;      /* free bytes to look at  */
+    size_t                   m_heap_segment_size; /* holding the heap, and */
+                                                  /* any merged onto it     */
+    size_t                   m_internal_blocks;   /* global ones we hold    */
 };
 
+#define lub_partition_local_from_heap(heap) \
+    (&((lub_partition_local_t*)(heap))[-1])
+#define lub_partition_heap_from_local(local) \
+    ((lub_heap_t*)&(local)[1])
+
 lub_heap_t *
 lub_partition__get_local_heap(lub_partition_t *instance);
 
@@ -25,12 +100,43 @@ lub_partition_lock(lub_partition_t *instance);
 void
 lub_partition_unlock(lub_partition_t *instance);
 
+/*
+ * Atomically add a block to a list
+ */
+void
+lub_partition_remote_push(lub_partition_link_t **list,
+                          lub_partition_link_t  *link);
+/*
+ * Atomically remove every block from a list
+ */
+lub_partition_link_t *
+lub_partition_remote_take(lub_partition_link_t **list);
 
+/*
+ * The 'caller' is the site to count a new allocation against, or NULL
+ * for the partition's own use.
+ */
+lub_heap_status_t
+lub_partition_global_realloc_locked(lub_partition_t *instance,
+                                    char           **ptr,
+                                    size_t           size,
+                                    lub_heap_align_t alignment,
+                                    const void      *caller);
 lub_heap_status_t
 lub_partition_global_realloc(lub_partition_t *instance,
                              char           **ptr,
                              size_t           size,
-                             lub_heap_align_t alignment);
+                             lub_heap_align_t alignment,
+                             const void      *caller);
+/*
+ * lub_partition_realloc() on behalf of the specified site
+ */
+lub_heap_status_t
+lub_partition_realloc_by_site(lub_partition_t *instance,
+                              char           **ptr,
+                              size_t           size,
+                              lub_heap_align_t alignment,
+                              const void      *caller);
 void *
 lub_partition_segment_alloc(lub_partition_t *instance,
                             size_t          *required);
@@ -38,6 +144,35 @@ lub_partition_segment_alloc(lub_partition_t *instance,
 void
 lub_partition_destroy_local_heap(lub_partition_t *instance,
                                  lub_heap_t      *local_heap); 
+/*
+ * Called as a thread exits; the local heap is kept for reuse by a
+ * later thread, as other threads may still hold blocks from it.
+ */
+void
+lub_partition_release_local_heap(lub_partition_t *instance,
+                                 lub_heap_t      *local_heap);
+/*
+ * Handle the request if it concerns a magazine.
+ *
+ * \return
+ * - BOOL_TRUE  - if the request has been handled and "status" set
+ * - BOOL_FALSE - if the request should be made of the heaps
+ */
+bool_t
+lub_partition_magazine_realloc(lub_partition_t   *instance,
+                               lub_heap_t        *local_heap,
+                               char             **ptr,
+                               size_t             size,
+                               lub_heap_align_t   alignment,
+                               lub_heap_status_t *status,
+                               const void        *caller);
+/*
+ * Return every block held in the magazines of a local heap, along
+ * with any freed by other threads, to the global heap.
+ */
+void
+lub_partition_magazine_flush(lub_partition_t *instance,
+                             lub_heap_t      *local_heap);
 void
 lub_partition_time_to_die(lub_partition_t *instance);
 
@@ -54,6 +189,40 @@ void *
 lub_partition_sysalloc(lub_partition_t *instance,
                        size_t           required);
 
+void
+lub_partition_sysfree(lub_partition_t *instance,
+                      void            *ptr,
+                      size_t           size);
+/*
+ * Give a segment to the global heap.
+ * This is called with the partition locked.
+ */
+void
+lub_partition_add_segment(lub_partition_t *instance,
+                          void            *segment,
+                          size_t           size);
+/*
+ * Hand back any segments of the global heap which have become free.
+ * This is called with the partition locked.
+ */
+void
+lub_partition_release_segments(lub_partition_t *instance);
+
+/*
+ * Return the pages of a segment to the system, whilst keeping the
+ * address space and the first few bytes.
+ */
+void
+lub_partition_decommit(void  *ptr,
+                       size_t size);
+
+/*
+ * Return how many of the specified bytes occupy physical memory
+ */
+size_t
+lub_partition_resident(const void *ptr,
+                       size_t      size);
+
 void
 lub_partition_init(lub_partition_t            *instance,
                    const lub_partition_spec_t *spec);
@@ -6,6 +6,7 @@
 
 #include <taskLib.h>
 #include <taskHookLib.h>
+#include <intLib.h>
 
 #include "private.h"
 
@@ -28,7 +29,7 @@ lub_vxworks_partition_task_delete_hook(WIND_TCB *pTcb)
         if(ERROR != val)
         {
             /* destroy this local heap */
-            lub_partition_destroy_local_heap(&(*ptr)->m_base,(void*)val);
+            lub_partition_release_local_heap(&(*ptr)->m_base,(void*)val);
 
             /* and remove the task variable */
             taskVarDelete(tid,(int*)&(*ptr)->m_local_heap);
@@ -128,6 +129,30 @@ lub_partition__set_local_heap(lub_partition_t *instance,
 }
 /*-------------------------------------------------------- */
 void
+lub_partition_remote_push(lub_partition_link_t **list,
+                          lub_partition_link_t  *link)
+{
+    int key = intLock();
+
+    link->m_next = *list;
+    *list        = link;
+    intUnlock(key);
+}
+/*-------------------------------------------------------- */
+lub_partition_link_t *
+lub_partition_remote_take(lub_partition_link_t **list)
+{
+    lub_partition_link_t *result;
+    int                   key = intLock();
+
+    result = *list;
+    *list  = 0;
+    intUnlock(key);
+
+    return result;
+}
+/*-------------------------------------------------------- */
+void
 lub_partition_lock(lub_partition_t *instance) 
 {
     lub_vxworks_partition_t *this = (void*)instance;
@@ -149,3 +174,21 @@ lub_partition_unlock(lub_partition_t *instance)
     }
 }
 /*-------------------------------------------------------- */
+void
+lub_partition_decommit(void  *ptr,
+                       size_t size)
+{
+    /* without virtual memory the pages cannot be given back */
+    ptr  = ptr;
+    size = size;
+}
+/*-------------------------------------------------------- */
+size_t
+lub_partition_resident(const void *ptr,
+                       size_t      size)
+{
+    /* all memory is physical memory */
+    ptr = ptr;
+    return size;
+}
+/*-------------------------------------------------------- */
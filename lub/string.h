@@ -236,6 +236,174 @@ void
         char *string
     );
 
+/**
+ * This type is used to build up a string piece by piece.
+ *
+ * Unlike lub_string_cat() it remembers the length of the string it holds
+ * and grows its buffer geometrically, so appending to it costs time in
+ * proportion to the text appended rather than to the string built so far.
+ *
+ * The client may supply some (typically stack based) storage to be used
+ * until the string outgrows it, after which dynamic memory is used.
+ *
+ * The fields are visible only so that a client may place a string buffer
+ * on the stack; they should be accessed through the functions below.
+ */
+typedef struct lub_strbuf_s lub_strbuf_t;
+struct lub_strbuf_s
+{
+    char   *buffer;   /* the string built so far */
+    size_t  length;   /* the length of the string */
+    size_t  size;     /* the size of the buffer */
+    char   *storage;  /* the client supplied storage (if any) */
+    size_t  capacity; /* the size of the client supplied storage */
+};
+/**
+ * This operation initialises a string buffer to hold an empty string.
+ *
+ * \pre 
+ * - 'storage' must either be NULL or reference 'size' bytes of memory
+ *   which remain valid for the lifetime of the string buffer.
+ * 
+ * \post 
+ * - The string buffer holds an empty string.
+ * - The client is responsible for calling lub_strbuf_fini() when they
+ *   are finished using the string buffer.
+ */
+void
+    lub_strbuf_init(
+        /**
+         * The string buffer instance to initialise
+         */
+        lub_strbuf_t *instance,
+        /**
+         * Some storage to use before resorting to dynamic memory
+         * (or NULL)
+         */
+        char         *storage,
+        /**
+         * The size of the specified storage
+         */
+        size_t        size
+    );
+/**
+ * This operation releases the resources associated with a string buffer.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ * 
+ * \post 
+ * - The string buffer must be initialised again before it is reused.
+ */
+void
+    lub_strbuf_fini(
+        /**
+         * The string buffer instance to finalise
+         */
+        lub_strbuf_t *instance
+    );
+/**
+ * This operation appends some text to a string buffer.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ * 
+ * \post 
+ * - If there is insufficient resource to extend the string then it will not
+ *   be extended.
+ */
+void
+    lub_strbuf_cat(
+        /**
+         * The string buffer instance
+         */
+        lub_strbuf_t *instance,
+        /**
+         * The text to be appended
+         */
+        const char   *text
+    );
+/**
+ * This operation appends a specified length of some text to a string
+ * buffer.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ * 
+ * \post 
+ * - If there is insufficient resource to extend the string then it will not
+ *   be extended.
+ * - If the length passed in is greater than that of the specified 'text'
+ *   then the length of the 'text' will be assumed.
+ */
+void
+    lub_strbuf_catn(
+        /**
+         * The string buffer instance
+         */
+        lub_strbuf_t *instance,
+        /**
+         * The text to be appended
+         */
+        const char   *text,
+        /**
+         * The length of text to be appended
+         */
+        size_t        length
+    );
+/**
+ * This operation hands the string built so far over to the client.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ * 
+ * \return
+ * A dynamically allocated string containing the content of the string
+ * buffer.
+ *
+ * \post 
+ * - The string buffer holds an empty string.
+ * - The client is responsible for calling lub_string_free() with the
+ *   returned string when they are finished using it.
+ */
+char *
+    lub_strbuf_detach(
+        /**
+         * The string buffer instance
+         */
+        lub_strbuf_t *instance
+    );
+/**
+ * This operation returns the string built so far.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ * 
+ * \return
+ * The string held by the buffer, which remains valid until the 
+ * string buffer is next modified.
+ */
+const char *
+    lub_strbuf__get_string(
+        /**
+         * The string buffer instance
+         */
+        const lub_strbuf_t *instance
+    );
+/**
+ * This operation returns the length of the string built so far.
+ *
+ * \pre 
+ * - The string buffer must have been initialised.
+ */
+size_t
+    lub_strbuf__get_length(
+        /**
+         * The string buffer instance
+         */
+        const lub_strbuf_t *instance
+    );
+
  _END_C_DECL
 
 #endif /* _lub_string_h */
@@ -0,0 +1,12 @@
+/*
+ * strbuf__get_length.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+size_t
+lub_strbuf__get_length(const lub_strbuf_t *this)
+{
+    return this->length;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,12 @@
+/*
+ * strbuf__get_string.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+const char *
+lub_strbuf__get_string(const lub_strbuf_t *this)
+{
+    return this->buffer ? this->buffer : "";
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,15 @@
+/*
+ * strbuf_cat.c
+ */
+#include "private.h"
+
+#include <string.h>
+/*--------------------------------------------------------- */
+void
+lub_strbuf_cat(lub_strbuf_t *this,
+               const char   *text)
+{
+    size_t len = text ? strlen(text) : 0;
+    lub_strbuf_catn(this,text,len);
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,80 @@
+/*
+ * strbuf_catn.c
+ */
+#include "private.h"
+#include "lub/types.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+/* the smallest dynamically allocated buffer */
+#define LUB_STRBUF_MIN_SIZE 64
+
+/*--------------------------------------------------------- */
+/*
+ * Make sure there is room for 'size' bytes in the buffer, doubling 
+ * its size as necessary so that the cost of growing the buffer is 
+ * spread over the text appended to it.
+ */
+static bool_t
+lub_strbuf_reserve(lub_strbuf_t *this,
+                   size_t        size)
+{
+    size_t  newsize = this->size ? this->size : LUB_STRBUF_MIN_SIZE;
+    char   *q;
+
+    if(size <= this->size)
+    {
+        /* nothing to do */
+        return BOOL_TRUE;
+    }
+    while(newsize < size)
+    {
+        newsize *= 2;
+    }
+    if(this->buffer == this->storage)
+    {
+        /* move out of the client supplied storage */
+        q = malloc(newsize);
+        if((NULL != q) && (NULL != this->buffer))
+        {
+            memcpy(q,this->buffer,this->length + 1);
+        }
+    }
+    else
+    {
+        q = realloc(this->buffer,newsize);
+    }
+    if(NULL == q)
+    {
+        return BOOL_FALSE;
+    }
+    this->buffer = q;
+    this->size   = newsize;
+
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------- */
+void
+lub_strbuf_catn(lub_strbuf_t *this,
+                const char   *text,
+                size_t        len)
+{
+    if(text)
+    {
+        /* make sure the client cannot give us duff details */
+        const char *end = memchr(text,'\0',len);
+        if(NULL != end)
+        {
+            len = end - text;
+        }
+        /* account for '\0' */
+        if(BOOL_TRUE == lub_strbuf_reserve(this,this->length + len + 1))
+        {
+            memcpy(&this->buffer[this->length],text,len);
+            this->length += len;
+            this->buffer[this->length] = '\0';
+        }
+    }
+}
+/*--------------------------------------------------------- */
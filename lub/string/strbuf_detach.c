@@ -0,0 +1,31 @@
+/*
+ * strbuf_detach.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+char *
+lub_strbuf_detach(lub_strbuf_t *this)
+{
+    char *result;
+
+    if(this->buffer == this->storage)
+    {
+        /* the client storage cannot be handed over */
+        result = lub_string_dupn(lub_strbuf__get_string(this),this->length);
+    }
+    else
+    {
+        /* hand over the dynamic buffer */
+        result       = this->buffer;
+        this->buffer = this->storage;
+        this->size   = this->capacity;
+    }
+    this->length = 0;
+    if(this->buffer)
+    {
+        this->buffer[0] = '\0';
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,20 @@
+/*
+ * strbuf_fini.c
+ */
+#include "private.h"
+
+#include <stdlib.h>
+
+/*--------------------------------------------------------- */
+void
+lub_strbuf_fini(lub_strbuf_t *this)
+{
+    if(this->buffer != this->storage)
+    {
+        free(this->buffer);
+    }
+    this->buffer = NULL;
+    this->length = 0;
+    this->size   = 0;
+}
+/*--------------------------------------------------------- */
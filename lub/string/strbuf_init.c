@@ -0,0 +1,22 @@
+/*
+ * strbuf_init.c
+ */
+#include "private.h"
+
+/*--------------------------------------------------------- */
+void
+lub_strbuf_init(lub_strbuf_t *this,
+                char         *storage,
+                size_t        size)
+{
+    this->length   = 0;
+    this->storage  = size ? storage : NULL;
+    this->capacity = this->storage ? size : 0;
+    this->buffer   = this->storage;
+    this->size     = this->capacity;
+    if(this->buffer)
+    {
+        this->buffer[0] = '\0';
+    }
+}
+/*--------------------------------------------------------- */
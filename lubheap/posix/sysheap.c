@@ -3,8 +3,8 @@
  *
  * This is a replacement of the POSIX memory management system
  * 
- * It uses sbrk() to obtain memory chunks for use by the lub_heap 
- * component
+ * It maps memory segments directly from the system for use by the
+ * lub_heap component, and hands them back once they are no longer used.
  * 
  * We undefine the public functions
  * (just in case they've been MACRO overriden
@@ -22,8 +22,6 @@
 #include <sys/mman.h>
 #include <pthread.h>
 #include <string.h>
-#define __USE_XOPEN_EXTENDED /* needed for sbrk() */
-#include <unistd.h>
 
 #include "lub/partition/posix/private.h"
 
@@ -35,15 +33,9 @@ static lub_partition_t      *sys_partition = &sysMemPartition.m_base;
 static lub_heap_show_e       show_mode   = LUB_HEAP_SHOW_LEAKS;
 static const char           *leak_filter = 0;
 
-/* the partition is extended in 128K chunks as needed */
-#define DEFAULT_CHUNK_SIZE (128 * 1024)
+/* free segments kept in reserve before they are unmapped */
+#define IDLE_THRESHOLD (8 * 1024 * 1024)
 
-/*-------------------------------------------------------- */
-static void *
-sysheap_segment_alloc(size_t required)
-{
-    return sbrk(required);
-}
 /*-------------------------------------------------------- */
 void
 sysheap_atexit(void)
@@ -60,14 +52,28 @@ sysheap_init_memory(size_t required)
     {
         lub_partition_spec_t spec = 
         {
-            BOOL_TRUE,            /* use_local_heap       */
-            8192,                 /* max_local_block_size */
-            8,                    /* num_local_max_blocks */
-            1 * 1024 * 1024,      /* min_segment_size     */
-            0,                    /* memory_limit         */
-            sysheap_segment_alloc /* sysalloc             */
+            BOOL_TRUE,                    /* use_local_heap       */
+            8192,                         /* max_local_block_size */
+            8,                            /* num_local_max_blocks */
+            1 * 1024 * 1024,              /* min_segment_size     */
+            0,                            /* memory_limit         */
+            lub_partition_mmap_alloc,     /* sysalloc             */
+            lub_partition_mmap_free,      /* sysfree              */
+            LUB_PARTITION_HUGE_PAGE_SIZE, /* segment_granularity  */
+            IDLE_THRESHOLD                /* idle_threshold       */
         };  
+        const char *sites = getenv("LUBHEAP_SITES");
+
         initialised = BOOL_TRUE;
+        if(NULL != sites)
+        {
+            /* 
+             * count allocations by site, skipping the given number of 
+             * wrappers around lub_partition_realloc(); malloc() is one
+             */
+            lub_heap__set_site_stats(BOOL_TRUE);
+            lub_heap__set_site_skip((unsigned)atoi(sites));
+        }
         lub_posix_partition_init(&sysMemPartition,&spec);
 
 /*        lub_heap_init("");
@@ -352,6 +352,35 @@ int main(int argc, const char *argv[])
 		lub_test_check(LUB_TEST_PASS == status,
 		              "Iterate backwards checking order",t);
  		/*------------------------------------------------------------ */
+                /*
+                 * iterate through the tree forwards without rearranging it
+                 */
+                {
+                        lub_bintree_node_t *root = tree->root;
+                        lub_bintree_key_t   key;
+                        test_node_t        *node;
+			int j = 0;
+
+                	status = LUB_TEST_PASS;
+                        for(node = lub_bintree_peekfirst(tree);
+                            node;
+                            node = lub_bintree_peeknext(tree,&key),j++)
+                        {
+                        	mapping[t].getkey(node,&key);
+                        	if((t == 0) && (node->value != j))
+                        	{
+                        		status = LUB_TEST_FAIL;
+                        		break;
+                        	}
+                        }
+			lub_test_check(LUB_TEST_PASS == status,
+				      "Peek forwards checking order",t);
+			lub_test_check_int(j,NUM_TEST_NODES,
+				          "Check peeking visits every node");
+			lub_test_check(root == tree->root,
+				      "Check peeking leaves the tree as it was");
+                }
+ 		/*------------------------------------------------------------ */
                 lub_test_check(NULL == lub_bintree_find(tree,&mapping[t].nonexistant),
                               "Check search for non-existant node fails");
  		/*------------------------------------------------------------ */
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "lub/test.h"
+#include "lub/hash.h"
+#include "lub/bintree.h"
+/**
+ \example test/hash.c
+ */
+
+/*************************************************************
+ * TEST CODE
+ ************************************************************* */
+
+#define NUM_NODES   2000
+#define NUM_LOOKUPS 400000
+
+static int testseq;
+
+typedef struct
+{
+    lub_bintree_node_t bt_node;
+    char               name[16];
+} node_t;
+
+static node_t nodes[NUM_NODES];
+
+/*--------------------------------------------------------------- */
+static const char *
+node_hash_getkey(const void *clientnode)
+{
+    const node_t *this = clientnode;
+
+    return this->name;
+}
+/*--------------------------------------------------------------- */
+static int
+node_bt_compare(const void *clientnode,
+                const void *clientkey)
+{
+    const node_t *this = clientnode;
+
+    return strcmp(this->name,clientkey);
+}
+/*--------------------------------------------------------------- */
+static void
+node_bt_getkey(const void        *clientnode,
+               lub_bintree_key_t *key)
+{
+    const node_t *this = clientnode;
+
+    strcpy((char *)key,this->name);
+}
+/*--------------------------------------------------------------- */
+/*
+ * Count the nodes which are not found as expected; every "step"th node
+ * should have been removed (none if "step" is zero)
+ */
+static unsigned
+count_missing(const lub_hash_t *hash,
+              unsigned          step)
+{
+    unsigned i,missing = 0;
+
+    for(i = 0;
+        i < NUM_NODES;
+        i++)
+    {
+        void *expected = (step && (0 == i % step)) ? NULL : &nodes[i];
+
+        if(expected != lub_hash_find(hash,nodes[i].name))
+        {
+            missing++;
+        }
+    }
+    return missing;
+}
+/*--------------------------------------------------------------- */
+/* This is the main entry point for this executable
+ */
+int main(int argc, const char *argv[])
+{
+    lub_hash_t    hash;
+    lub_bintree_t tree;
+    node_t        other;
+    char          name[16];
+    unsigned      i,missing;
+    clock_t       start;
+    double        searched,hashed;
+    int           status;
+
+    lub_test_parse_command_line(argc,argv);
+    lub_test_begin("lub_hash");
+
+    for(i = 0;
+        i < NUM_NODES;
+        i++)
+    {
+        sprintf(nodes[i].name,"Node%04u",i);
+    }
+
+    lub_test_seq_begin(++testseq,"lub_hash_insert()");
+
+    lub_hash_init(&hash,node_hash_getkey,BOOL_FALSE);
+    lub_test_check((NULL == lub_hash_find(&hash,"Node0000")),
+                   "Check an empty index finds nothing");
+    for(i = 0;
+        i < NUM_NODES;
+        i++)
+    {
+        if(0 != lub_hash_insert(&hash,&nodes[i]))
+        {
+            break;
+        }
+    }
+    lub_test_check((NUM_NODES == i),
+                   "Check %d nodes are inserted",NUM_NODES);
+    lub_test_check((NUM_NODES == lub_hash__get_count(&hash)),
+                   "Check the index holds %d nodes",NUM_NODES);
+    strcpy(other.name,"Node0042");
+    lub_test_check((-1 == lub_hash_insert(&hash,&other)),
+                   "Check a duplicate key is rejected");
+    lub_test_check((0 == count_missing(&hash,0)),
+                   "Check every node is found");
+    lub_test_check((NULL == lub_hash_find(&hash,"node0042")),
+                   "Check keys are case sensitive by default");
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"lub_hash_remove()");
+
+    for(i = 0;
+        i < NUM_NODES;
+        i += 3)
+    {
+        lub_hash_remove(&hash,&nodes[i]);
+    }
+    lub_hash_remove(&hash,&other);
+    lub_test_check((NUM_NODES - (NUM_NODES + 2) / 3 ==
+                    lub_hash__get_count(&hash)),
+                   "Check every third node is removed");
+    lub_test_check((0 == count_missing(&hash,3)),
+                   "Check the remaining nodes are still found");
+
+    lub_hash_fini(&hash);
+    lub_test_check((NULL == lub_hash_find(&hash,"Node0001")),
+                   "Check a finalised index finds nothing");
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"lub_hash_find() without regard to case");
+
+    lub_hash_init(&hash,node_hash_getkey,BOOL_TRUE);
+    lub_hash_insert(&hash,&nodes[42]);
+    lub_test_check((&nodes[42] == lub_hash_find(&hash,"nODE0042")),
+                   "Check 'nODE0042' finds 'Node0042'");
+    lub_test_check((-1 == lub_hash_insert(&hash,&other)),
+                   "Check a key differing only in case is rejected");
+    lub_hash_fini(&hash);
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"lub_hash_find() against lub_bintree_find()");
+
+    lub_hash_init(&hash,node_hash_getkey,BOOL_FALSE);
+    lub_bintree_init(&tree,
+                     offsetof(node_t,bt_node),
+                     node_bt_compare,
+                     node_bt_getkey);
+    for(i = 0;
+        i < NUM_NODES;
+        i++)
+    {
+        lub_bintree_node_init(&nodes[i].bt_node);
+        lub_bintree_insert(&tree,&nodes[i]);
+        lub_hash_insert(&hash,&nodes[i]);
+    }
+    missing = 0;
+    start   = clock();
+    for(i = 0;
+        i < NUM_LOOKUPS;
+        i++)
+    {
+        sprintf(name,"Node%04u",(i * 7) % NUM_NODES);
+        if(NULL == lub_bintree_find(&tree,name))
+        {
+            missing++;
+        }
+    }
+    searched = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start    = clock();
+    for(i = 0;
+        i < NUM_LOOKUPS;
+        i++)
+    {
+        sprintf(name,"Node%04u",(i * 7) % NUM_NODES);
+        if(NULL == lub_hash_find(&hash,name))
+        {
+            missing++;
+        }
+    }
+    hashed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    lub_test_check((0 == missing),
+                   "Check every lookup succeeds");
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "lub_bintree_find() : %.3f usec per lookup",
+                     searched * 1000000 / NUM_LOOKUPS);
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "lub_hash_find()    : %.3f usec per lookup",
+                     hashed * 1000000 / NUM_LOOKUPS);
+    lub_hash_fini(&hash);
+
+    lub_test_seq_end();
+
+    /* tidy up */
+    status = lub_test_get_status();
+    lub_test_end();
+
+    return status;
+}
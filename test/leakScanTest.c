@@ -0,0 +1,245 @@
+/*
+ * Time how long a leak scan takes for a range of heap sizes and
+ * numbers of scanning threads, checking that each number of threads
+ * finds the same leaks and that the scan leaves the heap segments
+ * alone while it is under way.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "lub/heap.h"
+
+unsigned test_sizes[] =
+{
+    8,
+    32,
+    128,
+    0
+};
+
+typedef struct test_node_s test_node_t;
+struct test_node_s
+{
+    test_node_t *next;
+};
+
+static test_node_t *first_node;
+static unsigned     failures;
+/*--------------------------------------------------------- */
+static void
+check(bool_t      ok,
+      const char *what)
+{
+    printf("*** %s: %s\n",ok ? "pass" : "FAIL",what);
+    if(BOOL_FALSE == ok)
+    {
+        ++failures;
+    }
+}
+/*--------------------------------------------------------- */
+/*
+ * Returns a pseudo random number based on the input.
+ * This will given 2^15 concequtive numbers generate the entire
+ * number space in a psedo random manner.
+ */
+static int
+pseudo_random(int i)
+{
+        /* multiply the first prime after 2^14 and mask to 15 bits */
+        return (16411*i) & (32767);
+}
+/*--------------------------------------------------------- */
+static void
+create_nodes(lub_heap_t *heap)
+{
+    int i;
+
+    /* fill the heap with a linked list of random sized blocks */
+    for(i = 0; ; i++)
+    {
+        /* pick a random size upto 1024 bytes */
+        size_t       size = sizeof(test_node_t) + 1024 * pseudo_random(i) / 32768;
+        test_node_t *node = 0;
+
+        /* keep the links where a scan, which steps a pointer at a time, can see them */
+        if(LUB_HEAP_OK != lub_heap_realloc(heap,(char**)&node,size,LUB_HEAP_ALIGN_2_POWER_4))
+        {
+            break;
+        }
+        node->next = first_node;
+        first_node = node;
+    }
+}
+/*--------------------------------------------------------- */
+static void
+cut_nodes(void)
+{
+    test_node_t *node;
+    unsigned     i = 0;
+
+    /* drop a node from the list every so often to leave some leaks */
+    for(node = first_node; node && node->next; node = node->next)
+    {
+        if(0 == (++i % 100))
+        {
+            node->next = node->next->next;
+        }
+    }
+}
+/*--------------------------------------------------------- */
+/*
+ * Read back the leak and partial counts from the summary record
+ * of an export.
+ */
+static bool_t
+get_counts(unsigned long *leaks,
+           unsigned long *partials)
+{
+    FILE  *file   = tmpfile();
+    bool_t result = BOOL_FALSE;
+    char   line[1024];
+
+    if(NULL == file)
+    {
+        return BOOL_FALSE;
+    }
+    if(BOOL_TRUE == lub_heap_leak_export(fileno(file),LUB_HEAP_SHOW_LEAKS))
+    {
+        rewind(file);
+        while(fgets(line,sizeof(line),file))
+        {
+            const char *leaks_field    = strstr(line,"\"leaks\":");
+            const char *partials_field = strstr(line,"\"partials\":");
+
+            if(strstr(line,"\"type\":\"summary\"") && leaks_field && partials_field)
+            {
+                *leaks    = strtoul(leaks_field + strlen("\"leaks\":"),NULL,10);
+                *partials = strtoul(partials_field + strlen("\"partials\":"),NULL,10);
+                result    = BOOL_TRUE;
+            }
+        }
+    }
+    fclose(file);
+
+    return result;
+}
+/*--------------------------------------------------------- */
+static unsigned long
+time_scan(unsigned threads)
+{
+    struct timespec start_time;
+    struct timespec end_time;
+
+    lub_heap__set_scan_threads(threads);
+
+    clock_gettime(CLOCK_REALTIME,&start_time);
+    lub_heap_leak_scan_start();
+    while(BOOL_FALSE == lub_heap_leak_scan_step(1024 * 1024))
+    {
+    }
+    clock_gettime(CLOCK_REALTIME,&end_time);
+
+    return (end_time.tv_sec  - start_time.tv_sec) * 1000
+         + (end_time.tv_nsec - start_time.tv_nsec) / 1000000;
+}
+/*--------------------------------------------------------- */
+static void
+leakScanTest(unsigned max_threads)
+{
+    unsigned *size_mb;
+
+    /* monitor a sample of the blocks so that the segments dominate */
+    lub_heap__set_framecount(1);
+    lub_heap__set_sample_interval(4096);
+
+    for(size_mb = test_sizes; *size_mb; size_mb++)
+    {
+        size_t      size   = *size_mb * 1024 * 1024;
+        char       *memory = malloc(size);
+        lub_heap_t *heap;
+        unsigned    threads;
+        unsigned long first_leaks    = 0;
+        unsigned long first_partials = 0;
+
+        if(NULL == memory)
+        {
+            printf("*** unable to allocate %u MB\n",*size_mb);
+            break;
+        }
+        heap = lub_heap_create(memory,size);
+        create_nodes(heap);
+        cut_nodes();
+
+        for(threads = 1; threads <= max_threads; threads <<= 1)
+        {
+            unsigned long leaks    = 0;
+            unsigned long partials = 0;
+
+            printf("*** %4u MB with %2u threads in %10lu milliseconds\n",
+                   *size_mb,
+                   threads,
+                   time_scan(threads));
+            if(BOOL_FALSE == get_counts(&leaks,&partials))
+            {
+                check(BOOL_FALSE,"the leak counts can be read back");
+            }
+            else if(1 == threads)
+            {
+                check((leaks > 0),"the single threaded scan finds the leaks");
+                first_leaks    = leaks;
+                first_partials = partials;
+            }
+            else
+            {
+                check(((leaks == first_leaks) && (partials == first_partials)),
+                      "the threads find the same leaks and partials as one thread");
+            }
+        }
+        first_node = 0;
+        lub_heap_destroy(heap);
+        free(memory);
+    }
+}
+/*--------------------------------------------------------- */
+static void
+segmentTest(void)
+{
+    size_t      size   = 64 * 1024;
+    char       *memory = malloc(size);
+    char       *extra  = malloc(size);
+    lub_heap_t *heap   = lub_heap_create(memory,size);
+    size_t      removed;
+
+    lub_heap_add_segment(heap,extra,size);
+
+    lub_heap_leak_scan_start();
+    check((NULL == lub_heap_remove_free_segment(heap,&removed)),
+          "a free segment is kept while a scan is under way");
+    while(BOOL_FALSE == lub_heap_leak_scan_step(1024))
+    {
+    }
+    check(((void*)extra == lub_heap_remove_free_segment(heap,&removed)),
+          "a free segment is given back once the scan has finished");
+
+    lub_heap_destroy(heap);
+    free(extra);
+    free(memory);
+}
+/*--------------------------------------------------------- */
+int
+main(int argc, char **argv)
+{
+    unsigned max_threads = 8;
+
+    if(argc > 1)
+    {
+        max_threads = atoi(argv[1]);
+    }
+    leakScanTest(max_threads);
+    segmentTest();
+
+    return failures ? 1 : 0;
+}
+/*--------------------------------------------------------- */
@@ -0,0 +1,488 @@
+/**
+\example test/partition.c
+ */
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "lub/heap.h"
+#include "lub/partition.h"
+#include "lub/partition/private.h"
+
+#include "lub/test.h"
+
+/*************************************************************
+ * TEST CODE
+ ************************************************************* */
+int testseq = 0;
+
+#define NUM_BLOCKS 100
+#define SMALL_SIZE 24
+#define LARGE_SIZE 20000
+
+#define NUM_THREADS 4
+#define NUM_LINKS   1000
+
+static char *blocks[NUM_BLOCKS];
+
+/* this is what a refill takes from the global heap */
+#define NUM_REFILL  (LUB_PARTITION_MAGAZINE_SIZE >> 1)
+
+/* the memory from which the segments are handed out */
+#define ARENA_SIZE  (4 * 1024 * 1024)
+
+static char    *arena;
+static size_t   arena_used;
+static size_t   arena_held;
+static unsigned arena_strays;
+
+static lub_partition_link_t  links[NUM_THREADS][NUM_LINKS];
+static lub_partition_link_t *remote;
+static lub_partition_t      *shared;
+
+static const lub_partition_spec_t spec =
+{
+    BOOL_TRUE,    /* use_local_heap       */
+    8192,         /* max_local_block_size */
+    8,            /* num_local_max_blocks */
+    64 * 1024,    /* min_segment_size     */
+    0,            /* memory_limit         */
+    NULL,         /* sysalloc             */
+    NULL,         /* sysfree              */
+    0,            /* segment_granularity  */
+    0             /* idle_threshold       */
+};
+/*--------------------------------------------------------- */
+/* hand out each piece next to the last, so that they could be merged */
+static void *
+test_sysalloc(size_t required)
+{
+    void *result = NULL;
+
+    if(arena_used + required <= ARENA_SIZE)
+    {
+        result      = arena + arena_used;
+        arena_used += required;
+        arena_held += required;
+    }
+    return result;
+}
+/*--------------------------------------------------------- */
+static void
+test_sysfree(void  *ptr,
+             size_t size)
+{
+    if(((char*)ptr < arena) || ((char*)ptr + size > arena + arena_used))
+    {
+        ++arena_strays;
+    }
+    arena_held -= size;
+}
+/*--------------------------------------------------------- */
+/* add up what every site holds */
+static void
+test_sites_fn(const lub_heap_site_stats_t *stats,
+              void                        *arg)
+{
+    lub_heap_site_stats_t *total = arg;
+
+    total->allocs += stats->allocs;
+    total->blocks += stats->blocks;
+    total->bytes  += stats->bytes;
+}
+/*--------------------------------------------------------- */
+static lub_heap_site_stats_t
+test_sites_total(void)
+{
+    lub_heap_site_stats_t total;
+
+    memset(&total,0,sizeof(total));
+    lub_heap_foreach_site(test_sites_fn,&total);
+
+    return total;
+}
+/*--------------------------------------------------------- */
+static void
+test_sites(void)
+{
+    lub_partition_t      *partition;
+    lub_heap_site_stats_t before,after;
+    char                 *ptr = NULL;
+    unsigned              i;
+
+    /*----------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check the magazines count by site");
+
+    /* the partition creates its heaps as they are needed */
+    lub_heap__set_site_stats(BOOL_TRUE);
+    partition = lub_partition_create(&spec);
+    lub_test_check(NULL != partition,"Check creation of a partition");
+
+    before = test_sites_total();
+    for(i = 0; i < NUM_BLOCKS; ++i)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(partition,
+                                    &blocks[i],
+                                    SMALL_SIZE,
+                                    LUB_HEAP_ALIGN_NATIVE);
+    }
+    after = test_sites_total();
+    lub_test_check_int(NUM_BLOCKS,
+                       after.blocks - before.blocks,
+                       "Check each block is counted once, not each refill");
+    lub_test_check_int(NUM_BLOCKS * SMALL_SIZE,
+                       after.bytes - before.bytes,
+                       "Check the bytes asked for are counted");
+
+    /* this stays in the same block */
+    (void)lub_partition_realloc(partition,
+                                &blocks[0],
+                                SMALL_SIZE + 6,
+                                LUB_HEAP_ALIGN_NATIVE);
+    after = test_sites_total();
+    lub_test_check_int(NUM_BLOCKS,
+                       after.blocks - before.blocks,
+                       "Check growing in place keeps the block count");
+    lub_test_check_int((NUM_BLOCKS * SMALL_SIZE) + 6,
+                       after.bytes - before.bytes,
+                       "Check growing in place counts the extra bytes");
+
+    for(i = 0; i < NUM_BLOCKS; i += 2)
+    {
+        (void)lub_partition_realloc(partition,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    after = test_sites_total();
+    lub_test_check_int(NUM_BLOCKS / 2,
+                       after.blocks - before.blocks,
+                       "Check a block given back to a magazine is taken off");
+
+    /* these are taken from the magazine again */
+    for(i = 0; i < NUM_BLOCKS; i += 2)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(partition,
+                                    &blocks[i],
+                                    SMALL_SIZE,
+                                    LUB_HEAP_ALIGN_NATIVE);
+    }
+    after = test_sites_total();
+    lub_test_check_int(NUM_BLOCKS,
+                       after.blocks - before.blocks,
+                       "Check a block reused from a magazine is counted again");
+    lub_test_check_int(NUM_BLOCKS * SMALL_SIZE,
+                       after.bytes - before.bytes,
+                       "Check the bytes of the reused blocks are counted");
+
+    (void)lub_partition_realloc(partition,&ptr,LARGE_SIZE,LUB_HEAP_ALIGN_NATIVE);
+    after = test_sites_total();
+    lub_test_check_int(NUM_BLOCKS + 1,
+                       after.blocks - before.blocks,
+                       "Check a large block is counted");
+    lub_test_check_int((NUM_BLOCKS * SMALL_SIZE) + LARGE_SIZE,
+                       after.bytes - before.bytes,
+                       "Check the bytes of a large block are counted");
+
+    (void)lub_partition_realloc(partition,&ptr,0,LUB_HEAP_ALIGN_NATIVE);
+    for(i = 0; i < NUM_BLOCKS; ++i)
+    {
+        (void)lub_partition_realloc(partition,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    after = test_sites_total();
+    lub_test_check_int(0,
+                       after.blocks - before.blocks,
+                       "Check every block has been taken off");
+    lub_test_check_int(0,
+                       after.bytes - before.bytes,
+                       "Check every byte has been taken off");
+
+    lub_partition_kill(partition);
+    lub_heap__set_site_stats(BOOL_FALSE);
+    lub_test_seq_end();
+    /*----------------------------------------------------- */
+}
+/*--------------------------------------------------------- */
+static void
+test_magazines(void)
+{
+    lub_partition_t *partition;
+    char            *ptr  = NULL;
+    char            *last = NULL;
+    unsigned         i;
+
+    /*----------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check the magazines hand blocks out and back");
+
+    partition = lub_partition_create(&spec);
+    lub_test_check(NULL != partition,"Check creation of a partition");
+
+    (void)lub_partition_realloc(partition,&ptr,SMALL_SIZE,LUB_HEAP_ALIGN_NATIVE);
+    lub_test_check(NULL != ptr,"Check a small block is allocated");
+    memset(ptr,0x55,SMALL_SIZE);
+    last = ptr;
+
+    (void)lub_partition_realloc(partition,&ptr,SMALL_SIZE + 6,LUB_HEAP_ALIGN_NATIVE);
+    lub_test_check(last == ptr,"Check a small growth stays in the same block");
+
+    (void)lub_partition_realloc(partition,&ptr,LARGE_SIZE,LUB_HEAP_ALIGN_NATIVE);
+    lub_test_check(last != ptr,"Check a large growth moves the block");
+    lub_test_check((0x55 == ptr[0]) && (0x55 == ptr[SMALL_SIZE - 1]),
+                   "Check the contents are moved with it");
+
+    (void)lub_partition_realloc(partition,&ptr,0,LUB_HEAP_ALIGN_NATIVE);
+    ptr = NULL;
+    (void)lub_partition_realloc(partition,&ptr,SMALL_SIZE,LUB_HEAP_ALIGN_NATIVE);
+    lub_test_check(last == ptr,"Check a freed block is the next one handed out");
+
+    /* more than a magazine holds, so that some are drained */
+    for(i = 0; i < NUM_BLOCKS; ++i)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(partition,
+                                    &blocks[i],
+                                    SMALL_SIZE,
+                                    LUB_HEAP_ALIGN_NATIVE);
+    }
+    for(i = 0; i < NUM_BLOCKS; ++i)
+    {
+        (void)lub_partition_realloc(partition,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    (void)lub_partition_realloc(partition,&ptr,0,LUB_HEAP_ALIGN_NATIVE);
+    lub_test_check(BOOL_TRUE == lub_partition_check_memory(partition),
+                   "Check the memory is intact");
+
+    lub_partition_kill(partition);
+    lub_test_seq_end();
+    /*----------------------------------------------------- */
+}
+/*--------------------------------------------------------- */
+static void *
+test_remote_push_fn(void *arg)
+{
+    lub_partition_link_t *link = arg;
+    unsigned              i;
+
+    for(i = 0; i < NUM_LINKS; ++i)
+    {
+        lub_partition_remote_push(&remote,&link[i]);
+    }
+    return NULL;
+}
+/*--------------------------------------------------------- */
+static void *
+test_remote_free_fn(void *arg)
+{
+    unsigned i;
+
+    (void)arg;
+    for(i = 0; i < NUM_REFILL; ++i)
+    {
+        (void)lub_partition_realloc(shared,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    return NULL;
+}
+/*--------------------------------------------------------- */
+static void
+test_remote(void)
+{
+    pthread_t             threads[NUM_THREADS];
+    lub_partition_link_t *link;
+    char                 *ptr;
+    unsigned              i,j,count = 0,found = 0;
+
+    /*----------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check the remote free list");
+
+    remote = NULL;
+    lub_partition_remote_push(&remote,&links[0][0]);
+    lub_partition_remote_push(&remote,&links[0][1]);
+    link = lub_partition_remote_take(&remote);
+    lub_test_check((&links[0][1] == link) && (&links[0][0] == link->m_next),
+                   "Check a list is taken in the order it was pushed");
+    lub_test_check(NULL == remote,"Check taking a list leaves it empty");
+
+    /* push from several threads at once */
+    for(i = 0; i < NUM_THREADS; ++i)
+    {
+        (void)pthread_create(&threads[i],NULL,test_remote_push_fn,links[i]);
+    }
+    for(i = 0; i < NUM_THREADS; ++i)
+    {
+        (void)pthread_join(threads[i],NULL);
+    }
+    for(link = lub_partition_remote_take(&remote);
+        link;
+        link = link->m_next)
+    {
+        ++count;
+    }
+    lub_test_check_int(NUM_THREADS * NUM_LINKS,
+                       count,
+                       "Check no push is lost when threads race");
+    lub_test_check(NULL == lub_partition_remote_take(&remote),
+                   "Check nothing is left once taken");
+
+    lub_test_seq_end();
+    /*----------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check blocks freed by another thread come back");
+
+    shared = lub_partition_create(&spec);
+    lub_test_check(NULL != shared,"Check creation of a partition");
+
+    /* this empties the magazine */
+    for(i = 0; i < NUM_REFILL; ++i)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(shared,&blocks[i],SMALL_SIZE,LUB_HEAP_ALIGN_NATIVE);
+        blocks[NUM_REFILL + i] = blocks[i];
+    }
+    (void)pthread_create(&threads[0],NULL,test_remote_free_fn,NULL);
+    (void)pthread_join(threads[0],NULL);
+
+    /* these should be gathered from the remote list */
+    for(i = 0; i < NUM_REFILL; ++i)
+    {
+        ptr = NULL;
+        (void)lub_partition_realloc(shared,&ptr,SMALL_SIZE,LUB_HEAP_ALIGN_NATIVE);
+        for(j = 0; j < NUM_REFILL; ++j)
+        {
+            if(ptr == blocks[NUM_REFILL + j])
+            {
+                ++found;
+                break;
+            }
+        }
+        blocks[i] = ptr;
+    }
+    lub_test_check_int(NUM_REFILL,
+                       found,
+                       "Check each block freed remotely is reused by its owner");
+
+    for(i = 0; i < NUM_REFILL; ++i)
+    {
+        (void)lub_partition_realloc(shared,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    lub_test_check(BOOL_TRUE == lub_partition_check_memory(shared),
+                   "Check the memory is intact");
+
+    lub_partition_kill(shared);
+    lub_test_seq_end();
+    /*----------------------------------------------------- */
+}
+/*--------------------------------------------------------- */
+static void
+test_segments(void)
+{
+    static const lub_partition_spec_t segment_spec =
+    {
+        BOOL_FALSE,   /* use_local_heap       */
+        0,            /* max_local_block_size */
+        0,            /* num_local_max_blocks */
+        64 * 1024,    /* min_segment_size     */
+        0,            /* memory_limit         */
+        test_sysalloc,/* sysalloc             */
+        test_sysfree, /* sysfree              */
+        0,            /* segment_granularity  */
+        256 * 1024    /* idle_threshold       */
+    };
+    lub_partition_t      *partition;
+    lub_partition_stats_t stats,busy;
+    size_t                base;
+    unsigned              i;
+
+    /*----------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check the segments are handed back");
+
+    arena = lub_partition_mmap_alloc(ARENA_SIZE);
+    lub_test_check(NULL != arena,"Check the arena is mapped");
+    if(NULL == arena)
+    {
+        lub_test_seq_end();
+        return;
+    }
+    partition = lub_partition_create(&segment_spec);
+    lub_test_check(NULL != partition,"Check creation of a partition");
+    base = arena_held;
+
+    for(i = 0; i < NUM_BLOCKS / 2; ++i)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(partition,&blocks[i],LARGE_SIZE,LUB_HEAP_ALIGN_NATIVE);
+        memset(blocks[i],0x55,LARGE_SIZE);
+    }
+    lub_partition__get_stats(partition,&busy);
+    lub_test_check_int(arena_held - base,
+                       busy.reserved_bytes,
+                       "Check every segment obtained is reserved");
+    lub_test_check(busy.resident_bytes >= (NUM_BLOCKS / 2) * LARGE_SIZE,
+                   "Check the blocks in use are resident");
+    lub_test_check_int(0,busy.idle_segs,"Check no segment is idle whilst in use");
+
+    for(i = 0; i < NUM_BLOCKS / 2; ++i)
+    {
+        (void)lub_partition_realloc(partition,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    lub_partition__get_stats(partition,&stats);
+    lub_test_check(stats.reserved_bytes < busy.reserved_bytes,
+                   "Check free segments are handed back");
+    lub_test_check_int(arena_held - base,
+                       stats.reserved_bytes,
+                       "Check the reserved bytes match those handed back");
+    lub_test_check(stats.idle_segs > 0,"Check some free segments are held in reserve");
+    lub_test_check(stats.idle_bytes <= segment_spec.idle_threshold,
+                   "Check the reserve is within its threshold");
+    lub_test_check(stats.resident_bytes < stats.reserved_bytes,
+                   "Check the pages of the reserve are decommitted");
+
+    /* these are satisfied from the reserve */
+    busy = stats;
+    for(i = 0; i < NUM_BLOCKS / 10; ++i)
+    {
+        blocks[i] = NULL;
+        (void)lub_partition_realloc(partition,&blocks[i],LARGE_SIZE,LUB_HEAP_ALIGN_NATIVE);
+    }
+    lub_partition__get_stats(partition,&stats);
+    lub_test_check(stats.idle_segs < busy.idle_segs,
+                   "Check a segment is taken from the reserve");
+    lub_test_check_int(busy.reserved_bytes,
+                       stats.reserved_bytes,
+                       "Check no more memory is obtained");
+
+    for(i = 0; i < NUM_BLOCKS / 10; ++i)
+    {
+        (void)lub_partition_realloc(partition,&blocks[i],0,LUB_HEAP_ALIGN_NATIVE);
+    }
+    lub_partition_kill(partition);
+    lub_test_check_int(0,arena_held,"Check every byte obtained is handed back");
+    lub_test_check_int(0,arena_strays,"Check only what was obtained is handed back");
+
+    lub_partition_mmap_free(arena,ARENA_SIZE);
+    arena = NULL;
+    lub_test_seq_end();
+    /*----------------------------------------------------- */
+}
+/*--------------------------------------------------------- */
+int
+main(int argc, const char *argv[])
+{
+    int status;
+
+    lub_heap_init(argv[0]);
+
+    lub_test_parse_command_line(argc,argv);
+    lub_test_begin("lub_partition");
+
+    /* the magazines are only used without leak detection */
+    lub_heap__set_framecount(0);
+
+    test_sites();
+    test_magazines();
+    test_remote();
+    test_segments();
+
+    /* tidy up */
+    status = lub_test_get_status();
+    lub_test_end();
+
+    return status;
+}
+/*--------------------------------------------------------- */
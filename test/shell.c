@@ -0,0 +1,622 @@
+#undef _POSIX_C_SOURCE /* we need to use setenv() */
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "lub/test.h"
+#include "lub/string.h"
+#include "clish/private.h"
+#include "clish/shell/private.h"
+/**
+ \example test/shell.c
+ */
+
+/*************************************************************
+ * TEST CODE
+ ************************************************************* */
+
+/* the tests are run from the top of the source tree */
+#define XML_EXAMPLES "xml-examples"
+
+static int testseq;
+
+static clish_shell_hooks_t hooks =
+{
+    NULL, /* don't worry about init callback */
+    NULL, /* don't worry about access callback */
+    NULL, /* don't worry about cmd_line callback */
+    clish_script_coprocess_callback,
+    NULL, /* don't worry about fini callback */
+    NULL  /* don't register any builtin functions */
+};
+
+/*--------------------------------------------------------------- */
+/* read back the first line written to a file by a script */
+static bool_t
+check_output(const char *filename,
+             const char *expected)
+{
+    bool_t result = BOOL_FALSE;
+    FILE  *file   = fopen(filename,"r");
+
+    if(NULL != file)
+    {
+        char line[80];
+
+        if(fgets(line,sizeof(line),file))
+        {
+            line[strcspn(line,"\n")] = '\0';
+            result = (0 == strcmp(line,expected)) ? BOOL_TRUE : BOOL_FALSE;
+        }
+        fclose(file);
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+static bool_t
+same_string(const char *a,
+            const char *b)
+{
+    if((NULL == a) || (NULL == b))
+    {
+        return (a == b) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    return (0 == strcmp(a,b)) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+static bool_t
+same_ptype(const clish_ptype_t *a,
+           const clish_ptype_t *b)
+{
+    if((NULL == a) || (NULL == b))
+    {
+        return (a == b) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    return (same_string(clish_ptype__get_name(a),clish_ptype__get_name(b))
+         && same_string(clish_ptype__get_text(a),clish_ptype__get_text(b))
+         && same_string(clish_ptype__get_pattern(a),clish_ptype__get_pattern(b))
+         && same_string(clish_ptype__get_range(a),clish_ptype__get_range(b))
+         && (clish_ptype__get_method(a) == clish_ptype__get_method(b))
+         && (clish_ptype__get_preprocess(a) == clish_ptype__get_preprocess(b)))
+         ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+static bool_t
+same_param(const clish_param_t *a,
+           const clish_param_t *b)
+{
+    if((NULL == a) || (NULL == b))
+    {
+        return (a == b) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    return (same_string(clish_param__get_name(a),clish_param__get_name(b))
+         && same_string(clish_param__get_text(a),clish_param__get_text(b))
+         && same_string(clish_param__get_prefix(a),clish_param__get_prefix(b))
+         && same_string(clish_param__get_default(a),clish_param__get_default(b))
+         && same_ptype(clish_param__get_ptype(a),clish_param__get_ptype(b)))
+         ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+static bool_t
+same_command(const clish_command_t *a,
+             const clish_command_t *b)
+{
+    const clish_view_t *view_a;
+    const clish_view_t *view_b;
+    unsigned            i;
+
+    if((NULL == a) || (NULL == b))
+    {
+        return (a == b) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    view_a = clish_command__get_view(a);
+    view_b = clish_command__get_view(b);
+    if((BOOL_FALSE == same_string(clish_command__get_name(a),
+                                  clish_command__get_name(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_text(a),
+                                     clish_command__get_text(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_detail(a),
+                                     clish_command__get_detail(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_builtin(a),
+                                     clish_command__get_builtin(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_escape_chars(a),
+                                     clish_command__get_escape_chars(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_access(a),
+                                     clish_command__get_access(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_unexpanded_action(a),
+                                     clish_command__get_unexpanded_action(b)))
+       || (BOOL_FALSE == same_string(clish_command__get_unexpanded_viewid(a),
+                                     clish_command__get_unexpanded_viewid(b)))
+       || (BOOL_FALSE == same_string(view_a ? clish_view__get_name(view_a) : NULL,
+                                     view_b ? clish_view__get_name(view_b) : NULL))
+       || (clish_command__get_executable(a) != clish_command__get_executable(b))
+       || (BOOL_FALSE == same_param(clish_command__get_args(a),
+                                    clish_command__get_args(b)))
+       || (clish_command__get_param_count(a) != clish_command__get_param_count(b)))
+    {
+        return BOOL_FALSE;
+    }
+    for(i = 0;
+        i < clish_command__get_param_count(a);
+        i++)
+    {
+        if(BOOL_FALSE == same_param(clish_command__get_param(a,i),
+                                    clish_command__get_param(b,i)))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------------- */
+static bool_t
+same_view(clish_view_t *a,
+          clish_view_t *b)
+{
+    clish_command_t *cmd_a;
+    clish_command_t *cmd_b;
+
+    if((BOOL_FALSE == same_string(clish_view__get_name(a),
+                                  clish_view__get_name(b)))
+       || (BOOL_FALSE == same_string(clish_view__get_unexpanded_prompt(a),
+                                     clish_view__get_unexpanded_prompt(b))))
+    {
+        return BOOL_FALSE;
+    }
+    for(cmd_a = clish_view_getfirst_command(a),
+        cmd_b = clish_view_getfirst_command(b);
+        cmd_a && cmd_b;
+        cmd_a = clish_view_getnext_command(a,cmd_a),
+        cmd_b = clish_view_getnext_command(b,cmd_b))
+    {
+        if(BOOL_FALSE == same_command(cmd_a,cmd_b))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return (cmd_a == cmd_b) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* Check two shells hold the same views, commands and ptypes */
+static bool_t
+same_model(const clish_shell_t *a,
+           const clish_shell_t *b)
+{
+    clish_shell_model_t *model_a = a->model;
+    clish_shell_model_t *model_b = b->model;
+    clish_view_t        *view_a;
+    clish_view_t        *view_b;
+    clish_ptype_t       *ptype_a;
+    clish_ptype_t       *ptype_b;
+
+    if((NULL == lub_bintree_peekfirst(&model_a->view_tree))
+       || (BOOL_FALSE == same_string(model_a->overview,model_b->overview))
+       || (BOOL_FALSE == same_command(model_a->startup,model_b->startup))
+       || ((NULL == model_a->global) != (NULL == model_b->global)))
+    {
+        return BOOL_FALSE;
+    }
+    for(view_a = lub_bintree_peekfirst(&model_a->view_tree),
+        view_b = lub_bintree_peekfirst(&model_b->view_tree);
+        view_a && view_b;
+        view_a = lub_bintree_peeknext(&model_a->view_tree,
+                                      clish_view__get_name(view_a)),
+        view_b = lub_bintree_peeknext(&model_b->view_tree,
+                                      clish_view__get_name(view_b)))
+    {
+        if(BOOL_FALSE == same_view(view_a,view_b))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    if(view_a != view_b)
+    {
+        return BOOL_FALSE;
+    }
+    for(ptype_a = lub_bintree_peekfirst(&model_a->ptype_tree),
+        ptype_b = lub_bintree_peekfirst(&model_b->ptype_tree);
+        ptype_a && ptype_b;
+        ptype_a = lub_bintree_peeknext(&model_a->ptype_tree,
+                                       clish_ptype__get_name(ptype_a)),
+        ptype_b = lub_bintree_peeknext(&model_b->ptype_tree,
+                                       clish_ptype__get_name(ptype_b)))
+    {
+        if(BOOL_FALSE == same_ptype(ptype_a,ptype_b))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return (ptype_a == ptype_b) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* Load a shell's definitions just as a spawned shell would */
+static clish_shell_t *
+load_shell(FILE *istream)
+{
+    clish_shell_t *shell = clish_shell_new(&hooks,NULL,istream);
+
+    if(NULL != shell)
+    {
+        clish_shell_load_files(shell);
+    }
+    return shell;
+}
+/*--------------------------------------------------------------- */
+/* Check whether the image can be read in place of the XML files */
+static bool_t
+image_is_used(FILE       *istream,
+              const char *image)
+{
+    clish_shell_t *shell  = clish_shell_new(&hooks,NULL,istream);
+    bool_t         result = BOOL_FALSE;
+
+    if(NULL != shell)
+    {
+        char **files = clish_shell_find_files(shell);
+
+        result = clish_shell_image_read(shell,image,files);
+        clish_shell_free_files(files);
+        clish_shell_delete(shell);
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* 
+ * Check a shell loads the same definitions as one which reads the 
+ * XML files itself.
+ */
+static bool_t
+check_load(FILE       *istream,
+           const char *image)
+{
+    clish_shell_t *loaded;
+    clish_shell_t *parsed;
+    bool_t         result = BOOL_FALSE;
+
+    (void)setenv("CLISH_IMAGE",image,1);
+    loaded = load_shell(istream);
+    (void)unsetenv("CLISH_IMAGE");
+    parsed = load_shell(istream);
+    if(loaded && parsed)
+    {
+        result = same_model(loaded,parsed);
+    }
+    if(loaded)
+    {
+        clish_shell_delete(loaded);
+    }
+    if(parsed)
+    {
+        clish_shell_delete(parsed);
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* Copy the XML files from one directory to another */
+static unsigned
+copy_xml_files(const char *from,
+               const char *to)
+{
+    DIR           *dir   = opendir(from);
+    struct dirent *entry;
+    unsigned       count = 0;
+
+    if(NULL == dir)
+    {
+        return 0;
+    }
+    while(NULL != (entry = readdir(dir)))
+    {
+        const char *extension = strrchr(entry->d_name,'.');
+        char       *src       = NULL;
+        char       *dst       = NULL;
+        FILE       *in;
+        FILE       *out;
+
+        if((NULL == extension) || strcmp(extension,".xml"))
+        {
+            continue;
+        }
+        lub_string_cat(&src,from);
+        lub_string_cat(&src,"/");
+        lub_string_cat(&src,entry->d_name);
+        lub_string_cat(&dst,to);
+        lub_string_cat(&dst,"/");
+        lub_string_cat(&dst,entry->d_name);
+        in  = fopen(src,"rb");
+        out = fopen(dst,"wb");
+        if(in && out)
+        {
+            char   buffer[1024];
+            size_t len;
+
+            while((len = fread(buffer,1,sizeof(buffer),in)) > 0)
+            {
+                (void)fwrite(buffer,1,len,out);
+            }
+            count++;
+        }
+        if(in)
+        {
+            fclose(in);
+        }
+        if(out)
+        {
+            fclose(out);
+        }
+        lub_string_free(src);
+        lub_string_free(dst);
+    }
+    closedir(dir);
+    return count;
+}
+/*--------------------------------------------------------------- */
+/* Remove a directory along with the files it holds */
+static void
+remove_dir(const char *dirname)
+{
+    DIR           *dir = opendir(dirname);
+    struct dirent *entry;
+
+    if(NULL != dir)
+    {
+        while(NULL != (entry = readdir(dir)))
+        {
+            char *filename = NULL;
+
+            if('.' == entry->d_name[0])
+            {
+                continue;
+            }
+            lub_string_cat(&filename,dirname);
+            lub_string_cat(&filename,"/");
+            lub_string_cat(&filename,entry->d_name);
+            (void)unlink(filename);
+            lub_string_free(filename);
+        }
+        closedir(dir);
+    }
+    (void)rmdir(dirname);
+}
+/*--------------------------------------------------------------- */
+/* Change some text in a file, which must be found */
+static bool_t
+edit_file(const char *filename,
+          const char *from,
+          const char *to)
+{
+    char    buffer[8192];
+    char   *p;
+    size_t  len;
+    FILE   *file  = fopen(filename,"rb");
+    bool_t  result = BOOL_FALSE;
+
+    if(NULL == file)
+    {
+        return BOOL_FALSE;
+    }
+    len = fread(buffer,1,sizeof(buffer) - 1,file);
+    fclose(file);
+    buffer[len] = '\0';
+    p = strstr(buffer,from);
+    file = p ? fopen(filename,"wb") : NULL;
+    if(NULL != file)
+    {
+        (void)fwrite(buffer,1,p - buffer,file);
+        (void)fputs(to,file);
+        (void)fputs(p + strlen(from),file);
+        result = (0 == fclose(file)) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* delete a shell, returning how many milliseconds it took */
+static long
+delete_shell(clish_shell_t *shell)
+{
+    struct timespec start,end;
+
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    clish_shell_delete(shell);
+    clock_gettime(CLOCK_MONOTONIC,&end);
+
+    return ((end.tv_sec - start.tv_sec) * 1000)
+         + ((end.tv_nsec - start.tv_nsec) / 1000000);
+}
+/*--------------------------------------------------------------- */
+/* This is the main entry point for this executable
+ */
+int
+main(int argc, const char *argv[])
+{
+    int            status;
+    FILE          *istream;
+    clish_shell_t *shell;
+    char           filename[32];
+    char          *script = NULL;
+
+    lub_test_parse_command_line(argc,argv);
+    lub_test_begin("clish_shell");
+
+    istream = fopen("/dev/null","r");
+    shell   = clish_shell_new(&hooks,NULL,istream);
+    sprintf(filename,"/tmp/clish_shell.%d",(int)getpid());
+
+    /*----------------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"clish_shell_coprocess_execute()");
+
+    lub_test_check(NULL != shell,
+                   "Check a shell is created");
+    lub_test_check(clish_shell_coprocess_execute(shell,"true"),
+                   "Check a script which succeeds");
+    lub_test_check(!clish_shell_coprocess_execute(shell,"false"),
+                   "Check a script which fails");
+    lub_test_check(clish_shell_coprocess_execute(shell,"test 'a b' = \"a b\""),
+                   "Check the quotes in a script are kept");
+    lub_test_check(clish_shell_coprocess_execute(shell,"true\ntrue"),
+                   "Check a script of several lines");
+
+    lub_string_cat(&script,"echo hello >");
+    lub_string_cat(&script,filename);
+    lub_test_check(clish_shell_coprocess_execute(shell,script),
+                   "Check a script which writes to a file");
+    lub_test_check(check_output(filename,"hello"),
+                   "Check the script's output is seen");
+    lub_string_free(script);
+    script = NULL;
+
+    lub_test_seq_end();
+    /*----------------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check the scripts share one shell");
+
+    lub_test_check(clish_shell_coprocess_execute(shell,"CLISH_TEST=shared"),
+                   "Check a script which sets a variable");
+    lub_test_check(clish_shell_coprocess_execute(shell,"test \"$CLISH_TEST\" = shared"),
+                   "Check the next script sees the variable");
+    lub_test_check(!clish_shell_coprocess_execute(shell,"if"),
+                   "Check a script with a syntax error fails");
+    lub_test_check(clish_shell_coprocess_execute(shell,"test \"$CLISH_TEST\" = shared"),
+                   "Check the shell survives a syntax error");
+    lub_test_check(!clish_shell_coprocess_execute(shell,"exit 3"),
+                   "Check a script which exits with a failure");
+    lub_test_check(clish_shell_coprocess_execute(shell,"test -z \"$CLISH_TEST\""),
+                   "Check the next script gets a fresh shell");
+    lub_test_check(clish_shell_coprocess_execute(shell,"exit 0"),
+                   "Check a script which exits successfully");
+    lub_test_check(clish_shell_coprocess_execute(shell,"true"),
+                   "Check a script runs after an exit");
+
+    lub_test_seq_end();
+    /*----------------------------------------------------------- */
+    lub_test_seq_begin(++testseq,"Check each shell has its own coprocess");
+    {
+        FILE          *other_istream = fopen("/dev/null","r");
+        clish_shell_t *other         = clish_shell_new(&hooks,NULL,other_istream);
+
+        /* this coprocess is started while the first shell's is running */
+        lub_test_check(clish_shell_coprocess_execute(other,"true"),
+                       "Check a second shell runs a script");
+        lub_test_check(delete_shell(shell) < 500,
+                       "Check a shell is deleted while another's coprocess runs");
+        shell = NULL;
+        lub_test_check(clish_shell_coprocess_execute(other,"true"),
+                       "Check the second shell's coprocess is unaffected");
+        lub_test_check(delete_shell(other) < 500,
+                       "Check the second shell is deleted");
+        fclose(other_istream);
+    }
+    lub_test_seq_end();
+    /*----------------------------------------------------------- */
+
+    lub_test_seq_begin(++testseq,"Check a compiled image");
+    {
+        char        dirname[32];
+        char       *image    = NULL;
+        char       *clock    = NULL;
+        FILE       *file;
+        struct stat info;
+
+        sprintf(dirname,"/tmp/clish_image.%d",(int)getpid());
+        (void)mkdir(dirname,0700);
+        lub_string_cat(&image,dirname);
+        lub_string_cat(&image,"/image");
+        lub_string_cat(&clock,dirname);
+        lub_string_cat(&clock,"/clock.xml");
+
+        lub_test_check(copy_xml_files(XML_EXAMPLES,dirname) > 0,
+                       "Check the example files are found");
+        (void)setenv("CLISH_PATH",dirname,1);
+        lub_test_check(clish_shell_compile(image),
+                       "Check an image is compiled from the examples");
+        lub_test_check(image_is_used(istream,image),
+                       "Check the image is read back");
+        lub_test_check(check_load(istream,image),
+                       "Check the image holds the same definitions as the XML");
+
+        /* an image which is cut short */
+        (void)stat(image,&info);
+        file = fopen(image,"r+b");
+        if(NULL != file)
+        {
+            (void)ftruncate(fileno(file),info.st_size / 2);
+            fclose(file);
+        }
+        lub_test_check(!image_is_used(istream,image),
+                       "Check a truncated image isn't used");
+        lub_test_check(check_load(istream,image),
+                       "Check the XML is read in place of a truncated image");
+
+        /* an image with nonsense in place of its tables */
+        lub_test_check(clish_shell_compile(image),
+                       "Check the image is compiled again");
+        file = fopen(image,"r+b");
+        if(NULL != file)
+        {
+            static const char junk[64] = "this is not a table";
+
+            /* leave the magic number and version alone */
+            (void)fseek(file,(long)(2 * sizeof(unsigned)),SEEK_SET);
+            (void)fwrite(junk,1,sizeof(junk),file);
+            fclose(file);
+        }
+        lub_test_check(!image_is_used(istream,image),
+                       "Check a corrupted image isn't used");
+        lub_test_check(check_load(istream,image),
+                       "Check the XML is read in place of a corrupted image");
+
+        /* a file which has changed size since the image was compiled */
+        lub_test_check(clish_shell_compile(image),
+                       "Check the image is compiled again");
+        lub_test_check(edit_file(clock,"Set the timezone","Set the time zone"),
+                       "Check an example file is changed");
+        lub_test_check(!image_is_used(istream,image),
+                       "Check an image of a file which has grown isn't used");
+        lub_test_check(check_load(istream,image),
+                       "Check the changed XML is read in place of the image");
+
+        /* a file which has been changed but not its size */
+        lub_test_check(clish_shell_compile(image),
+                       "Check the image is compiled again");
+        (void)stat(clock,&info);
+        lub_test_check(edit_file(clock,"Set the time zone","Set the time area"),
+                       "Check an example file is changed in place");
+        {
+            struct utimbuf times;
+
+            /* the edit may well have been made within the same second */
+            times.actime  = info.st_atime;
+            times.modtime = info.st_mtime + 1;
+            (void)utime(clock,&times);
+        }
+        lub_test_check(!image_is_used(istream,image),
+                       "Check an image of a file which has been touched isn't used");
+        lub_test_check(check_load(istream,image),
+                       "Check the touched XML is read in place of the image");
+
+        remove_dir(dirname);
+        lub_string_free(clock);
+        lub_string_free(image);
+    }
+    lub_test_seq_end();
+    /*----------------------------------------------------------- */
+
+    /* tidy up */
+    if(NULL != shell)
+    {
+        clish_shell_delete(shell);
+    }
+    fclose(istream);
+    (void)unlink(filename);
+
+    status = lub_test_get_status();
+    lub_test_end();
+
+    return status;
+}
+/*--------------------------------------------------------------- */
@@ -1,3 +1,6 @@
+#include <string.h>
+#include <time.h>
+
 #include "lub/test.h"
 #include "lub/string.h"
 
@@ -5,6 +8,8 @@
  * TEST CODE
  ************************************************************* */
 
+#define NUM_WORDS 20000
+
 static int testseq;
 
 /*--------------------------------------------------------------- */
@@ -14,6 +19,13 @@ int main(int argc, const char *argv[])
 {
     int comp;
  	int status;
+    char          storage[8];
+    lub_strbuf_t  buffer;
+    char         *string = NULL;
+    char         *result;
+    unsigned      i;
+    clock_t       start;
+    double        concatenated,buffered;
 
 	lub_test_parse_command_line(argc,argv);
 	lub_test_begin("lub_string");
@@ -41,6 +53,69 @@ int main(int argc, const char *argv[])
                         "Check 'hellp' > 'HeLlO'");
      
     lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"lub_strbuf_catn()");
+
+    lub_strbuf_init(&buffer,storage,sizeof(storage));
+    lub_test_check((0 == strcmp("",lub_strbuf__get_string(&buffer))),
+                   "Check a new buffer holds an empty string");
+    lub_strbuf_cat(&buffer,"hello");
+    lub_test_check((storage == lub_strbuf__get_string(&buffer)),
+                   "Check a short string uses the client storage");
+    lub_strbuf_catn(&buffer," world and more",6);
+    lub_strbuf_catn(&buffer,"!",10);
+    lub_test_check((0 == strcmp("hello world!",lub_strbuf__get_string(&buffer))),
+                   "Check 'hello world!' has been built");
+    lub_test_check((12 == lub_strbuf__get_length(&buffer)),
+                   "Check the length is 12");
+    result = lub_strbuf_detach(&buffer);
+    lub_test_check((0 == strcmp("hello world!",result)),
+                   "Check the detached string is 'hello world!'");
+    lub_test_check((0 == lub_strbuf__get_length(&buffer)),
+                   "Check the buffer is empty once detached");
+    lub_string_free(result);
+    lub_strbuf_cat(&buffer,"abc");
+    result = lub_strbuf_detach(&buffer);
+    lub_test_check((0 == strcmp("abc",result)),
+                   "Check a string can be detached from the client storage");
+    lub_string_free(result);
+    lub_strbuf_fini(&buffer);
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"building a string of %d words",NUM_WORDS);
+
+    start = clock();
+    for(i = 0;
+        i < NUM_WORDS;
+        i++)
+    {
+        lub_string_cat(&string,"word ");
+    }
+    concatenated = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    lub_strbuf_init(&buffer,NULL,0);
+    for(i = 0;
+        i < NUM_WORDS;
+        i++)
+    {
+        lub_strbuf_cat(&buffer,"word ");
+    }
+    result = lub_strbuf_detach(&buffer);
+    lub_strbuf_fini(&buffer);
+    buffered = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    lub_test_check((0 == strcmp(string,result)),
+                   "Check both strings are the same");
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "lub_string_cat() : %.3f msec",concatenated * 1000);
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "lub_strbuf_cat() : %.3f msec",buffered * 1000);
+    lub_string_free(string);
+    lub_string_free(result);
+
+    lub_test_seq_end();
         
     /* tidy up */
     status = lub_test_get_status();
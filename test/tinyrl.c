@@ -0,0 +1,636 @@
+#undef __STRICT_ANSI__ /* we need to use fdopen() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "lub/test.h"
+#include "tinyrl/tinyrl.h"
+#include "tinyrl/history.h"
+#include "tinyrl/vt100.h"
+/**
+ \example test/tinyrl.c
+ */
+
+/*************************************************************
+ * TEST CODE
+ ************************************************************* */
+
+#define NUM_KEYS 20
+#define LONG_LINE 100000
+#define NUM_COMMANDS 100000
+#define HISTORY_FILE "tinyrl_history.test"
+#define HISTORY_LIMIT 1000
+
+static int testseq;
+
+/*--------------------------------------------------------------- */
+/*
+ * Each write to the terminal arrives as a separate packet, so
+ * counting the packets counts the writes.
+ */
+static unsigned
+count_writes(int    fd,
+             char  *last,
+             size_t size)
+{
+    unsigned count = 0;
+    char     buffer[1024];
+    ssize_t  len;
+
+    while((len = recv(fd,buffer,sizeof(buffer),MSG_DONTWAIT)) > 0)
+    {
+        ++count;
+        if(last)
+        {
+            if((size_t)len >= size)
+            {
+                len = size - 1;
+            }
+            memcpy(last,buffer,len);
+            last[len] = '\0';
+        }
+    }
+    return count;
+}
+/*--------------------------------------------------------------- */
+/*
+ * This is how a masked line used to be redrawn after an edit in
+ * the middle of it; one output call for each movement and each
+ * echo character.
+ */
+static void
+redraw_line(const tinyrl_vt100_t *term,
+            unsigned              len)
+{
+    tinyrl_vt100_cursor_back(term,len);
+    tinyrl_vt100_erase(term,len);
+    while(len--)
+    {
+        tinyrl_vt100_write(term,"*",1);
+    }
+    tinyrl_vt100_cursor_back(term,NUM_KEYS/2);
+}
+/*--------------------------------------------------------------- */
+/*
+ * Send some input to the terminal and decode the control sequence
+ * which follows the ESC.
+ */
+static tinyrl_vt100_escape_t
+decode(const tinyrl_vt100_t *term,
+       int                   fd,
+       const char           *input)
+{
+    tinyrl_vt100_escape_t result = tinyrl_vt100_UNKNOWN;
+
+    if((ssize_t)strlen(input) == write(fd,input,strlen(input)))
+    {
+        if(KEY_ESC == tinyrl_vt100_getchar(term))
+        {
+            result = tinyrl_vt100_escape_decode(term);
+        }
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* Read a line from a script and check it is as expected */
+static bool_t
+check_line(tinyrl_t   *rl,
+           const char *expected)
+{
+    char  *line   = tinyrl_readline(rl,"> ",NULL);
+    bool_t result = BOOL_FALSE;
+
+    if(NULL == line)
+    {
+        result = (NULL == expected) ? BOOL_TRUE : BOOL_FALSE;
+    }
+    else
+    {
+        result = (expected && (0 == strcmp(line,expected))) ? BOOL_TRUE : BOOL_FALSE;
+        free(line);
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* An Enter handler which completes the line, as clish does */
+static bool_t
+complete_enter(tinyrl_t *rl,
+               int       key)
+{
+    if(0 == strcmp(tinyrl__get_line(rl),"debu"))
+    {
+        (void)tinyrl_insert_text(rl,"g");
+        tinyrl_redisplay(rl);
+    }
+    tinyrl_crlf(rl);
+    tinyrl_done(rl);
+    /* keep the compiler happy */
+    key = key;
+    return BOOL_TRUE;
+}
+/*--------------------------------------------------------------- */
+/* Check the history holds the expected lines, oldest first */
+static bool_t
+check_history(const tinyrl_history_t *history,
+              const char             *expected[])
+{
+    tinyrl_history_iterator_t iter;
+    tinyrl_history_entry_t   *entry;
+    unsigned                  i = 0;
+
+    for(entry = tinyrl_history_getfirst(history,&iter);
+        entry;
+        entry = tinyrl_history_getnext(&iter))
+    {
+        if((NULL == expected[i]) 
+           || strcmp(expected[i++],tinyrl_history_entry__get_line(entry)))
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return (NULL == expected[i]) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* Search the history file, checking the lines which are found */
+static bool_t
+check_search(tinyrl_history_t *history,
+             const char       *text,
+             const char       *expected[])
+{
+    tinyrl_history_search_t search;
+    char                   *line;
+    unsigned                i      = 0;
+    bool_t                  result = BOOL_TRUE;
+
+    for(line = tinyrl_history_search_first(history,text,&search);
+        line;
+        line = tinyrl_history_search_next(&search))
+    {
+        if((NULL == expected[i]) || strcmp(expected[i++],line))
+        {
+            result = BOOL_FALSE;
+        }
+        free(line);
+    }
+    return (result && (NULL == expected[i])) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* Give a background compaction a chance to finish */
+static size_t
+history_file_size(size_t written)
+{
+    struct stat     st;
+    struct timespec delay;
+    unsigned        i;
+
+    delay.tv_sec  = 0;
+    delay.tv_nsec = 10000000;
+    for(i = 0; i < 200; i++)
+    {
+        if((0 == stat(HISTORY_FILE,&st)) && ((size_t)st.st_size < written))
+        {
+            break;
+        }
+        nanosleep(&delay,NULL);
+    }
+    return (size_t)st.st_size;
+}
+/*--------------------------------------------------------------- */
+/* This is the main entry point for this executable
+ */
+int main(int argc, const char *argv[])
+{
+ 	int             status;
+    int             sv[2];
+    FILE           *istream;
+    FILE           *ostream;
+    tinyrl_vt100_t *term;
+    unsigned        i,writes,unframed,framed;
+    char            last[64];
+    int             pv[2];
+
+	lub_test_parse_command_line(argc,argv);
+	lub_test_begin("tinyrl");
+
+    if(-1 == socketpair(AF_UNIX,SOCK_SEQPACKET,0,sv))
+    {
+        lub_test_seq_begin(++testseq,"terminal output");
+        lub_test_seq_log(LUB_TEST_NORMAL,"packet sockets are not available");
+        lub_test_seq_end();
+        lub_test_end();
+        return 0;
+    }
+    /* an unbuffered stream shows every write */
+    ostream = fdopen(sv[0],"w");
+    setvbuf(ostream,NULL,_IONBF,0);
+    istream = tmpfile();
+
+    lub_test_seq_begin(++testseq,"tinyrl_vt100 frames");
+
+    term = tinyrl_vt100_new(istream,ostream);
+
+    tinyrl_vt100_frame_begin(term);
+    tinyrl_vt100_cursor_forward(term,3);
+    tinyrl_vt100_cursor_back(term,5);
+    tinyrl_vt100_frame_begin(term);
+    tinyrl_vt100_erase(term,12);
+    tinyrl_vt100_write(term,"***",3);
+    tinyrl_vt100_frame_end(term);
+    lub_test_check((0 == count_writes(sv[1],NULL,0)),
+                   "Check nothing is written until the outer frame ends");
+    tinyrl_vt100_frame_end(term);
+    writes = count_writes(sv[1],last,sizeof(last));
+    lub_test_check((1 == writes),
+                   "Check the frame is sent in a single write");
+    lub_test_check((0 == strcmp(last,"\033[2D\033[12P***")),
+                   "Check the cursor movements have been merged");
+
+    tinyrl_vt100_frame_begin(term);
+    tinyrl_vt100_cursor_back(term,4);
+    tinyrl_vt100_cursor_forward(term,4);
+    tinyrl_vt100_frame_end(term);
+    lub_test_check((0 == count_writes(sv[1],NULL,0)),
+                   "Check movements which cancel out write nothing");
+
+    tinyrl_vt100__set_coalesce(term,BOOL_FALSE);
+    tinyrl_vt100_frame_begin(term);
+    tinyrl_vt100_cursor_back(term,4);
+    tinyrl_vt100_cursor_forward(term,4);
+    tinyrl_vt100_frame_end(term);
+    writes = count_writes(sv[1],last,sizeof(last));
+    lub_test_check((1 == writes) && (0 == strcmp(last,"\033[4D\033[4C")),
+                   "Check movements can be left unmerged");
+    tinyrl_vt100__set_coalesce(term,BOOL_TRUE);
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"writes per keystroke");
+
+    unframed = 0;
+    for(i = 0; i < NUM_KEYS; i++)
+    {
+        redraw_line(term,NUM_KEYS);
+        unframed += count_writes(sv[1],NULL,0);
+    }
+    framed = 0;
+    for(i = 0; i < NUM_KEYS; i++)
+    {
+        tinyrl_vt100_frame_begin(term);
+        redraw_line(term,NUM_KEYS);
+        tinyrl_vt100_frame_end(term);
+        framed += count_writes(sv[1],NULL,0);
+    }
+    lub_test_check((NUM_KEYS == framed),
+                   "Check each redrawn line takes one write");
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "unframed : %.1f writes per keystroke",
+                     (double)unframed/NUM_KEYS);
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "framed   : %.1f writes per keystroke",
+                     (double)framed/NUM_KEYS);
+    tinyrl_vt100_delete(term);
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"tinyrl_vt100 input");
+    if(-1 == pipe(pv))
+    {
+        lub_test_seq_log(LUB_TEST_NORMAL,"pipes are not available");
+    }
+    else
+    {
+        FILE *input = fdopen(pv[0],"r");
+
+        term = tinyrl_vt100_new(input,ostream);
+        lub_test_check((tinyrl_vt100_CURSOR_UP == decode(term,pv[1],"\033[A")),
+                       "Check the up arrow is decoded");
+        lub_test_check((tinyrl_vt100_END == decode(term,pv[1],"\033OF")),
+                       "Check an SS3 sequence is decoded");
+        lub_test_check((tinyrl_vt100_DELETE == decode(term,pv[1],"\033[3~")),
+                       "Check the delete key is decoded");
+        lub_test_check((tinyrl_vt100_HOME == decode(term,pv[1],"\033[1;5H")),
+                       "Check modifiers are ignored");
+        lub_test_check((tinyrl_vt100_PASTE_BEGIN == decode(term,pv[1],"\033[200~x")),
+                       "Check the start of a paste is decoded");
+        lub_test_check(('x' == tinyrl_vt100_getchar(term)),
+                       "Check the following input is kept");
+        lub_test_check((tinyrl_vt100_UNKNOWN == decode(term,pv[1],"\033[")),
+                       "Check an incomplete sequence times out");
+        lub_test_check((EOF == tinyrl_vt100_peekchar(term,0)),
+                       "Check there is nothing left to read");
+        {
+            int   pv2[2];
+            FILE *other = NULL;
+
+            if(0 == pipe(pv2))
+            {
+                other = fdopen(pv2[0],"r");
+                if((2 == write(pv[1],"ab",2)) && (1 == write(pv2[1],"y",1)))
+                {
+                    lub_test_check(('a' == tinyrl_vt100_getchar(term)),
+                                   "Check input is read ahead");
+                    tinyrl_vt100__set_istream(term,other);
+                    lub_test_check(('y' == tinyrl_vt100_getchar(term)),
+                                   "Check the read ahead is dropped with its stream");
+                    tinyrl_vt100__set_istream(term,input);
+                    lub_test_check((EOF == tinyrl_vt100_peekchar(term,0)),
+                                   "Check the dropped input isn't seen again");
+                }
+                close(pv2[1]);
+                if(NULL != other)
+                {
+                    fclose(other);
+                }
+            }
+        }
+        lub_test_check((tinyrl_vt100_UNKNOWN == decode(term,pv[1],"\033[99~q")),
+                       "Check an unknown sequence is consumed");
+        lub_test_check(('q' == tinyrl_vt100_getchar(term)),
+                       "Check the input after an unknown sequence is kept");
+        close(pv[1]);
+        lub_test_check((EOF == tinyrl_vt100_getchar(term))
+                       && tinyrl_vt100_ieof(term),
+                       "Check the end of the input is seen");
+        tinyrl_vt100_delete(term);
+        fclose(input);
+    }
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"tinyrl scripts");
+    {
+        FILE     *script = tmpfile();
+        FILE     *echo   = tmpfile();
+        tinyrl_t *rl;
+        char     *longline;
+
+        longline = malloc(LONG_LINE + 1);
+        memset(longline,'x',LONG_LINE);
+        longline[LONG_LINE] = '\0';
+        fprintf(script,"  first\r\n\nthird\n%s\nlast",longline);
+        rewind(script);
+
+        rl = tinyrl_new(script,echo,0,NULL);
+        lub_test_check(check_line(rl,"first"),
+                       "Check leading space and line endings are stripped");
+        lub_test_check(check_line(rl,""),
+                       "Check a blank line is returned");
+        tinyrl__set_script_echo(rl,BOOL_FALSE);
+        lub_test_check(check_line(rl,"third"),
+                       "Check a line can be read without echo");
+        tinyrl__set_script_echo(rl,BOOL_TRUE);
+        lub_test_check(check_line(rl,longline),
+                       "Check a line longer than a block is read whole");
+        lub_test_check(check_line(rl,"last"),
+                       "Check the last line needn't have a newline");
+        lub_test_check(check_line(rl,NULL),
+                       "Check the end of the script is seen");
+        /* a script may be interrupted by another one */
+        tinyrl__set_script_echo(rl,BOOL_FALSE);
+        {
+            FILE *outer = tmpfile();
+            FILE *inner = tmpfile();
+
+            fputs("outer1\nouter2\n",outer);
+            fputs("inner1\n",inner);
+            rewind(outer);
+            rewind(inner);
+            tinyrl__set_istream(rl,outer);
+            (void)check_line(rl,"outer1");
+            tinyrl__set_istream(rl,inner);
+            lub_test_check(check_line(rl,"inner1") && check_line(rl,NULL),
+                           "Check a nested script is read");
+            tinyrl__set_istream(rl,outer);
+            lub_test_check(check_line(rl,"outer2"),
+                           "Check the outer script carries on where it left off");
+            fclose(inner);
+            fclose(outer);
+        }
+        /* a script may be abandoned and its stream reused for another */
+        {
+            FILE *outer = tmpfile();
+            FILE *inner = tmpfile();
+            FILE *again = tmpfile();
+
+            fputs("outer1\nouter2\n",outer);
+            fputs("inner1\ninner2\n",inner);
+            fputs("again1\n",again);
+            rewind(outer);
+            rewind(again);
+            tinyrl__set_istream(rl,outer);
+            (void)check_line(rl,"outer1");
+            /* the same FILE is used again for the second script */
+            rewind(inner);
+            tinyrl__set_istream(rl,inner);
+            (void)check_line(rl,"inner1");
+            tinyrl_forget_istream(rl,inner);
+            tinyrl__set_istream(rl,outer);
+            rewind(inner);
+            ftruncate(fileno(inner),0);
+            fputs("second1\n",inner);
+            rewind(inner);
+            tinyrl__set_istream(rl,inner);
+            lub_test_check(check_line(rl,"second1") && check_line(rl,NULL),
+                           "Check an abandoned script isn't read again");
+            tinyrl_forget_istream(rl,inner);
+            tinyrl__set_istream(rl,again);
+            lub_test_check(check_line(rl,"again1") && check_line(rl,NULL),
+                           "Check a script can follow a finished one");
+            tinyrl_forget_istream(rl,again);
+            tinyrl__set_istream(rl,outer);
+            lub_test_check(check_line(rl,"outer2") && check_line(rl,NULL),
+                           "Check the outer script is still read");
+            fclose(again);
+            fclose(inner);
+            fclose(outer);
+        }
+        tinyrl_delete(rl);
+
+        /* the echo should show just the lines which had it enabled */
+        rewind(echo);
+        lub_test_check(fgets(last,sizeof(last),echo)
+                       && (0 == strcmp(last,"> first\n")),
+                       "Check the line is echoed with its prompt");
+        /* a blank line just moves down the screen */
+        while(fgets(last,sizeof(last),echo) && (0 == strcmp(last,"\n")))
+        {
+        }
+        lub_test_check((0 == strncmp(last,"> xxx",5)),
+                       "Check nothing is echoed when echo is disabled");
+        free(longline);
+        fclose(echo);
+        fclose(script);
+    }
+    {
+        FILE     *script = tmpfile();
+        FILE     *echo   = tmpfile();
+        tinyrl_t *rl;
+        size_t    len;
+
+        fputs("debu\nclock\n",script);
+        rewind(script);
+
+        rl = tinyrl_new(script,echo,0,NULL);
+        tinyrl_bind_key(rl,KEY_LF,complete_enter);
+        lub_test_check(check_line(rl,"debug"),
+                       "Check the Enter handler can complete a line");
+        lub_test_check(check_line(rl,"clock"),
+                       "Check a line the handler leaves alone");
+        tinyrl_delete(rl);
+
+        /* the completion is added to the echo rather than repeating it */
+        rewind(echo);
+        len = fread(last,1,sizeof(last) - 1,echo);
+        last[len] = '\0';
+        lub_test_check((0 == strcmp(last,"> debug\n> clock\n")),
+                       "Check a completed line is echoed once");
+        fclose(echo);
+        fclose(script);
+    }
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"tinyrl_history");
+    {
+        static const char        *moved[]   = {"b","c","a",NULL};
+        static const char        *stifled[] = {"c","a","d",NULL};
+        static const char        *removed[] = {"c","d",NULL};
+        tinyrl_history_t         *history   = tinyrl_history_new(0);
+        tinyrl_history_iterator_t iter;
+        tinyrl_history_entry_t   *entry;
+        char                      line[32];
+        clock_t                   start;
+
+        tinyrl_history_add(history,"a");
+        tinyrl_history_add(history,"b");
+        tinyrl_history_add(history,"c");
+        tinyrl_history_add(history,"a");
+        lub_test_check(check_history(history,moved),
+                       "Check a repeated line moves to the end");
+        entry = tinyrl_history_getlast(history,&iter);
+        entry = tinyrl_history_getprevious(&iter);
+        lub_test_check(entry && (0 == strcmp("c",tinyrl_history_entry__get_line(entry))),
+                       "Check the history can be walked backwards");
+        entry = tinyrl_history_get(history,3);
+        lub_test_check(entry && (0 == strcmp("c",tinyrl_history_entry__get_line(entry))),
+                       "Check an entry can be found by its index");
+        lub_test_check((NULL == tinyrl_history_get(history,1)),
+                       "Check a replaced entry can't be found");
+
+        tinyrl_history_stifle(history,3);
+        tinyrl_history_add(history,"d");
+        lub_test_check(check_history(history,stifled),
+                       "Check the oldest line is dropped when stifled");
+        entry = tinyrl_history_remove(history,1);
+        lub_test_check(entry && (0 == strcmp("a",tinyrl_history_entry__get_line(entry)))
+                       && check_history(history,removed),
+                       "Check an entry can be removed from the middle");
+        free(entry);
+        tinyrl_history_unstifle(history);
+
+        /* a long running session which keeps repeating itself */
+        start = clock();
+        for(i = 0; i < NUM_COMMANDS; i++)
+        {
+            sprintf(line,"show interface %u",(i * 7919) % (NUM_COMMANDS/2));
+            tinyrl_history_add(history,line);
+        }
+        lub_test_seq_log(LUB_TEST_NORMAL,
+                         "%u commands added in %.1f ms",
+                         NUM_COMMANDS,
+                         (double)(clock() - start) * 1000 / CLOCKS_PER_SEC);
+        i = 0;
+        for(entry = tinyrl_history_getfirst(history,&iter);
+            entry;
+            entry = tinyrl_history_getnext(&iter))
+        {
+            i++;
+        }
+        lub_test_check((i == 2 + NUM_COMMANDS/2),
+                       "Check each line is only held once");
+        tinyrl_history_clear(history);
+        lub_test_check((NULL == tinyrl_history_getfirst(history,&iter)),
+                       "Check the history can be cleared");
+        tinyrl_history_delete(history);
+    }
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"tinyrl_history files");
+    {
+        static const char *loaded[]  = {"show version","configure","show interfaces",NULL};
+        static const char *shows[]   = {"show interfaces","show version",NULL};
+        static const char *nothing[] = {NULL};
+        tinyrl_history_t  *first     = tinyrl_history_new(0);
+        tinyrl_history_t  *second    = tinyrl_history_new(0);
+        tinyrl_history_t  *later     = tinyrl_history_new(0);
+        tinyrl_history_t  *latest    = tinyrl_history_new(2);
+        tinyrl_history_iterator_t iter;
+        tinyrl_history_entry_t   *entry;
+        char               line[32];
+        size_t             written = 0;
+        size_t             size;
+
+        (void)unlink(HISTORY_FILE);
+        lub_test_check(tinyrl_history_attach(first,HISTORY_FILE,0)
+                       && tinyrl_history_attach(second,HISTORY_FILE,0),
+                       "Check two sessions can share a history file");
+        tinyrl_history_add(first,"show version");
+        tinyrl_history_add(second,"configure");
+        tinyrl_history_add(first,"show interfaces");
+        lub_test_check(tinyrl_history_attach(later,HISTORY_FILE,0)
+                       && check_history(later,loaded),
+                       "Check a new session picks up the lines from both");
+        lub_test_check(check_search(second,"show",shows),
+                       "Check the file can be searched back from the newest line");
+        lub_test_check(check_search(second,"delete",nothing),
+                       "Check a search can find nothing");
+        lub_test_check(tinyrl_history_attach(latest,HISTORY_FILE,0)
+                       && check_history(latest,&loaded[1]),
+                       "Check only the newest lines are loaded when stifled");
+        tinyrl_history_delete(latest);
+        tinyrl_history_delete(later);
+        tinyrl_history_delete(second);
+        tinyrl_history_delete(first);
+
+        (void)unlink(HISTORY_FILE);
+        first = tinyrl_history_new(0);
+        (void)tinyrl_history_attach(first,HISTORY_FILE,HISTORY_LIMIT);
+        for(i = 0; i < 200; i++)
+        {
+            sprintf(line,"show interface %u",i);
+            tinyrl_history_add(first,line);
+            written += strlen(line) + 1;
+        }
+        size = history_file_size(written);
+        lub_test_seq_log(LUB_TEST_NORMAL,
+                         "%u bytes written, %u bytes kept",
+                         (unsigned)written,(unsigned)size);
+        lub_test_check((size < written),
+                       "Check the file is compacted when it grows too big");
+        tinyrl_history_delete(first);
+        later = tinyrl_history_new(0);
+        (void)tinyrl_history_attach(later,HISTORY_FILE,HISTORY_LIMIT);
+        entry = tinyrl_history_getlast(later,&iter);
+        lub_test_check(entry && (0 == strcmp(line,tinyrl_history_entry__get_line(entry))),
+                       "Check the newest line is kept");
+        entry = tinyrl_history_getfirst(later,&iter);
+        lub_test_check(entry && (0 == strncmp("show interface ",tinyrl_history_entry__get_line(entry),15)),
+                       "Check the file is cut at the start of a line");
+        tinyrl_history_delete(later);
+        (void)unlink(HISTORY_FILE);
+    }
+    lub_test_seq_end();
+
+    fclose(istream);
+    fclose(ostream);
+    close(sv[1]);
+
+    /* tidy up */
+    status = lub_test_get_status();
+    lub_test_end();
+
+    return status;
+}
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "lub/test.h"
+#include "lub/string.h"
+#include "lub/argv.h"
+#include "lub/ctype.h"
+#include "clish/view.h"
+#include "clish/command.h"
+/**
+ \example test/view.c
+ */
+
+/*************************************************************
+ * TEST CODE
+ ************************************************************* */
+
+#define NUM_COMMANDS 2000
+#define NUM_LOOKUPS  200000
+
+static int testseq;
+
+static const char *lines[] =
+{
+    "none","empty","action","builtin x","view","command0001 arg","nothing",NULL
+};
+
+/*--------------------------------------------------------------- */
+/*
+ * This is how a command line used to be resolved; by expanding
+ * the action just to see whether there was one.
+ */
+static clish_command_t *
+resolve_by_expansion(clish_view_t *view,
+                     const char   *line)
+{
+    clish_command_t *result = clish_view_resolve_prefix(view,line);
+
+    if (NULL != result)
+    {
+        char *action = clish_command__get_action(result,NULL,NULL);
+        if((NULL == action) &&
+           (NULL == clish_command__get_builtin(result)) &&
+           (NULL == clish_command__get_view(result)) )
+        {
+            result = NULL;
+        }
+        lub_string_free(action);
+    }
+    return result;
+}
+/*--------------------------------------------------------------- */
+/* the commands used to check the trie against a scan of the view */
+static const char *trie_commands[] =
+{
+    "show","show interfaces","show interfaces brief","show ip route",
+    "Show Version","sh","shutdown","ip address","copy",
+    "copy running startup",NULL
+};
+static const char *trie_lines[] =
+{
+    "","   ","show","SHOW","sHoW iNtErFaCeS","show interfaces brief",
+    "show INTERFACES BRIEF extra","show bogus interfaces","sh","sho",
+    "show version","show ip","show ip route","ip","ip address 1.2.3.4",
+    "ip bogus","copy running","copy running startup now","x",NULL
+};
+static const char *trie_partials[] =
+{
+    "","s","S","sh","SH","show ","show i","SHOW I","show interfaces ",
+    "show ip ","show ip","ip ","ip A","x","show interfaces brief ",
+    "copy r","show bogus ","shutdown ",NULL
+};
+/*--------------------------------------------------------------- */
+/*
+ * This is how a command line used to be resolved; by looking up
+ * each run of leading words in turn. The number of words which
+ * were looked at is also returned.
+ */
+static clish_command_t *
+resolve_by_scan(clish_view_t *view,
+                const char   *line,
+                unsigned     *examined)
+{
+    clish_command_t *result = NULL,*cmd;
+    char            *buffer = NULL;
+    lub_argv_t      *argv   = lub_argv_new(line,0);
+    unsigned         i;
+
+    for(i = 0;
+        i < lub_argv__get_count(argv);
+        i++)
+    {
+        lub_string_cat(&buffer,lub_argv__get_arg(argv,i));
+        cmd = clish_view_find_command(view,buffer);
+        if(NULL == cmd)
+        {
+            i++;
+            break;
+        }
+        result = cmd;
+        lub_string_cat(&buffer," ");
+    }
+    *examined = i;
+    lub_string_free(buffer);
+    lub_argv_delete(argv);
+
+    return result;
+}
+/*--------------------------------------------------------------- */
+/*
+ * This is how the next completion used to be found; by scanning
+ * every following command in the view.
+ */
+static const clish_command_t *
+complete_by_scan(clish_view_t          *view,
+                 const clish_command_t *cmd,
+                 const char            *line)
+{
+    unsigned words = lub_argv_wordcount(line);
+
+    if(!*line || lub_ctype_isspace(line[strlen(line)-1]))
+    {
+        /* account for trailing space */
+        words++;
+    }
+    for(cmd = cmd ? clish_view_getnext_command(view,cmd)
+                  : clish_view_getfirst_command(view);
+        cmd;
+        cmd = clish_view_getnext_command(view,cmd))
+    {
+        const char *name = clish_command__get_name(cmd);
+
+        if((words == lub_argv_wordcount(name))
+           && (lub_string_nocasestr(name,line) == name))
+        {
+            break;
+        }
+    }
+    return cmd;
+}
+/*--------------------------------------------------------------- */
+/* Check every completion of a line is found, in the same order, by both */
+static bool_t
+same_completions(clish_view_t *view,
+                 const char   *line,
+                 unsigned     *count)
+{
+    const clish_command_t *trie = NULL;
+    const clish_command_t *scan = NULL;
+    lub_argv_t            *argv = lub_argv_new(line,0);
+
+    *count = 0;
+    do
+    {
+        trie = clish_view_find_next_completion_argv(view,trie,line,argv,NULL,NULL);
+        scan = complete_by_scan(view,scan,line);
+        if(trie)
+        {
+            ++*count;
+        }
+    } while(trie && (trie == scan));
+    lub_argv_delete(argv);
+
+    return (trie == scan) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* allow only those commands without an access restriction */
+static bool_t
+unrestricted(const clish_command_t *cmd,
+             void                  *arg)
+{
+    arg = arg; /* not used */
+    return (NULL == clish_command__get_access(cmd)) ? BOOL_TRUE : BOOL_FALSE;
+}
+/*--------------------------------------------------------------- */
+/* This is the main entry point for this executable
+ */
+int main(int argc, const char *argv[])
+{
+    clish_view_t    *view,*other;
+    clish_command_t *cmd;
+    char             name[32];
+    const char      *line;
+    unsigned         i,mismatches;
+    clock_t          start;
+    double           expanded,queried;
+    int              status;
+
+    lub_test_parse_command_line(argc,argv);
+    lub_test_begin("clish_view");
+
+    view  = clish_view_new("view","view> ");
+    other = clish_view_new("other","other> ");
+
+    lub_test_seq_begin(++testseq,"clish_command__get_executable()");
+
+    cmd = clish_view_new_command(view,"none","does nothing");
+    lub_test_check((BOOL_FALSE == clish_command__get_executable(cmd)),
+                   "Check a command with nothing to do is not executable");
+    lub_test_check((NULL == clish_view_resolve_command(view,"none")),
+                   "Check a command with nothing to do is not resolved");
+
+    cmd = clish_view_new_command(view,"empty","has an empty action");
+    clish_command__set_action(cmd,"");
+    lub_test_check((BOOL_FALSE == clish_command__get_executable(cmd)),
+                   "Check a command with an empty action is not executable");
+
+    cmd = clish_view_new_command(view,"action","has an action");
+    clish_command__set_action(cmd,"${NO_SUCH_VARIABLE}");
+    lub_test_check((BOOL_TRUE == clish_command__get_executable(cmd)),
+                   "Check a command with an action is executable");
+    lub_test_check((cmd == clish_view_resolve_command(view,"action")),
+                   "Check a command with an action is resolved");
+
+    cmd = clish_view_new_command(view,"builtin","has a builtin");
+    clish_command__set_builtin(cmd,"clish_close");
+    lub_test_check((BOOL_TRUE == clish_command__get_executable(cmd)),
+                   "Check a command with a builtin is executable");
+
+    cmd = clish_view_new_command(view,"view","has a view");
+    clish_command__set_view(cmd,other);
+    lub_test_check((BOOL_TRUE == clish_command__get_executable(cmd)),
+                   "Check a command with a view is executable");
+
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"access checked at lookup");
+    {
+        clish_command_t       *show, *secret;
+        lub_argv_t            *argv;
+        const clish_command_t *next;
+
+        show   = clish_view_new_command(other,"show","shows something");
+        clish_command__set_action(show,"show");
+        secret = clish_view_new_command(other,"show secret","shows a secret");
+        clish_command__set_action(secret,"show secret");
+        clish_command__set_access(secret,"admin");
+
+        argv = lub_argv_new("show secret",0);
+        lub_test_check((secret == clish_view_resolve_prefix_argv(other,argv,NULL,NULL,NULL)),
+                       "Check a restricted command resolves without an access check");
+        lub_test_check((show == clish_view_resolve_prefix_argv(other,argv,NULL,unrestricted,NULL)),
+                       "Check a denied command leaves the shorter match");
+        lub_argv_delete(argv);
+
+        argv = lub_argv_new("show s",0);
+        next = clish_view_find_next_completion_argv(other,NULL,"show s",argv,NULL,NULL);
+        lub_test_check((secret == next),
+                       "Check a restricted command completes without an access check");
+        next = clish_view_find_next_completion_argv(other,NULL,"show s",argv,unrestricted,NULL);
+        lub_test_check((NULL == next),
+                       "Check a denied command is not offered as a completion");
+        lub_argv_delete(argv);
+    }
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"the trie of command words");
+    {
+        clish_view_t    *trie = clish_view_new("trie","trie> ");
+        clish_command_t *scanned;
+        lub_argv_t      *argv;
+        unsigned         examined,expected,count;
+
+        for(i = 0;
+            (line = trie_commands[i]);
+            i++)
+        {
+            cmd = clish_view_new_command(trie,line,"a command");
+            clish_command__set_action(cmd,line);
+        }
+        for(i = 0;
+            (line = trie_lines[i]);
+            i++)
+        {
+            scanned = resolve_by_scan(trie,line,&expected);
+            lub_test_check((scanned == clish_view_resolve_prefix(trie,line)),
+                           "Check '%s' resolves to '%s' as the scan does",
+                           line,scanned ? clish_command__get_name(scanned) : "");
+            argv = lub_argv_new(line,0);
+            cmd  = clish_view_resolve_prefix_argv(trie,argv,&examined,NULL,NULL);
+            lub_test_check((scanned == cmd) && (expected == examined),
+                           "Check '%s' examines %u words as the scan does",
+                           line,expected);
+            lub_argv_delete(argv);
+        }
+        for(i = 0;
+            (line = trie_partials[i]);
+            i++)
+        {
+            bool_t same = same_completions(trie,line,&count);
+
+            lub_test_check(same,
+                           "Check '%s' has the same %u completions as the scan",
+                           line,count);
+        }
+        /* some particular cases, in case the scan is wrong too */
+        lub_test_check((clish_view_find_command(trie,"show version")
+                        == clish_view_resolve_prefix(trie,"SHOW VERSION")),
+                       "Check a mixed case command is resolved in any case");
+        lub_test_check((clish_view_find_command(trie,"show")
+                        == clish_view_resolve_prefix(trie,"show ip")),
+                       "Check a word with no command of its own isn't resolved");
+        argv = lub_argv_new("show bogus interfaces",0);
+        (void)clish_view_resolve_prefix_argv(trie,argv,&examined,NULL,NULL);
+        lub_test_check((2 == examined),
+                       "Check the words after a failing one aren't examined");
+        lub_argv_delete(argv);
+        lub_test_check(same_completions(trie,"sh",&count) && (3 == count),
+                       "Check a command is offered along with those it prefixes");
+
+        clish_view_delete(trie);
+    }
+    lub_test_seq_end();
+
+    lub_test_seq_begin(++testseq,"clish_view_resolve_command() on %d commands",
+                       NUM_COMMANDS);
+
+    for(i = 0;
+        i < NUM_COMMANDS;
+        i++)
+    {
+        sprintf(name,"command%04u",i);
+        cmd = clish_view_new_command(view,name,"a command");
+        clish_command__set_action(cmd,"echo ${first} ${second} `date` | cat");
+    }
+    mismatches = 0;
+    start      = clock();
+    for(i = 0;
+        i < NUM_LOOKUPS;
+        i++)
+    {
+        sprintf(name,"command%04u ",i % NUM_COMMANDS);
+        if(NULL == resolve_by_expansion(view,name))
+        {
+            mismatches++;
+        }
+    }
+    expanded = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start    = clock();
+    for(i = 0;
+        i < NUM_LOOKUPS;
+        i++)
+    {
+        sprintf(name,"command%04u ",i % NUM_COMMANDS);
+        if(NULL == clish_view_resolve_command(view,name))
+        {
+            mismatches++;
+        }
+    }
+    queried = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    lub_test_check((0 == mismatches),
+                   "Check every command line is resolved");
+    for(i = 0;
+        (line = lines[i]);
+        i++)
+    {
+        lub_test_check((resolve_by_expansion(view,line) ==
+                        clish_view_resolve_command(view,line)),
+                       "Check '%s' resolves as it did by expansion",line);
+    }
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "expanding the action : %.3f usec per lookup",
+                     expanded * 1000000 / NUM_LOOKUPS);
+    lub_test_seq_log(LUB_TEST_NORMAL,
+                     "precomputed query    : %.3f usec per lookup",
+                     queried * 1000000 / NUM_LOOKUPS);
+    lub_test_seq_end();
+
+    clish_view_delete(view);
+    clish_view_delete(other);
+
+    /* tidy up */
+    status = lub_test_get_status();
+    lub_test_end();
+
+    return status;
+}
@@ -9,6 +9,8 @@
 #ifndef _tinyrl_history_h
 #define _tinyrl_history_h
 
+#include <stddef.h>
+
 #include "lub/c_decl.h"
 #include "lub/types.h"
 
@@ -108,6 +110,69 @@ extern tinyrl_history_expand_t
                           const char             *string, 
                           char                  **output);
 
+/*
+ * HISTORY FILE
+ */
+/**
+ * The default size at which a history file is compacted.
+ */
+#define TINYRL_HISTORY_FILE_LIMIT (1024 * 1024)
+
+/**
+ * The number of lines taken from a history file when it is attached
+ * to a history which isn't stifled.
+ */
+#define TINYRL_HISTORY_FILE_LOAD 500
+
+/**
+ * This operation shares the history with other sessions through a file.
+ * The newest lines in the file are added to the history, and each line
+ * added from now on is appended to the file. 
+ *
+ * The file is memory mapped rather than read, so only the lines which are
+ * used get looked at. Any number of sessions may append to the same 
+ * file. Once it grows beyond the limit (zero means no limit) the older 
+ * half of it is discarded in the background.
+ *
+ * \return
+ * - BOOL_TRUE if the file could be opened.
+ */
+extern bool_t
+    tinyrl_history_attach(tinyrl_history_t *instance,
+                          const char       *filename,
+                          size_t            limit);
+
+/**
+ * This type is used to search back through a history file
+ */
+typedef struct _tinyrl_history_search tinyrl_history_search_t;
+/**
+ * CLIENTS MUST NOT USE THESE FIELDS DIRECTLY
+ */
+struct _tinyrl_history_search
+{
+    const tinyrl_history_t *history;
+    const char             *text;
+    size_t                  offset;
+};
+
+/**
+ * This operation finds the newest line in the history file which contains
+ * the specified text. This includes the lines appended by other sessions.
+ *
+ * \return
+ * - a dynamically allocated copy of the line or NULL if there is none.
+ */
+extern char *
+    tinyrl_history_search_first(tinyrl_history_t        *instance,
+                                const char              *text,
+                                tinyrl_history_search_t *search);
+/**
+ * This operation finds the next older line which contains the text.
+ */
+extern char *
+    tinyrl_history_search_next(tinyrl_history_search_t *search);
+
 _END_C_DECL
 
 #endif /* _tinyrl_history_h */
@@ -9,19 +9,42 @@
 
 #include "private.h"
 #include "lub/string.h"
+#include "lub/hash.h"
 #include <stdlib.h>
 
 #include "tinyrl/history.h"
 
+/* the number of slots in a new ring */
+#define TINYRL_HISTORY_INITIAL_SIZE 16
+
+/*
+ * The entries are held in a ring of slots, oldest first. Each entry
+ * records its position, which grows without limit; the slot for a 
+ * position is found by masking it with the (power of two) ring size.
+ * Removing an entry from the middle of the ring simply empties its 
+ * slot.
+ */
 struct _tinyrl_history
 {
-    tinyrl_history_entry_t **entries;   /* pointer entries */
-    unsigned     length;    /* Number of elements within this array */
-    unsigned     size;      /* Number of slots allocated in this array */
+    tinyrl_history_entry_t **entries;   /* a ring of pointer entries */
+    unsigned     size;      /* Number of slots allocated in the ring */
+    unsigned     first;     /* The position of the oldest slot in use */
+    unsigned     used;      /* Number of slots in use (including empty ones) */
+    unsigned     length;    /* Number of entries within the ring */
+    lub_hash_t   lines;     /* The entries indexed by their line */
     unsigned     current_index;
     unsigned     stifle;
+    tinyrl_history_file_t *file; /* The file shared with other sessions */
 };
 
+#define SLOT(this,position) (this)->entries[(position) & ((this)->size - 1)]
+
+/*------------------------------------- */
+static const char *
+entry_getkey(const void *clientnode)
+{
+    return tinyrl_history_entry__get_line(clientnode);
+}
 /*------------------------------------- */
 void
 tinyrl_history_init(tinyrl_history_t *this,
@@ -30,26 +53,31 @@ tinyrl_history_init(tinyrl_history_t *this,
     this->entries       = NULL;
     this->stifle        = stifle;
     this->current_index = 1;
-    this->length        = 0;
     this->size          = 0;
+    this->first         = 0;
+    this->used          = 0;
+    this->length        = 0;
+    this->file          = NULL;
+    lub_hash_init(&this->lines,entry_getkey,BOOL_FALSE);
 }
 /*------------------------------------- */
 void
 tinyrl_history_fini(tinyrl_history_t *this)
 {
-    tinyrl_history_entry_t *entry;
-    tinyrl_history_iterator_t iter;
-    
     /* release the resource associated with each entry */
-    for(entry = tinyrl_history_getfirst(this,&iter);
-        entry;
-        entry = tinyrl_history_getnext(&iter))
-    {
-        tinyrl_history_entry_delete(entry);
-    }
-    /* release the list */
+    tinyrl_history_clear(this);
+
+    /* release the ring */
     free(this->entries);
     this->entries = NULL;
+    this->size    = 0;
+    lub_hash_fini(&this->lines);
+
+    if(NULL != this->file)
+    {
+        tinyrl_history_file_delete(this->file);
+        this->file = NULL;
+    }
 }
 /*------------------------------------- */
 tinyrl_history_t *
@@ -74,153 +102,133 @@ tinyrl_history_delete(tinyrl_history_t *this)
 HISTORY LIST MANAGEMENT 
 */
 /*------------------------------------- */
-/* insert a new entry at the current offset */
-static void
-insert_entry(tinyrl_history_t *this,
-             const char       *line)
+/*
+ * Take the entry at the specified position out of the ring and the
+ * index, returning it to the caller.
+ */
+static tinyrl_history_entry_t *
+remove_entry(tinyrl_history_t *this,
+             unsigned          position)
 {
-    tinyrl_history_entry_t *new_entry = tinyrl_history_entry_new(line,this->current_index++);
-    assert(this->length);
-    assert(this->entries);
-    if(new_entry)
+    tinyrl_history_entry_t *entry = SLOT(this,position);
+    
+    assert(entry);
+    SLOT(this,position) = NULL;
+    lub_hash_remove(&this->lines,entry);
+    this->length--;
+
+    /* give back any empty slots at either end of the ring */
+    while(this->used && (NULL == SLOT(this,this->first)))
+    {
+        this->first++;
+        this->used--;
+    }
+    while(this->used && (NULL == SLOT(this,this->first + this->used - 1)))
     {
-        this->entries[this->length-1] = new_entry;
+        this->used--;
     }
+    return entry;
 }
 /*------------------------------------- */
 /*
- * This frees the specified entries from the 
- * entries vector. NB it doesn't perform any shuffling.
- * This function is inclusive of start and end
+ * Move the entries down to fill any empty slots
  */
 static void
-free_entries(const tinyrl_history_t *this,
-             unsigned                start,
-             unsigned                end)
+compact_entries(tinyrl_history_t *this)
 {
-    unsigned i;
-    assert(start <= end);
-    assert(end < this->length);
-        
-    for(i  = start;
-        i <= end;
-        i++)
+    unsigned from,to = 0;
+
+    for(from = 0; from < this->used; from++)
     {
-        tinyrl_history_entry_t *entry = this->entries[i];
-        tinyrl_history_entry_delete(entry);
-        entry = NULL;
+        tinyrl_history_entry_t *entry = SLOT(this,this->first + from);
+        if(NULL != entry)
+        {
+            SLOT(this,this->first + from) = NULL;
+            SLOT(this,this->first + to)   = entry;
+            tinyrl_history_entry__set_position(entry,this->first + to);
+            to++;
+        }
     }
+    this->used = to;
 }
 /*------------------------------------- */
 /*
- * This removes the specified entries from the 
- * entries vector. Shuffling up the array as necessary 
- * This function is inclusive of start and end
+ * Double the size of the ring; each slot in use has to move to where 
+ * its position now lies.
  */
-static void
-remove_entries(tinyrl_history_t *this,
-               unsigned          start,
-               unsigned          end)
+static bool_t
+grow_entries(tinyrl_history_t *this)
 {
-    unsigned delta = (end - start) + 1; /* number of entries being deleted */
-    /* number of entries to shuffle */
-    unsigned num_entries = (this->length - end) - 1; 
-    assert(start <= end);
-    assert(end < this->length);
+    unsigned                 new_size = this->size ? this->size * 2 : TINYRL_HISTORY_INITIAL_SIZE;
+    tinyrl_history_entry_t **new_entries;
+    unsigned                 i;
 
-    if(num_entries)
+    new_entries = calloc(new_size,sizeof(tinyrl_history_entry_t *));
+    if(NULL == new_entries)
     {
-        /* move the remaining entries down to close the array */
-        memmove(&this->entries[start],
-                &this->entries[end+1],
-                sizeof(tinyrl_history_entry_t *) * num_entries);
+        return BOOL_FALSE;
     }
-    /* now fix up the length variables */
-    this->length -= delta;
-}
-/*------------------------------------- */
-/* 
-Search the current history buffer for the specified 
-line and if found remove it.
-*/
-static bool_t
-remove_duplicate(tinyrl_history_t *this,
-                 const char       *line)
-{
-    bool_t result = BOOL_FALSE;
-    unsigned i;
-        
-    for(i  = 0;
-        i < this->length;
-        i++)
+    for(i = 0; i < this->used; i++)
     {
-        tinyrl_history_entry_t *entry = this->entries[i];
-        if(0 == strcmp(line,tinyrl_history_entry__get_line(entry)))
-        {
-            free_entries(this,i,i);
-            remove_entries(this,i,i);
-            result = BOOL_TRUE;
-            break;
-        }
+        unsigned position = this->first + i;
+        new_entries[position & (new_size - 1)] = SLOT(this,position);
     }
-    return result;
+    free(this->entries);
+    this->entries = new_entries;
+    this->size    = new_size;
+
+    return BOOL_TRUE;
 }
 /*------------------------------------- */
-/* 
-add an entry to the end of the current array 
-if there is no space returns -1 else 0
-*/
+/* add an entry to the end of the ring, making room if necessary */
 static void
 append_entry(tinyrl_history_t *this,
              const char       *line)
 {
-    if(this->length < this->size)
+    tinyrl_history_entry_t *new_entry;
+
+    if(this->used == this->size)
     {
-        this->length++;
+        if((this->used - this->length) > this->length)
+        {
+            /* mostly empty slots so squeeze them out */
+            compact_entries(this);
+        }
+        else if(BOOL_FALSE == grow_entries(this))
+        {
+            return;
+        }
+    }
+    new_entry = tinyrl_history_entry_new(line,this->current_index++);
+    if(NULL != new_entry)
+    {
+        unsigned position = this->first + this->used++;
 
-        insert_entry(this,line);
+        tinyrl_history_entry__set_position(new_entry,position);
+        SLOT(this,position) = new_entry;
+        this->length++;
+        (void)lub_hash_insert(&this->lines,new_entry);
     }
 }
 /*------------------------------------- */
-/*
- add a new history entry replacing the oldest one 
- */
 static void
-add_n_replace(tinyrl_history_t *this,
-              const char       *line)
+add_line(tinyrl_history_t *this,
+         const char       *line)
 {
-    if(BOOL_FALSE == remove_duplicate(this,line))
+    tinyrl_history_entry_t *entry = lub_hash_find(&this->lines,line);
+
+    if(NULL != entry)
     {
-        /* free the oldest entry */
-        free_entries(this,0,0);
-        /* shuffle the array */
-        remove_entries(this,0,0);
+        /* the line moves to the end of the history */
+        entry = remove_entry(this,tinyrl_history_entry__get_position(entry));
+        tinyrl_history_entry_delete(entry);
     }
-    /* add the new entry */
-    append_entry(this,line);
-}
-/*------------------------------------- */
-/* add a new history entry growing the array if necessary */
-static void
-add_n_grow(tinyrl_history_t *this,
-           const char       *line)
-{
-    if(this->size == this->length)
+    else if(this->stifle && (this->length >= this->stifle))
     {
-        /* increment the history memory by 10 entries each time we grow */
-        unsigned                 new_size = this->size + 10;
-        size_t                   nbytes;
-        tinyrl_history_entry_t **new_entries;
-        
-        nbytes      = sizeof(tinyrl_history_entry_t *)*new_size;
-        new_entries = realloc(this->entries,nbytes);
-        if(NULL != new_entries)
-        {
-            this->size    = new_size;
-            this->entries = new_entries;
-        }
+        /* make room by dropping the oldest entry */
+        entry = remove_entry(this,this->first);
+        tinyrl_history_entry_delete(entry);
     }
-    (void)remove_duplicate(this,line);
     append_entry(this,line);
 }
 /*------------------------------------- */
@@ -228,13 +236,11 @@ void
 tinyrl_history_add(tinyrl_history_t *this,
                    const char       *line)
 {
-    if(this->length && (this->length == this->stifle))
+    add_line(this,line);
+    if(NULL != this->file)
     {
-        add_n_replace(this,line);
-    }
-    else
-    {
-        add_n_grow(this,line);
+        /* share the line with the other sessions */
+        tinyrl_history_file_append(this->file,line);
     }
 }
 /*------------------------------------- */
@@ -246,9 +252,25 @@ tinyrl_history_remove(tinyrl_history_t *this,
     
     if(offset < this->length)
     {
-        result = this->entries[offset];
+        unsigned i = 0;
+
+        if(this->used != this->length)
+        {
+            /* count past the empty slots */
+            for(i = 0; i < this->used; i++)
+            {
+                if(SLOT(this,this->first + i) && (0 == offset--))
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            i = offset;
+        }
         /* do the biz */
-        remove_entries(this,offset,offset);
+        result = remove_entry(this,this->first + i);
     }
     return result;
 }
@@ -257,9 +279,11 @@ void
 tinyrl_history_clear(tinyrl_history_t *this)
 {
     /* free all the entries */
-    free_entries(this,0,this->length-1);
-    /* and shuffle the array */
-    remove_entries(this,0,this->length-1);
+    while(this->length)
+    {
+        tinyrl_history_entry_delete(remove_entry(this,this->first));
+    }
+    this->first = 0;
 }
 /*------------------------------------- */
 void
@@ -272,13 +296,9 @@ tinyrl_history_stifle(tinyrl_history_t *this,
      */
     if(stifle)
     {
-        if(stifle < this->length)
+        while(stifle < this->length)
         {
-            unsigned num_deletes = this->length - stifle;
-            /* free the entries */
-            free_entries(this,0,num_deletes-1);
-            /* shuffle the array shut */
-            remove_entries(this,0,num_deletes-1);
+            tinyrl_history_entry_delete(remove_entry(this,this->first));
         }
         this->stifle = stifle;
     }
@@ -306,21 +326,30 @@ tinyrl_history_entry_t *
 tinyrl_history_get(const tinyrl_history_t *this,
                    unsigned                position)
 {
-    unsigned i;
-    tinyrl_history_entry_t *entry = NULL;
-    for(i = 0;
-        i < this->length;
-        i++)
+    unsigned i = this->used;
+    tinyrl_history_entry_t *result = NULL;
+
+    /* the entries are in index order so search back from the newest */
+    while(i--)
     {
-        entry = this->entries[i];
-        if(position == tinyrl_history_entry__get_index(entry))
+        tinyrl_history_entry_t *entry = SLOT(this,this->first + i);
+        if(entry)
         {
-            /* found it */
-            break;
+            unsigned index = tinyrl_history_entry__get_index(entry);
+            if(position == index)
+            {
+                /* found it */
+                result = entry;
+                break;
+            }
+            if(position > index)
+            {
+                /* it isn't here */
+                break;
+            }
         }
-        entry = NULL;
     }
-    return entry;
+    return result;
 }
 /*------------------------------------- */
 tinyrl_history_expand_t
@@ -330,9 +359,10 @@ tinyrl_history_expand(const tinyrl_history_t *this,
 {
     tinyrl_history_expand_t result = tinyrl_history_NO_EXPANSION; /* no expansion */
     const char             *p,*start;
-    char                   *buffer = NULL;
+    lub_strbuf_t            buffer;
     unsigned                len;
     
+    lub_strbuf_init(&buffer,NULL,0);
     for(p = string,start=string,len=0;
         *p;
         p++,len++)
@@ -372,7 +402,7 @@ tinyrl_history_expand(const tinyrl_history_t *this,
             if(len > 0)
             {
                 /* we need to add in some previous plain text */
-                lub_string_catn(&buffer,start,len);
+                lub_strbuf_catn(&buffer,start,len);
             }
             
             /* skip the escaped chars */
@@ -387,7 +417,7 @@ tinyrl_history_expand(const tinyrl_history_t *this,
                 len   = 0;
                 /* add the expanded text to the buffer */
                 result = tinyrl_history_EXPANDED;
-                lub_string_cat(&buffer,tinyrl_history_entry__get_line(entry));
+                lub_strbuf_cat(&buffer,tinyrl_history_entry__get_line(entry));
             }
             else
             {
@@ -397,8 +427,9 @@ tinyrl_history_expand(const tinyrl_history_t *this,
         }
     }
     /* add any left over plain text */
-    lub_string_catn(&buffer,start,len);
-    *output = buffer;
+    lub_strbuf_catn(&buffer,start,len);
+    *output = lub_strbuf_detach(&buffer);
+    lub_strbuf_fini(&buffer);
     
     return result;
 }
@@ -412,9 +443,10 @@ tinyrl_history_getfirst(const tinyrl_history_t    *this,
     iter->history = this;
     iter->offset  = 0;
 
-    if(this->length)
+    if(this->used)
     {
-        result = this->entries[iter->offset];
+        /* the oldest slot in use is never empty */
+        result = SLOT(this,this->first);
     }    
     return result;
 }
@@ -422,14 +454,14 @@ tinyrl_history_getfirst(const tinyrl_history_t    *this,
 tinyrl_history_entry_t *
 tinyrl_history_getnext(tinyrl_history_iterator_t *iter)
 {
+    const tinyrl_history_t *this   = iter->history;
     tinyrl_history_entry_t *result = NULL;
 
-    if(iter->offset < iter->history->length - 1)
+    while((NULL == result) && (iter->offset + 1 < this->used))
     {
         iter->offset++;
-        result = iter->history->entries[iter->offset];
+        result = SLOT(this,this->first + iter->offset);
     }
-
     return result;
 }
 /*-------------------------------------*/
@@ -438,7 +470,7 @@ tinyrl_history_getlast (const tinyrl_history_t    *this,
                         tinyrl_history_iterator_t *iter)
 {
     iter->history = this;
-    iter->offset  = this->length;
+    iter->offset  = this->used;
     
     return tinyrl_history_getprevious(iter);
 }
@@ -446,14 +478,113 @@ tinyrl_history_getlast (const tinyrl_history_t    *this,
 tinyrl_history_entry_t *
 tinyrl_history_getprevious(tinyrl_history_iterator_t *iter)
 {
+    const tinyrl_history_t *this   = iter->history;
     tinyrl_history_entry_t *result = NULL;
 
-    if(iter->offset)
+    while((NULL == result) && iter->offset)
     {
         iter->offset--;
-        result = iter->history->entries[iter->offset];
+        result = SLOT(this,this->first + iter->offset);
     }
-
     return result;    
 }
 /*-------------------------------------*/
+/*
+HISTORY FILE
+*/
+/*-------------------------------------*/
+bool_t
+tinyrl_history_attach(tinyrl_history_t *this,
+                      const char       *filename,
+                      size_t            limit)
+{
+    tinyrl_history_file_t *file = tinyrl_history_file_new(filename,limit);
+    unsigned               count,wanted;
+    size_t                 offset,len;
+
+    if(NULL == file)
+    {
+        return BOOL_FALSE;
+    }
+    if(NULL != this->file)
+    {
+        tinyrl_history_file_delete(this->file);
+    }
+    /* find the start of the newest lines without reading the rest */
+    wanted = this->stifle ? this->stifle : TINYRL_HISTORY_FILE_LOAD;
+    offset = tinyrl_history_file__get_size(file);
+    for(count = 0;
+        (count < wanted) && tinyrl_history_file_getprevious(file,&offset,&len);
+        count++)
+    {
+    }
+    /* now add them, oldest first */
+    while(count--)
+    {
+        const char *line = tinyrl_history_file_getnext(file,&offset,&len);
+        char       *tmp  = lub_string_dupn(line,(unsigned)len);
+
+        add_line(this,tmp);
+        lub_string_free(tmp);
+    }
+    this->file = file;
+
+    return BOOL_TRUE;
+}
+/*-------------------------------------*/
+char *
+tinyrl_history_search_first(tinyrl_history_t        *this,
+                            const char              *text,
+                            tinyrl_history_search_t *search)
+{
+    search->history = this;
+    search->text    = text;
+    search->offset  = 0;
+    if(NULL != this->file)
+    {
+        /* pick up what the other sessions have added */
+        tinyrl_history_file_remap(this->file);
+        search->offset = tinyrl_history_file__get_size(this->file);
+    }
+    return tinyrl_history_search_next(search);
+}
+/*-------------------------------------*/
+char *
+tinyrl_history_search_next(tinyrl_history_search_t *search)
+{
+    const tinyrl_history_file_t *file     = search->history->file;
+    size_t                       text_len = strlen(search->text);
+    const char                  *line;
+    size_t                       len;
+
+    if(NULL == file)
+    {
+        return NULL;
+    }
+    while(NULL != (line = tinyrl_history_file_getprevious(file,&search->offset,&len)))
+    {
+        const char *p   = line;
+        const char *end = line + len;
+
+        /* look for the text within this record */
+        while((size_t)(end - p) >= text_len)
+        {
+            if(0 == text_len)
+            {
+                return lub_string_dupn(line,(unsigned)len);
+            }
+            p = memchr(p,search->text[0],(size_t)(end - p) - text_len + 1);
+            if(NULL == p)
+            {
+                break;
+            }
+            if(0 == memcmp(p,search->text,text_len))
+            {
+                return lub_string_dupn(line,(unsigned)len);
+            }
+            p++;
+        }
+    }
+    return NULL;
+}
+/*-------------------------------------*/
@@ -7,6 +7,7 @@ struct _tinyrl_history_entry
 {
     char       *line;
     unsigned    index;
+    unsigned    position; /* where the history holds this entry */
 };
 /*------------------------------------- */
 static void
@@ -16,6 +17,7 @@ entry_init(tinyrl_history_entry_t *this,
 {
     this->line = lub_string_dup(line);
     this->index = index;
+    this->position = 0;
 }
 /*------------------------------------- */
 static void
@@ -56,3 +58,16 @@ tinyrl_history_entry__get_index(const tinyrl_history_entry_t *this)
     return this->index;
 }
 /*------------------------------------- */
+unsigned
+tinyrl_history_entry__get_position(const tinyrl_history_entry_t *this)
+{
+    return this->position;
+}
+/*------------------------------------- */
+void
+tinyrl_history_entry__set_position(tinyrl_history_entry_t *this,
+                                   unsigned                position)
+{
+    this->position = position;
+}
+/*------------------------------------- */
@@ -0,0 +1,414 @@
+/* tinyrl_history_file.c */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "private.h"
+#include "lub/string.h"
+
+/*
+ * The file holds one record per line, each ending with a newline. Every
+ * record is appended with a single write to a descriptor opened with
+ * O_APPEND so the records from concurrent sessions never interleave.
+ *
+ * Appending takes a shared lock on the file and compacting it takes an
+ * exclusive one. A compacted file is written alongside and renamed over
+ * the original, so appenders check whether the file they have open is
+ * still the one which is named, and reopen it if not.
+ */
+struct _tinyrl_history_file
+{
+    char       *filename;
+    int         fd;
+    const char *map;      /* the file as it was when last mapped */
+    size_t      map_size;
+    size_t      limit;    /* the size at which to compact the file */
+};
+
+/* the arguments for a background compaction */
+typedef struct
+{
+    char  *filename;
+    size_t limit;
+} history_compact_t;
+
+/*
+ * Record locks belong to the process rather than a descriptor, so the
+ * sessions within a process also have to keep out of each other's way.
+ */
+static pthread_mutex_t history_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool_t          history_file_compacting = BOOL_FALSE;
+
+/*------------------------------------- */
+static bool_t
+file_lock(int   fd,
+          short type,
+          int   cmd)
+{
+    struct flock lock;
+    int          status;
+
+    lock.l_type   = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start  = 0;
+    lock.l_len    = 0;
+    do
+    {
+        status = fcntl(fd,cmd,&lock);
+    } while((-1 == status) && (EINTR == errno));
+
+    return (-1 == status) ? BOOL_FALSE : BOOL_TRUE;
+}
+/*------------------------------------- */
+/*
+ * Has the file been replaced since this descriptor was opened?
+ */
+static bool_t
+file_is_stale(int         fd,
+              const char *filename)
+{
+    struct stat opened,named;
+
+    if((0 != fstat(fd,&opened)) || (0 != stat(filename,&named)))
+    {
+        return BOOL_TRUE;
+    }
+    return ((opened.st_ino != named.st_ino) || (opened.st_dev != named.st_dev)) ?
+        BOOL_TRUE : BOOL_FALSE;
+}
+/*------------------------------------- */
+static bool_t
+file_write(int         fd,
+           const char *data,
+           size_t      size)
+{
+    while(size)
+    {
+        ssize_t written = write(fd,data,size);
+        if(-1 == written)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+            return BOOL_FALSE;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return BOOL_TRUE;
+}
+/*------------------------------------- */
+/*
+ * Cut the file down to the newest half of its limit.
+ */
+static void
+file_compact(const char *filename,
+             size_t      limit)
+{
+    int fd;
+
+    pthread_mutex_lock(&history_file_mutex);
+    fd = open(filename,O_RDWR);
+    if(-1 != fd)
+    {
+        struct stat st;
+
+        /* give up if another session is busy with the file */
+        if((BOOL_TRUE == file_lock(fd,F_WRLCK,F_SETLK))
+           && (BOOL_FALSE == file_is_stale(fd,filename))
+           && (0 == fstat(fd,&st))
+           && ((size_t)st.st_size > limit))
+        {
+            size_t size = (size_t)st.st_size;
+            char  *map  = mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+
+            if(MAP_FAILED != map)
+            {
+                size_t start   = size - (limit / 2);
+                char  *tmpname = lub_string_dup(filename);
+                int    tmp;
+
+                /* start at the beginning of a record */
+                while((start < size) && ('\n' != map[start-1]))
+                {
+                    start++;
+                }
+                lub_string_cat(&tmpname,".compact");
+                tmp = open(tmpname,O_WRONLY | O_CREAT | O_TRUNC,0600);
+                if(-1 != tmp)
+                {
+                    bool_t ok = file_write(tmp,&map[start],size - start);
+
+                    if((0 != close(tmp))
+                       || (BOOL_FALSE == ok)
+                       || (0 != rename(tmpname,filename)))
+                    {
+                        (void)unlink(tmpname);
+                    }
+                }
+                lub_string_free(tmpname);
+                (void)munmap(map,size);
+            }
+        }
+        /* this also releases the lock */
+        (void)close(fd);
+    }
+    history_file_compacting = BOOL_FALSE;
+    pthread_mutex_unlock(&history_file_mutex);
+}
+/*------------------------------------- */
+static void *
+file_compact_thread(void *arg)
+{
+    history_compact_t *compact = arg;
+
+    file_compact(compact->filename,compact->limit);
+    lub_string_free(compact->filename);
+    free(compact);
+
+    return NULL;
+}
+/*------------------------------------- */
+/*
+ * Compact the file without holding up the session.
+ */
+static void
+file_start_compaction(const tinyrl_history_file_t *this)
+{
+    history_compact_t *compact = malloc(sizeof(history_compact_t));
+
+    if(NULL != compact)
+    {
+        pthread_attr_t attr;
+        pthread_t      thread;
+        int            status;
+
+        compact->filename = lub_string_dup(this->filename);
+        compact->limit    = this->limit;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+        status = pthread_create(&thread,&attr,file_compact_thread,compact);
+        pthread_attr_destroy(&attr);
+        if(0 != status)
+        {
+            /* do it now instead */
+            (void)file_compact_thread(compact);
+        }
+    }
+}
+/*------------------------------------- */
+static void
+file_reopen(tinyrl_history_file_t *this)
+{
+    if(-1 != this->fd)
+    {
+        (void)close(this->fd);
+    }
+    this->fd = open(this->filename,O_RDWR | O_APPEND | O_CREAT,0600);
+}
+/*------------------------------------- */
+static void
+file_unmap(tinyrl_history_file_t *this)
+{
+    if(NULL != this->map)
+    {
+        (void)munmap((void *)this->map,this->map_size);
+    }
+    this->map      = NULL;
+    this->map_size = 0;
+}
+/*------------------------------------- */
+tinyrl_history_file_t *
+tinyrl_history_file_new(const char *filename,
+                        size_t      limit)
+{
+    tinyrl_history_file_t *this = malloc(sizeof(tinyrl_history_file_t));
+    if(NULL != this)
+    {
+        this->filename = lub_string_dup(filename);
+        this->fd       = -1;
+        this->map      = NULL;
+        this->map_size = 0;
+        this->limit    = limit;
+        file_reopen(this);
+        if(-1 == this->fd)
+        {
+            tinyrl_history_file_delete(this);
+            return NULL;
+        }
+        tinyrl_history_file_remap(this);
+    }
+    return this;
+}
+/*------------------------------------- */
+void
+tinyrl_history_file_delete(tinyrl_history_file_t *this)
+{
+    file_unmap(this);
+    if(-1 != this->fd)
+    {
+        (void)close(this->fd);
+    }
+    lub_string_free(this->filename);
+    free(this);
+}
+/*------------------------------------- */
+void
+tinyrl_history_file_remap(tinyrl_history_file_t *this)
+{
+    struct stat st;
+    bool_t      reopened = BOOL_FALSE;
+
+    if(BOOL_TRUE == file_is_stale(this->fd,this->filename))
+    {
+        /* the file has been compacted since we last looked */
+        file_reopen(this);
+        reopened = BOOL_TRUE;
+    }
+    if((-1 != this->fd) && (0 == fstat(this->fd,&st)))
+    {
+        size_t size = (size_t)st.st_size;
+        if((BOOL_TRUE == reopened) || (size != this->map_size))
+        {
+            file_unmap(this);
+            if(size)
+            {
+                void *map = mmap(NULL,size,PROT_READ,MAP_SHARED,this->fd,0);
+                if(MAP_FAILED != map)
+                {
+                    this->map      = map;
+                    this->map_size = size;
+                }
+            }
+        }
+    }
+}
+/*------------------------------------- */
+void
+tinyrl_history_file_append(tinyrl_history_file_t *this,
+                           const char            *line)
+{
+    size_t len     = strlen(line);
+    bool_t compact = BOOL_FALSE;
+    char  *record;
+
+    if(strchr(line,'\n'))
+    {
+        /* this can't be held as a single record */
+        return;
+    }
+    record = malloc(len + 1);
+    if(NULL == record)
+    {
+        return;
+    }
+    memcpy(record,line,len);
+    record[len] = '\n';
+
+    pthread_mutex_lock(&history_file_mutex);
+    if(-1 != this->fd)
+    {
+        (void)file_lock(this->fd,F_RDLCK,F_SETLKW);
+        if(BOOL_TRUE == file_is_stale(this->fd,this->filename))
+        {
+            /* another session has compacted the file */
+            file_reopen(this);
+            if(-1 != this->fd)
+            {
+                (void)file_lock(this->fd,F_RDLCK,F_SETLKW);
+            }
+        }
+    }
+    if(-1 != this->fd)
+    {
+        struct stat st;
+        ssize_t     written;
+
+        /* the whole record goes in one write so it can't be split */
+        do
+        {
+            written = write(this->fd,record,len + 1);
+        } while((-1 == written) && (EINTR == errno));
+
+        if(this->limit
+           && (0 == fstat(this->fd,&st))
+           && ((size_t)st.st_size > this->limit)
+           && (BOOL_FALSE == history_file_compacting))
+        {
+            history_file_compacting = BOOL_TRUE;
+            compact                 = BOOL_TRUE;
+        }
+        (void)file_lock(this->fd,F_UNLCK,F_SETLK);
+    }
+    pthread_mutex_unlock(&history_file_mutex);
+    free(record);
+
+    if(BOOL_TRUE == compact)
+    {
+        file_start_compaction(this);
+    }
+}
+/*------------------------------------- */
+const char *
+tinyrl_history_file_getprevious(const tinyrl_history_file_t *this,
+                                size_t                      *offset,
+                                size_t                      *len)
+{
+    size_t end = (*offset < this->map_size) ? *offset : this->map_size;
+    size_t start;
+
+    /* skip the newline which ends the record (and any blank ones) */
+    while(end && ('\n' == this->map[end-1]))
+    {
+        end--;
+    }
+    /* find the start of the record */
+    for(start = end; start && ('\n' != this->map[start-1]); start--)
+    {
+    }
+    *offset = start;
+    *len    = end - start;
+
+    return end ? &this->map[start] : NULL;
+}
+/*------------------------------------- */
+const char *
+tinyrl_history_file_getnext(const tinyrl_history_file_t *this,
+                            size_t                      *offset,
+                            size_t                      *len)
+{
+    size_t      start = *offset;
+    const char *end;
+
+    /* skip any blank records */
+    while((start < this->map_size) && ('\n' == this->map[start]))
+    {
+        start++;
+    }
+    if(start >= this->map_size)
+    {
+        *offset = this->map_size;
+        return NULL;
+    }
+    end = memchr(&this->map[start],'\n',this->map_size - start);
+    *len    = end ? (size_t)(end - &this->map[start]) : (this->map_size - start);
+    *offset = start + *len;
+
+    return &this->map[start];
+}
+/*------------------------------------- */
+size_t
+tinyrl_history_file__get_size(const tinyrl_history_file_t *this)
+{
+    return this->map_size;
+}
+/*------------------------------------- */
@@ -1,4 +1,6 @@
 /* private.h */
+#include <stddef.h>
+
 #include "tinyrl/history.h"
 /**************************************
  * protected interface to tinyrl_history_entry class
@@ -9,3 +11,47 @@ extern tinyrl_history_entry_t *
 
 extern void
     tinyrl_history_entry_delete(tinyrl_history_entry_t *instance);
+
+extern unsigned
+    tinyrl_history_entry__get_position(const tinyrl_history_entry_t *instance);
+
+extern void
+    tinyrl_history_entry__set_position(tinyrl_history_entry_t *instance,
+                                       unsigned                position);
+
+/**************************************
+ * protected interface to tinyrl_history_file class
+ ************************************** */
+typedef struct _tinyrl_history_file tinyrl_history_file_t;
+
+extern tinyrl_history_file_t *
+    tinyrl_history_file_new(const char *filename,
+                            size_t      limit);
+
+extern void
+    tinyrl_history_file_delete(tinyrl_history_file_t *instance);
+
+extern void
+    tinyrl_history_file_append(tinyrl_history_file_t *instance,
+                               const char            *line);
+
+/* map any records which have been added since the file was last mapped */
+extern void
+    tinyrl_history_file_remap(tinyrl_history_file_t *instance);
+
+/* 
+ * step through the records in the mapped file; the records aren't 
+ * terminated so their length is returned as well
+ */
+extern const char *
+    tinyrl_history_file_getprevious(const tinyrl_history_file_t *instance,
+                                    size_t                      *offset,
+                                    size_t                      *len);
+
+extern const char *
+    tinyrl_history_file_getnext(const tinyrl_history_file_t *instance,
+                                size_t                      *offset,
+                                size_t                      *len);
+
+extern size_t
+    tinyrl_history_file__get_size(const tinyrl_history_file_t *instance);
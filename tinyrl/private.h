@@ -3,6 +3,25 @@
 #include "tinyrl/tinyrl.h"
 #include "tinyrl/vt100.h"
 
+/* the size of the blocks in which a script is read */
+#define TINYRL_SCRIPT_BLOCK_SIZE 65536
+
+/*
+ * The text which has been read from a non-interactive input stream but 
+ * not yet returned as lines.
+ */
+typedef struct _tinyrl_script tinyrl_script_t;
+struct _tinyrl_script
+{
+    FILE            *stream;
+    char            *block;
+    size_t           size;  /* the allocated size of the block */
+    size_t           head;  /* the start of the next line */
+    size_t           count; /* the number of bytes from head */
+    bool_t           eof;
+    tinyrl_script_t *next;  /* a stream which has been switched away from */
+};
+
 /* define the class member data and virtual methods */
 struct _tinyrl
 {
@@ -34,6 +53,9 @@ struct _tinyrl
     bool_t                    echo_enabled;
     struct termios            default_termios;
     bool_t                    isatty;
+    bool_t                    pasting; /* within bracketed pasted text */
+    tinyrl_script_t          *script;
+    bool_t                    script_echo;
     char                     *last_buffer; /* hold record of the previous 
                                               buffer for redisplay purposes */
     unsigned                  last_point; /* hold record of the previous 
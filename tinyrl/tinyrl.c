@@ -14,6 +14,7 @@
 
 /* POSIX HEADERS */
 #include <unistd.h>
+#include <errno.h>
 
 #include "lub/string.h"
 
@@ -40,14 +41,23 @@ tty_set_raw_mode(tinyrl_t *this)
         /* Do the mode switch */
         status = tcsetattr(fd,TCSAFLUSH,&new_termios); 
         assert(-1 != status);
+        /* have pasted text marked so it isn't taken as key presses */
+        tinyrl_vt100_bracketed_paste(this->term,BOOL_TRUE);
+        tinyrl_vt100_oflush(this->term);
     }
 }
 /*----------------------------------------------------------------------- */
 static void
 tty_restore_mode(const tinyrl_t *this)
 {
-    int fd = fileno(tinyrl_vt100__get_istream(this->term));
+    int            fd = fileno(tinyrl_vt100__get_istream(this->term));
+    struct termios termios;
 
+    if(-1 != tcgetattr(fd,&termios))
+    {
+        tinyrl_vt100_bracketed_paste(this->term,BOOL_FALSE);
+        tinyrl_vt100_oflush(this->term);
+    }
     /* Do the mode switch */
     (void)tcsetattr(fd,TCSAFLUSH,&this->default_termios);  
 }
@@ -78,9 +88,27 @@ tinyrl_key_default(tinyrl_t *this,
     bool_t result = BOOL_FALSE;
     if(key > 31)
     {
-        char tmp[2];
-        tmp[0] = (key & 0xFF),
-        tmp[1] = '\0';
+        char     tmp[5];
+        unsigned len = 1;
+        int      c;
+
+        tmp[0] = (key & 0xFF);
+        if((key >= 0xC0) && (key <= 0xF7))
+        {
+            /* 
+             * this starts a multibyte UTF-8 character; keep its 
+             * continuation bytes with it so the character is inserted 
+             * whole
+             */
+            while((len < sizeof(tmp) - 1)
+                  && (EOF != (c = tinyrl_vt100_peekchar(this->term,
+                                                        TINYRL_VT100_KEY_TIMEOUT)))
+                  && (c >= 0x80) && (c <= 0xBF))
+            {
+                tmp[len++] = (char)tinyrl_vt100_getchar(this->term);
+            }
+        }
+        tmp[len] = '\0';
         /* inject this text into the buffer */
         result = tinyrl_insert_text(this,tmp);
     }
@@ -340,6 +368,26 @@ tinyrl_key_escape(tinyrl_t *this,
         case tinyrl_vt100_CURSOR_RIGHT:
             result = tinyrl_key_right(this,key);
             break;
+        case tinyrl_vt100_HOME:
+            result = tinyrl_key_start_of_line(this,key);
+            break;
+        case tinyrl_vt100_END:
+            result = tinyrl_key_end_of_line(this,key);
+            break;
+        case tinyrl_vt100_DELETE:
+            result = tinyrl_key_delete(this,key);
+            break;
+        case tinyrl_vt100_PASTE_BEGIN:
+            this->pasting = BOOL_TRUE;
+            result        = BOOL_TRUE;
+            break;
+        case tinyrl_vt100_PASTE_END:
+            this->pasting = BOOL_FALSE;
+            result        = BOOL_TRUE;
+            break;
+        case tinyrl_vt100_INSERT:
+        case tinyrl_vt100_PAGE_UP:
+        case tinyrl_vt100_PAGE_DOWN:
         case tinyrl_vt100_UNKNOWN:
             break;
     }
@@ -378,8 +426,204 @@ tinyrl_key_tab(tinyrl_t *this,
 }
 /*-------------------------------------------------------- */
 static void
+tinyrl_script_delete(tinyrl_t *this)
+{
+    tinyrl_script_t *script = this->script;
+
+    this->script = script->next;
+    free(script->block);
+    free(script);
+}
+/*-------------------------------------------------------- */
+/*
+ * Find the unread text for the specified stream, starting afresh if
+ * there is none.
+ */
+static tinyrl_script_t *
+tinyrl_script_find(tinyrl_t *this,
+                   FILE     *stream)
+{
+    tinyrl_script_t *script;
+
+    for(script = this->script; script; script = script->next)
+    {
+        if(script->stream == stream)
+        {
+            break;
+        }
+    }
+    if(NULL != script)
+    {
+        /* 
+         * we've returned to this stream so any others read since
+         * it was switched away from have finished
+         */
+        while(this->script != script)
+        {
+            tinyrl_script_delete(this);
+        }
+        return script;
+    }
+    /* there is no need to remember streams with nothing left to read */
+    while(this->script && (0 == this->script->count))
+    {
+        tinyrl_script_delete(this);
+    }
+    script = malloc(sizeof(tinyrl_script_t));
+    if(NULL != script)
+    {
+        script->block = malloc(TINYRL_SCRIPT_BLOCK_SIZE);
+        if(NULL == script->block)
+        {
+            free(script);
+            return NULL;
+        }
+        script->stream = stream;
+        script->size   = TINYRL_SCRIPT_BLOCK_SIZE;
+        script->head   = 0;
+        script->count  = 0;
+        script->eof    = BOOL_FALSE;
+        script->next   = this->script;
+        this->script   = script;
+    }
+    return script;
+}
+/*-------------------------------------------------------- */
+/*
+ * Read whatever is available from the stream into the block, keeping
+ * any partial line which is already there.
+ */
+static void
+tinyrl_script_fill(tinyrl_script_t *script)
+{
+    int     fd    = fileno(script->stream);
+    size_t  space;
+    ssize_t len;
+
+    if(script->head)
+    {
+        /* move the partial line to the start of the block */
+        memmove(script->block,&script->block[script->head],script->count);
+        script->head = 0;
+    }
+    if(script->count + 1 == script->size)
+    {
+        /* this line doesn't fit so make room for it */
+        char *block = realloc(script->block,script->size * 2);
+        if(NULL == block)
+        {
+            /* make do with what we have */
+            script->eof = BOOL_TRUE;
+            return;
+        }
+        script->block  = block;
+        script->size  *= 2;
+    }
+    /* always leave room to terminate the last line */
+    space = script->size - script->count - 1;
+    if(-1 == fd)
+    {
+        len = (ssize_t)fread(&script->block[script->count],1,space,script->stream);
+    }
+    else
+    {
+        do
+        {
+            len = read(fd,&script->block[script->count],space);
+        } while((-1 == len) && (EINTR == errno));
+    }
+    if(len > 0)
+    {
+        script->count += (size_t)len;
+    }
+    else
+    {
+        /* an error is treated as the end of the script */
+        script->eof = BOOL_TRUE;
+    }
+}
+/*-------------------------------------------------------- */
+/*
+ * Get the next line of a script. The line is split out in place so 
+ * remains valid until the next line is read.
+ */
+static char *
+tinyrl_script_getline(tinyrl_t *this)
+{
+    tinyrl_script_t *script = tinyrl_script_find(this,
+                                                 tinyrl_vt100__get_istream(this->term));
+    char            *line   = NULL;
+    bool_t           last   = BOOL_FALSE;
+
+    while((NULL != script) && (NULL == line))
+    {
+        char  *start = &script->block[script->head];
+        char  *end   = memchr(start,'\n',script->count);
+        size_t len;
+
+        if(NULL != end)
+        {
+            len = (size_t)(end - start) + 1;
+        }
+        else if(BOOL_FALSE == script->eof)
+        {
+            tinyrl_script_fill(script);
+            continue;
+        }
+        else if(0 == script->count)
+        {
+            /* nothing more to read */
+            break;
+        }
+        else
+        {
+            /* the last line has no newline */
+            len  = script->count;
+            end  = &start[len];
+            last = BOOL_TRUE;
+        }
+        *end = '\0';
+        line = start;
+        script->head  += len;
+        script->count -= len;
+    }
+    if(NULL != line)
+    {
+        char *p;
+        /* strip any spurious '\r' */
+        p = strchr(line,'\r');
+        if(NULL != p)
+        {
+            *p = '\0';
+        }
+        /* skip any whitespace at the beginning of the line */
+        while(*line && isspace((unsigned char)*line))
+        {
+            line++;
+        }
+        if((0 != this->max_line_length) && (strlen(line) >= this->max_line_length))
+        {
+            /* keep to the same limit as an edited line */
+            line[this->max_line_length - 1] = '\0';
+        }
+        if((BOOL_TRUE == last) && ('\0' == *line))
+        {
+            /* blank space at the end of the script is ignored */
+            line = NULL;
+        }
+    }
+    return line;
+}
+/*-------------------------------------------------------- */
+static void
 tinyrl_fini(tinyrl_t *this)
 {
+    /* discard any unread script text */
+    while(this->script)
+    {
+        tinyrl_script_delete(this);
+    }
+
     /* delete the history session */
     tinyrl_history_delete(this->history);
 
@@ -440,6 +684,9 @@ tinyrl_init(tinyrl_t                 *this,
     this->echo_char                     = '\0';
     this->echo_enabled                  = BOOL_TRUE;
     this->isatty                        = isatty(fileno(instream)) ? BOOL_TRUE : BOOL_FALSE;
+    this->pasting                       = BOOL_FALSE;
+    this->script                        = NULL;
+    this->script_echo                   = BOOL_TRUE;
     this->last_buffer                   = NULL;
     this->last_point                    = 0;
     
@@ -497,17 +744,22 @@ tinyrl_internal_print(const tinyrl_t *this,
     if(BOOL_TRUE == this->echo_enabled)
     {
         /* simply echo the line */
-        tinyrl_vt100_printf(this->term,"%s",text);
+        tinyrl_vt100_write(this->term,text,strlen(text));
     }
     else
     {
         /* replace the line with echo char if defined */
         if(this->echo_char)
         {
-            unsigned i = strlen(text);
-            while(i--)
+            char   mask[32];
+            size_t i = strlen(text);
+
+            memset(mask,this->echo_char,sizeof(mask));
+            while(i)
             {
-                tinyrl_vt100_printf(this->term,"%c",this->echo_char);
+                size_t len = (i < sizeof(mask)) ? i : sizeof(mask);
+                tinyrl_vt100_write(this->term,mask,len);
+                i -= len;
             }
         }
     }
@@ -518,9 +770,17 @@ tinyrl_redisplay(tinyrl_t *this)
 {   
     int          delta;
     unsigned line_len, last_line_len,count;
+
+    if((BOOL_FALSE == this->isatty) && (BOOL_FALSE == this->script_echo))
+    {
+        /* the script is being read quietly */
+        return;
+    }
     line_len      = strlen(this->line);    
     last_line_len = (this->last_buffer ? strlen(this->last_buffer) : 0);
     
+    /* collect the output so that it reaches the terminal in one go */
+    tinyrl_vt100_frame_begin(this->term);
     do
     {
         if(this->last_buffer)
@@ -594,7 +854,7 @@ tinyrl_redisplay(tinyrl_t *this)
         else
         {
             /* simply display the prompt and the line */
-            tinyrl_vt100_printf(this->term,"%s",this->prompt);
+            tinyrl_vt100_write(this->term,this->prompt,this->prompt_size);
             tinyrl_internal_print(this,this->line);
             if(this->point < line_len)
             {
@@ -627,7 +887,7 @@ tinyrl_redisplay(tinyrl_t *this)
     } /*lint -e717 */ while(0) /*lint +e717 */;
     
     /* update the display */
-    (void)tinyrl_vt100_oflush(this->term);
+    tinyrl_vt100_frame_end(this->term);
     
     /* set up the last line buffer */
     lub_string_free(this->last_buffer);
@@ -657,15 +917,13 @@ tinyrl_readline(tinyrl_t   *this,
                 const char *prompt,
                 void       *context)
 {
-    FILE *istream = tinyrl_vt100__get_istream(this->term);
-
     /* initialise for reading a line */
     this->done             = BOOL_FALSE;
     this->point            = 0;
     this->end              = 0;
-    this->buffer           = lub_string_dup("");
-    this->buffer_size      = strlen(this->buffer);
-    this->line             = this->buffer;
+    this->buffer           = NULL;
+    this->buffer_size      = 0;
+    this->line             = NULL;
     this->prompt           = prompt;
     this->prompt_size      = strlen(prompt);
     this->context          = context;
@@ -673,6 +931,10 @@ tinyrl_readline(tinyrl_t   *this,
 
     if(BOOL_TRUE == this->isatty)
     {        
+        this->buffer      = lub_string_dup("");
+        this->buffer_size = strlen(this->buffer);
+        this->line        = this->buffer;
+
         /* set the terminal into raw input mode */
         tty_set_raw_mode(this);
 
@@ -690,8 +952,16 @@ tinyrl_readline(tinyrl_t   *this,
             /* has the input stream terminated? */
             if(EOF != key)
             {
+                tinyrl_key_func_t *handler = this->handlers[key];
+
+                if((BOOL_TRUE == this->pasting) 
+                   && (key > 31) && (KEY_DEL != key))
+                {
+                    /* pasted text is inserted as it stands */
+                    handler = tinyrl_key_default;
+                }
                 /* call the handler for this key */
-                if(BOOL_FALSE == this->handlers[key](this,key))
+                if(BOOL_FALSE == handler(this,key))
                 {
                     /* an issue has occured */
                     tinyrl_ding(this);
@@ -722,57 +992,38 @@ tinyrl_readline(tinyrl_t   *this,
     else
     {
         /* This is a non-interactive set of commands */
-        char  *s = 0, buffer[80];
-        size_t len = sizeof(buffer);
-        
+        char *line;
+
         /* manually reset the line state without redisplaying */
         lub_string_free(this->last_buffer);
         this->last_buffer = NULL;
 
-        while((sizeof(buffer) == len) && 
-                (s = fgets(buffer,sizeof(buffer),istream)))
+        line = tinyrl_script_getline(this);
+        if(NULL != line)
         {
-            char *p;
-            /* strip any spurious '\r' or '\n' */
-            p = strchr(buffer,'\r');
-            if(NULL == p)
-            {
-                p = strchr(buffer,'\n');
-            }
-            if (NULL != p)
-            {
-                *p = '\0';
-            }
-            /* skip any whitespace at the beginning of the line */
-            if(0 == this->point)
-            {
-                while(*s && isspace(*s))
-                {
-                    s++;
-                }
-            }
-            if(*s)
+            /* 
+             * the line is used where it lies; it is only copied into
+             * the buffer if it gets edited
+             */
+            this->line  = line;
+            this->point = this->end = strlen(line);
+            if(*line && (BOOL_TRUE == this->script_echo))
             {
-                /* append this string to the input buffer */
-                (void) tinyrl_insert_text(this,s);
-                /* echo the command to the output stream */
-                tinyrl_redisplay(this);
-            }
-            len = strlen(buffer) + 1; /* account for the '\0' */
-        }
+                /* 
+                 * echo the command to the output stream, making sure it 
+                 * comes before anything the command itself outputs
+                 */
+                tinyrl_vt100_write(this->term,this->prompt,this->prompt_size);
+                tinyrl_internal_print(this,this->line);
+                tinyrl_vt100_oflush(this->term);
 
-        /*
-         * check against fgets returning null as either error or end of file.
-         * This is a measure to stop potential task spin on encountering an
-         * error from fgets.
-         */
-        if( s == NULL || (this->line[0] == '\0' && feof(istream)) )
-        {
-            /* time to finish the session */
-            this->line = NULL;
-        }
-        else
-        {
+                /*
+                 * so that any change the handler makes to the line
+                 * is displayed as just that change
+                 */
+                this->last_buffer = lub_string_dup(this->line);
+                this->last_point  = this->point;
+            }
             /* call the handler for the newline key */
             if(BOOL_FALSE == this->handlers[KEY_LF](this,KEY_LF))
             {
@@ -950,8 +1201,13 @@ tinyrl_display_matches(const tinyrl_t        *this,
             for(c=0; c<cols && len; c++)
             {
                 const char *match = *matches++;
+                size_t      pad   = max + 1 - strlen(match);
                 len--;
-                tinyrl_vt100_printf(this->term,"%-*s ",max,match);
+                tinyrl_vt100_write(this->term,match,strlen(match));
+                while(pad--)
+                {
+                    tinyrl_vt100_write(this->term," ",1);
+                }
             }
             tinyrl_crlf(this);
         }
@@ -1128,7 +1384,10 @@ tinyrl_delete_matches(char **this)
 void
 tinyrl_crlf(const tinyrl_t *this)
 {
-    tinyrl_vt100_printf(this->term,"\n");
+    if((BOOL_TRUE == this->isatty) || (BOOL_TRUE == this->script_echo))
+    {
+        tinyrl_vt100_write(this->term,"\n",1);
+    }
 }
 /*-------------------------------------------------------- */
 /*
@@ -1160,6 +1419,9 @@ tinyrl_replace_line(tinyrl_t   *this,
     /* ignored for now */
     clear_undo = clear_undo;
     
+    /* make sure the buffer holds the line */
+    changed_line(this);
+
     /* ensure there is sufficient space */
     if (BOOL_TRUE == tinyrl_extend_line_buffer(this,new_len))
     {
@@ -1359,6 +1621,34 @@ tinyrl__set_istream(tinyrl_t *this,
     this->isatty = isatty(fileno(istream)) ? BOOL_TRUE : BOOL_FALSE;
 }
 /*-------------------------------------------------------- */
+void
+tinyrl_forget_istream(tinyrl_t *this,
+                      FILE     *istream)
+{
+    tinyrl_script_t *script;
+
+    for(script = this->script; script; script = script->next)
+    {
+        if(script->stream == istream)
+        {
+            /* any streams read since this one have finished too */
+            while(this->script != script)
+            {
+                tinyrl_script_delete(this);
+            }
+            tinyrl_script_delete(this);
+            break;
+        }
+    }
+}
+/*-------------------------------------------------------- */
+void
+tinyrl__set_script_echo(tinyrl_t *this,
+                        bool_t    echo)
+{
+    this->script_echo = echo;
+}
+/*-------------------------------------------------------- */
 bool_t
 tinyrl__get_isatty(const tinyrl_t *this)
 {
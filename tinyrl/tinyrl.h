@@ -125,9 +125,28 @@ extern void
     tinyrl__set_istream(tinyrl_t *instance,
                         FILE     *istream);
 
+/**
+ * This operation discards any input which has been read ahead from a 
+ * non-interactive stream. It must be called before the stream is 
+ * closed, otherwise another stream opened later at the same address 
+ * would be taken for it.
+ */
+extern void
+    tinyrl_forget_istream(tinyrl_t *instance,
+                          FILE     *istream);
+
 extern bool_t
     tinyrl__get_isatty(const tinyrl_t *instance);
 
+/**
+ * This operation controls whether the lines read from a non-interactive
+ * input stream are echoed, along with the prompt, to the output stream.
+ * (The default is to echo them.)
+ */
+extern void
+    tinyrl__set_script_echo(tinyrl_t *instance,
+                            bool_t    echo);
+
 extern FILE *
     tinyrl__get_istream(const tinyrl_t *instance);
 
@@ -74,9 +74,23 @@ typedef enum
     tinyrl_vt100_CURSOR_UP,    /**< Move the cursor up        */
     tinyrl_vt100_CURSOR_DOWN,  /**< Move the cursor down      */
     tinyrl_vt100_CURSOR_LEFT,  /**< Move the cursor left      */
-    tinyrl_vt100_CURSOR_RIGHT  /**< Move the cursor right     */      
+    tinyrl_vt100_CURSOR_RIGHT, /**< Move the cursor right     */      
+    tinyrl_vt100_HOME,         /**< The Home key              */
+    tinyrl_vt100_END,          /**< The End key               */
+    tinyrl_vt100_INSERT,       /**< The Insert key            */
+    tinyrl_vt100_DELETE,       /**< The Delete key            */
+    tinyrl_vt100_PAGE_UP,      /**< The Page Up key           */
+    tinyrl_vt100_PAGE_DOWN,    /**< The Page Down key         */
+    tinyrl_vt100_PASTE_BEGIN,  /**< The start of pasted text  */
+    tinyrl_vt100_PASTE_END     /**< The end of pasted text    */
 } tinyrl_vt100_escape_t;
 
+/**
+ * The number of milliseconds allowed between the characters of a single
+ * key press, such as an escape sequence or a UTF-8 character.
+ */
+#define TINYRL_VT100_KEY_TIMEOUT 100
+
 extern tinyrl_vt100_t *
     tinyrl_vt100_new(
         FILE               *instream,
@@ -98,6 +112,43 @@ extern int
         const char           *fmt, 
         va_list               args
     );
+/**
+ * This operation outputs some text without any formatting.
+ */
+extern void
+    tinyrl_vt100_write(
+        const tinyrl_vt100_t *instance,
+        const char           *text,
+        size_t                len
+    );
+/**
+ * This operation starts a frame. Until the matching call to 
+ * tinyrl_vt100_frame_end() any text and control sequences are 
+ * collected in memory rather than being sent to the terminal.
+ * Frames may be nested.
+ */
+extern void
+    tinyrl_vt100_frame_begin(
+        const tinyrl_vt100_t *instance
+    );
+/**
+ * This operation ends a frame. When the outermost frame is ended its 
+ * contents are sent to the terminal in a single write.
+ */
+extern void
+    tinyrl_vt100_frame_end(
+        const tinyrl_vt100_t *instance
+    );
+/**
+ * This operation controls whether the horizontal cursor movements
+ * made within a frame are merged into a single movement. (The 
+ * default is to merge them.)
+ */
+extern void
+    tinyrl_vt100__set_coalesce(
+        tinyrl_vt100_t *instance,
+        bool_t          coalesce
+    );
 
 extern int
     tinyrl_vt100_oflush(
@@ -119,6 +170,20 @@ extern int
     tinyrl_vt100_getchar(
         const tinyrl_vt100_t *instance
     );
+/**
+ * This operation returns the next input character without consuming it.
+ *
+ * \return
+ * - the character or EOF if none arrives within the timeout.
+ */
+extern int
+    tinyrl_vt100_peekchar(
+        const tinyrl_vt100_t *instance,
+        /**
+         * The number of milliseconds to wait (or -1 to wait for ever)
+         */
+        int                   timeout
+    );
 extern unsigned
     tinyrl_vt100__get_width(
         const tinyrl_vt100_t *instance
@@ -141,10 +206,24 @@ extern FILE *
         const tinyrl_vt100_t *instance
     );
 
+/**
+ * This operation decodes the control sequence which follows an ESC 
+ * character. The sequence is read as it arrives, allowing 
+ * TINYRL_VT100_KEY_TIMEOUT for each character.
+ */
 extern tinyrl_vt100_escape_t
     tinyrl_vt100_escape_decode(
         const tinyrl_vt100_t *instance
     );
+/**
+ * This operation asks the terminal to mark any pasted text with
+ * tinyrl_vt100_PASTE_BEGIN and tinyrl_vt100_PASTE_END sequences.
+ */
+extern void
+    tinyrl_vt100_bracketed_paste(
+        const tinyrl_vt100_t *instance,
+        bool_t                enable
+    );
 extern void
     tinyrl_vt100_ding(
         const tinyrl_vt100_t *instance
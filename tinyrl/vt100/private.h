@@ -1,8 +1,42 @@
 #include "tinyrl/vt100.h"
+#include "lub/string.h"
 
+/* the output which can be collected before resorting to dynamic memory */
+#define TINYRL_VT100_FRAME_SIZE 256
+
+/*
+ * The output which is collected between tinyrl_vt100_frame_begin() and
+ * tinyrl_vt100_frame_end() so that it can be sent in a single write.
+ */
+typedef struct
+{
+    lub_strbuf_t buffer;
+    char         storage[TINYRL_VT100_FRAME_SIZE];
+    unsigned     depth;    /* the nesting of frame_begin() calls */
+    int          cursor;   /* pending cursor movement; +ve is forwards */
+    bool_t       coalesce; /* whether to merge cursor movements */
+} tinyrl_vt100_frame_t;
+
+/* the input which can be read from the terminal in one go */
+#define TINYRL_VT100_INPUT_SIZE 256
+
+/*
+ * The bytes which have been read from the terminal but not yet 
+ * decoded.
+ */
+typedef struct
+{
+    unsigned char buffer[TINYRL_VT100_INPUT_SIZE];
+    unsigned      head;  /* the next byte to decode */
+    unsigned      count; /* the number of bytes left to decode */
+    bool_t        eof;
+    bool_t        error;
+} tinyrl_vt100_input_t;
 
 struct _tinyrl_vt100
 {
-    FILE *istream;
-    FILE *ostream;   
+    FILE                 *istream;
+    FILE                 *ostream;   
+    tinyrl_vt100_frame_t *frame;
+    tinyrl_vt100_input_t *input;
 };
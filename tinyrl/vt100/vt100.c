@@ -1,99 +1,364 @@
 #undef __STRICT_ANSI__ /* we need to use fileno() */
 #include <stdlib.h>
+#include <errno.h>
 # include <unistd.h>
-# include <fcntl.h>
+# include <poll.h>
 
 #include "private.h"
 
 typedef struct
 {
     const char            terminator;
+    unsigned              param;
     tinyrl_vt100_escape_t code;
 } vt100_decode_t;
 
-/* This table maps the vt100 escape codes to an enumeration */
-static vt100_decode_t cmds[] =
-{
-    {'A',    tinyrl_vt100_CURSOR_UP},
-    {'B',    tinyrl_vt100_CURSOR_DOWN},
-    {'C',    tinyrl_vt100_CURSOR_RIGHT},
-    {'D',    tinyrl_vt100_CURSOR_LEFT},
+/* 
+ * This table maps the vt100/xterm control sequences (ESC [ ...) to an 
+ * enumeration. The parameter is only checked for the '~' sequences.
+ */
+static const vt100_decode_t csi_cmds[] =
+{
+    {'A',   0, tinyrl_vt100_CURSOR_UP},
+    {'B',   0, tinyrl_vt100_CURSOR_DOWN},
+    {'C',   0, tinyrl_vt100_CURSOR_RIGHT},
+    {'D',   0, tinyrl_vt100_CURSOR_LEFT},
+    {'H',   0, tinyrl_vt100_HOME},
+    {'F',   0, tinyrl_vt100_END},
+    {'~',   1, tinyrl_vt100_HOME},
+    {'~',   2, tinyrl_vt100_INSERT},
+    {'~',   3, tinyrl_vt100_DELETE},
+    {'~',   4, tinyrl_vt100_END},
+    {'~',   5, tinyrl_vt100_PAGE_UP},
+    {'~',   6, tinyrl_vt100_PAGE_DOWN},
+    {'~',   7, tinyrl_vt100_HOME},
+    {'~',   8, tinyrl_vt100_END},
+    {'~', 200, tinyrl_vt100_PASTE_BEGIN},
+    {'~', 201, tinyrl_vt100_PASTE_END}
+};
+
+/* This table maps the single shift sequences (ESC O ...) */
+static const vt100_decode_t ss3_cmds[] =
+{
+    {'A',   0, tinyrl_vt100_CURSOR_UP},
+    {'B',   0, tinyrl_vt100_CURSOR_DOWN},
+    {'C',   0, tinyrl_vt100_CURSOR_RIGHT},
+    {'D',   0, tinyrl_vt100_CURSOR_LEFT},
+    {'H',   0, tinyrl_vt100_HOME},
+    {'F',   0, tinyrl_vt100_END}
 };
+
+/* the longest control sequence we are prepared to read */
+#define TINYRL_VT100_MAX_SEQUENCE 16
+
 /*--------------------------------------------------------- */
-static void
-_tinyrl_vt100_setInputNonBlocking(const tinyrl_vt100_t *this)
+/*
+ * Make sure there is some input buffered, waiting no longer than the
+ * specified number of milliseconds. (A negative timeout waits for ever.)
+ */
+static bool_t
+tinyrl_vt100_input_fill(const tinyrl_vt100_t *this,
+                        int                   timeout)
+{
+    tinyrl_vt100_input_t *input = this->input;
+    int                   fd    = fileno(this->istream);
+    ssize_t               len;
+
+    if(input->count)
+    {
+        return BOOL_TRUE;
+    }
+    if(input->eof || input->error)
+    {
+        return BOOL_FALSE;
+    }
+    if(timeout >= 0)
+    {
+        struct pollfd pfd;
+        int           ready;
+
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+        do
+        {
+            ready = poll(&pfd,1,timeout);
+        } while((-1 == ready) && (EINTR == errno));
+        if(ready <= 0)
+        {
+            /* nothing arrived in time */
+            return BOOL_FALSE;
+        }
+    }
+    /* take whatever has arrived in one go */
+    do
+    {
+        len = read(fd,input->buffer,sizeof(input->buffer));
+    } while((-1 == len) && (EINTR == errno));
+
+    if(len > 0)
+    {
+        input->head  = 0;
+        input->count = (unsigned)len;
+        return BOOL_TRUE;
+    }
+    if(0 == len)
+    {
+        input->eof = BOOL_TRUE;
+    }
+    else
+    {
+        input->error = BOOL_TRUE;
+    }
+    return BOOL_FALSE;
+}
+/*--------------------------------------------------------- */
+int
+tinyrl_vt100_peekchar(const tinyrl_vt100_t *this,
+                      int                   timeout)
 {
-#if defined(STDIN_FILENO)
-    int flags = (fcntl(STDIN_FILENO,F_GETFL,0) | O_NONBLOCK);
-    fcntl(STDIN_FILENO,F_SETFL,flags);
-#endif /* STDIN_FILENO */
+    tinyrl_vt100_input_t *input = this->input;
+
+    if((NULL == input) || (-1 == fileno(this->istream)))
+    {
+        /* we can't wait on this stream */
+        int c = getc(this->istream);
+        if(EOF != c)
+        {
+            (void)ungetc(c,this->istream);
+        }
+        return c;
+    }
+    if(BOOL_FALSE == tinyrl_vt100_input_fill(this,timeout))
+    {
+        return EOF;
+    }
+    return input->buffer[input->head];
 }
 /*--------------------------------------------------------- */
-static void
-_tinyrl_vt100_setInputBlocking(const tinyrl_vt100_t *this)
+int
+tinyrl_vt100_getchar(const tinyrl_vt100_t *this)
+{
+    tinyrl_vt100_input_t *input = this->input;
+    int                   c;
+
+    if((NULL == input) || (-1 == fileno(this->istream)))
+    {
+        return getc(this->istream);
+    }
+    c = tinyrl_vt100_peekchar(this,-1);
+    if(EOF != c)
+    {
+        /* consume the character */
+        ++input->head;
+        --input->count;
+    }
+    return c;
+}
+/*--------------------------------------------------------- */
+/*
+ * Get the next character of a control sequence, allowing a short time 
+ * for it to arrive.
+ */
+static int
+tinyrl_vt100_sequence_getchar(const tinyrl_vt100_t *this)
+{
+    int c = tinyrl_vt100_peekchar(this,TINYRL_VT100_KEY_TIMEOUT);
+    if(EOF != c)
+    {
+        c = tinyrl_vt100_getchar(this);
+    }
+    return c;
+}
+/*--------------------------------------------------------- */
+static tinyrl_vt100_escape_t
+tinyrl_vt100_lookup(const vt100_decode_t *cmds,
+                    unsigned              num_cmds,
+                    int                   terminator,
+                    unsigned              param)
 {
-#if defined(STDIN_FILENO)
-    int flags = (fcntl(STDIN_FILENO,F_GETFL,0) & ~O_NONBLOCK);
-    fcntl(STDIN_FILENO,F_SETFL,flags);
-#endif /* STDIN_FILENO */
+    unsigned i;
+
+    for(i = 0; i < num_cmds; i++)
+    {
+        if((cmds[i].terminator == terminator)
+           && (('~' != terminator) || (cmds[i].param == param)))
+        {
+            /* found the code in the lookup table */
+            return cmds[i].code;
+        }
+    }
+    return tinyrl_vt100_UNKNOWN;
 }
 /*--------------------------------------------------------- */
 tinyrl_vt100_escape_t
 tinyrl_vt100_escape_decode(const tinyrl_vt100_t *this)
 {
     tinyrl_vt100_escape_t result = tinyrl_vt100_UNKNOWN;
-    char                  sequence[10],*p=sequence;
+    unsigned              length = 0;
+    unsigned              param  = 0;
+    bool_t                first  = BOOL_TRUE;
     int                   c;
-    unsigned              i;
-    /* before the while loop, set the input as non-blocking */
-    _tinyrl_vt100_setInputNonBlocking(this); 
 
-    /* dump the control sequence into our sequence buffer 
-     * ANSI standard control sequences will end 
-     * with a character between 64 - 126
-     */
-    while(1)
+    /* the ESC has already been read; what kind of sequence is this? */
+    c = tinyrl_vt100_sequence_getchar(this);
+    if('O' == c)
     {
-        c = getc(this->istream);
-
-        /* ignore no-character condition */
-        if(-1 != c)
+        c = tinyrl_vt100_sequence_getchar(this);
+        result = tinyrl_vt100_lookup(ss3_cmds,
+                                     sizeof(ss3_cmds)/sizeof(vt100_decode_t),
+                                     c,0);
+    }
+    else if('[' == c)
+    {
+        /* 
+         * ANSI standard control sequences have some parameter and 
+         * intermediate characters and end with a character between 
+         * 64 - 126
+         */
+        while((length++ < TINYRL_VT100_MAX_SEQUENCE)
+              && (EOF != (c = tinyrl_vt100_sequence_getchar(this))))
         {
-            *p++ = (c & 0xFF);
-            if( (c != '[') && (c > 63) ) 
+            if((c >= '0') && (c <= '9'))
             {
-                /* this is an ANSI control sequence terminator code */
-                result = tinyrl_vt100_CURSOR_UP; /* just a non-UNKNOWN value */
+                if(BOOL_TRUE == first)
+                {
+                    param = (param * 10) + (unsigned)(c - '0');
+                }
+            }
+            else if((c >= 0x20) && (c <= 0x3f))
+            {
+                /* only the first parameter is of interest */
+                first = BOOL_FALSE;
+            }
+            else
+            {
+                if((c >= 0x40) && (c <= 0x7e))
+                {
+                    result = tinyrl_vt100_lookup(csi_cmds,
+                                                 sizeof(csi_cmds)/sizeof(vt100_decode_t),
+                                                 c,param);
+                }
                 break;
             }
-        } else { 
-            result = tinyrl_vt100_UNKNOWN;
-            break;
         }
     }
-    /* terminate the string (for debug purposes) */
-    *p = '\0';
-    
-    /* restore the blocking status */
-    _tinyrl_vt100_setInputBlocking(this);
+    return result;
+}
+/*-------------------------------------------------------- */
+/*
+ * Output a control sequence of the form ESC [ <count> <terminator>
+ */
+static void
+tinyrl_vt100_csi(const tinyrl_vt100_t *this,
+                 unsigned              count,
+                 char                  terminator)
+{
+    char  sequence[16];
+    char *p = &sequence[sizeof(sequence)];
 
-    if(tinyrl_vt100_UNKNOWN != result)
+    /* build the sequence backwards from the terminator */
+    *--p = terminator;
+    do
     {
-        /* now decode the sequence */
-        for(i = 0;
-            i < sizeof(cmds)/sizeof(vt100_decode_t);
-            i++)
+        *--p = (char)('0' + (count % 10));
+        count /= 10;
+    } while(count);
+    *--p = '[';
+    *--p = KEY_ESC;
+    tinyrl_vt100_write(this,p,(size_t)(&sequence[sizeof(sequence)] - p));
+}
+/*-------------------------------------------------------- */
+/*
+ * Output the cursor movement which has been held back in the
+ * current frame.
+ */
+static void
+tinyrl_vt100_frame_cursor(const tinyrl_vt100_t *this)
+{
+    tinyrl_vt100_frame_t *frame  = this->frame;
+    int                   cursor = frame->cursor;
+
+    frame->cursor = 0;
+    if(cursor > 0)
+    {
+        tinyrl_vt100_csi(this,(unsigned)cursor,'C');
+    }
+    else if(cursor < 0)
+    {
+        tinyrl_vt100_csi(this,(unsigned)-cursor,'D');
+    }
+}
+/*-------------------------------------------------------- */
+/*
+ * Send and empty the current frame. (This must be called from within the
+ * frame so that any pending movement is collected with the rest.)
+ */
+static void
+tinyrl_vt100_frame_flush(const tinyrl_vt100_t *this)
+{
+    tinyrl_vt100_frame_t *frame = this->frame;
+    size_t                len;
+
+    tinyrl_vt100_frame_cursor(this);
+    len = lub_strbuf__get_length(&frame->buffer);
+    if(len)
+    {
+        /* 
+         * go through stdio so that anything the client has already 
+         * printed comes first; the frame is still sent in one write.
+         */
+        (void)fwrite(lub_strbuf__get_string(&frame->buffer),1,len,this->ostream);
+        (void)fflush(this->ostream);
+        
+        /* start again with the static storage */
+        lub_strbuf_fini(&frame->buffer);
+        lub_strbuf_init(&frame->buffer,frame->storage,sizeof(frame->storage));
+    }
+}
+/*-------------------------------------------------------- */
+void
+tinyrl_vt100_write(const tinyrl_vt100_t *this,
+                   const char           *text,
+                   size_t                len)
+{
+    tinyrl_vt100_frame_t *frame = this->frame;
+
+    if(frame && frame->depth)
+    {
+        if(frame->cursor)
         {
-            if(cmds[i].terminator == c)
-            {
-                /* found the code in the lookup table */
-                result = cmds[i].code;
-                break;
-            }
+            tinyrl_vt100_frame_cursor(this);
         }
+        lub_strbuf_catn(&frame->buffer,text,len);
+    }
+    else
+    {
+        (void)fwrite(text,1,len,this->ostream);
+    }
+}
+/*-------------------------------------------------------- */
+void
+tinyrl_vt100_frame_begin(const tinyrl_vt100_t *this)
+{
+    if(this->frame)
+    {
+        ++this->frame->depth;
+    }
+}
+/*-------------------------------------------------------- */
+void
+tinyrl_vt100_frame_end(const tinyrl_vt100_t *this)
+{
+    tinyrl_vt100_frame_t *frame = this->frame;
+
+    if(frame && frame->depth)
+    {
+        if(1 == frame->depth)
+        {
+            tinyrl_vt100_frame_flush(this);
+        }
+        --frame->depth;
     }
-    
-    return result;
 }
 /*-------------------------------------------------------- */
 int 
@@ -117,25 +382,29 @@ tinyrl_vt100_vprintf(const tinyrl_vt100_t *this,
                      const char           *fmt,
                      va_list               args)
 {
+    if(this->frame && this->frame->depth)
+    {
+        /* keep the output in order */
+        tinyrl_vt100_frame_flush(this);
+    }
     return vfprintf(this->ostream, fmt, args);
 }
 /*-------------------------------------------------------- */
 int
-tinyrl_vt100_getchar(const tinyrl_vt100_t *this)
-{
-    return getc(this->istream);
-}
-/*-------------------------------------------------------- */
-int
 tinyrl_vt100_oflush(const tinyrl_vt100_t *this)
 {
+    if(this->frame && this->frame->depth)
+    {
+        /* the output will be sent at the end of the frame */
+        return 0;
+    }
     return fflush(this->ostream);
 }
 /*-------------------------------------------------------- */
 int
 tinyrl_vt100_ierror(const tinyrl_vt100_t *this)
 {
-    return ferror(this->istream);
+    return (this->input && this->input->error) || ferror(this->istream);
 }
 /*-------------------------------------------------------- */
 int
@@ -147,13 +416,13 @@ tinyrl_vt100_oerror(const tinyrl_vt100_t *this)
 int
 tinyrl_vt100_ieof(const tinyrl_vt100_t *this)
 {
-    return feof(this->istream);
+    return (this->input && this->input->eof) || feof(this->istream);
 }
 /*-------------------------------------------------------- */
 int
 tinyrl_vt100_eof(const tinyrl_vt100_t *this)
 {
-    return feof(this->istream);
+    return tinyrl_vt100_ieof(this);
 }
 /*-------------------------------------------------------- */
 unsigned
@@ -171,13 +440,41 @@ tinyrl_vt100_init(tinyrl_vt100_t     *this,
 {
     this->istream  = istream;
     this->ostream = ostream;
+    this->frame   = malloc(sizeof(tinyrl_vt100_frame_t));
+    if(NULL != this->frame)
+    {
+        lub_strbuf_init(&this->frame->buffer,
+                        this->frame->storage,
+                        sizeof(this->frame->storage));
+        this->frame->depth    = 0;
+        this->frame->cursor   = 0;
+        this->frame->coalesce = BOOL_TRUE;
+    }
+    this->input = malloc(sizeof(tinyrl_vt100_input_t));
+    if(NULL != this->input)
+    {
+        this->input->head  = 0;
+        this->input->count = 0;
+        this->input->eof   = BOOL_FALSE;
+        this->input->error = BOOL_FALSE;
+    }
 }
 /*-------------------------------------------------------- */
 static void
 tinyrl_vt100_fini(tinyrl_vt100_t *this)
 {
-    /* nothing to do yet... */
-    this=this;
+    if(NULL != this->frame)
+    {
+        if(this->frame->depth)
+        {
+            /* don't lose any pending output */
+            this->frame->depth = 1;
+            tinyrl_vt100_frame_end(this);
+        }
+        lub_strbuf_fini(&this->frame->buffer);
+        free(this->frame);
+    }
+    free(this->input);
 }
 /*-------------------------------------------------------- */
 tinyrl_vt100_t *
@@ -206,121 +503,166 @@ tinyrl_vt100_delete(tinyrl_vt100_t *this)
 void
 tinyrl_vt100_ding(const tinyrl_vt100_t *this)
 {
-    tinyrl_vt100_printf(this,"%c",KEY_BEL);
+    tinyrl_vt100_write(this,"\007",1);
     (void)tinyrl_vt100_oflush(this);
 }
 /*-------------------------------------------------------- */
 void
+tinyrl_vt100_bracketed_paste(const tinyrl_vt100_t *this,
+                             bool_t                enable)
+{
+    if(BOOL_TRUE == enable)
+    {
+        tinyrl_vt100_write(this,"\033[?2004h",8);
+    }
+    else
+    {
+        tinyrl_vt100_write(this,"\033[?2004l",8);
+    }
+}
+/*-------------------------------------------------------- */
+void
 tinyrl_vt100_attribute_reset(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[0m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[0m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_bright(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[1m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[1m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_dim(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[2m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[2m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_underscore(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[4m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[4m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_blink(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[5m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[5m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_reverse(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[7m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[7m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_attribute_hidden(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[8m",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[8m",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_erase_line(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[2K",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[2K",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_clear_screen(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[2J",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[2J",4);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_save(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c7",KEY_ESC);
+        tinyrl_vt100_write(this,"\0337",2);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_restore(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c8",KEY_ESC);
+        tinyrl_vt100_write(this,"\0338",2);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_forward(const tinyrl_vt100_t *this,
                             unsigned              count)
 {
-        tinyrl_vt100_printf(this,"%c[%dC",KEY_ESC,count);
+    tinyrl_vt100_frame_t *frame = this->frame;
+    
+    if(frame && frame->depth && frame->coalesce)
+    {
+        /* merge with any other movements in this frame */
+        frame->cursor += (int)count;
+    }
+    else
+    {
+        tinyrl_vt100_csi(this,count,'C');
+    }
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_back(const tinyrl_vt100_t *this,
                          unsigned              count)
 {
-        tinyrl_vt100_printf(this,"%c[%dD",KEY_ESC,count);
+    tinyrl_vt100_frame_t *frame = this->frame;
+    
+    if(frame && frame->depth && frame->coalesce)
+    {
+        /* merge with any other movements in this frame */
+        frame->cursor -= (int)count;
+    }
+    else
+    {
+        tinyrl_vt100_csi(this,count,'D');
+    }
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_up(const tinyrl_vt100_t *this,
                        unsigned              count)
 {
-        tinyrl_vt100_printf(this,"%c[%dA",KEY_ESC,count);
+        tinyrl_vt100_csi(this,count,'A');
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_down(const tinyrl_vt100_t *this,
                          unsigned              count)
 {
-        tinyrl_vt100_printf(this,"%c[%dB",KEY_ESC,count);
+        tinyrl_vt100_csi(this,count,'B');
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_cursor_home(const tinyrl_vt100_t *this)
 {
-        tinyrl_vt100_printf(this,"%c[H",KEY_ESC);
+        tinyrl_vt100_write(this,"\033[H",3);
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100_erase(const tinyrl_vt100_t *this,
                    unsigned              count)
 {
-        tinyrl_vt100_printf(this,"%c[%dP",KEY_ESC,count);
+        tinyrl_vt100_csi(this,count,'P');
 }
 /*-------------------------------------------------------- */
 void
 tinyrl_vt100__set_istream(tinyrl_vt100_t *this,
                           FILE           *istream)
 {
+        if(this->input && (istream != this->istream))
+        {
+            /* 
+             * anything read ahead came from the old stream so mustn't
+             * be decoded as if it came from this one
+             */
+            this->input->head  = 0;
+            this->input->count = 0;
+            this->input->eof   = BOOL_FALSE;
+            this->input->error = BOOL_FALSE;
+        }
         this->istream = istream;
 }
 /*-------------------------------------------------------- */
@@ -336,3 +678,13 @@ tinyrl_vt100__get_ostream(const tinyrl_vt100_t *this)
         return this->ostream;
 }
 /*-------------------------------------------------------- */
+void
+tinyrl_vt100__set_coalesce(tinyrl_vt100_t *this,
+                           bool_t          coalesce)
+{
+    if(this->frame)
+    {
+        this->frame->coalesce = coalesce;
+    }
+}
+/*-------------------------------------------------------- */